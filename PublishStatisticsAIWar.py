@@ -167,14 +167,14 @@ def createStatistics_overview(args):
                 draw = 0
                 for g in playerGames:
                     if g['blue']['name'] == name and 'blue wins' in g['result']    \
-                       or g['blue']['name'] == name and 'red error' in g['result'] \
+                       or g['blue']['name'] == name and ('red error' in g['result'] or 'red forfeit' in g['result']) \
                        or g['red']['name'] == name and 'red wins' in g['result']   \
-                       or g['red']['name'] == name and 'blue error' in g['result']:
+                       or g['red']['name'] == name and ('blue error' in g['result'] or 'blue forfeit' in g['result']):
                         win += 1
                     elif g['blue']['name'] == name and 'red wins' in g['result']    \
-                       or g['blue']['name'] == name and 'blue error' in g['result'] \
+                       or g['blue']['name'] == name and ('blue error' in g['result'] or 'blue forfeit' in g['result']) \
                        or g['red']['name'] == name and 'blue wins' in g['result']   \
-                       or g['red']['name'] == name and 'red error' in g['result']:
+                       or g['red']['name'] == name and ('red error' in g['result'] or 'red forfeit' in g['result']):
                          lose += 1
                     elif 'draw' in g['result']:
                          draw += 1
@@ -231,8 +231,8 @@ def createStatistics_maps(args):
                     # '[{playerName, rank, blue, red}]' added later
                 
                 # Blue/Red ratio winner
-                brRatio[map_]['blue'] += len([g for g in resultFile if g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error') ])
-                brRatio[map_]['red'] += len([g for g in resultFile if g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error') ])
+                brRatio[map_]['blue'] += len([g for g in resultFile if g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit') ])
+                brRatio[map_]['red'] += len([g for g in resultFile if g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit') ])
                 
                 # Duration of game
                 duration[map_]['samples'] += [int(g['end']-g['start']) for g in resultFile if g['map'] == map_]
@@ -246,14 +246,14 @@ def createStatistics_maps(args):
                     draw = 0
                     for g in playerGames:
                         if g['blue']['name'] == name and 'blue wins' in g['result']    \
-                           or g['blue']['name'] == name and 'red error' in g['result'] \
+                           or g['blue']['name'] == name and ('red error' in g['result'] or 'red forfeit' in g['result']) \
                            or g['red']['name'] == name and 'red wins' in g['result']   \
-                           or g['red']['name'] == name and 'blue error' in g['result']:
+                           or g['red']['name'] == name and ('blue error' in g['result'] or 'blue forfeit' in g['result']):
                             win += 1
                         elif g['blue']['name'] == name and 'red wins' in g['result']    \
-                           or g['blue']['name'] == name and 'blue error' in g['result'] \
+                           or g['blue']['name'] == name and ('blue error' in g['result'] or 'blue forfeit' in g['result']) \
                            or g['red']['name'] == name and 'blue wins' in g['result']   \
-                           or g['red']['name'] == name and 'red error' in g['result']:
+                           or g['red']['name'] == name and ('red error' in g['result'] or 'red forfeit' in g['result']):
                             lose += 1
                         elif 'draw' in g['result']:
                             draw += 1
@@ -326,18 +326,18 @@ def createStatistics_players(args):
                     # '[{duration, number}]' added later
                 
                 # Blue/Red ratio winner
-                brRatio[playerName]['blue'] += len([g for g in resultFile if g['blue']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error') ])
-                brRatio[playerName]['red'] += len([g for g in resultFile if g['red']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error') ])
+                brRatio[playerName]['blue'] += len([g for g in resultFile if g['blue']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit') ])
+                brRatio[playerName]['red'] += len([g for g in resultFile if g['red']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit') ])
                 
                 # Overview win/lose/draw ratio
                 # {playerName, win, draw, lose}
                 overRatio[playerName]['win'] += len([g for g in resultFile 
-                                                     if (g['blue']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error')) 
-                                                     or (g['red']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error')) ])
+                                                     if (g['blue']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) 
+                                                     or (g['red']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) ])
                 overRatio[playerName]['draw'] += len([g for g in resultFile if (g['red']['name'] == playerName or g['blue']['name'] == playerName) and g['result'] == 'draw' ])
                 overRatio[playerName]['lose'] += len([g for g in resultFile 
-                                                     if (g['blue']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error')) 
-                                                     or (g['red']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error')) ])
+                                                     if (g['blue']['name'] == playerName and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) 
+                                                     or (g['red']['name'] == playerName and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) ])
                 
                 # Duration of game
                 # {playerName, samples:[{duration, number}]}
@@ -349,14 +349,14 @@ def createStatistics_players(args):
                     if on != playerName:
                         # Stats against other players
                         w = len([g for g in resultFile 
-                                 if (g['blue']['name'] == playerName and g['red']['name'] == on and (g['result'] == 'blue wins' or g['result'] == 'red error')) 
-                                 or (g['red']['name'] == playerName and g['blue']['name'] == on and (g['result'] == 'red wins' or g['result'] == 'blue error')) ])
+                                 if (g['blue']['name'] == playerName and g['red']['name'] == on and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) 
+                                 or (g['red']['name'] == playerName and g['blue']['name'] == on and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) ])
                         d = len([g for g in resultFile 
                                  if (g['blue']['name'] == playerName and g['red']['name'] == on and g['result'] == 'draw') 
                                  or (g['red']['name'] == playerName and g['blue']['name'] == on and g['result'] == 'draw') ])
                         l = len([g for g in resultFile 
-                                 if (g['blue']['name'] == playerName and g['red']['name'] == on and (g['result'] == 'red wins' or g['result'] == 'blue error')) 
-                                 or (g['red']['name'] == playerName and g['blue']['name'] == on and (g['result'] == 'blue wins' or g['result'] == 'red error')) ])
+                                 if (g['blue']['name'] == playerName and g['red']['name'] == on and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) 
+                                 or (g['red']['name'] == playerName and g['blue']['name'] == on and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) ])
                         if on not in playerRatio[playerName].keys():
                             # add new player in list
                             playerRatio[playerName][on] = {'playerName': playerName, 'opponentName': on, 'win': w, 'draw': d, 'lose': l}
@@ -370,14 +370,14 @@ def createStatistics_players(args):
                 # {playerName, maps:[{playerName, mapName, win, draw, lose}]}
                 for map_ in args['list-maps']:
                     w = len([g for g in resultFile 
-                                                 if (g['blue']['name'] == playerName and g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error')) 
-                                                 or (g['red']['name'] == playerName and g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error')) ])
+                                                 if (g['blue']['name'] == playerName and g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) 
+                                                 or (g['red']['name'] == playerName and g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) ])
                     d = len([g for g in resultFile 
                                                  if (g['blue']['name'] == playerName and g['map'] == map_ and g['result'] == 'draw') 
                                                  or (g['red']['name'] == playerName and g['map'] == map_ and g['result'] == 'draw') ])
                     l = len([g for g in resultFile 
-                                                 if (g['blue']['name'] == playerName and g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error')) 
-                                                 or (g['red']['name'] == playerName and g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error')) ])
+                                                 if (g['blue']['name'] == playerName and g['map'] == map_ and (g['result'] == 'red wins' or g['result'] == 'blue error' or g['result'] == 'blue forfeit')) 
+                                                 or (g['red']['name'] == playerName and g['map'] == map_ and (g['result'] == 'blue wins' or g['result'] == 'red error' or g['result'] == 'red forfeit')) ])
                     if map_ not in mapRatio[playerName].keys():
                         # add new map in list
                         mapRatio[playerName][map_] = {'playerName': playerName, 'mapName': map_, 'win': w, 'draw': d, 'lose': l}
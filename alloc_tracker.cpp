@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "alloc_tracker.hpp"
+
+#include "profiler.hpp" // for Profiler::Phase
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#ifdef AIWAR_ALLOC_TRACKING
+#       ifndef __GNUC__
+#               error "The allocation tracking needs gcc or clang"
+#       endif
+#       define AIWAR_THREAD_LOCAL __thread
+#else
+#       define AIWAR_THREAD_LOCAL
+#endif
+
+using namespace aiwar::core;
+
+namespace {
+
+// phase 0 is out of any ProfileScope, the phase p of the profiler is p + 1
+const int PHASES = Profiler::RENDER + 2;
+
+const char* phaseName(int phase)
+{
+    switch(phase - 1)
+    {
+    case Profiler::TICK: return "tick";
+    case Profiler::PLAY: return "play";
+    case Profiler::PYTHON: return "python";
+    case Profiler::NEIGHBOURS: return "neighbours";
+    case Profiler::THINK: return "think";
+    case Profiler::REMOVE: return "remove";
+    case Profiler::MISSILES: return "missiles";
+    case Profiler::ACTIVITY: return "activity";
+    case Profiler::RENDER: return "render";
+    }
+    return "other";
+}
+
+const char* siteName(int site)
+{
+    switch(site)
+    {
+    case AllocTracker::LOG: return "log";
+    case AllocTracker::CACHE: return "neighbour cache";
+    case AllocTracker::ITEMS: return "items";
+    case AllocTracker::PYTHON_OBJECTS: return "python objects";
+    default: return "";
+    }
+}
+
+// a counter is only written by atomic adds, from any thread
+struct Counter
+{
+    unsigned long allocs;
+    unsigned long bytes;
+    unsigned long frees;
+};
+
+// zero initialized before any constructor, operator new can be called first
+Counter counters[PHASES][AllocTracker::SITES][AllocTracker::SOURCES];
+
+AIWAR_THREAD_LOCAL int currentPhase = 0;
+AIWAR_THREAD_LOCAL int currentSite = AllocTracker::NO_SITE;
+
+// allocations per tick, of all the threads, updated by the main thread
+unsigned long ticks = 0;
+unsigned long lastAllocs = 0, lastBytes = 0;
+unsigned long maxAllocs = 0, maxBytes = 0;
+unsigned long tickAllocs = 0, tickBytes = 0;
+
+void add(unsigned long &counter, unsigned long value)
+{
+#ifdef AIWAR_ALLOC_TRACKING
+    __sync_fetch_and_add(&counter, value);
+#else
+    counter += value;
+#endif
+}
+
+void totals(unsigned long &allocs, unsigned long &bytes, unsigned long &frees)
+{
+    allocs = bytes = frees = 0;
+    for(int p = 0 ; p < PHASES ; ++p)
+    {
+        for(int s = 0 ; s < AllocTracker::SITES ; ++s)
+        {
+            for(int src = 0 ; src < AllocTracker::SOURCES ; ++src)
+            {
+                allocs += counters[p][s][src].allocs;
+                bytes += counters[p][s][src].bytes;
+                frees += counters[p][s][src].frees;
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+
+/*** AllocTracker class ***/
+
+void AllocTracker::allocated(Source source, std::size_t bytes)
+{
+    Counter &c = counters[currentPhase][currentSite][source];
+    add(c.allocs, 1);
+    add(c.bytes, bytes);
+}
+
+void AllocTracker::freed(Source source)
+{
+    add(counters[currentPhase][currentSite][source].frees, 1);
+}
+
+int AllocTracker::enterPhase(int phase)
+{
+    int previous = currentPhase;
+    currentPhase = phase + 1;
+    return previous;
+}
+
+void AllocTracker::leavePhase(int previous)
+{
+    bool tick = (currentPhase == Profiler::TICK + 1);
+    currentPhase = previous;
+    if(tick)
+        _endTick();
+}
+
+int AllocTracker::enterSite(Site site)
+{
+    int previous = currentSite;
+    currentSite = site;
+    return previous;
+}
+
+void AllocTracker::leaveSite(int previous)
+{
+    currentSite = previous;
+}
+
+void AllocTracker::_endTick()
+{
+    unsigned long allocs, bytes, frees;
+    totals(allocs, bytes, frees);
+
+    unsigned long a = allocs - lastAllocs, b = bytes - lastBytes;
+    lastAllocs = allocs;
+    lastBytes = bytes;
+    ticks++;
+    tickAllocs += a;
+    tickBytes += b;
+    if(a > maxAllocs)
+        maxAllocs = a;
+    if(b > maxBytes)
+        maxBytes = b;
+}
+
+std::string AllocTracker::dump()
+{
+    std::ostringstream oss;
+    unsigned long allocs, bytes, frees;
+    totals(allocs, bytes, frees);
+
+    double n = ticks > 0 ? static_cast<double>(ticks) : 1.0;
+    oss << "Allocations: " << allocs << " (" << bytes << " bytes), frees: " << frees << "\n"
+        << "Allocations per tick (" << ticks << " ticks): mean " << std::fixed << std::setprecision(1)
+        << tickAllocs / n << " (" << tickBytes / n << " bytes), max " << maxAllocs << " (" << maxBytes << " bytes)\n";
+
+    // one line per phase and site, with the operator new and python counts
+    for(int p = 0 ; p < PHASES ; ++p)
+    {
+        for(int s = 0 ; s < SITES ; ++s)
+        {
+            const Counter &cxx = counters[p][s][CXX];
+            const Counter &py = counters[p][s][PYTHON];
+            if(cxx.allocs == 0 && py.allocs == 0)
+                continue;
+
+            oss << "\t" << phaseName(p);
+            if(s != NO_SITE)
+                oss << "/" << siteName(s);
+            oss << ": " << cxx.allocs << " (" << cxx.bytes << " bytes)";
+            if(py.allocs > 0)
+                oss << " + python " << py.allocs << " (" << py.bytes << " bytes)";
+            oss << ", " << (cxx.allocs + py.allocs) / n << " per tick\n";
+        }
+    }
+    return oss.str();
+}
+
+
+/*** replaced global operators ***/
+
+#ifdef AIWAR_ALLOC_TRACKING
+
+#if __cplusplus >= 201103L
+#       define AIWAR_THROW_BAD_ALLOC
+#       define AIWAR_NO_THROW noexcept
+#else
+#       define AIWAR_THROW_BAD_ALLOC throw(std::bad_alloc)
+#       define AIWAR_NO_THROW throw()
+#endif
+
+namespace {
+
+// malloc, calling the new handler until it succeeds, like the default operator new
+void* allocate(std::size_t size)
+{
+    if(size == 0)
+        size = 1;
+
+    void *p;
+    while(!(p = std::malloc(size)))
+    {
+        std::new_handler handler = std::set_new_handler(0);
+        std::set_new_handler(handler);
+        if(!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+    AllocTracker::allocated(AllocTracker::CXX, size);
+    return p;
+}
+
+void deallocate(void *p)
+{
+    if(!p)
+        return;
+    AllocTracker::freed(AllocTracker::CXX);
+    std::free(p);
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) AIWAR_THROW_BAD_ALLOC
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) AIWAR_THROW_BAD_ALLOC
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) AIWAR_NO_THROW
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch(...)
+    {
+        return NULL;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) AIWAR_NO_THROW
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch(...)
+    {
+        return NULL;
+    }
+}
+
+void operator delete(void *p) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete[](void *p) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void *p, std::size_t) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete[](void *p, std::size_t) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+#endif
+
+void operator delete(void *p, const std::nothrow_t&) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) AIWAR_NO_THROW
+{
+    deallocate(p);
+}
+
+#endif /* AIWAR_ALLOC_TRACKING */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Counts the allocations per tick, phase and call site, in the
+         * builds defining AIWAR_ALLOC_TRACKING ('make ALLOC_TRACKING=1')
+         *
+         * The global operator new and delete are replaced by counting ones.
+         * Python 2 has no hook on its allocators: the python source only
+         * counts the objects created by the wrapper for the AIs (items,
+         * snapshots and lists), the allocations made by the python code of
+         * the AIs are not tracked. An allocation is counted in the
+         * phase of the innermost ProfileScope of its thread, even if
+         * --profile is not given, and in the site of the innermost AllocSite.
+         * Allocations out of any phase, before the game or in other threads,
+         * are in the "other" phase.
+         *
+         * In the other builds, the scopes do nothing and nothing is counted.
+         */
+        class AllocTracker
+        {
+        public:
+            /**
+             * \brief Call sites known to allocate during a tick
+             */
+            enum Site
+            {
+                NO_SITE,
+                LOG,            ///< Playable::log
+                CACHE,          ///< entries of the neighbour cache
+                ITEMS,          ///< creation of the items
+                PYTHON_OBJECTS, ///< python objects wrapping the items
+                SITES
+            };
+
+            enum Source
+            {
+                CXX,    ///< operator new
+                PYTHON, ///< python objects created by the wrapper
+                SOURCES
+            };
+
+            static bool compiled()
+            {
+#ifdef AIWAR_ALLOC_TRACKING
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            /**
+             * \brief Count an allocation, in the phase and site of the calling thread
+             */
+            static void allocated(Source source, std::size_t bytes);
+            static void freed(Source source);
+
+            /**
+             * \brief Intern methods. Set the phase or the site of the calling thread
+             * \return The previous one, to give back when leaving
+             */
+            static int enterPhase(int phase);
+            static void leavePhase(int previous);
+            static int enterSite(Site site);
+            static void leaveSite(int previous);
+
+            /**
+             * \brief Totals, per tick and per phase and site
+             */
+            static std::string dump();
+
+        private:
+            static void _endTick();
+        };
+
+
+        /**
+         * \brief Counts the allocations from its construction to its destruction in a site
+         */
+        class AllocSite
+        {
+        public:
+#ifdef AIWAR_ALLOC_TRACKING
+            explicit AllocSite(AllocTracker::Site site) : _previous(AllocTracker::enterSite(site)) {}
+            ~AllocSite() { AllocTracker::leaveSite(_previous); }
+#else
+            explicit AllocSite(AllocTracker::Site) {}
+#endif
+
+        private:
+            // no copy
+            AllocSite(const AllocSite&);
+            AllocSite& operator=(const AllocSite&);
+
+#ifdef AIWAR_ALLOC_TRACKING
+            int _previous;
+#endif
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* ALLOC_TRACKER_HPP */
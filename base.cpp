@@ -38,6 +38,7 @@ Base::Base(GameManager &gm, Key k, double xpos, double ypos, Team team, PlayFunc
       _mineralStorage(Config::instance().BASE_START_MINERAL_STORAGE),
       _hasLaunch(false), _hasCreate(false)
 {
+    _tag |= BASE_KIND;
     // the only way for a Base to save mineral. Warning if at a time player will be able to create base
     _sm.mineralSaved(team, _mineralStorage);
 }
@@ -46,6 +47,11 @@ Base::~Base()
 {
 }
 
+Base* Base::_asBase()
+{
+    return this;
+}
+
 void Base::_preUpdate(unsigned int ticks)
 {
     Playable::_preUpdate(ticks);
@@ -54,6 +60,11 @@ void Base::_preUpdate(unsigned int ticks)
     _hasCreate = false;
 }
 
+void Base::_startRound(unsigned int tick)
+{
+    _preUpdate(tick);
+}
+
 void Base::update(unsigned int tick)
 {
     _preUpdate(tick);
@@ -146,7 +157,7 @@ unsigned int Base::repair(unsigned int points, Living *item)
 
     // repair only friends or neutral items
     Playable *pl = NULL;
-    if((pl = dynamic_cast<Playable*>(item)))
+    if((pl = item_cast<Playable>(item)))
     {
         if(!isFriend(pl))
         {
@@ -174,7 +185,7 @@ unsigned int Base::refuel(unsigned int points, Movable *item)
 
     // refuel only friends or neutral items
     Playable *pl = NULL;
-    if((pl = dynamic_cast<Playable*>(item)))
+    if((pl = item_cast<Playable>(item)))
     {
         if(!isFriend(pl))
         {
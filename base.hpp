@@ -40,7 +40,10 @@ namespace aiwar {
             Base(GameManager &gm, Key k, double xpos, double ypos, Team team, PlayFunction& pf);
             ~Base();
 
+            Base* _asBase();
+
             void update(unsigned int tick);
+            void _startRound(unsigned int tick);
 
             /**
              * \brief Launch a missile to the target
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Dispatch benchmark: times a tick and a frame with 10 to 100000 items
+ *  - "update": ItemManager::update() with units doing nothing and missiles launched at the start, per item and tick
+ *  - "frame_draw": a frame of RendererSDLDraw (all the items and the stats) drawn in memory, per frame
+ *  - "frame_summary": the final frame of RendererSummary, per frame
+ * 'make bench_dispatch' builds it twice: bench_dispatch_tag finds the kind of the items
+ * with their tag, bench_dispatch_rtti with the dynamic_cast chains of the code before
+ * the tags (AIWAR_RTTI_CAST). Both play the same game, with the same checksums.
+ *
+ * usage: bench_dispatch_tag|bench_dispatch_rtti [max_items], run from the directory of
+ * config.xml and fonts/, no window is opened (SDL dummy video driver)
+ * Output: a header line with the dispatch, then one line per case and size,
+ * "case items reps ns_per_op checksum", to compare the runs of both binaries
+ */
+
+#include "game_manager.hpp"
+#include "item_manager.hpp"
+#include "stat_manager.hpp"
+#include "mineral.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "base.hpp"
+#include "handler_dummy.hpp"
+#include "renderer_sdl.hpp"
+#include "renderer_sdl_draw.hpp"
+#include "renderer_summary.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+#include <sys/time.h>
+
+using namespace aiwar::core;
+using aiwar::renderer::RendererSDL;
+using aiwar::renderer::RendererSDLDraw;
+using aiwar::renderer::RendererSummary;
+
+// item operations per case and size, to keep each case about as long at every size
+static const unsigned long TICK_OPS = 200000;
+static const unsigned long FRAME_OPS = 100000;
+
+// distance between two items, most units see about 30 neighbours
+static const double SPACING = 50.0;
+
+// one unit in MISSILE_RATE launches a missile at the start
+static const unsigned int MISSILE_RATE = 10;
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static unsigned long repsFor(unsigned long ops, unsigned int items, unsigned long minimum)
+{
+    unsigned long reps = ops / items;
+    return reps < minimum ? minimum : reps;
+}
+
+static unsigned long countItems(const ItemManager &im)
+{
+    unsigned long n = 0;
+    ItemManager::ItemMap::const_iterator it;
+    for(it = im.begin() ; it != im.end() ; ++it)
+        n++;
+    return n;
+}
+
+static void report(const char *name, unsigned int items, unsigned long reps, double seconds, unsigned long ops, unsigned long checksum)
+{
+    std::printf("%s %u %lu %.1f %lu\n", name, items, reps, ops > 0 ? seconds * 1e9 / ops : 0.0, checksum);
+    std::fflush(stdout);
+}
+
+// a game with the units played by HandlerDummy: both bases, then minerals, mining
+// ships and fighters on a square grid, and missiles launched at the enemies
+class Game
+{
+public:
+    Game(HandlerInterface &h, unsigned int n) : _h(h)
+    {
+        const Config &cfg = Config::instance();
+        std::srand(cfg.seed);
+        _h.load(cfg.blue, "");
+        _h.load(cfg.red, "");
+        _gm = new GameManager();
+        _gm->registerTeam(BLUE_TEAM, _h.get_BaseHandler(cfg.blue), _h.get_MiningShipHandler(cfg.blue), _h.get_FighterHandler(cfg.blue), _h.get_TeamHandler(cfg.blue));
+        _gm->registerTeam(RED_TEAM, _h.get_BaseHandler(cfg.red), _h.get_MiningShipHandler(cfg.red), _h.get_FighterHandler(cfg.red), _h.get_TeamHandler(cfg.red));
+        _populate(n);
+    }
+
+    ~Game()
+    {
+        delete _gm;
+        const Config &cfg = Config::instance();
+        _h.unload(cfg.red);
+        _h.unload(cfg.blue);
+    }
+
+    GameManager& gm() { return *_gm; }
+    ItemManager& im() { return _gm->getItemManager(); }
+
+private:
+    // no copy
+    Game(const Game&);
+    Game& operator=(const Game&);
+
+    static void _position(unsigned int i, unsigned int n, double &x, double &y)
+    {
+        unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(n))));
+        x = (i % side) * SPACING + (std::rand() % 100) * 0.1;
+        y = (i / side) * SPACING + (std::rand() % 100) * 0.1;
+    }
+
+    void _populate(unsigned int n)
+    {
+        double x, y;
+        _position(0, n, x, y);
+        im().createBase(x, y, BLUE_TEAM);
+        _position(n - 1, n, x, y);
+        im().createBase(x, y, RED_TEAM);
+
+        Fighter *targets[RED_TEAM + 1] = { NULL };
+        for(unsigned int i = 1 ; i + 1 < n ; ++i)
+        {
+            _position(i, n, x, y);
+            Team team = (i % 2) ? RED_TEAM : BLUE_TEAM;
+            switch(i % 3)
+            {
+            case 0:
+                im().createMineral(x, y);
+                break;
+            case 1:
+                im().createMiningShip(x, y, team);
+                break;
+            default:
+                targets[team] = im().createFighter(x, y, team);
+                break;
+            }
+        }
+        im().packMinerals();
+
+        // the missiles of each team fly to the last fighter of the other one, the map grows with them
+        std::vector<Playable*> launchers;
+        unsigned int i = 0;
+        ItemManager::ItemMap::const_iterator it;
+        for(it = im().begin() ; it != im().end() ; ++it, ++i)
+        {
+            Playable *p = item_cast<Playable>(it->second);
+            if(p && i % MISSILE_RATE == 0)
+                launchers.push_back(p);
+        }
+        std::vector<Playable*>::const_iterator l;
+        for(l = launchers.begin() ; l != launchers.end() ; ++l)
+        {
+            Fighter *target = targets[((*l)->team() == BLUE_TEAM) ? RED_TEAM : BLUE_TEAM];
+            if(target)
+                im().createMissile(*l, target);
+        }
+    }
+
+    HandlerInterface &_h;
+    GameManager *_gm;
+};
+
+static void benchUpdate(HandlerInterface &h, unsigned int n)
+{
+    Game g(h, n);
+
+    unsigned long ticks = repsFor(TICK_OPS, n, 3);
+    double start = now();
+    for(unsigned long t = 0 ; t < ticks ; ++t)
+        g.im().update(static_cast<unsigned int>(t));
+    report("update", n, ticks, now() - start, ticks * n, countItems(g.im()));
+}
+
+static void benchFrameDraw(HandlerInterface &h, unsigned int n, SDL_Surface *screen)
+{
+    Game g(h, n);
+    RendererSDLDraw drawer(screen);
+
+    // the items as seen by RendererSDL
+    RendererSDL::ItemExMap items;
+    ItemManager::ItemMap::const_iterator it;
+    for(it = g.im().begin() ; it != g.im().end() ; ++it)
+        items[it->first].item = it->second;
+
+    unsigned long frames = repsFor(FRAME_OPS, n, 3);
+    double start = now();
+    for(unsigned long f = 0 ; f < frames ; ++f)
+    {
+        drawer.preDraw(false, 0, 0, 0, 0, 0, 0, 0);
+        RendererSDL::ItemExMap::iterator ex;
+        for(ex = items.begin() ; ex != items.end() ; ++ex)
+            drawer.draw(&ex->second, g.im());
+        drawer.drawStats(g.gm().getStatManager(), g.im());
+        drawer.postDraw();
+    }
+    report("frame_draw", n, frames, now() - start, frames, items.size());
+}
+
+static void benchFrameSummary(HandlerInterface &h, unsigned int n)
+{
+    Game g(h, n);
+    RendererSummary summary;
+
+    unsigned long frames = repsFor(FRAME_OPS / 10, 1, 1), checksum = 0;
+    double start = now();
+    for(unsigned long f = 0 ; f < frames ; ++f)
+        checksum += summary.render(g.im(), g.gm().getStatManager(), true, NO_TEAM) ? 1 : 0;
+    report("frame_summary", n, frames, now() - start, frames, checksum);
+}
+
+// the frames are drawn in memory, with the dummy video driver unless another one is asked
+static SDL_Surface* openScreen()
+{
+    if(!std::getenv("SDL_VIDEODRIVER"))
+        putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+    if(SDL_Init(SDL_INIT_VIDEO) < 0 || TTF_Init() < 0)
+    {
+        std::cerr << "Error while initializing SDL: " << SDL_GetError() << std::endl;
+        return NULL;
+    }
+    SDL_Surface *screen = SDL_SetVideoMode(1024, 768, 32, SDL_SWSURFACE);
+    if(!screen)
+        std::cerr << "Error while creating the screen: " << SDL_GetError() << std::endl;
+    return screen;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int maxItems = (argc > 1) ? static_cast<unsigned int>(std::atoi(argv[1])) : 100000;
+
+    Config &cfg = Config::instance();
+    if(!cfg.loadConfigFile())
+        return 1;
+    if(cfg.seed == 0)
+        cfg.seed = 1;
+
+    SDL_Surface *screen = openScreen();
+    if(!screen)
+        return 1;
+
+    // the messages of the game and the summary would break the output
+    std::cout.setstate(std::ios::failbit);
+
+    HandlerDummy dh;
+    dh.initialize();
+
+#ifdef AIWAR_RTTI_CAST
+    std::printf("# dispatch: dynamic_cast\n");
+#else
+    std::printf("# dispatch: tag\n");
+#endif
+    std::printf("case items reps ns_per_op checksum\n");
+    for(unsigned int n = 10 ; n <= maxItems ; n *= 10)
+    {
+        benchUpdate(dh, n);
+        benchFrameDraw(dh, n, screen);
+        benchFrameSummary(dh, n);
+    }
+
+    dh.finalize();
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Engine benchmark: times the core of the game with 10 to 100000 items
+ *  - "create": ItemManager::create*() of minerals, mining ships and fighters then
+ *    ItemManager::packMinerals(), like a map being loaded, per item
+ *  - "neighbours": Item::neighbours() of each item, per query
+ *  - "update": ItemManager::update() with units doing nothing, per item and tick
+ *  - "missiles": ItemManager::update() of flying missiles, per missile and tick
+ *  - "memory": Memory::setMemory() then getMemory() of each unit, per access
+ *  - "stat_dump": StatManager::dump(), per call
+ *  - "tick_dummy": GameManager::update() with the units played by HandlerDummy, per tick
+ *  - "tick_example": GameManager::update() with the units played by HandlerExample, per tick
+ * The items are spread at the same density at every size, so that a query
+ * sees about as many neighbours with 10 items as with 100000.
+ *
+ * usage: bench_engine [max_items], run from the directory of config.xml
+ * Output: a header line, then one line per case and size,
+ * "case items reps ns_per_op checksum", to compare the runs of two commits
+ */
+
+#include "game_manager.hpp"
+#include "item_manager.hpp"
+#include "stat_manager.hpp"
+#include "mineral.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "base.hpp"
+#include "handler_dummy.hpp"
+#include "handler_example.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <sys/time.h>
+
+using namespace aiwar::core;
+
+// item operations per case and size, to keep each case about as long at every size
+static const unsigned long OPS = 1000000;
+static const unsigned long TICK_OPS = 200000;
+
+// distance between two items, most units see about 30 neighbours
+static const double SPACING = 50.0;
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static unsigned long repsFor(unsigned long ops, unsigned int items, unsigned long minimum)
+{
+    unsigned long reps = ops / items;
+    return reps < minimum ? minimum : reps;
+}
+
+static unsigned long countItems(const ItemManager &im)
+{
+    unsigned long n = 0;
+    ItemManager::ItemMap::const_iterator it;
+    for(it = im.begin() ; it != im.end() ; ++it)
+        n++;
+    return n;
+}
+
+static void report(const char *name, unsigned int items, unsigned long reps, double seconds, unsigned long ops, unsigned long checksum)
+{
+    std::printf("%s %u %lu %.1f %lu\n", name, items, reps, ops > 0 ? seconds * 1e9 / ops : 0.0, checksum);
+    std::fflush(stdout);
+}
+
+// a game whose teams are played by a handler, for the time of a case
+class Game
+{
+public:
+    explicit Game(HandlerInterface &h) : _h(h)
+    {
+        const Config &cfg = Config::instance();
+        std::srand(cfg.seed);
+        _h.load(cfg.blue, "");
+        _h.load(cfg.red, "");
+        _gm = new GameManager();
+        _gm->registerTeam(BLUE_TEAM, _h.get_BaseHandler(cfg.blue), _h.get_MiningShipHandler(cfg.blue), _h.get_FighterHandler(cfg.blue), _h.get_TeamHandler(cfg.blue));
+        _gm->registerTeam(RED_TEAM, _h.get_BaseHandler(cfg.red), _h.get_MiningShipHandler(cfg.red), _h.get_FighterHandler(cfg.red), _h.get_TeamHandler(cfg.red));
+    }
+
+    ~Game()
+    {
+        delete _gm;
+        const Config &cfg = Config::instance();
+        _h.unload(cfg.red);
+        _h.unload(cfg.blue);
+    }
+
+    GameManager& gm() { return *_gm; }
+    ItemManager& im() { return _gm->getItemManager(); }
+
+    // place of the item i of n, on a square grid
+    static void position(unsigned int i, unsigned int n, double &x, double &y)
+    {
+        unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(n))));
+        x = (i % side) * SPACING + (std::rand() % 100) * 0.1;
+        y = (i / side) * SPACING + (std::rand() % 100) * 0.1;
+    }
+
+    // a third of minerals, a third of mining ships and a third of fighters, in both teams
+    void populate(unsigned int n)
+    {
+        for(unsigned int i = 0 ; i < n ; ++i)
+        {
+            double x, y;
+            position(i, n, x, y);
+            Team team = (i % 2) ? RED_TEAM : BLUE_TEAM;
+            switch(i % 3)
+            {
+            case 0:
+                im().createMineral(x, y);
+                break;
+            case 1:
+                im().createMiningShip(x, y, team);
+                break;
+            default:
+                im().createFighter(x, y, team);
+                break;
+            }
+        }
+        im().packMinerals();
+    }
+
+private:
+    // no copy
+    Game(const Game&);
+    Game& operator=(const Game&);
+
+    HandlerInterface &_h;
+    GameManager *_gm;
+};
+
+static void benchCreate(HandlerInterface &h, unsigned int n)
+{
+    unsigned long reps = repsFor(OPS, n, 1), checksum = 0;
+    double seconds = 0.0;
+    for(unsigned long r = 0 ; r < reps ; ++r)
+    {
+        Game g(h);
+        double start = now();
+        g.populate(n);
+        seconds += now() - start;
+        checksum += g.gm().getStatManager().miningShipCurrent(BLUE_TEAM);
+    }
+    report("create", n, reps, seconds, reps * n, checksum);
+}
+
+static void benchNeighbours(HandlerInterface &h, unsigned int n)
+{
+    Game g(h);
+    g.populate(n);
+
+    unsigned long reps = repsFor(OPS, n, 1), checksum = 0;
+    Item::ItemVector res;
+    double start = now();
+    for(unsigned long r = 0 ; r < reps ; ++r)
+    {
+        ItemManager::ItemMap::const_iterator it;
+        for(it = g.im().begin() ; it != g.im().end() ; ++it)
+        {
+            it->second->neighbours(res);
+            checksum += res.size();
+        }
+    }
+    report("neighbours", n, reps, now() - start, reps * n, checksum);
+}
+
+static void benchUpdate(HandlerInterface &h, unsigned int n)
+{
+    Game g(h);
+    g.populate(n);
+
+    unsigned long ticks = repsFor(TICK_OPS, n, 3);
+    double start = now();
+    for(unsigned long t = 0 ; t < ticks ; ++t)
+        g.im().update(static_cast<unsigned int>(t));
+    report("update", n, ticks, now() - start, ticks * n, countItems(g.im()));
+}
+
+static void benchMissiles(HandlerInterface &h, unsigned int n)
+{
+    // a missile lives MISSILE_START_FUEL / MISSILE_MOVE_CONSO ticks, its target is out of reach
+    const Config &cfg = Config::instance();
+    unsigned long ticks = cfg.MISSILE_START_FUEL / cfg.MISSILE_MOVE_CONSO;
+    if(ticks > 0)
+        ticks--;
+    double distance = (ticks + 2) * cfg.MISSILE_SPEED;
+
+    unsigned long reps = repsFor(TICK_OPS, static_cast<unsigned int>(n * ticks), 1), checksum = 0;
+    double seconds = 0.0;
+    for(unsigned long r = 0 ; r < reps ; ++r)
+    {
+        Game g(h);
+        Mineral *launcher = g.im().createMineral(0.0, 0.0);
+        Fighter *target = g.im().createFighter(distance, 0.0, RED_TEAM);
+        for(unsigned int i = 0 ; i < n ; ++i)
+            g.im().createMissile(launcher, target);
+
+        double start = now();
+        for(unsigned long t = 0 ; t < ticks ; ++t)
+            g.im().update(static_cast<unsigned int>(t));
+        seconds += now() - start;
+        checksum += countItems(g.im());
+    }
+    report("missiles", n, reps, seconds, reps * n * ticks, checksum);
+}
+
+static void benchMemory(HandlerInterface &h, unsigned int n)
+{
+    Game g(h);
+    g.populate(n);
+
+    std::vector<Memory*> units;
+    ItemManager::ItemMap::const_iterator it;
+    for(it = g.im().begin() ; it != g.im().end() ; ++it)
+    {
+        Memory *m = item_cast<Memory>(it->second);
+        if(m)
+            units.push_back(m);
+    }
+    if(units.empty())
+    {
+        report("memory", n, 0, 0.0, 0, 0);
+        return;
+    }
+
+    unsigned long accesses = 0;
+    for(std::vector<Memory*>::size_type u = 0 ; u < units.size() ; ++u)
+        accesses += units[u]->memorySize();
+
+    unsigned long reps = repsFor(OPS, static_cast<unsigned int>(accesses), 1), checksum = 0;
+    double start = now();
+    for(unsigned long r = 0 ; r < reps ; ++r)
+    {
+        for(std::vector<Memory*>::size_type u = 0 ; u < units.size() ; ++u)
+        {
+            for(unsigned int i = 0 ; i < units[u]->memorySize() ; ++i)
+            {
+                units[u]->setMemory<unsigned int>(i, static_cast<unsigned int>(r + i));
+                checksum += units[u]->getMemory<unsigned int>(i);
+            }
+        }
+    }
+    report("memory", n, reps, now() - start, reps * accesses * 2, checksum);
+}
+
+static void benchStatDump(HandlerInterface &h, unsigned int n)
+{
+    Game g(h);
+    g.populate(n);
+
+    unsigned long reps = repsFor(OPS / 100, 1, 1), checksum = 0;
+    double start = now();
+    for(unsigned long r = 0 ; r < reps ; ++r)
+        checksum += g.gm().getStatManager().dump().size();
+    report("stat_dump", n, reps, now() - start, reps, checksum);
+}
+
+// both teams have a base, the other items are spread around
+static void benchTicks(const char *name, HandlerInterface &h, unsigned int n)
+{
+    Game g(h);
+    double x, y;
+    Game::position(0, n, x, y);
+    g.im().createBase(x, y, BLUE_TEAM);
+    Game::position(n - 1, n, x, y);
+    g.im().createBase(x, y, RED_TEAM);
+    g.populate(n > 2 ? n - 2 : 0);
+
+    unsigned long ticks = repsFor(TICK_OPS, n, 3);
+    double start = now();
+    try
+    {
+        for(unsigned long t = 0 ; t < ticks ; ++t)
+            g.gm().update(static_cast<unsigned int>(t));
+    }
+    catch(const HandlerError &e)
+    {
+        std::cerr << "Error in the handler: " << e.what() << std::endl;
+    }
+    report(name, n, ticks, now() - start, ticks, countItems(g.im()));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int maxItems = (argc > 1) ? static_cast<unsigned int>(std::atoi(argv[1])) : 100000;
+
+    Config &cfg = Config::instance();
+    if(!cfg.loadConfigFile())
+        return 1;
+    if(cfg.seed == 0)
+        cfg.seed = 1;
+
+    // the messages of the game would break the output
+    std::cout.setstate(std::ios::failbit);
+
+    HandlerDummy dh;
+    HandlerExample eh;
+    dh.initialize();
+    eh.initialize();
+
+    std::printf("case items reps ns_per_op checksum\n");
+    for(unsigned int n = 10 ; n <= maxItems ; n *= 10)
+    {
+        benchCreate(dh, n);
+        benchNeighbours(dh, n);
+        benchUpdate(dh, n);
+        benchMissiles(dh, n);
+        benchMemory(dh, n);
+        benchStatDump(dh, n);
+        benchTicks("tick_dummy", dh, n);
+        benchTicks("tick_example", eh, n);
+    }
+
+    eh.finalize();
+    dh.finalize();
+    return 0;
+}
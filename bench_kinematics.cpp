@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Movement benchmark: moves N items during T ticks
+ *  - "object": one heap object per item, cos/sin computed at each move (former Movable::move())
+ *  - "step": KinematicStore::step() called item by item
+ * Each case is run with straight moves and with a rotation before each move.
+ *
+ * Output: one line per case, "case turning items ticks ns_per_move checksum"
+ */
+
+#include "kinematics.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#ifndef M_PI
+#       define M_PI 3.1415926535897932384626433832795
+#endif
+
+using aiwar::core::KinematicStore;
+
+static const double SPEED = 4.0;
+static const unsigned int MOVE_CONSO = 1;
+
+// the former layout: kinematic state inside a polymorphic object
+class LegacyMovable
+{
+public:
+    LegacyMovable(double px, double py, double angle)
+        : _xpos(px), _ypos(py), _angle(angle), _speed(SPEED), _fuel(~0u), _moveConso(MOVE_CONSO), _hasMoved(false)
+    {
+    }
+
+    virtual ~LegacyMovable()
+    {
+    }
+
+    void rotateOf(double angle)
+    {
+        _angle += angle;
+    }
+
+    void move()
+    {
+        if(!_hasMoved && doMove())
+        {
+            _xpos += cos(_angle * M_PI / 180.0) * _speed;
+            _ypos -= sin(_angle * M_PI / 180.0) * _speed;
+            _hasMoved = true;
+        }
+    }
+
+    void preUpdate()
+    {
+        _hasMoved = false;
+    }
+
+    virtual bool doMove()
+    {
+        if(_fuel < _moveConso)
+            return false;
+        _fuel -= _moveConso;
+        return true;
+    }
+
+    double _xpos, _ypos, _angle, _speed;
+    unsigned int _fuel, _moveConso;
+    bool _hasMoved;
+};
+
+static double elapsedNs(std::clock_t start)
+{
+    return static_cast<double>(std::clock() - start) * 1e9 / CLOCKS_PER_SEC;
+}
+
+static void report(const char *name, bool turning, unsigned int items, unsigned int ticks, double ns, double checksum)
+{
+    std::printf("%s %d %u %u %.2f %.6g\n", name, turning ? 1 : 0, items, ticks, ns / (static_cast<double>(items) * ticks), checksum);
+}
+
+static void benchObject(unsigned int items, unsigned int ticks, bool turning)
+{
+    std::vector<LegacyMovable*> v;
+    for(unsigned int i = 0 ; i < items ; ++i)
+        v.push_back(new LegacyMovable(i % 1000, i / 1000, i % 360));
+
+    std::clock_t start = std::clock();
+    for(unsigned int t = 0 ; t < ticks ; ++t)
+    {
+        for(unsigned int i = 0 ; i < items ; ++i)
+        {
+            v[i]->preUpdate();
+            if(turning)
+                v[i]->rotateOf(3.0);
+            v[i]->move();
+        }
+    }
+    double ns = elapsedNs(start);
+
+    double checksum = 0.0;
+    for(unsigned int i = 0 ; i < items ; ++i)
+    {
+        checksum += v[i]->_xpos + v[i]->_ypos;
+        delete v[i];
+    }
+    report("object", turning, items, ticks, ns, checksum);
+}
+
+static void benchStore(unsigned int items, unsigned int ticks, bool turning)
+{
+    KinematicStore store;
+    std::vector<double> angle(items);
+    for(unsigned int i = 0 ; i < items ; ++i)
+    {
+        KinematicStore::Slot s = store.add(i % 1000, i / 1000);
+        angle[s] = i % 360;
+        store.setHeading(s, angle[s]);
+        store.setSpeed(s, SPEED);
+        store.setFuel(s, ~0u);
+    }
+
+    std::clock_t start = std::clock();
+    for(unsigned int t = 0 ; t < ticks ; ++t)
+    {
+        for(KinematicStore::Slot s = 0 ; s < items ; ++s)
+        {
+            if(turning)
+            {
+                angle[s] += 3.0;
+                store.setHeading(s, angle[s]);
+            }
+
+            // same fuel rule as Movable::doMove()
+            unsigned int f = store.fuel(s);
+            if(f < MOVE_CONSO)
+                continue;
+            store.setFuel(s, f - MOVE_CONSO);
+
+            store.step(s);
+        }
+    }
+    double ns = elapsedNs(start);
+
+    double checksum = 0.0;
+    for(KinematicStore::Slot s = 0 ; s < items ; ++s)
+        checksum += store.x(s) + store.y(s);
+    report("step", turning, items, ticks, ns, checksum);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int items = (argc > 1) ? static_cast<unsigned int>(std::atoi(argv[1])) : 100000;
+    unsigned int ticks = (argc > 2) ? static_cast<unsigned int>(std::atoi(argv[2])) : 100;
+
+    for(int turning = 0 ; turning < 2 ; ++turning)
+    {
+        benchObject(items, ticks, turning != 0);
+        benchStore(items, ticks, turning != 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Throughput of the process handler: plays T ticks of the map of config.xml
+ *  - "example": both teams played in the game process by HandlerExample
+ *  - "process": both teams played by a child process each, one after the other
+ *  - "process-isolate": the same, both processes think at the same time (--isolate)
+ *
+ * usage: bench_process [ticks [command]], the command defaults to client/example_client
+ * Output: one line per case, "case ticks seconds ticks_per_second"
+ */
+
+#include "game_manager.hpp"
+#include "handler_example.hpp"
+#include "handler_process.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+
+using namespace aiwar::core;
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// play a game, return the number of ticks played
+static unsigned int play(HandlerInterface &h, unsigned int ticks, double &seconds)
+{
+    const Config &cfg = Config::instance();
+    std::srand(cfg.seed);
+
+    if(!h.load(cfg.blue, cfg.players.find(cfg.blue)->second.params) || !h.load(cfg.red, cfg.players.find(cfg.red)->second.params))
+        return 0;
+
+    unsigned int t = 0;
+    {
+        GameManager gm;
+        gm.registerTeam(BLUE_TEAM, h.get_BaseHandler(cfg.blue), h.get_MiningShipHandler(cfg.blue), h.get_FighterHandler(cfg.blue), h.get_TeamHandler(cfg.blue));
+        gm.registerTeam(RED_TEAM, h.get_BaseHandler(cfg.red), h.get_MiningShipHandler(cfg.red), h.get_FighterHandler(cfg.red), h.get_TeamHandler(cfg.red));
+        if(!gm.init())
+            return 0;
+
+        double start = now();
+        try
+        {
+            for( ; t < ticks && !gm.gameOver() ; ++t)
+                gm.update(t);
+        }
+        catch(const HandlerError &e)
+        {
+            std::cerr << "Error in the handler: " << e.what() << std::endl;
+        }
+        seconds = now() - start;
+    }
+
+    h.unload(cfg.red);
+    h.unload(cfg.blue);
+    return t;
+}
+
+static void report(const char *name, unsigned int ticks, double seconds)
+{
+    std::printf("%s %u %.3f %.1f\n", name, ticks, seconds, seconds > 0.0 ? ticks / seconds : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int ticks = (argc > 1) ? static_cast<unsigned int>(std::atoi(argv[1])) : 2000;
+    std::string command = (argc > 2) ? argv[2] : "client/example_client";
+
+    Config &cfg = Config::instance();
+    if(!cfg.loadConfigFile())
+        return 1;
+
+    // both teams are played by the same player
+    Config::PlayerInfo p;
+    p.name = "bench";
+    p.handler = "process";
+    p.params = command;
+    cfg.blue = cfg.red = cfg.players.rbegin()->first + 1;
+    cfg.players[cfg.blue] = p;
+
+    double seconds = 0.0;
+    unsigned int n;
+
+    HandlerExample eh;
+    eh.initialize();
+    n = play(eh, ticks, seconds);
+    report("example", n, seconds);
+    eh.finalize();
+
+    HandlerProcess ph;
+    ph.initialize();
+    n = play(ph, ticks, seconds);
+    report("process", n, seconds);
+
+    cfg.isolateTeams = true;
+    n = play(ph, ticks, seconds);
+    report("process-isolate", n, seconds);
+    ph.finalize();
+
+    return 0;
+}
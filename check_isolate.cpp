@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Isolation check: plays both teams with a concurrent() TeamPlayFunction and
+ * --isolate, like the process and native handlers, and checks the three steps
+ * of ItemManager::_playTeams():
+ *  - "order": each round, prepare() of both teams, then think(), then apply()
+ *    in team order
+ *  - "snapshot": both teams see the world as it was before any of them played
+ *  - "parallel": both think() run at the same time, in two threads
+ *  - "replay": two games give the same world
+ *  - "errors": an error thrown by think() in a thread is thrown again by
+ *    GameManager::update() for its team, the first team first, once both
+ *    teams have thought
+ *  - "destroyed": a unit destroyed by a missile later in the item loop is not
+ *    given to its team, with and without --isolate
+ *
+ * usage: check_isolate
+ * Output: one line per check, exits with 1 if one of them fails
+ */
+
+#include "game_manager.hpp"
+#include "item_manager.hpp"
+#include "config.hpp"
+#include "base.hpp"
+#include "fighter.hpp"
+#include "handler_interface.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+#include <time.h>
+
+using namespace aiwar::core;
+
+static const unsigned int ROUNDS = 20;
+
+// think time of each team per round, long enough to see the teams overlap
+static const long THINK_NS = 20000000;
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// sum of the coordinates of the fighters of a team
+static double fightersOf(const ItemManager &im, Team team)
+{
+    double sum = 0.0;
+    ItemManager::ItemMap::const_iterator it;
+    for(it = im.begin() ; it != im.end() ; ++it)
+    {
+        const Fighter *f = dynamic_cast<const Fighter*>(it->second);
+        if(f && !f->_toRemove() && f->team() == team)
+            sum += f->xpos() + f->ypos();
+    }
+    return sum;
+}
+
+// what happened during a game
+struct Journal
+{
+    std::string steps; ///< prepare() and apply() of the teams, played by the main thread: "pB", "aR"...
+    double lastPrepare; ///< time of the last prepare() of the round
+    double firstApply; ///< time of the first apply() of the round
+
+    // per team
+    std::vector<double> thinkStart[RED_TEAM + 1];
+    std::vector<double> thinkEnd[RED_TEAM + 1];
+    std::vector<pthread_t> thinkThread[RED_TEAM + 1];
+    std::vector<double> ownSeen[RED_TEAM + 1]; ///< fightersOf() the team, at its prepare()
+    std::vector<double> enemySeen[RED_TEAM + 1]; ///< fightersOf() the other team, at its prepare()
+    unsigned int thinkOutOfTime; ///< think() started before a prepare() or ended after an apply() of the round
+
+    Journal() : lastPrepare(0.0), firstApply(0.0), thinkOutOfTime(0) {}
+};
+
+// the fighters go to the enemy fighter seen at prepare() and fire at it one round out of 5
+class IsolatedTeam : public TeamPlayFunction
+{
+public:
+    IsolatedTeam(Team team, const ItemManager &im, Journal &journal)
+        : _team(team), _im(im), _journal(journal), _round(0), _failAt(-1) {}
+
+    // throw an error from think() at this round
+    void failAt(int round) { _failAt = round; }
+
+    void operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+    {
+        prepare(bases, miningShips, fighters);
+        think();
+        apply();
+    }
+
+    bool concurrent() const { return true; }
+
+    void prepare(const BaseVector &, const MiningShipVector &, const FighterVector &fighters)
+    {
+        _journal.steps += (_team == BLUE_TEAM) ? "pB" : "pR";
+        _journal.lastPrepare = now();
+        _journal.ownSeen[_team].push_back(fightersOf(_im, _team));
+        _journal.enemySeen[_team].push_back(fightersOf(_im, _team == BLUE_TEAM ? RED_TEAM : BLUE_TEAM));
+
+        _fighters = fighters;
+        _targets.assign(fighters.size(), static_cast<Fighter*>(NULL));
+        _tx.assign(fighters.size(), 0.0);
+        _ty.assign(fighters.size(), 0.0);
+        for(FighterVector::size_type i = 0 ; i < fighters.size() ; ++i)
+        {
+            Item::ItemList n = fighters[i]->neighbours();
+            for(Item::ItemList::iterator it = n.begin() ; it != n.end() ; ++it)
+            {
+                Fighter *e = dynamic_cast<Fighter*>(*it);
+                if(e && !fighters[i]->isFriend(e))
+                {
+                    _targets[i] = e;
+                    _tx[i] = e->xpos();
+                    _ty[i] = e->ypos();
+                    break;
+                }
+            }
+        }
+    }
+
+    // only the vectors of this team are written: the other team thinks at the same time
+    void think()
+    {
+        double start = now();
+        timespec ts = { 0, THINK_NS };
+        nanosleep(&ts, NULL);
+        _journal.thinkStart[_team].push_back(start);
+        _journal.thinkEnd[_team].push_back(now());
+        _journal.thinkThread[_team].push_back(pthread_self());
+
+        if(_round == _failAt)
+            throw HandlerError(_team, "failed in think()");
+    }
+
+    void apply()
+    {
+        if(_team == BLUE_TEAM)
+            _journal.firstApply = now();
+        _journal.steps += (_team == BLUE_TEAM) ? "aB" : "aR";
+
+        // both teams have thought between the last prepare() and the first apply()
+        if(_team == RED_TEAM)
+        {
+            for(int t = BLUE_TEAM ; t <= RED_TEAM ; ++t)
+            {
+                if(_journal.thinkStart[t].size() != static_cast<std::vector<double>::size_type>(_round + 1)
+                   || _journal.thinkStart[t].back() < _journal.lastPrepare
+                   || _journal.thinkEnd[t].back() > _journal.firstApply)
+                    _journal.thinkOutOfTime++;
+            }
+        }
+
+        for(FighterVector::size_type i = 0 ; i < _fighters.size() ; ++i)
+        {
+            if(!_targets[i])
+                continue;
+            _fighters[i]->rotateTo(_tx[i], _ty[i]);
+            _fighters[i]->move();
+            if(_round % 5 == 0 && !_targets[i]->_toRemove())
+                _fighters[i]->launchMissile(_targets[i]);
+        }
+        _round++;
+    }
+
+private:
+    Team _team;
+    const ItemManager &_im;
+    Journal &_journal;
+    int _round;
+    int _failAt;
+    FighterVector _fighters;
+    std::vector<Fighter*> _targets;
+    std::vector<double> _tx, _ty;
+};
+
+static void setRules()
+{
+    Config &c = Config::instance();
+    c.WORLD_SIZE_X = 800; c.WORLD_SIZE_Y = 800;
+    c.FIGHTER_SIZE_X = 16; c.FIGHTER_SIZE_Y = 16; c.FIGHTER_SPEED = 5; c.FIGHTER_DETECTION_RADIUS = 400;
+    c.FIGHTER_MAX_LIFE = 1000; c.FIGHTER_START_LIFE = 600; c.FIGHTER_MOVE_CONSO = 1; c.FIGHTER_START_FUEL = 1200;
+    c.FIGHTER_MAX_FUEL = 2000; c.FIGHTER_MEMORY_SIZE = 4; c.FIGHTER_START_MISSILE = 8; c.FIGHTER_MAX_MISSILE = 12;
+    c.MISSILE_SIZE_X = 5; c.MISSILE_SIZE_Y = 1; c.MISSILE_LIFE = 10; c.MISSILE_MOVE_CONSO = 2; c.MISSILE_START_FUEL = 16;
+    c.MISSILE_MAX_FUEL = 16; c.MISSILE_SPEED = 20; c.MISSILE_DAMAGE = 200;
+    c.BASE_SIZE_X = 25; c.BASE_SIZE_Y = 25; c.BASE_DETECTION_RADIUS = 200; c.BASE_MAX_LIFE = 10000; c.BASE_START_LIFE = 5000;
+    c.BASE_MEMORY_SIZE = 4;
+    c.isolateTeams = true;
+}
+
+// a game of ROUNDS rounds, or until the first error
+class Game
+{
+public:
+    Game() : _blue(BLUE_TEAM, _gm.getItemManager(), journal), _red(RED_TEAM, _gm.getItemManager(), journal),
+             _errorTeam(NO_TEAM), _errors(0)
+    {
+        _gm.registerTeam(BLUE_TEAM, Playable::playNoOp, Playable::playNoOp, Playable::playNoOp, &_blue);
+        _gm.registerTeam(RED_TEAM, Playable::playNoOp, Playable::playNoOp, Playable::playNoOp, &_red);
+
+        ItemManager &im = _gm.getItemManager();
+        double ox = 0.0, oy = 0.0;
+        im.applyOffset(ox, oy);
+        im.createBase(ox + 80, oy + 400, BLUE_TEAM);
+        im.createBase(ox + 720, oy + 400, RED_TEAM);
+        for(int i = 0 ; i < 10 ; i++)
+        {
+            im.createFighter(ox + 300, oy + 350 + i * 10, BLUE_TEAM);
+            im.createFighter(ox + 500, oy + 350 + i * 10, RED_TEAM);
+        }
+    }
+
+    void failAt(Team team, int round) { (team == BLUE_TEAM ? _blue : _red).failAt(round); }
+
+    void play()
+    {
+        for(unsigned int round = 0 ; round < ROUNDS ; ++round)
+        {
+            try
+            {
+                _gm.update(round);
+            }
+            catch(const HandlerError &e)
+            {
+                _errorTeam = e.team();
+                _errors++;
+                return;
+            }
+        }
+    }
+
+    // positions and lives of the items
+    std::vector<double> world() const
+    {
+        std::vector<double> w;
+        const ItemManager &im = _gm.getItemManager();
+        ItemManager::ItemMap::const_iterator it;
+        for(it = im.begin() ; it != im.end() ; ++it)
+        {
+            w.push_back(it->second->xpos());
+            w.push_back(it->second->ypos());
+            if(const Living *l = dynamic_cast<const Living*>(it->second))
+                w.push_back(l->life());
+        }
+        return w;
+    }
+
+    Team errorTeam() const { return _errorTeam; }
+    int errors() const { return _errors; }
+
+    Journal journal;
+
+private:
+    // no copy
+    Game(const Game&);
+    Game& operator=(const Game&);
+
+    GameManager _gm;
+    IsolatedTeam _blue, _red;
+    Team _errorTeam;
+    int _errors;
+};
+
+// keep the fighters given to the team in the last round
+class FighterRecorder : public TeamPlayFunction
+{
+public:
+    void operator()(const BaseVector &, const MiningShipVector &, const FighterVector &fighters) { given = fighters; }
+
+    bool concurrent() const { return true; }
+
+    void prepare(const BaseVector &, const MiningShipVector &, const FighterVector &fighters) { given = fighters; }
+
+    FighterVector given;
+};
+
+// a blue fighter played before the missiles which destroy it in the same round
+static bool destroyedNotGiven(bool isolate)
+{
+    Config::instance().isolateTeams = isolate;
+
+    FighterRecorder blue, red;
+    GameManager gm;
+    gm.registerTeam(BLUE_TEAM, Playable::playNoOp, Playable::playNoOp, Playable::playNoOp, &blue);
+    gm.registerTeam(RED_TEAM, Playable::playNoOp, Playable::playNoOp, Playable::playNoOp, &red);
+
+    ItemManager &im = gm.getItemManager();
+    double ox = 0.0, oy = 0.0;
+    im.applyOffset(ox, oy);
+    Fighter *alive = im.createFighter(ox + 300, oy + 300, BLUE_TEAM);
+    Fighter *target = im.createFighter(ox + 400, oy + 400, BLUE_TEAM);
+    Fighter *launcher = im.createFighter(ox + 410, oy + 400, RED_TEAM);
+    const Config &c = Config::instance();
+    for(unsigned int life = 0 ; life < c.FIGHTER_START_LIFE ; life += c.MISSILE_DAMAGE)
+        im.createMissile(launcher, target);
+
+    gm.update(0);
+
+    Config::instance().isolateTeams = true;
+    return target->_toRemove()
+        && std::find(blue.given.begin(), blue.given.end(), target) == blue.given.end()
+        && std::find(blue.given.begin(), blue.given.end(), alive) != blue.given.end()
+        && red.given.size() == 1;
+}
+
+static int failures = 0;
+
+static void check(const char *name, bool ok, const std::string &detail = "")
+{
+    std::printf("%s: %s%s%s\n", name, ok ? "ok" : "FAILED", detail.empty() ? "" : ", ", detail.c_str());
+    if(!ok)
+        failures++;
+}
+
+int main()
+{
+    // the messages of the game would hide the results
+    std::cout.setstate(std::ios::failbit);
+    setRules();
+
+    // the offset of the world is random
+    std::srand(42);
+    Game g;
+    double start = now();
+    g.play();
+    double seconds = now() - start;
+    const Journal &j = g.journal;
+
+    std::string order;
+    for(unsigned int round = 0 ; round < ROUNDS ; ++round)
+        order += "pBpRaBaR";
+    check("order", g.errors() == 0 && j.steps == order && j.thinkOutOfTime == 0);
+
+    // red prepared before blue applied: it saw the blue fighters where blue saw them, and the other way round
+    unsigned int same = 0, moved = 0;
+    for(unsigned int round = 0 ; round < j.ownSeen[BLUE_TEAM].size() && round < j.ownSeen[RED_TEAM].size() ; ++round)
+    {
+        if(j.enemySeen[RED_TEAM][round] == j.ownSeen[BLUE_TEAM][round] && j.enemySeen[BLUE_TEAM][round] == j.ownSeen[RED_TEAM][round])
+            same++;
+        if(round > 0 && j.ownSeen[BLUE_TEAM][round] != j.ownSeen[BLUE_TEAM][round - 1])
+            moved++;
+    }
+    check("snapshot", same == ROUNDS && moved > 0);
+
+    unsigned int overlaps = 0, threads = 0;
+    for(unsigned int round = 0 ; round < j.thinkStart[BLUE_TEAM].size() && round < j.thinkStart[RED_TEAM].size() ; ++round)
+    {
+        double latestStart = std::max(j.thinkStart[BLUE_TEAM][round], j.thinkStart[RED_TEAM][round]);
+        double earliestEnd = std::min(j.thinkEnd[BLUE_TEAM][round], j.thinkEnd[RED_TEAM][round]);
+        if(latestStart < earliestEnd)
+            overlaps++;
+        if(!pthread_equal(j.thinkThread[BLUE_TEAM][round], j.thinkThread[RED_TEAM][round]))
+            threads++;
+    }
+    char detail[128];
+    std::snprintf(detail, sizeof(detail), "%u rounds out of %u, %.0f ms for %.0f ms of think time",
+                  overlaps, ROUNDS, seconds * 1000.0, ROUNDS * 2 * THINK_NS / 1e6);
+    check("parallel", overlaps == ROUNDS && threads == ROUNDS, detail);
+
+    std::srand(42);
+    Game again;
+    again.play();
+    check("replay", g.world() == again.world() && j.enemySeen[BLUE_TEAM] == again.journal.enemySeen[BLUE_TEAM]
+          && j.enemySeen[RED_TEAM] == again.journal.enemySeen[RED_TEAM]);
+
+    // an error of the red team at the round 3: blue has applied its round, red has not
+    Game redFails;
+    redFails.failAt(RED_TEAM, 3);
+    redFails.play();
+    const std::string &r = redFails.journal.steps;
+    check("errors", redFails.errors() == 1 && redFails.errorTeam() == RED_TEAM
+          && r.size() == 3 * 8 + 6 && r.substr(r.size() - 6) == "pBpRaB");
+
+    // both fail: the blue error is thrown, red has thought too
+    Game bothFail;
+    bothFail.failAt(BLUE_TEAM, 3);
+    bothFail.failAt(RED_TEAM, 3);
+    bothFail.play();
+    const std::string &b = bothFail.journal.steps;
+    check("errors", bothFail.errors() == 1 && bothFail.errorTeam() == BLUE_TEAM
+          && b.size() == 3 * 8 + 4 && bothFail.journal.thinkStart[RED_TEAM].size() == 4);
+
+    check("destroyed", destroyedNotGiven(true) && destroyedNotGiven(false));
+
+    return failures > 0 ? 1 : 0;
+}
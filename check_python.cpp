@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Python check: a player may keep a bound method of an item, like
+ * 'f = ship.pos', and call it after the item has been destroyed. The call
+ * must raise a RuntimeError and not use the deleted item.
+ *
+ * The check takes every method of the python objects of a base, a mining
+ * ship, a fighter, a mineral and a missile, as given to their player and as
+ * seen by the others, deletes the items with the game and calls the methods.
+ *
+ * usage: check_python
+ * Output: one line per method which does not raise, exits with 1 if any
+ */
+
+#include "python_wrapper.hpp"
+#include "game_manager.hpp"
+#include "item_manager.hpp"
+#include "config.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aiwar::core;
+
+static void setRules()
+{
+    Config &c = Config::instance();
+    c.WORLD_SIZE_X = 800; c.WORLD_SIZE_Y = 800;
+    c.MINERAL_SIZE_X = 4; c.MINERAL_SIZE_Y = 4; c.MINERAL_LIFE = 2000;
+    c.MININGSHIP_SIZE_X = 16; c.MININGSHIP_SIZE_Y = 16; c.MININGSHIP_SPEED = 5; c.MININGSHIP_DETECTION_RADIUS = 160;
+    c.MININGSHIP_MAX_LIFE = 1000; c.MININGSHIP_START_LIFE = 600; c.MININGSHIP_START_FUEL = 1200; c.MININGSHIP_MAX_FUEL = 2000;
+    c.MININGSHIP_MEMORY_SIZE = 4;
+    c.FIGHTER_SIZE_X = 16; c.FIGHTER_SIZE_Y = 16; c.FIGHTER_SPEED = 5; c.FIGHTER_DETECTION_RADIUS = 160;
+    c.FIGHTER_MAX_LIFE = 1000; c.FIGHTER_START_LIFE = 600; c.FIGHTER_START_FUEL = 1200; c.FIGHTER_MAX_FUEL = 2000;
+    c.FIGHTER_MEMORY_SIZE = 4; c.FIGHTER_START_MISSILE = 8; c.FIGHTER_MAX_MISSILE = 12;
+    c.MISSILE_SIZE_X = 5; c.MISSILE_SIZE_Y = 1; c.MISSILE_LIFE = 10; c.MISSILE_START_FUEL = 16; c.MISSILE_MAX_FUEL = 16;
+    c.MISSILE_SPEED = 20; c.MISSILE_DAMAGE = 200;
+    c.BASE_SIZE_X = 25; c.BASE_SIZE_Y = 25; c.BASE_DETECTION_RADIUS = 200; c.BASE_MAX_LIFE = 10000; c.BASE_START_LIFE = 5000;
+    c.BASE_START_MINERAL_STORAGE = 10000; c.BASE_MAX_MINERAL_STORAGE = 500000; c.BASE_MEMORY_SIZE = 4;
+}
+
+static void noPlay(Playable *)
+{
+}
+
+struct BoundMethod
+{
+    std::string name;
+    PyObject *method;
+};
+
+// keep the methods of a python view of an item, the view itself is released
+static bool takeMethods(PyObject *view, const char *kind, std::vector<BoundMethod> &methods)
+{
+    if(!view)
+    {
+        PyErr_Print();
+        return false;
+    }
+
+    PyObject *names = PyObject_Dir(view);
+    if(!names)
+    {
+        PyErr_Print();
+        Py_DECREF(view);
+        return false;
+    }
+
+    for(Py_ssize_t i = 0 ; i < PyList_GET_SIZE(names) ; ++i)
+    {
+        const char *name = PyString_AsString(PyList_GET_ITEM(names, i));
+        if(std::strncmp(name, "__", 2) == 0)
+            continue;
+
+        PyObject *m = PyObject_GetAttrString(view, name);
+        if(m && PyCFunction_Check(m))
+        {
+            BoundMethod b;
+            b.name = std::string(kind) + "." + name;
+            b.method = m;
+            methods.push_back(b);
+        }
+        else
+            Py_XDECREF(m);
+        PyErr_Clear();
+    }
+
+    Py_DECREF(names);
+    Py_DECREF(view);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    // the messages of the game would hide the result
+    std::cout.setstate(std::ios::failbit);
+
+    Py_Initialize();
+    if(!initPythonInterpreter(argc, argv) || !initAiwarModule())
+    {
+        std::printf("cannot initialize the aiwar module\n");
+        return 1;
+    }
+
+    setRules();
+
+    DefaultPlayFunction pf(&noPlay);
+    GameManager *gm = new GameManager();
+    gm->registerTeam(BLUE_TEAM, pf, pf, pf);
+    gm->registerTeam(RED_TEAM, pf, pf, pf);
+
+    ItemManager &im = gm->getItemManager();
+    double ox = 0.0, oy = 0.0;
+    im.applyOffset(ox, oy);
+    Base *base = im.createBase(ox + 100, oy + 100, BLUE_TEAM);
+    MiningShip *ship = im.createMiningShip(ox + 120, oy + 100, BLUE_TEAM);
+    Fighter *fighter = im.createFighter(ox + 140, oy + 100, RED_TEAM);
+    Mineral *mineral = im.createMineral(ox + 160, oy + 100);
+    Missile *missile = im.createMissile(fighter, base);
+
+    std::vector<BoundMethod> methods;
+    bool ok = takeMethods(Playable_Get(base), "Base", methods)
+        && takeMethods(Playable_Get(ship), "MiningShip", methods)
+        && takeMethods(Playable_Get(fighter), "Fighter", methods)
+        && takeMethods(Neighbour_Get(base), "BaseConst", methods)
+        && takeMethods(Neighbour_Get(ship), "MiningShipConst", methods)
+        && takeMethods(Neighbour_Get(fighter), "FighterConst", methods)
+        && takeMethods(Neighbour_Get(mineral), "Mineral", methods)
+        && takeMethods(Neighbour_Get(missile), "Missile", methods);
+    if(!ok)
+    {
+        std::printf("cannot get the python objects of the items\n");
+        return 1;
+    }
+
+    // the items are deleted with the game
+    delete gm;
+
+    unsigned int failed = 0;
+    std::vector<BoundMethod>::iterator it;
+    for(it = methods.begin() ; it != methods.end() ; ++it)
+    {
+        PyObject *args = PyTuple_New(0);
+        PyObject *r = PyObject_Call(it->method, args, NULL);
+        Py_DECREF(args);
+        if(r || !PyErr_ExceptionMatches(PyExc_RuntimeError))
+        {
+            std::printf("%s: called on a destroyed item without a RuntimeError\n", it->name.c_str());
+            ++failed;
+        }
+        Py_XDECREF(r);
+        PyErr_Clear();
+        Py_DECREF(it->method);
+    }
+
+    std::printf("%u methods of destroyed items called, %u without a RuntimeError: %s\n",
+                static_cast<unsigned int>(methods.size()), failed, failed ? "FAILED" : "ok");
+
+    Py_Finalize();
+    return failed ? 1 : 0;
+}
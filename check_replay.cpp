@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replay check: plays a seeded game and compares its digest to the one of
+ * the engine before the slot map, the grid and the kinematic store. The
+ * changes of the engine must not change a game: the items play in the same
+ * order, see the same neighbours and move the same.
+ *
+ * The rules are set here and not read from config.xml, and the units are
+ * played by simple play functions and by HandlerExample: both bases and 40
+ * ships per team on a field of minerals, fighters and bases firing missiles
+ * at the enemies in sight, for ROUNDS rounds or until the game is over.
+ *
+ * usage: check_replay [-v]
+ * Output: the digest every 100 rounds (with -v) and at the end, exits with 1
+ * if the final digest is not the expected one
+ */
+
+#include "game_manager.hpp"
+#include "item_manager.hpp"
+#include "config.hpp"
+#include "base.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "mineral.hpp"
+#include "missile.hpp"
+#include "handler_example.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace aiwar::core;
+
+static const unsigned int ROUNDS = 3000;
+
+// digest of the game played by the engine before the changes above, over at 2142 rounds
+static const unsigned long long EXPECTED_DIGEST = 0x316678b765400899ULL;
+
+static void setRules()
+{
+    Config &c = Config::instance();
+    c.WORLD_SIZE_X = 800; c.WORLD_SIZE_Y = 800;
+    c.MINERAL_SIZE_X = 4; c.MINERAL_SIZE_Y = 4; c.MINERAL_LIFE = 2000;
+    c.MININGSHIP_SIZE_X = 16; c.MININGSHIP_SIZE_Y = 16; c.MININGSHIP_SPEED = 5; c.MININGSHIP_DETECTION_RADIUS = 160;
+    c.MININGSHIP_MAX_LIFE = 1000; c.MININGSHIP_START_LIFE = 600; c.MININGSHIP_START_FUEL = 1200; c.MININGSHIP_MAX_FUEL = 2000;
+    c.MININGSHIP_MOVE_CONSO = 5; c.MININGSHIP_MINING_RADIUS = 30; c.MININGSHIP_MINERAL_EXTRACT = 50;
+    c.MININGSHIP_MAX_MINERAL_STORAGE = 8000; c.MININGSHIP_MEMORY_SIZE = 4;
+    c.FIGHTER_SIZE_X = 16; c.FIGHTER_SIZE_Y = 16; c.FIGHTER_SPEED = 5; c.FIGHTER_DETECTION_RADIUS = 160;
+    c.FIGHTER_MAX_LIFE = 1000; c.FIGHTER_START_LIFE = 600; c.FIGHTER_MOVE_CONSO = 5; c.FIGHTER_START_FUEL = 1200;
+    c.FIGHTER_MAX_FUEL = 2000; c.FIGHTER_MEMORY_SIZE = 4; c.FIGHTER_START_MISSILE = 8; c.FIGHTER_MAX_MISSILE = 12;
+    c.MISSILE_SIZE_X = 5; c.MISSILE_SIZE_Y = 1; c.MISSILE_LIFE = 10; c.MISSILE_MOVE_CONSO = 2; c.MISSILE_START_FUEL = 16;
+    c.MISSILE_MAX_FUEL = 16; c.MISSILE_SPEED = 20; c.MISSILE_DAMAGE = 200;
+    c.BASE_SIZE_X = 25; c.BASE_SIZE_Y = 25; c.BASE_DETECTION_RADIUS = 200; c.BASE_MAX_LIFE = 10000; c.BASE_START_LIFE = 5000;
+    c.BASE_MISSILE_PRICE = 26; c.BASE_MININGSHIP_PRICE = 1800; c.BASE_FIGHTER_PRICE = 2008;
+    c.BASE_START_MINERAL_STORAGE = 10000; c.BASE_MAX_MINERAL_STORAGE = 500000; c.BASE_MEMORY_SIZE = 4;
+    c.BASE_REPAIR_RADIUS = 40; c.BASE_REFUEL_RADIUS = 40; c.BASE_GIVE_MISSILE_RADIUS = 40; c.COMMUNICATION_RADIUS = 40;
+}
+
+// fire at an enemy in sight, sometimes
+static void fireAtEnemy(Playable *p, int odds)
+{
+    Item::ItemList n = p->neighbours();
+    for(Item::ItemList::iterator it = n.begin() ; it != n.end() ; ++it)
+    {
+        Playable *e = dynamic_cast<Playable*>(*it);
+        if(e && !p->isFriend(e) && (std::rand() % odds) == 0)
+        {
+            if(Fighter *f = dynamic_cast<Fighter*>(p))
+                f->launchMissile(dynamic_cast<Living*>(e));
+            else if(Base *b = dynamic_cast<Base*>(p))
+                b->launchMissile(dynamic_cast<Living*>(e));
+            break;
+        }
+    }
+}
+
+static void fighterPlay(Playable *p)
+{
+    Fighter *f = dynamic_cast<Fighter*>(p);
+    fireAtEnemy(f, 3);
+    f->rotateOf((std::rand() % 91) - 45);
+    f->move();
+}
+
+static void basePlay(Playable *p)
+{
+    Base *b = dynamic_cast<Base*>(p);
+    fireAtEnemy(b, 4);
+    if(std::rand() % 10 == 0)
+        b->createFighter();
+    if(std::rand() % 15 == 0)
+        b->createMiningShip();
+}
+
+// 64 bits FNV-1a
+static void hash(unsigned long long &digest, const char *s)
+{
+    for( ; *s ; ++s)
+    {
+        digest ^= static_cast<unsigned char>(*s);
+        digest *= 1099511628211ULL;
+    }
+}
+
+// the kind and state of each item, in the order of the item loop
+static unsigned long long digest(const ItemManager &im)
+{
+    unsigned long long d = 14695981039346656037ULL;
+    char line[256];
+    ItemManager::ItemMap::const_iterator it;
+    for(it = im.begin() ; it != im.end() ; ++it)
+    {
+        const Item *item = it->second;
+        if(item->_toRemove())
+            continue;
+
+        const char *kind = "Item";
+        unsigned int life = 0, fuel = 0;
+        double angle = 0.0;
+        if(dynamic_cast<const Base*>(item))
+            kind = "Base";
+        else if(dynamic_cast<const MiningShip*>(item))
+            kind = "MiningShip";
+        else if(dynamic_cast<const Fighter*>(item))
+            kind = "Fighter";
+        else if(dynamic_cast<const Missile*>(item))
+            kind = "Missile";
+        else if(dynamic_cast<const Mineral*>(item))
+            kind = "Mineral";
+        if(const Living *l = dynamic_cast<const Living*>(item))
+            life = l->life();
+        if(const Movable *m = dynamic_cast<const Movable*>(item))
+        {
+            fuel = m->fuel();
+            angle = m->angle();
+        }
+
+        // rounded: the engine may compute the same move with other operations
+        std::sprintf(line, "%s %.3f %.3f %.2f %u %u;", kind, item->xpos(), item->ypos(), angle, life, fuel);
+        hash(d, line);
+    }
+    return d;
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = (argc > 1 && std::strcmp(argv[1], "-v") == 0);
+
+    // the messages of the game would hide the digests
+    std::cout.setstate(std::ios::failbit);
+
+    std::srand(42);
+    setRules();
+
+    DefaultPlayFunction fpf(&fighterPlay), bpf(&basePlay);
+    HandlerExample eh;
+    GameManager gm;
+    gm.registerTeam(BLUE_TEAM, bpf, eh.get_MiningShipHandler(1), fpf);
+    gm.registerTeam(RED_TEAM, bpf, eh.get_MiningShipHandler(2), fpf);
+
+    ItemManager &im = gm.getItemManager();
+    double ox = 0.0, oy = 0.0;
+    im.applyOffset(ox, oy);
+    im.createBase(ox + 80, oy + 400, BLUE_TEAM);
+    im.createBase(ox + 720, oy + 400, RED_TEAM);
+    for(int i = 0 ; i < 12 ; i++)
+    {
+        for(int j = 0 ; j < 12 ; j++)
+            im.createMineral(ox + 100 + i * 50, oy + 100 + j * 50);
+    }
+    for(int i = 0 ; i < 20 ; i++)
+    {
+        im.createMiningShip(ox + 280, oy + 380 + i * 5, BLUE_TEAM);
+        im.createMiningShip(ox + 520, oy + 380 + i * 5, RED_TEAM);
+    }
+    for(int i = 0 ; i < 20 ; i++)
+    {
+        im.createFighter(ox + 350, oy + 380 + i * 5, BLUE_TEAM);
+        im.createFighter(ox + 450, oy + 380 + i * 5, RED_TEAM);
+    }
+
+    unsigned int round;
+    for(round = 0 ; round < ROUNDS && !gm.gameOver() ; ++round)
+    {
+        gm.update(round);
+        if(verbose && round % 100 == 0)
+            std::printf("round %u digest %016llx\n", round, digest(im));
+    }
+
+    unsigned long long d = digest(im);
+    std::printf("%u rounds, digest %016llx, expected %016llx: %s\n", round, d, EXPECTED_DIGEST,
+                d == EXPECTED_DIGEST ? "ok" : "DIFFERENT");
+    return d == EXPECTED_DIGEST ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "aiwar_client.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* read exactly size bytes, return 1 on success, 0 at the end of the input, -1 on error */
+static int read_all(void *data, size_t size)
+{
+    size_t n = fread(data, 1, size, stdin);
+    if(n == size)
+        return 1;
+    return (n == 0 && feof(stdin)) ? 0 : -1;
+}
+
+/* grow an array to hold at least count elements */
+static int reserve(void **array, size_t *capacity, size_t count, size_t size)
+{
+    size_t n;
+    void *p;
+
+    if(count <= *capacity)
+        return 0;
+
+    n = *capacity ? *capacity : 64;
+    while(n < count)
+        n *= 2;
+
+    p = realloc(*array, n * size);
+    if(!p)
+        return -1;
+    *array = p;
+    *capacity = n;
+    return 0;
+}
+
+int aiwar_init(AiwarClient *c)
+{
+    memset(c, 0, sizeof(*c));
+
+    if(read_all(&c->hello, sizeof(c->hello)) != 1)
+        return -1;
+    if(c->hello.magic != AIWAR_MAGIC_HELLO || c->hello.version != AIWAR_PROTOCOL_VERSION)
+    {
+        fprintf(stderr, "aiwar: unknown protocol\n");
+        return -1;
+    }
+    return 0;
+}
+
+int aiwar_next_frame(AiwarClient *c)
+{
+    int r = read_all(&c->frame, sizeof(c->frame));
+    if(r != 1)
+        return r;
+    if(c->frame.magic != AIWAR_MAGIC_FRAME)
+    {
+        fprintf(stderr, "aiwar: bad frame\n");
+        return -1;
+    }
+
+    if(reserve((void**)&c->items, &c->itemCapacity, c->frame.itemCount, sizeof(AiwarItem)) != 0
+       || reserve((void**)&c->units, &c->unitCapacity, c->frame.unitCount, sizeof(AiwarUnit)) != 0
+       || reserve((void**)&c->neighbours, &c->neighbourCapacity, c->frame.neighbourCount, sizeof(uint32_t)) != 0)
+        return -1;
+
+    if((c->frame.itemCount && read_all(c->items, c->frame.itemCount * sizeof(AiwarItem)) != 1)
+       || (c->frame.unitCount && read_all(c->units, c->frame.unitCount * sizeof(AiwarUnit)) != 1)
+       || (c->frame.neighbourCount && read_all(c->neighbours, c->frame.neighbourCount * sizeof(uint32_t)) != 1))
+        return -1;
+
+    c->commandCount = 0;
+    return 1;
+}
+
+const AiwarItem* aiwar_neighbour(const AiwarClient *c, uint32_t u, uint32_t i)
+{
+    return &c->items[c->neighbours[c->units[u].first + i]];
+}
+
+double aiwar_distance(const AiwarItem *a, const AiwarItem *b)
+{
+    return aiwar_distance_to(a, b->x, b->y);
+}
+
+double aiwar_distance_to(const AiwarItem *a, double x, double y)
+{
+    double dx = a->x - x, dy = a->y - y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+int aiwar_command(AiwarClient *c, uint32_t op, uint64_t unit, uint64_t target, double x, double y, uint32_t value)
+{
+    AiwarCommand *cmd;
+
+    if(reserve((void**)&c->commands, &c->commandCapacity, c->commandCount + 1, sizeof(AiwarCommand)) != 0)
+        return -1;
+
+    cmd = &c->commands[c->commandCount++];
+    cmd->unit = unit;
+    cmd->target = target;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->op = op;
+    cmd->value = value;
+    return 0;
+}
+
+int aiwar_rotate_to(AiwarClient *c, const AiwarItem *unit, double x, double y)
+{
+    return aiwar_command(c, AIWAR_ROTATE_TO, unit->key, 0, x, y, 0);
+}
+
+int aiwar_rotate_of(AiwarClient *c, const AiwarItem *unit, double angle)
+{
+    return aiwar_command(c, AIWAR_ROTATE_OF, unit->key, 0, angle, 0.0, 0);
+}
+
+int aiwar_move(AiwarClient *c, const AiwarItem *unit)
+{
+    return aiwar_command(c, AIWAR_MOVE, unit->key, 0, 0.0, 0.0, 0);
+}
+
+int aiwar_extract(AiwarClient *c, const AiwarItem *ship, const AiwarItem *mineral)
+{
+    return aiwar_command(c, AIWAR_EXTRACT, ship->key, mineral->key, 0.0, 0.0, 0);
+}
+
+int aiwar_push_mineral(AiwarClient *c, const AiwarItem *ship, const AiwarItem *base, uint32_t points)
+{
+    return aiwar_command(c, AIWAR_PUSH_MINERAL, ship->key, base->key, 0.0, 0.0, points);
+}
+
+int aiwar_launch_missile(AiwarClient *c, const AiwarItem *unit, const AiwarItem *target)
+{
+    return aiwar_command(c, AIWAR_LAUNCH_MISSILE, unit->key, target->key, 0.0, 0.0, 0);
+}
+
+int aiwar_create_miningship(AiwarClient *c, const AiwarItem *base)
+{
+    return aiwar_command(c, AIWAR_CREATE_MININGSHIP, base->key, 0, 0.0, 0.0, 0);
+}
+
+int aiwar_create_fighter(AiwarClient *c, const AiwarItem *base)
+{
+    return aiwar_command(c, AIWAR_CREATE_FIGHTER, base->key, 0, 0.0, 0.0, 0);
+}
+
+int aiwar_refuel(AiwarClient *c, const AiwarItem *base, const AiwarItem *ship, uint32_t points)
+{
+    return aiwar_command(c, AIWAR_REFUEL, base->key, ship->key, 0.0, 0.0, points);
+}
+
+int aiwar_give_missiles(AiwarClient *c, const AiwarItem *base, const AiwarItem *fighter, uint32_t missiles)
+{
+    return aiwar_command(c, AIWAR_GIVE_MISSILES, base->key, fighter->key, 0.0, 0.0, missiles);
+}
+
+int aiwar_state(AiwarClient *c, const AiwarItem *unit, uint32_t state)
+{
+    return aiwar_command(c, AIWAR_STATE, unit->key, 0, 0.0, 0.0, state);
+}
+
+int aiwar_send(AiwarClient *c)
+{
+    AiwarCommandHeader h;
+    h.magic = AIWAR_MAGIC_COMMAND;
+    h.tick = c->frame.tick;
+    h.count = c->commandCount;
+    h.reserved = 0;
+
+    if(fwrite(&h, sizeof(h), 1, stdout) != 1)
+        return -1;
+    if(c->commandCount && fwrite(c->commands, sizeof(AiwarCommand), c->commandCount, stdout) != c->commandCount)
+        return -1;
+    return fflush(stdout) == 0 ? 0 : -1;
+}
+
+void aiwar_free(AiwarClient *c)
+{
+    free(c->items);
+    free(c->units);
+    free(c->neighbours);
+    free(c->commands);
+    memset(c, 0, sizeof(*c));
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Client library for the AIs run by the "process" handler, see aiwar_protocol.h.
+ *
+ *     AiwarClient c;
+ *     if(aiwar_init(&c) != 0)
+ *         return 1;
+ *     while(aiwar_next_frame(&c) == 1)
+ *     {
+ *         for(u = 0 ; u < c.frame.unitCount ; ++u)
+ *             ... read c.items[u], aiwar_neighbour(&c, u, i), add commands ...
+ *         if(aiwar_send(&c) != 0)
+ *             break;
+ *     }
+ *     aiwar_free(&c);
+ *
+ * The standard output is the pipe to the game: print messages on stderr.
+ */
+
+#ifndef AIWAR_CLIENT_H
+#define AIWAR_CLIENT_H
+
+#include "aiwar_protocol.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    AiwarHello hello;       /* team and rules of the game */
+    AiwarFrameHeader frame; /* the last frame read */
+
+    AiwarItem *items;       /* frame.itemCount items, the units of the team first */
+    AiwarUnit *units;       /* frame.unitCount units */
+    uint32_t *neighbours;   /* frame.neighbourCount indexes in items */
+
+    AiwarCommand *commands; /* commands of the round, sent by aiwar_send() */
+    uint32_t commandCount;
+
+    /* allocated sizes */
+    size_t itemCapacity;
+    size_t unitCapacity;
+    size_t neighbourCapacity;
+    size_t commandCapacity;
+} AiwarClient;
+
+/* read the hello message, return 0 on success */
+int aiwar_init(AiwarClient *c);
+
+/* read the next frame and clear the commands, return 1 if a frame is read, 0 at the end of the game, -1 on error */
+int aiwar_next_frame(AiwarClient *c);
+
+/* i-th neighbour of the unit u, sorted by key */
+const AiwarItem* aiwar_neighbour(const AiwarClient *c, uint32_t u, uint32_t i);
+
+double aiwar_distance(const AiwarItem *a, const AiwarItem *b);
+double aiwar_distance_to(const AiwarItem *a, double x, double y);
+
+/* add a command, return 0 on success */
+int aiwar_command(AiwarClient *c, uint32_t op, uint64_t unit, uint64_t target, double x, double y, uint32_t value);
+
+/* shortcuts for aiwar_command() */
+int aiwar_rotate_to(AiwarClient *c, const AiwarItem *unit, double x, double y);
+int aiwar_rotate_of(AiwarClient *c, const AiwarItem *unit, double angle);
+int aiwar_move(AiwarClient *c, const AiwarItem *unit);
+int aiwar_extract(AiwarClient *c, const AiwarItem *ship, const AiwarItem *mineral);
+int aiwar_push_mineral(AiwarClient *c, const AiwarItem *ship, const AiwarItem *base, uint32_t points);
+int aiwar_launch_missile(AiwarClient *c, const AiwarItem *unit, const AiwarItem *target);
+int aiwar_create_miningship(AiwarClient *c, const AiwarItem *base);
+int aiwar_create_fighter(AiwarClient *c, const AiwarItem *base);
+int aiwar_refuel(AiwarClient *c, const AiwarItem *base, const AiwarItem *ship, uint32_t points);
+int aiwar_give_missiles(AiwarClient *c, const AiwarItem *base, const AiwarItem *fighter, uint32_t missiles);
+int aiwar_state(AiwarClient *c, const AiwarItem *unit, uint32_t state);
+
+/* send the commands of the round, return 0 on success */
+int aiwar_send(AiwarClient *c);
+
+void aiwar_free(AiwarClient *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIWAR_CLIENT_H */
@@ -0,0 +1,604 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2012, 2013 Paul Grégoire
+#
+# This file is part of AIWar.
+#
+# AIWar is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# AIWar is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Runs an AI written for the python handler in its own process, with the
+process handler: each team has its own interpreter, and with --isolate the
+two teams think at the same time.
+
+config.xml:
+    <player>
+      <name>GuiGui-6-Process</name>
+      <handler>process</handler>
+      <params>python client/aiwar_client.py AIWar_GuiGui_06</params>
+    </player>
+
+The module is imported from the current directory, like with the python
+handler, and its play_team() or play_base(), play_miningship() and
+play_fighter() are called each round. It imports an 'aiwar' module made by
+this client from the messages of client/aiwar_protocol.h, with the API of
+the one of the python handler, except:
+ - the units see the world as it was at the start of the round: the actions
+   are sent to the game at the end of the round and applied in the order
+   they were made, so pos() does not change after move(). The actions
+   returning a number return the most the game may give, the number given
+   is seen in the next round;
+ - the memory of the units is kept by this process, with the same rules;
+ - an item of the team raises a RuntimeError once destroyed, but an item
+   which is out of sight keeps the state it had when last seen;
+ - log() is ignored: the log of a unit is shown by the renderer of the game;
+ - the neighbour queries (nearest() to argminBy()), moveTowards(),
+   keepDistance(), snapshot() and the C API are not available.
+The standard output of the AI goes to the standard error.
+"""
+
+import math
+import os
+import random
+import struct
+import sys
+import types
+
+PROTOCOL_VERSION = 2
+
+MAGIC_HELLO = 0x48574941
+MAGIC_FRAME = 0x54574941
+MAGIC_COMMAND = 0x43574941
+
+MINERAL_KIND, MISSILE_KIND, BASE_KIND, MININGSHIP_KIND, FIGHTER_KIND = 1, 2, 3, 4, 5
+
+(ROTATE_TO, ROTATE_OF, MOVE, EXTRACT, PUSH_MINERAL, PULL_MINERAL, LAUNCH_MISSILE,
+ CREATE_MININGSHIP, CREATE_FIGHTER, REPAIR, REFUEL, GIVE_MISSILES, STATE) = range(1, 14)
+
+# fields of AiwarConfig, in order, and the ones which are integers in the game
+CONFIG = ('WORLD_SIZE_X', 'WORLD_SIZE_Y',
+          'MINERAL_SIZE_X', 'MINERAL_SIZE_Y', 'MINERAL_LIFE',
+          'MININGSHIP_SIZE_X', 'MININGSHIP_SIZE_Y', 'MININGSHIP_SPEED', 'MININGSHIP_DETECTION_RADIUS',
+          'MININGSHIP_MAX_LIFE', 'MININGSHIP_START_LIFE', 'MININGSHIP_START_FUEL', 'MININGSHIP_MAX_FUEL',
+          'MININGSHIP_MOVE_CONSO', 'MININGSHIP_MINING_RADIUS', 'MININGSHIP_MINERAL_EXTRACT',
+          'MININGSHIP_MAX_MINERAL_STORAGE',
+          'FIGHTER_SIZE_X', 'FIGHTER_SIZE_Y', 'FIGHTER_SPEED', 'FIGHTER_DETECTION_RADIUS',
+          'FIGHTER_MAX_LIFE', 'FIGHTER_START_LIFE', 'FIGHTER_MOVE_CONSO', 'FIGHTER_START_FUEL',
+          'FIGHTER_MAX_FUEL', 'FIGHTER_START_MISSILE', 'FIGHTER_MAX_MISSILE',
+          'MISSILE_SIZE_X', 'MISSILE_SIZE_Y', 'MISSILE_LIFE', 'MISSILE_MOVE_CONSO', 'MISSILE_START_FUEL',
+          'MISSILE_MAX_FUEL', 'MISSILE_SPEED', 'MISSILE_DAMAGE',
+          'BASE_SIZE_X', 'BASE_SIZE_Y', 'BASE_DETECTION_RADIUS', 'BASE_MAX_LIFE', 'BASE_START_LIFE',
+          'BASE_MISSILE_PRICE', 'BASE_MININGSHIP_PRICE', 'BASE_FIGHTER_PRICE', 'BASE_START_MINERAL_STORAGE',
+          'BASE_MAX_MINERAL_STORAGE', 'BASE_REPAIR_RADIUS', 'BASE_REFUEL_RADIUS', 'BASE_GIVE_MISSILE_RADIUS',
+          'COMMUNICATION_RADIUS',
+          'MININGSHIP_MEMORY_SIZE', 'FIGHTER_MEMORY_SIZE', 'BASE_MEMORY_SIZE')
+DOUBLES = ('WORLD_SIZE_X', 'WORLD_SIZE_Y', 'MINERAL_SIZE_X', 'MINERAL_SIZE_Y',
+           'MININGSHIP_SIZE_X', 'MININGSHIP_SIZE_Y', 'MININGSHIP_SPEED', 'MININGSHIP_DETECTION_RADIUS',
+           'MININGSHIP_MINING_RADIUS',
+           'FIGHTER_SIZE_X', 'FIGHTER_SIZE_Y', 'FIGHTER_SPEED', 'FIGHTER_DETECTION_RADIUS',
+           'MISSILE_SIZE_X', 'MISSILE_SIZE_Y', 'MISSILE_SPEED',
+           'BASE_SIZE_X', 'BASE_SIZE_Y', 'BASE_DETECTION_RADIUS', 'BASE_REPAIR_RADIUS', 'BASE_REFUEL_RADIUS',
+           'BASE_GIVE_MISSILE_RADIUS', 'COMMUNICATION_RADIUS')
+
+HELLO = struct.Struct('=4I%dd' % len(CONFIG))
+FRAME = struct.Struct('=6I')
+ITEM = struct.Struct('=Q3d3I2BH')
+UNIT = struct.Struct('=2I')
+COMMAND_HEADER = struct.Struct('=4I')
+COMMAND = struct.Struct('=2Q2d2I')
+
+# value of the memory slots, they are 4 bytes like in the game
+MEMORY = {'Int': struct.Struct('=i'), 'UInt': struct.Struct('=I'), 'Float': struct.Struct('=f')}
+
+
+class Record(object):
+    "State of an item in the last frame where it was seen"
+    __slots__ = ('key', 'kind', 'team', 'x', 'y', 'angle', 'life', 'fuel', 'extra',
+                 'alive', 'seen', 'neighbours', 'memory', 'playable', 'view')
+
+    def __init__(self, key):
+        self.key = key
+        self.alive = True
+        self.seen = -1
+        self.neighbours = ()
+        self.memory = None
+        self.playable = None
+        self.view = None
+
+
+class Game(object):
+    "The connection to the game and the items seen by the team"
+
+    def __init__(self, fin, fout):
+        self.fin = fin
+        self.fout = fout
+        self.records = {}
+        self.commands = []
+        self.tick = 0
+
+        h = HELLO.unpack(self._read(HELLO.size))
+        if h[0] != MAGIC_HELLO or h[1] != PROTOCOL_VERSION:
+            raise RuntimeError('aiwar: unknown protocol')
+        self.team = h[2]
+        self.seed = h[3]
+        self.config = dict(zip(CONFIG, h[4:]))
+        for name in CONFIG:
+            if name not in DOUBLES:
+                self.config[name] = int(self.config[name])
+
+    def _read(self, size):
+        data = self.fin.read(size)
+        if len(data) != size:
+            raise EOFError()
+        return data
+
+    def nextFrame(self):
+        "Read a frame, return the units of the team, False when the game is over"
+        try:
+            magic, tick, unitCount, itemCount, neighbourCount, _ = FRAME.unpack(self._read(FRAME.size))
+        except EOFError:
+            return False
+        if magic != MAGIC_FRAME:
+            raise RuntimeError('aiwar: bad frame')
+        self.tick = tick
+
+        data = self._read(itemCount * ITEM.size + unitCount * UNIT.size + neighbourCount * 4)
+        records = self.records
+        items = []
+        unpack = ITEM.unpack_from
+        for i in range(itemCount):
+            key, x, y, angle, life, fuel, extra, kind, team, _ = unpack(data, i * ITEM.size)
+            r = records.get(key)
+            if r is None:
+                r = records[key] = Record(key)
+            r.x, r.y, r.angle, r.life, r.fuel, r.extra, r.kind, r.team = x, y, angle, life, fuel, extra, kind, team
+            r.seen = tick
+            items.append(r)
+
+        offset = itemCount * ITEM.size
+        units = items[:unitCount]
+        neighbours = struct.unpack_from('=%dI' % neighbourCount, data, offset + unitCount * UNIT.size)
+        for u in range(unitCount):
+            first, count = UNIT.unpack_from(data, offset + u * UNIT.size)
+            units[u].neighbours = [items[n] for n in neighbours[first:first + count]]
+
+        # the units of the team which are not seen anymore have been destroyed
+        for key in [k for k, r in records.items() if r.seen != tick]:
+            r = records.pop(key)
+            if r.team == self.team:
+                r.alive = False
+
+        self.commands = []
+        return units
+
+    def command(self, unit, op, target=None, x=0.0, y=0.0, value=0):
+        self.commands.append((unit.key, target.key if target else 0, x, y, op, value))
+
+    def sendCommands(self):
+        out = [COMMAND_HEADER.pack(MAGIC_COMMAND, self.tick, len(self.commands), 0)]
+        for c in self.commands:
+            out.append(COMMAND.pack(*c))
+        self.fout.write(b''.join(out))
+        self.fout.flush()
+
+
+game = None
+
+
+def record(o):
+    "Record of an item given to a method, like the python handler checks it"
+    if not isinstance(o, Item):
+        raise TypeError('must be an item')
+    r = o._r
+    if not r.alive:
+        raise RuntimeError('the item has been destroyed')
+    return r
+
+
+def seen(r):
+    "True if the item was in the last frame, so it can be the target of a command"
+    return r.seen == game.tick
+
+
+def position(o):
+    "Position of an item or a tuple of two floats"
+    if isinstance(o, Item):
+        r = record(o)
+        return r.x, r.y
+    try:
+        x, y = o
+        return float(x), float(y)
+    except (TypeError, ValueError):
+        raise TypeError('must be an Item or a tuple of two floats')
+
+
+def distance(r, x, y):
+    return math.sqrt((x - r.x) * (x - r.x) + (y - r.y) * (y - r.y))
+
+
+class Item(object):
+    "A view of an item, its methods raise a RuntimeError once the item is destroyed"
+    __slots__ = ('_r',)
+
+    def __init__(self, r):
+        self._r = r
+
+    def __eq__(self, other):
+        if not isinstance(other, Item):
+            return NotImplemented
+        return self._r.key == other._r.key
+
+    def __ne__(self, other):
+        if not isinstance(other, Item):
+            return NotImplemented
+        return self._r.key != other._r.key
+
+    def __hash__(self):
+        return hash(self._r.key)
+
+    def pos(self):
+        "Return the position of the item"
+        r = record(self)
+        return r.x, r.y
+
+    def life(self):
+        "Return the remaining life of the item"
+        return record(self).life
+
+
+class Moving(Item):
+    __slots__ = ()
+
+    def angle(self):
+        "Return the current angle of the item"
+        return record(self).angle
+
+
+class Mineral(Item):
+    __slots__ = ()
+
+
+class Missile(Moving):
+    __slots__ = ()
+
+
+class Base(Item):
+    __slots__ = ()
+
+
+class MiningShip(Moving):
+    __slots__ = ()
+
+
+class Fighter(Moving):
+    __slots__ = ()
+
+
+class Playable(Item):
+    "Methods of the units of the team"
+    __slots__ = ()
+
+    def neighbours(self):
+        "Return the neighbours of the item"
+        return [view(n) for n in record(self).neighbours]
+
+    def distanceTo(self, o):
+        "Return the distance to the other item or a point"
+        x, y = position(o)
+        return distance(record(self), x, y)
+
+    def team(self):
+        "Return the team of the item"
+        return record(self).team
+
+    def isFriend(self, o):
+        "Return true if the given item belong to the same team"
+        me = record(self)
+        r = record(o)
+        if r.kind not in (BASE_KIND, MININGSHIP_KIND, FIGHTER_KIND):
+            raise TypeError('argmument is not a Playable item')
+        return r.team == me.team
+
+    def fuel(self, o=None):
+        "Return the current fuel of the ship, or of a friend ship in the communication radius"
+        me = record(self)
+        if o is None:
+            return me.fuel
+        r = record(o)
+        if r.kind not in (MISSILE_KIND, MININGSHIP_KIND, FIGHTER_KIND):
+            raise TypeError('argmument is not a Movable item')
+        if distance(me, r.x, r.y) > game.config['COMMUNICATION_RADIUS'] or r.team != me.team:
+            return 0
+        return r.fuel
+
+    def log(self, msg):
+        "Log the message, ignored"
+        record(self)
+
+    def state(self, state):
+        "Set item state"
+        game.command(record(self), STATE, value=state)
+
+    def memorySize(self):
+        "Return the number of memory slots allocated to the item"
+        return len(memory(record(self))) // 4
+
+    def _getMemory(self, kind, index, o):
+        me = record(self)
+        r = me
+        if o is not None:
+            r = record(o)
+            if r.kind not in (BASE_KIND, MININGSHIP_KIND, FIGHTER_KIND):
+                raise TypeError('second argmument is not a Memory item')
+            if distance(me, r.x, r.y) > game.config['COMMUNICATION_RADIUS'] or r.team != me.team:
+                return MEMORY[kind].unpack(b'\0\0\0\0')[0]
+        m = memory(r)
+        if index < 0 or 4 * index >= len(m):
+            return MEMORY[kind].unpack(b'\0\0\0\0')[0]
+        return MEMORY[kind].unpack_from(m, 4 * index)[0]
+
+    def _setMemory(self, kind, index, value, o):
+        me = record(self)
+        r = me
+        if o is not None:
+            r = record(o)
+            if r.kind not in (BASE_KIND, MININGSHIP_KIND, FIGHTER_KIND):
+                raise TypeError('second argmument is not a Memory item')
+            if distance(me, r.x, r.y) > game.config['COMMUNICATION_RADIUS'] or r.team != me.team:
+                return
+        m = memory(r)
+        if 0 <= index and 4 * index < len(m):
+            MEMORY[kind].pack_into(m, 4 * index, value)
+
+    def getMemoryInt(self, index, o=None):
+        "Return the memory contained at position 'index' as an int value"
+        return self._getMemory('Int', index, o)
+
+    def getMemoryUInt(self, index, o=None):
+        "Return the memory contained at position 'index' as an unsigned int value"
+        return self._getMemory('UInt', index, o)
+
+    def getMemoryFloat(self, index, o=None):
+        "Return the memory contained at position 'index' as a float value"
+        return self._getMemory('Float', index, o)
+
+    def setMemoryInt(self, index, value, o=None):
+        "Set the memory at position 'index' with 'value' as an int"
+        self._setMemory('Int', index, value, o)
+
+    def setMemoryUInt(self, index, value, o=None):
+        "Set the memory at position 'index' with 'value' as an unsigned int"
+        self._setMemory('UInt', index, value, o)
+
+    def setMemoryFloat(self, index, value, o=None):
+        "Set the memory at position 'index' with 'value' as a float"
+        self._setMemory('Float', index, value, o)
+
+
+class PlayableMoving(Playable):
+    __slots__ = ()
+
+    def angle(self):
+        "Return the current angle of the ship"
+        return record(self).angle
+
+    def rotateOf(self, a):
+        "Rotate the movable item of the given angle"
+        game.command(record(self), ROTATE_OF, x=float(a))
+
+    def rotateTo(self, o):
+        "Rotate the movable item in the direction of the other item or point"
+        me = record(self)
+        if isinstance(o, Item) and seen(record(o)):
+            game.command(me, ROTATE_TO, target=record(o))
+        else:
+            x, y = position(o)
+            game.command(me, ROTATE_TO, x=x, y=y)
+
+    def move(self):
+        "Move the movable item in the direction given by its angle"
+        game.command(record(self), MOVE)
+
+
+class PlayableMiningShip(PlayableMoving):
+    __slots__ = ()
+
+    def mineralStorage(self):
+        "Return the number of mineral points contained in the ship"
+        return record(self).extra
+
+    def extract(self, m):
+        "Extract mineral points from a Mineral item"
+        me = record(self)
+        if not isinstance(m, Mineral):
+            raise TypeError('must be a Mineral')
+        r = record(m)
+        if not seen(r):
+            return 0
+        game.command(me, EXTRACT, target=r)
+        space = game.config['MININGSHIP_MAX_MINERAL_STORAGE'] - me.extra
+        return max(0, min(game.config['MININGSHIP_MINERAL_EXTRACT'], r.life, space))
+
+    def pushMineral(self, o, value):
+        "Push Mineral points to a friend Base"
+        me = record(self)
+        r = record(o)
+        if r.kind != BASE_KIND:
+            raise TypeError('must be a Base')
+        if not seen(r):
+            return 0
+        game.command(me, PUSH_MINERAL, target=r, value=value)
+        return value
+
+
+class PlayableBase(Playable):
+    __slots__ = ()
+
+    def mineralStorage(self):
+        "Return the number of mineral points contained in the base"
+        return record(self).extra
+
+    def pullMineral(self, o, value):
+        "Pull mineral from a friend MiningShip"
+        me = record(self)
+        r = record(o)
+        if r.kind != MININGSHIP_KIND:
+            raise TypeError('must be a MiningShip')
+        if not seen(r):
+            return 0
+        game.command(me, PULL_MINERAL, target=r, value=value)
+        return value
+
+    def launchMissile(self, o):
+        "Launch a Missile to a target"
+        me = record(self)
+        r = record(o)
+        if seen(r):
+            game.command(me, LAUNCH_MISSILE, target=r)
+
+    def createMiningShip(self):
+        "Create a new MiningShip"
+        game.command(record(self), CREATE_MININGSHIP)
+
+    def createFighter(self):
+        "Create a new Fighter"
+        game.command(record(self), CREATE_FIGHTER)
+
+    def repair(self, value, o=None):
+        "Repair itself or a friend"
+        me = record(self)
+        r = None
+        if o is not None:
+            r = record(o)
+            if not seen(r):
+                return 0
+        game.command(me, REPAIR, target=r, value=value)
+        return value
+
+    def refuel(self, value, o):
+        "Refuel a friend ship"
+        me = record(self)
+        r = record(o)
+        if not seen(r):
+            return 0
+        game.command(me, REFUEL, target=r, value=value)
+        return value
+
+    def giveMissiles(self, value, o):
+        "Give missiles to a friend Fighter"
+        me = record(self)
+        r = record(o)
+        if r.kind != FIGHTER_KIND:
+            raise TypeError('must be a Fighter')
+        if not seen(r):
+            return 0
+        game.command(me, GIVE_MISSILES, target=r, value=value)
+        return value
+
+
+class PlayableFighter(PlayableMoving):
+    __slots__ = ()
+
+    def missiles(self):
+        "Return the number of missiles of the fighter"
+        return record(self).extra
+
+    def launchMissile(self, o):
+        "Launch a Missile to a target"
+        me = record(self)
+        r = record(o)
+        if seen(r):
+            game.command(me, LAUNCH_MISSILE, target=r)
+
+
+VIEWS = {MINERAL_KIND: Mineral, MISSILE_KIND: Missile, BASE_KIND: Base,
+         MININGSHIP_KIND: MiningShip, FIGHTER_KIND: Fighter}
+PLAYABLES = {BASE_KIND: PlayableBase, MININGSHIP_KIND: PlayableMiningShip, FIGHTER_KIND: PlayableFighter}
+
+
+def view(r):
+    "The item as seen by the other items, the same object until the item is deleted"
+    if r.view is None:
+        r.view = VIEWS[r.kind](r)
+    return r.view
+
+
+def playable(r):
+    "The unit as given to its play function, the same object until the unit is deleted"
+    if r.playable is None:
+        r.playable = PLAYABLES[r.kind](r)
+    return r.playable
+
+
+def memory(r):
+    if r.memory is None:
+        size = {BASE_KIND: 'BASE_MEMORY_SIZE', MININGSHIP_KIND: 'MININGSHIP_MEMORY_SIZE',
+                FIGHTER_KIND: 'FIGHTER_MEMORY_SIZE'}[r.kind]
+        r.memory = bytearray(4 * game.config[size])
+    return r.memory
+
+
+def aiwarModule():
+    "The aiwar module of the python handler, made from the rules of the game"
+    m = types.ModuleType('aiwar')
+    m.__doc__ = 'aiwar module that provides item types and constant values'
+    for name in ('Mineral', 'Missile', 'Base', 'MiningShip', 'Fighter',
+                 'PlayableBase', 'PlayableMiningShip', 'PlayableFighter'):
+        setattr(m, name, globals()[name])
+    m.DEFAULT, m.LIGHT, m.DARK = 0, 1, 2
+    for name, value in game.config.items():
+        setattr(m, name, (lambda v: lambda: v)(value))
+    return m
+
+
+def main(argv):
+    global game
+
+    if len(argv) != 2:
+        sys.stderr.write('usage: aiwar_client.py module\n')
+        return 2
+
+    # the messages go to the game: what the AI prints goes to the standard error
+    fin = getattr(sys.stdin, 'buffer', sys.stdin)
+    fout = os.fdopen(os.dup(sys.stdout.fileno()), 'wb')
+    os.dup2(sys.stderr.fileno(), sys.stdout.fileno())
+    sys.stdout = sys.stderr
+
+    game = Game(fin, fout)
+    random.seed(game.seed)
+    sys.modules['aiwar'] = aiwarModule()
+    sys.path.insert(0, '.')
+    module = __import__(argv[1])
+
+    play_team = getattr(module, 'play_team', None)
+    handlers = {BASE_KIND: getattr(module, 'play_base', None),
+                MININGSHIP_KIND: getattr(module, 'play_miningship', None),
+                FIGHTER_KIND: getattr(module, 'play_fighter', None)}
+
+    units = game.nextFrame()
+    while units is not False:
+        if play_team:
+            play_team([playable(u) for u in units if u.kind == BASE_KIND],
+                      [playable(u) for u in units if u.kind == MININGSHIP_KIND],
+                      [playable(u) for u in units if u.kind == FIGHTER_KIND])
+        else:
+            for u in units:
+                handlers[u.kind](playable(u))
+        game.sendCommands()
+        units = game.nextFrame()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * C interface of the AIs loaded as shared objects (handler "native").
+ *
+ * The params of the player are the path of the shared object, optionally followed
+ * by a space and a string given to aiwar_init(). The shared object exports:
+ *
+ *     void play_base(const AiwarApi *api, AiwarNativeItem *self);
+ *     void play_miningship(const AiwarApi *api, AiwarNativeItem *self);
+ *     void play_fighter(const AiwarApi *api, AiwarNativeItem *self);
+ *
+ * and optionally:
+ *
+ *     int aiwar_init(const AiwarApi *api, const char *params);   0 on success
+ *     void aiwar_teardown(void);
+ *     int aiwar_mode(void);                                      AIWAR_MODE_IMMEDIATE by default
+ *
+ * The units only act through the functions of the AiwarApi, with the rules of the
+ * game. An item is only valid during the call it is given in. A function called with
+ * an item of the wrong kind does nothing and makes the team lose at the end of the call.
+ *
+ * The shared object is loaded once per process: when both teams are played by the
+ * same object, they share its global variables.
+ *
+ * In AIWAR_MODE_IMMEDIATE, the units are played one at a time and their actions change
+ * the world at once. In AIWAR_MODE_INTENTS, all the units of a team are played at the
+ * same time, on the threads of the game (--threads), so the play functions must be
+ * thread-safe. Each unit sees the world as it was at the start of the round: its
+ * actions, state and memory writes are recorded, then applied with the usual rules
+ * once all the units of the team have played, unit after unit in key order and in the
+ * order of the calls of each unit. In this mode:
+ *   - only the unit given to the play function can act, log, and query its neighbours;
+ *   - the actions return 0, their effect is seen at the next round.
+ *
+ * The layout of AiwarApi only grows: new functions are added at its end, and
+ * api->size tells which ones the game provides.
+ */
+
+#ifndef AIWAR_NATIVE_H
+#define AIWAR_NATIVE_H
+
+#include "aiwar_protocol.h" /* for AiwarKind and AiwarTeam */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIWAR_NATIVE_VERSION 1
+
+/* values of aiwar_mode() */
+#define AIWAR_MODE_IMMEDIATE 0
+#define AIWAR_MODE_INTENTS   1
+
+/* an item of the game */
+typedef struct AiwarNativeItem AiwarNativeItem;
+
+typedef struct AiwarApi
+{
+    uint32_t version; /* AIWAR_NATIVE_VERSION */
+    uint32_t size;    /* sizeof(AiwarApi) in the game */
+
+    const AiwarConfig *config;
+
+    /* all items */
+    uint64_t (*key)(const AiwarNativeItem *item);
+    uint32_t (*kind)(const AiwarNativeItem *item);     /* AiwarKind */
+    uint32_t (*team)(const AiwarNativeItem *item);     /* AiwarTeam, AIWAR_NO_TEAM if not a unit */
+    double (*xpos)(const AiwarNativeItem *item);
+    double (*ypos)(const AiwarNativeItem *item);
+    double (*distance)(const AiwarNativeItem *item, const AiwarNativeItem *other);
+    double (*distance_to)(const AiwarNativeItem *item, double x, double y);
+    uint32_t (*life)(const AiwarNativeItem *item);     /* 0 if not living, mineral points of a mineral */
+
+    /* neighbours sorted by key, with masks of accepted kinds (1 << kind) and teams (1 << team), 0 for all.
+       Fills at most max items and returns the number of neighbours. */
+    size_t (*neighbours)(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, AiwarNativeItem **res, size_t max);
+    /* nearest neighbour, NULL if none. maxRadius < 0 for the whole detection radius */
+    AiwarNativeItem* (*nearest)(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, double maxRadius);
+
+    /* units */
+    int (*is_friend)(const AiwarNativeItem *self, const AiwarNativeItem *other);
+    void (*log)(AiwarNativeItem *self, const char *msg);
+    void (*state)(AiwarNativeItem *self, uint32_t state);  /* 0 DEFAULT, 1 LIGHT, 2 DARK */
+
+    /* memory of a unit, or of a friend in the communication radius if other is not NULL */
+    uint32_t (*memory_size)(const AiwarNativeItem *self);
+    int32_t (*get_memory_int)(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other);
+    uint32_t (*get_memory_uint)(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other);
+    float (*get_memory_float)(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other);
+    void (*set_memory_int)(AiwarNativeItem *self, uint32_t index, int32_t value, AiwarNativeItem *other);
+    void (*set_memory_uint)(AiwarNativeItem *self, uint32_t index, uint32_t value, AiwarNativeItem *other);
+    void (*set_memory_float)(AiwarNativeItem *self, uint32_t index, float value, AiwarNativeItem *other);
+
+    /* ships */
+    double (*angle)(const AiwarNativeItem *ship);
+    uint32_t (*fuel)(const AiwarNativeItem *ship);
+    uint32_t (*friend_fuel)(const AiwarNativeItem *self, const AiwarNativeItem *ship); /* in the communication radius */
+    void (*rotate_of)(AiwarNativeItem *ship, double angle);
+    void (*rotate_to)(AiwarNativeItem *ship, double x, double y);
+    void (*move)(AiwarNativeItem *ship);
+    int (*move_towards)(AiwarNativeItem *ship, double x, double y, double stopRadius);
+    int (*keep_distance)(AiwarNativeItem *ship, double x, double y, double radius);
+
+    /* mining ships and bases */
+    uint32_t (*mineral_storage)(const AiwarNativeItem *unit);
+
+    /* mining ships */
+    uint32_t (*extract)(AiwarNativeItem *ship, AiwarNativeItem *mineral);
+    uint32_t (*push_mineral)(AiwarNativeItem *ship, AiwarNativeItem *base, uint32_t points);
+
+    /* fighters */
+    uint32_t (*missiles)(const AiwarNativeItem *fighter);
+
+    /* bases and fighters */
+    void (*launch_missile)(AiwarNativeItem *unit, AiwarNativeItem *target);
+
+    /* bases */
+    void (*create_miningship)(AiwarNativeItem *base);
+    void (*create_fighter)(AiwarNativeItem *base);
+    uint32_t (*pull_mineral)(AiwarNativeItem *base, AiwarNativeItem *ship, uint32_t points);
+    uint32_t (*repair)(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *target); /* target NULL for the base */
+    uint32_t (*refuel)(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *ship);
+    uint32_t (*give_missiles)(AiwarNativeItem *base, uint32_t missiles, AiwarNativeItem *fighter);
+
+    /* non-zero once the team of the unit is over its think time budget (--tick-budget, --match-budget):
+       the play function should return at once, the team forfeits at the end of the call.
+       Only provided when api->size > offsetof(AiwarApi, over_budget) */
+    int (*over_budget)(const AiwarNativeItem *self);
+} AiwarApi;
+
+typedef void (*AiwarPlayFunction)(const AiwarApi *api, AiwarNativeItem *self);
+typedef int (*AiwarInitFunction)(const AiwarApi *api, const char *params);
+typedef void (*AiwarTeardownFunction)(void);
+typedef int (*AiwarModeFunction)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIWAR_NATIVE_H */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AIWAR_NATIVE_HPP
+#define AIWAR_NATIVE_HPP
+
+#include "aiwar_native.h"
+
+#include <string>
+#include <vector>
+
+namespace aiwar {
+    namespace native {
+
+        /**
+         * \brief C++ view of an item of the game, for the AIs compiled as shared objects
+         *
+         * A thin wrapper around the functions of AiwarApi: an Item is only valid
+         * during the play function it comes from.
+         */
+        class Item
+        {
+        public:
+            typedef std::vector<Item> ItemVector;
+
+            Item() : _api(NULL), _item(NULL) {}
+            Item(const AiwarApi *api, AiwarNativeItem *item) : _api(api), _item(item) {}
+
+            bool valid() const { return _item != NULL; }
+            AiwarNativeItem* handle() const { return _item; }
+            const AiwarConfig& config() const { return *_api->config; }
+
+            bool operator==(const Item &o) const { return _item == o._item; }
+            bool operator!=(const Item &o) const { return _item != o._item; }
+
+            // all items
+            uint64_t key() const { return _api->key(_item); }
+            AiwarKind kind() const { return static_cast<AiwarKind>(_api->kind(_item)); }
+            AiwarTeam team() const { return static_cast<AiwarTeam>(_api->team(_item)); }
+            double xpos() const { return _api->xpos(_item); }
+            double ypos() const { return _api->ypos(_item); }
+            double distanceTo(const Item &o) const { return _api->distance(_item, o._item); }
+            double distanceTo(double px, double py) const { return _api->distance_to(_item, px, py); }
+            unsigned int life() const { return _api->life(_item); }
+
+            bool isMineral() const { return kind() == AIWAR_MINERAL; }
+            bool isMissile() const { return kind() == AIWAR_MISSILE; }
+            bool isBase() const { return kind() == AIWAR_BASE; }
+            bool isMiningShip() const { return kind() == AIWAR_MININGSHIP; }
+            bool isFighter() const { return kind() == AIWAR_FIGHTER; }
+
+            /**
+             * \brief Get the neighbours sorted by key
+             * \param res Cleared then filled, reuse it from one call to the next
+             * \param kinds Bit (1 << AiwarKind) of the accepted kinds, 0 for all
+             * \param teams Bit (1 << AiwarTeam) of the accepted teams, 0 for all
+             */
+            void neighbours(ItemVector &res, unsigned int kinds = 0, unsigned int teams = 0) const
+            {
+                // no shared buffer: the units may be played by several threads
+                AiwarNativeItem *found[64];
+                std::size_t i, n = _api->neighbours(_item, kinds, teams, found, 64);
+                res.clear();
+                if(n <= 64)
+                {
+                    for(i = 0 ; i < n ; ++i)
+                        res.push_back(Item(_api, found[i]));
+                    return;
+                }
+                std::vector<AiwarNativeItem*> all(n);
+                n = _api->neighbours(_item, kinds, teams, &all[0], n);
+                for(i = 0 ; i < n && i < all.size() ; ++i)
+                    res.push_back(Item(_api, all[i]));
+            }
+
+            /**
+             * \brief Get the nearest neighbour, an invalid item if none
+             */
+            Item nearest(unsigned int kinds = 0, unsigned int teams = 0, double maxRadius = -1.0) const
+            {
+                return Item(_api, _api->nearest(_item, kinds, teams, maxRadius));
+            }
+
+            // units
+            bool isFriend(const Item &o) const { return _api->is_friend(_item, o._item) != 0; }
+            void log(const std::string &msg) { _api->log(_item, msg.c_str()); }
+            void state(unsigned int s) { _api->state(_item, s); }
+
+            unsigned int memorySize() const { return _api->memory_size(_item); }
+            template<typename T> T getMemory(unsigned int index) const;
+            template<typename T> T getMemory(unsigned int index, const Item &other) const;
+            template<typename T> void setMemory(unsigned int index, T value);
+            template<typename T> void setMemory(unsigned int index, T value, Item &other);
+
+            // ships
+            double angle() const { return _api->angle(_item); }
+            unsigned int fuel() const { return _api->fuel(_item); }
+            unsigned int fuel(const Item &ship) const { return _api->friend_fuel(_item, ship._item); }
+            void rotateOf(double a) { _api->rotate_of(_item, a); }
+            void rotateTo(double px, double py) { _api->rotate_to(_item, px, py); }
+            void rotateTo(const Item &o) { rotateTo(o.xpos(), o.ypos()); }
+            void move() { _api->move(_item); }
+            bool moveTowards(double px, double py, double stopRadius = 0.0) { return _api->move_towards(_item, px, py, stopRadius) != 0; }
+            bool keepDistance(double px, double py, double radius) { return _api->keep_distance(_item, px, py, radius) != 0; }
+
+            // mining ships and bases
+            unsigned int mineralStorage() const { return _api->mineral_storage(_item); }
+
+            // mining ships
+            unsigned int extract(Item &mineral) { return _api->extract(_item, mineral._item); }
+            unsigned int pushMineral(Item &base, unsigned int points) { return _api->push_mineral(_item, base._item, points); }
+
+            // fighters
+            unsigned int missiles() const { return _api->missiles(_item); }
+
+            // bases and fighters
+            void launchMissile(Item &target) { _api->launch_missile(_item, target._item); }
+
+            // bases
+            void createMiningShip() { _api->create_miningship(_item); }
+            void createFighter() { _api->create_fighter(_item); }
+            unsigned int pullMineral(Item &ship, unsigned int points) { return _api->pull_mineral(_item, ship._item, points); }
+            unsigned int repair(unsigned int points) { return _api->repair(_item, points, NULL); }
+            unsigned int repair(unsigned int points, Item &target) { return _api->repair(_item, points, target._item); }
+            unsigned int refuel(unsigned int points, Item &ship) { return _api->refuel(_item, points, ship._item); }
+            unsigned int giveMissiles(unsigned int nb, Item &fighter) { return _api->give_missiles(_item, nb, fighter._item); }
+
+            // the team is over its think time budget, false with a game older than over_budget
+            bool overBudget() const { return _api->size > offsetof(AiwarApi, over_budget) && _api->over_budget(_item) != 0; }
+
+        private:
+            const AiwarApi *_api;
+            AiwarNativeItem *_item;
+        };
+
+        template<> inline int Item::getMemory<int>(unsigned int index) const { return _api->get_memory_int(_item, index, NULL); }
+        template<> inline unsigned int Item::getMemory<unsigned int>(unsigned int index) const { return _api->get_memory_uint(_item, index, NULL); }
+        template<> inline float Item::getMemory<float>(unsigned int index) const { return _api->get_memory_float(_item, index, NULL); }
+
+        template<> inline int Item::getMemory<int>(unsigned int index, const Item &o) const { return _api->get_memory_int(_item, index, o._item); }
+        template<> inline unsigned int Item::getMemory<unsigned int>(unsigned int index, const Item &o) const { return _api->get_memory_uint(_item, index, o._item); }
+        template<> inline float Item::getMemory<float>(unsigned int index, const Item &o) const { return _api->get_memory_float(_item, index, o._item); }
+
+        template<> inline void Item::setMemory<int>(unsigned int index, int value) { _api->set_memory_int(_item, index, value, NULL); }
+        template<> inline void Item::setMemory<unsigned int>(unsigned int index, unsigned int value) { _api->set_memory_uint(_item, index, value, NULL); }
+        template<> inline void Item::setMemory<float>(unsigned int index, float value) { _api->set_memory_float(_item, index, value, NULL); }
+
+        template<> inline void Item::setMemory<int>(unsigned int index, int value, Item &o) { _api->set_memory_int(_item, index, value, o._item); }
+        template<> inline void Item::setMemory<unsigned int>(unsigned int index, unsigned int value, Item &o) { _api->set_memory_uint(_item, index, value, o._item); }
+        template<> inline void Item::setMemory<float>(unsigned int index, float value, Item &o) { _api->set_memory_float(_item, index, value, o._item); }
+
+    } // namespace aiwar::native
+} // namespace aiwar
+
+/**
+ * \brief Define the exported play functions of a shared object from three C++ functions taking an aiwar::native::Item&
+ */
+#define AIWAR_NATIVE_PLAYER(base, miningShip, fighter) \
+    extern "C" void play_base(const AiwarApi *api, AiwarNativeItem *self) { aiwar::native::Item i(api, self); base(i); } \
+    extern "C" void play_miningship(const AiwarApi *api, AiwarNativeItem *self) { aiwar::native::Item i(api, self); miningShip(i); } \
+    extern "C" void play_fighter(const AiwarApi *api, AiwarNativeItem *self) { aiwar::native::Item i(api, self); fighter(i); }
+
+#endif /* AIWAR_NATIVE_HPP */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Protocol between AIWar and an AI running in its own process (handler "process").
+ *
+ * The AI process reads the engine messages on its standard input and writes its
+ * commands on its standard output. All integers and floats are in the byte order
+ * of the host, all structures have their fields at their natural alignment and
+ * no implicit padding, so they can be read and written as they are.
+ *
+ * Engine -> AI:
+ *  - once, before the first frame: AiwarHello
+ *  - each round: AiwarFrameHeader
+ *                AiwarItem[itemCount]      the units of the team first (unitCount), then the items they see
+ *                AiwarUnit[unitCount]      neighbours of each unit
+ *                uint32_t[neighbourCount]  indexes in the item array
+ *
+ * AI -> Engine, after each frame:
+ *  - AiwarCommandHeader
+ *    AiwarCommand[count]                   applied in this order, with the rules of the game
+ *
+ * The engine closes the standard input of the AI when the game is over.
+ */
+
+#ifndef AIWAR_PROTOCOL_H
+#define AIWAR_PROTOCOL_H
+
+#include <stdint.h>
+
+#define AIWAR_PROTOCOL_VERSION 2
+
+#define AIWAR_MAGIC_HELLO   0x48574941u /* "AIWH" */
+#define AIWAR_MAGIC_FRAME   0x54574941u /* "AIWT" */
+#define AIWAR_MAGIC_COMMAND 0x43574941u /* "AIWC" */
+
+/* kinds of AiwarItem, values of aiwar::core::ItemKind */
+enum AiwarKind
+{
+    AIWAR_MINERAL = 1,
+    AIWAR_MISSILE = 2,
+    AIWAR_BASE = 3,
+    AIWAR_MININGSHIP = 4,
+    AIWAR_FIGHTER = 5
+};
+
+/* teams, values of aiwar::core::Team */
+enum AiwarTeam
+{
+    AIWAR_NO_TEAM = 0,
+    AIWAR_BLUE_TEAM = 1,
+    AIWAR_RED_TEAM = 2
+};
+
+/* rules of the game, see config.xml */
+typedef struct
+{
+    double WORLD_SIZE_X;
+    double WORLD_SIZE_Y;
+
+    double MINERAL_SIZE_X;
+    double MINERAL_SIZE_Y;
+    double MINERAL_LIFE;
+
+    double MININGSHIP_SIZE_X;
+    double MININGSHIP_SIZE_Y;
+    double MININGSHIP_SPEED;
+    double MININGSHIP_DETECTION_RADIUS;
+    double MININGSHIP_MAX_LIFE;
+    double MININGSHIP_START_LIFE;
+    double MININGSHIP_START_FUEL;
+    double MININGSHIP_MAX_FUEL;
+    double MININGSHIP_MOVE_CONSO;
+    double MININGSHIP_MINING_RADIUS;
+    double MININGSHIP_MINERAL_EXTRACT;
+    double MININGSHIP_MAX_MINERAL_STORAGE;
+
+    double FIGHTER_SIZE_X;
+    double FIGHTER_SIZE_Y;
+    double FIGHTER_SPEED;
+    double FIGHTER_DETECTION_RADIUS;
+    double FIGHTER_MAX_LIFE;
+    double FIGHTER_START_LIFE;
+    double FIGHTER_MOVE_CONSO;
+    double FIGHTER_START_FUEL;
+    double FIGHTER_MAX_FUEL;
+    double FIGHTER_START_MISSILE;
+    double FIGHTER_MAX_MISSILE;
+
+    double MISSILE_SIZE_X;
+    double MISSILE_SIZE_Y;
+    double MISSILE_LIFE;
+    double MISSILE_MOVE_CONSO;
+    double MISSILE_START_FUEL;
+    double MISSILE_MAX_FUEL;
+    double MISSILE_SPEED;
+    double MISSILE_DAMAGE;
+
+    double BASE_SIZE_X;
+    double BASE_SIZE_Y;
+    double BASE_DETECTION_RADIUS;
+    double BASE_MAX_LIFE;
+    double BASE_START_LIFE;
+    double BASE_MISSILE_PRICE;
+    double BASE_MININGSHIP_PRICE;
+    double BASE_FIGHTER_PRICE;
+    double BASE_START_MINERAL_STORAGE;
+    double BASE_MAX_MINERAL_STORAGE;
+    double BASE_REPAIR_RADIUS;
+    double BASE_REFUEL_RADIUS;
+    double BASE_GIVE_MISSILE_RADIUS;
+
+    double COMMUNICATION_RADIUS;
+
+    /* since the version 2, at the end so the native AIs built before still read the rules above */
+    double MININGSHIP_MEMORY_SIZE;
+    double FIGHTER_MEMORY_SIZE;
+    double BASE_MEMORY_SIZE;
+} AiwarConfig;
+
+typedef struct
+{
+    uint32_t magic;   /* AIWAR_MAGIC_HELLO */
+    uint32_t version; /* AIWAR_PROTOCOL_VERSION */
+    uint32_t team;    /* AiwarTeam played by the process */
+    uint32_t seed;    /* seed of the game, for the pseudo-random generators of the AI */
+    AiwarConfig config;
+} AiwarHello;
+
+typedef struct
+{
+    uint32_t magic; /* AIWAR_MAGIC_FRAME */
+    uint32_t tick;  /* number of the round, from 0 */
+    uint32_t unitCount;
+    uint32_t itemCount;
+    uint32_t neighbourCount;
+    uint32_t reserved;
+} AiwarFrameHeader;
+
+typedef struct
+{
+    uint64_t key;   /* identifies the item during all the game */
+    double x;
+    double y;
+    double angle;   /* degrees, trigonometric, 0 if not Movable */
+    uint32_t life;  /* 0 if not Living, mineral points of a Mineral */
+    uint32_t fuel;  /* units of the team only, 0 for the others */
+    uint32_t extra; /* units of the team only: mineral storage of a base or mining ship, missiles of a fighter */
+    uint8_t kind;   /* AiwarKind */
+    uint8_t team;   /* AiwarTeam */
+    uint16_t reserved;
+} AiwarItem;
+
+typedef struct
+{
+    uint32_t first; /* first neighbour of the unit in the neighbour array */
+    uint32_t count; /* number of neighbours, sorted by key */
+} AiwarUnit;
+
+/* commands, the unit is always a unit of the team */
+enum AiwarOp
+{
+    AIWAR_ROTATE_TO = 1,       /* turn toward the target, or toward (x, y) if target is 0 */
+    AIWAR_ROTATE_OF = 2,       /* turn of x degrees */
+    AIWAR_MOVE = 3,            /* one step along the current angle */
+    AIWAR_EXTRACT = 4,         /* mining ship extracts from the target mineral */
+    AIWAR_PUSH_MINERAL = 5,    /* mining ship gives value points to the target base */
+    AIWAR_PULL_MINERAL = 6,    /* base takes value points from the target mining ship */
+    AIWAR_LAUNCH_MISSILE = 7,  /* base or fighter shoots at the target */
+    AIWAR_CREATE_MININGSHIP = 8,
+    AIWAR_CREATE_FIGHTER = 9,
+    AIWAR_REPAIR = 10,         /* base gives value life points to the target, itself if target is 0 */
+    AIWAR_REFUEL = 11,         /* base gives value fuel points to the target */
+    AIWAR_GIVE_MISSILES = 12,  /* base gives value missiles to the target fighter */
+    AIWAR_STATE = 13           /* set the state (DEFAULT, LIGHT, DARK) of the unit to value */
+};
+
+typedef struct
+{
+    uint32_t magic; /* AIWAR_MAGIC_COMMAND */
+    uint32_t tick;  /* tick of the frame */
+    uint32_t count;
+    uint32_t reserved;
+} AiwarCommandHeader;
+
+typedef struct
+{
+    uint64_t unit;   /* key of the unit */
+    uint64_t target; /* key of an item seen by the team in the last frame, 0 if none */
+    double x;
+    double y;
+    uint32_t op;     /* AiwarOp */
+    uint32_t value;
+} AiwarCommand;
+
+#endif /* AIWAR_PROTOCOL_H */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * C API of the aiwar python module, for the python AIs written as compiled extensions.
+ *
+ * The aiwar module publishes a table of functions in the capsule aiwar._C_API. They
+ * call the game directly, without creating python objects nor parsing arguments:
+ *
+ *     static const AiwarPythonApi *api;
+ *
+ *     PyMODINIT_FUNC initmy_ai(void)
+ *     {
+ *         api = aiwar_import_api();
+ *         if(!api)
+ *             return;
+ *         Py_InitModule("my_ai", methods);
+ *     }
+ *
+ * A play function gets its unit as a python object: api->unit() gives its handle.
+ * Handles are only valid during the play function they were obtained in.
+ *
+ * Errors are python exceptions: functions returning a long return -1 with an exception
+ * set, functions returning a handle return NULL (with an exception set only on error,
+ * NULL may also mean "none"), and after a function returning a double or void, check
+ * PyErr_Occurred() when the arguments may be wrong.
+ *
+ * The layout of AiwarPythonApi only grows: new functions are added at its end, and
+ * api->size tells which ones the game provides.
+ */
+
+#ifndef AIWAR_PYTHON_H
+#define AIWAR_PYTHON_H
+
+#include <Python.h>
+
+#include "aiwar_protocol.h" /* for AiwarKind and AiwarTeam */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIWAR_PYTHON_API_VERSION 1
+#define AIWAR_PYTHON_CAPSULE "aiwar._C_API"
+
+/* any item of the game */
+typedef struct AiwarPyItem AiwarPyItem;
+
+/* a unit given to a play function: it can act. A unit is also an item: AIWAR_PY_ITEM(unit) */
+typedef struct AiwarPyUnit AiwarPyUnit;
+
+#define AIWAR_PY_ITEM(unit) ((AiwarPyItem*)(unit))
+
+/* teams of the queries, relatively to the unit: aiwar.FRIENDS, aiwar.ENEMIES, aiwar.NEUTRALS */
+#define AIWAR_PY_FRIENDS  0x1
+#define AIWAR_PY_ENEMIES  0x2
+#define AIWAR_PY_NEUTRALS 0x4
+
+/* kinds of the queries: aiwar.MINERALS... */
+#define AIWAR_PY_KIND(kind) (1u << (kind))
+
+/* states of the units: aiwar.DEFAULT, aiwar.LIGHT, aiwar.DARK */
+#define AIWAR_PY_DEFAULT 0
+#define AIWAR_PY_LIGHT   1
+#define AIWAR_PY_DARK    2
+
+typedef struct AiwarPythonApi
+{
+    uint32_t version; /* AIWAR_PYTHON_API_VERSION */
+    uint32_t size;    /* sizeof(AiwarPythonApi) in the game */
+
+    /* handles */
+    AiwarPyUnit *(*unit)(PyObject *playable); /* only the objects given to the play functions */
+    AiwarPyItem *(*item)(PyObject *item);     /* any aiwar item */
+    PyObject *(*object)(AiwarPyItem *item);   /* new reference, the item as seen by the others */
+
+    /* all items */
+    uint64_t (*key)(const AiwarPyItem *item);
+    int (*kind)(const AiwarPyItem *item);     /* AiwarKind */
+    int (*team)(const AiwarPyItem *item);     /* AiwarTeam, AIWAR_NO_TEAM if not a unit */
+    double (*xpos)(const AiwarPyItem *item);
+    double (*ypos)(const AiwarPyItem *item);
+    double (*distance)(const AiwarPyItem *item, const AiwarPyItem *other);
+    double (*distance_to)(const AiwarPyItem *item, double x, double y);
+    long (*life)(const AiwarPyItem *item);    /* 0 if not living, mineral points of a mineral */
+
+    /* queries of a unit, kinds and teams are masks of AIWAR_PY_KIND() and AIWAR_PY_FRIENDS...,
+       0 for all. neighbours() fills at most max items sorted by key and
+       returns the number of neighbours. */
+    Py_ssize_t (*neighbours)(AiwarPyUnit *unit, unsigned int kinds, unsigned int teams, AiwarPyItem **res, Py_ssize_t max);
+    AiwarPyItem *(*nearest)(AiwarPyUnit *unit, unsigned int kinds, unsigned int teams, double maxRadius);
+    long (*is_friend)(AiwarPyUnit *unit, const AiwarPyItem *item);
+
+    /* memory, of the unit if other is NULL, else of a friend in the communication radius */
+    long (*memory_size)(AiwarPyUnit *unit);
+    long (*get_memory_int)(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, int32_t *value);
+    long (*get_memory_uint)(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, uint32_t *value);
+    long (*get_memory_float)(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, float *value);
+    long (*set_memory_int)(AiwarPyUnit *unit, unsigned int index, int32_t value, AiwarPyItem *other);
+    long (*set_memory_uint)(AiwarPyUnit *unit, unsigned int index, uint32_t value, AiwarPyItem *other);
+    long (*set_memory_float)(AiwarPyUnit *unit, unsigned int index, float value, AiwarPyItem *other);
+
+    /* all units */
+    long (*log)(AiwarPyUnit *unit, const char *msg);
+    long (*state)(AiwarPyUnit *unit, unsigned int state); /* AIWAR_PY_DEFAULT, AIWAR_PY_LIGHT or AIWAR_PY_DARK */
+
+    /* ships */
+    double (*angle)(AiwarPyUnit *ship);
+    long (*fuel)(AiwarPyUnit *unit, const AiwarPyItem *ship); /* of the unit if ship is NULL */
+    long (*rotate_of)(AiwarPyUnit *ship, double angle);
+    long (*rotate_to)(AiwarPyUnit *ship, double x, double y);
+    long (*move)(AiwarPyUnit *ship);
+    long (*move_towards)(AiwarPyUnit *ship, double x, double y, double stopRadius); /* 1 if moved */
+    long (*keep_distance)(AiwarPyUnit *ship, double x, double y, double radius);    /* 1 if moved */
+
+    /* mining ships and bases */
+    long (*mineral_storage)(AiwarPyUnit *unit);
+    long (*extract)(AiwarPyUnit *ship, AiwarPyItem *mineral);
+    long (*push_mineral)(AiwarPyUnit *ship, AiwarPyItem *base, unsigned int points);
+
+    /* fighters and bases */
+    long (*missiles)(AiwarPyUnit *fighter);
+    long (*launch_missile)(AiwarPyUnit *unit, AiwarPyItem *target);
+
+    /* bases */
+    long (*create_miningship)(AiwarPyUnit *base);
+    long (*create_fighter)(AiwarPyUnit *base);
+    long (*pull_mineral)(AiwarPyUnit *base, AiwarPyItem *ship, unsigned int points);
+    long (*repair)(AiwarPyUnit *base, unsigned int points, AiwarPyItem *target); /* the base itself if target is NULL */
+    long (*refuel)(AiwarPyUnit *base, unsigned int points, AiwarPyItem *ship);
+    long (*give_missiles)(AiwarPyUnit *base, unsigned int missiles, AiwarPyItem *fighter);
+} AiwarPythonApi;
+
+#ifndef AIWAR_PYTHON_MODULE
+/*
+ * Import the table, NULL with an exception set if the aiwar module is not the right one.
+ * Call it from the init function of the extension.
+ */
+static const AiwarPythonApi *aiwar_import_api(void)
+{
+    const AiwarPythonApi *api = (const AiwarPythonApi*)PyCapsule_Import(AIWAR_PYTHON_CAPSULE, 0);
+    if(api && (api->version != AIWAR_PYTHON_API_VERSION || api->size < sizeof(AiwarPythonApi)))
+    {
+        PyErr_SetString(PyExc_ImportError, "unknown version of the aiwar C API");
+        return NULL;
+    }
+    return api;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIWAR_PYTHON_H */
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Example of an AI run in its own process, the play of handler_example.cpp.
+ * The memory of the units is replaced by the knowledge of the whole team:
+ * the position of its base and of the last mineral seen.
+ *
+ * config.xml:
+ *     <player>
+ *       <name>Example-Process</name>
+ *       <handler>process</handler>
+ *       <params>client/example_client</params>
+ *     </player>
+ */
+
+#include "aiwar_client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct
+{
+    int baseKnown;
+    double baseX, baseY;
+    int mineralKnown;
+    double mineralX, mineralY;
+} Knowledge;
+
+static void random_move(AiwarClient *c, const AiwarItem *self)
+{
+    aiwar_rotate_of(c, self, (rand() % 91) - 45);
+    aiwar_move(c, self);
+}
+
+static void play_base(AiwarClient *c, uint32_t u, Knowledge *k)
+{
+    const AiwarConfig *CFG = &c->hello.config;
+    const AiwarItem *self = &c->items[u];
+    uint32_t i;
+
+    k->baseKnown = 1;
+    k->baseX = self->x;
+    k->baseY = self->y;
+
+    /* refuel friend ships */
+    for(i = 0 ; i < c->units[u].count ; ++i)
+    {
+        const AiwarItem *n = aiwar_neighbour(c, u, i);
+        if(n->kind == AIWAR_MININGSHIP && n->team == self->team && aiwar_distance(self, n) <= CFG->BASE_REFUEL_RADIUS)
+            aiwar_refuel(c, self, n, (uint32_t)CFG->MININGSHIP_START_FUEL);
+    }
+
+    /* create new MiningShip */
+    if(self->extra > CFG->BASE_MININGSHIP_PRICE && (rand() % 20) == 1)
+        aiwar_create_miningship(c, self);
+}
+
+static void play_miningship(AiwarClient *c, uint32_t u, Knowledge *k)
+{
+    const AiwarConfig *CFG = &c->hello.config;
+    const AiwarItem *self = &c->items[u];
+    const AiwarItem *base = NULL, *mineral = NULL;
+    uint32_t i;
+
+    for(i = 0 ; i < c->units[u].count ; ++i)
+    {
+        const AiwarItem *n = aiwar_neighbour(c, u, i);
+        if(!base && n->kind == AIWAR_BASE && n->team == self->team)
+            base = n;
+        else if(!mineral && n->kind == AIWAR_MINERAL && n->life > 0)
+            mineral = n;
+    }
+
+    /* go back to the base ? */
+    if(self->extra == CFG->MININGSHIP_MAX_MINERAL_STORAGE || self->fuel < (k->baseKnown ? aiwar_distance_to(self, k->baseX, k->baseY) : 170))
+    {
+        if(!k->baseKnown)
+        {
+            random_move(c, self);
+            return;
+        }
+
+        aiwar_state(c, self, 2); /* DARK */
+        aiwar_rotate_to(c, self, k->baseX, k->baseY);
+        aiwar_move(c, self);
+        if(base && aiwar_distance(self, base) <= CFG->MININGSHIP_MINING_RADIUS)
+            aiwar_push_mineral(c, self, base, self->extra);
+        return;
+    }
+
+    /* visible mineral */
+    if(mineral)
+    {
+        k->mineralKnown = 1;
+        k->mineralX = mineral->x;
+        k->mineralY = mineral->y;
+
+        aiwar_state(c, self, 0); /* DEFAULT */
+        aiwar_rotate_to(c, self, mineral->x, mineral->y);
+        aiwar_move(c, self);
+        if(aiwar_distance(self, mineral) <= CFG->MININGSHIP_MINING_RADIUS - 1)
+        {
+            aiwar_state(c, self, 1); /* LIGHT */
+            aiwar_extract(c, self, mineral);
+        }
+        return;
+    }
+
+    /* known mineral */
+    if(k->mineralKnown)
+    {
+        if(aiwar_distance_to(self, k->mineralX, k->mineralY) < CFG->MININGSHIP_DETECTION_RADIUS)
+            k->mineralKnown = 0; /* it should be seen: it is empty */
+        else
+        {
+            aiwar_state(c, self, 0);
+            aiwar_rotate_to(c, self, k->mineralX, k->mineralY);
+            aiwar_move(c, self);
+            return;
+        }
+    }
+
+    aiwar_state(c, self, 0);
+    random_move(c, self);
+}
+
+static void play_fighter(AiwarClient *c, uint32_t u)
+{
+    const AiwarItem *self = &c->items[u];
+    uint32_t i;
+
+    /* shoot the first enemy seen */
+    for(i = 0 ; i < c->units[u].count && self->extra > 0 ; ++i)
+    {
+        const AiwarItem *n = aiwar_neighbour(c, u, i);
+        if(n->team != AIWAR_NO_TEAM && n->team != self->team)
+        {
+            aiwar_launch_missile(c, self, n);
+            break;
+        }
+    }
+
+    random_move(c, self);
+}
+
+int main(void)
+{
+    AiwarClient c;
+    Knowledge k = { 0, 0.0, 0.0, 0, 0.0, 0.0 };
+    uint32_t u;
+    int r;
+
+    if(aiwar_init(&c) != 0)
+        return 1;
+    srand(c.hello.seed + c.hello.team);
+
+    while((r = aiwar_next_frame(&c)) == 1)
+    {
+        for(u = 0 ; u < c.frame.unitCount ; ++u)
+        {
+            switch(c.items[u].kind)
+            {
+            case AIWAR_BASE:
+                play_base(&c, u, &k);
+                break;
+            case AIWAR_MININGSHIP:
+                play_miningship(&c, u, &k);
+                break;
+            case AIWAR_FIGHTER:
+                play_fighter(&c, u);
+                break;
+            }
+        }
+
+        if(aiwar_send(&c) != 0)
+        {
+            r = -1;
+            break;
+        }
+    }
+
+    aiwar_free(&c);
+    return r < 0 ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Example of an AI compiled as a shared object, the play of handler_example.cpp.
+ *
+ * Build: make native
+ * config.xml:
+ *     <player>
+ *       <name>Example-Native</name>
+ *       <handler>native</handler>
+ *       <params>client/example_native.so</params>
+ *     </player>
+ *
+ * With the params "client/example_native.so intents", the units are played in
+ * intent mode (see aiwar_native.h).
+ */
+
+#include "aiwar_native.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdlib.h> // for rand_r
+
+using aiwar::native::Item;
+
+static void random_move(Item &self);
+static int draw(Item &self);
+
+// set by aiwar_init()
+static int mode = AIWAR_MODE_IMMEDIATE;
+
+static void playBase(Item &self)
+{
+    Item::ItemVector::iterator it;
+    std::ostringstream oss;
+
+    const AiwarConfig &CFG = self.config();
+
+    self.log("*********BASE**********");
+    oss << "Vie: " << self.life();
+    self.log(oss.str()); oss.str("");
+    oss << "MineralStorage: " << self.mineralStorage();
+    self.log(oss.str()); oss.str("");
+
+    Item::ItemVector n;
+    self.neighbours(n, 1u << AIWAR_MININGSHIP, 1u << self.team());
+
+    // refuel friend ships
+    for (it = n.begin() ; it != n.end() ; ++it)
+    {
+        if (it->isMiningShip() && self.isFriend(*it) && self.distanceTo(*it) <= CFG.BASE_REFUEL_RADIUS)
+        {
+            oss << "mon ami a encore " << self.fuel(*it) << " fuel";
+            self.log(oss.str()); oss.str("");
+            self.log("je fais le plein de mon ami");
+            self.refuel(static_cast<unsigned int>(CFG.MININGSHIP_START_FUEL), *it);
+        }
+    }
+
+    // create new MiningShip
+    if (self.mineralStorage() > CFG.BASE_MININGSHIP_PRICE && (draw(self) % 20) == 1)
+    {
+        self.log("Je cree un MiningShip");
+        self.createMiningShip();
+    }
+
+    // communiquer avec les copains
+    for (it = n.begin() ; it != n.end() ; ++it)
+    {
+        if (it->isMiningShip() && self.isFriend(*it) && self.distanceTo(*it) <= CFG.COMMUNICATION_RADIUS)
+        {
+            // si on connait la position du mineral
+            float posMineralSelf_x = self.getMemory<float>(2);
+            float posMineralSelf_y = self.getMemory<float>(3);
+            if (posMineralSelf_x != 0.0 || posMineralSelf_y != 0.0)
+            {
+                // envoi de la position du mineral s'il ne la connait pas
+                float posMineralCopain_x = self.getMemory<float>(2, *it);
+                float posMineralCopain_y = self.getMemory<float>(3, *it);
+                if (posMineralCopain_x == 0.0 && posMineralCopain_y == 0.0)
+                {
+                    self.setMemory<float>(2, posMineralSelf_x, *it);
+                    self.setMemory<float>(3, posMineralSelf_y, *it);
+                    self.log("J'ai donne la position de mon minerais a mon copain");
+                }
+            }
+        }
+    }
+}
+
+static void playMiningShip(Item &self)
+{
+    Item::ItemVector::iterator it;
+    std::ostringstream oss;
+
+    const AiwarConfig &CFG = self.config();
+
+    self.log("*******MININGSHIP******");
+    oss << "Vie: " << self.life();
+    self.log(oss.str()); oss.str("");
+    oss << "MineralStorage: " << self.mineralStorage();
+    self.log(oss.str()); oss.str("");
+    oss << "Fuel: " << self.fuel();
+    self.log(oss.str()); oss.str("");
+
+    Item::ItemVector n;
+    self.neighbours(n);
+
+    // recherche de la base amie
+    bool baseConnue = false;
+    float basePos_x = self.getMemory<float>(0);
+    float basePos_y = self.getMemory<float>(1);
+    if (basePos_x != 0.0 || basePos_y != 0.0)
+    {
+        self.log("je connais ma base");
+        baseConnue = true;
+    }
+    else
+    {
+        for (it = n.begin() ; it != n.end() ; ++it)
+        {
+            if (it->isBase() && self.isFriend(*it))
+            {
+                self.log("base trouvee");
+                basePos_x = it->xpos();
+                basePos_y = it->ypos();
+                self.setMemory<float>(0, basePos_x);
+                self.setMemory<float>(1, basePos_y);
+                baseConnue = true;
+                break;
+            }
+        }
+    }
+
+    // communiquer avec les copains
+    for (it = n.begin() ; it != n.end() ; ++it)
+    {
+        if ((it->isBase() || it->isMiningShip()) && self.isFriend(*it) && self.distanceTo(*it) <= CFG.COMMUNICATION_RADIUS)
+        {
+            // si on connait la position du mineral
+            float posMineralSelf_x = self.getMemory<float>(2);
+            float posMineralSelf_y = self.getMemory<float>(3);
+            if (posMineralSelf_x != 0.0 || posMineralSelf_y != 0.0)
+            {
+                // envoi de la position du mineral s'il ne la connait pas
+                float posMineralCopain_x = self.getMemory<float>(2, *it);
+                float posMineralCopain_y = self.getMemory<float>(3, *it);
+                if (posMineralCopain_x == 0.0 && posMineralCopain_y == 0.0)
+                {
+                    self.setMemory<float>(2, posMineralSelf_x, *it);
+                    self.setMemory<float>(3, posMineralSelf_y, *it);
+                    self.log("J'ai donne la position de mon minerais a mon copain");
+                }
+            }
+        }
+    }
+
+    // rentrer a la base ?
+    if (self.mineralStorage() == CFG.MININGSHIP_MAX_MINERAL_STORAGE || self.fuel() < (baseConnue ? self.distanceTo(basePos_x, basePos_y) : 170))
+    {
+        if (baseConnue)
+        {
+            self.log("je rentre a la base");
+            self.state(2); // DARK
+            self.rotateTo(basePos_x, basePos_y);
+            self.move();
+            // base en vue et assez proche pour donner le minerai ?
+            for (it = n.begin() ; it != n.end() ; ++it)
+            {
+                if (it->isBase() && self.isFriend(*it))
+                {
+                    if (self.distanceTo(*it) <= CFG.MININGSHIP_MINING_RADIUS)
+                    {
+                        self.log("je donne mon minerai a ma base");
+                        self.pushMineral(*it, self.mineralStorage());
+                    }
+                    break;
+                }
+            }
+            return;
+        }
+        else
+        {
+            self.log("je cherche ma base");
+            random_move(self);
+            return;
+        }
+    }
+
+    // recherche de minerais visible
+    for (it = n.begin() ; it != n.end() ; ++it)
+    {
+        if (it->isMineral())
+        {
+            self.log("je sauvegarde la position du minerai");
+            float mpx = it->xpos();
+            float mpy = it->ypos();
+            self.setMemory<float>(2, mpx);
+            self.setMemory<float>(3, mpy);
+            self.log("je vais au minerais visible");
+            self.state(0); // DEFAULT
+            self.rotateTo(*it);
+            self.move();
+            if (self.distanceTo(*it) <= CFG.MININGSHIP_MINING_RADIUS-1)
+            {
+                self.log("je mine");
+                self.state(1); // LIGHT
+                self.extract(*it);
+            }
+            return;
+        }
+    }
+
+    // recherche de minerai connu
+    float minPos_x = self.getMemory<float>(2);
+    float minPos_y = self.getMemory<float>(3);
+    if (minPos_x != 0.0 || minPos_y != 0.0)
+    {
+        self.log("je connais un minerai");
+        if (self.distanceTo(minPos_x, minPos_y) < CFG.MININGSHIP_DETECTION_RADIUS) // on aurait du voir le minerai -> il est vide
+        {
+            // reset de la position
+            self.setMemory<float>(2, 0.0);
+            self.setMemory<float>(3, 0.0);
+        }
+        else
+        {
+            self.log("je vais au minerais connus");
+            self.state(0);
+            self.rotateTo(minPos_x, minPos_y);
+            self.move();
+            return;
+        }
+    }
+
+    // deplacement aleatoire
+    self.log("je cherche du minerais");
+    self.state(0);
+    random_move(self);
+}
+
+static void playFighter(Item &)
+{
+}
+
+// helpers
+static int draw(Item &self)
+{
+    if (mode == AIWAR_MODE_IMMEDIATE)
+        return std::rand();
+
+    // the threads play the units in any order: the draw only depends on the unit and its position
+    unsigned int seed = static_cast<unsigned int>(self.key()) * 2654435761u
+        ^ static_cast<unsigned int>(self.xpos() * 16.0) ^ (static_cast<unsigned int>(self.ypos() * 16.0) << 16);
+    return rand_r(&seed);
+}
+
+static void random_move(Item &self)
+{
+    int a = (draw(self) % 91) - 45;
+    self.rotateOf(a);
+    self.move();
+}
+
+AIWAR_NATIVE_PLAYER(playBase, playMiningShip, playFighter)
+
+extern "C" int aiwar_init(const AiwarApi *api, const char *params)
+{
+    if(api->version != AIWAR_NATIVE_VERSION || api->size < sizeof(AiwarApi))
+    {
+        std::fprintf(stderr, "example_native: unknown version of the game\n");
+        return -1;
+    }
+    if(std::strcmp(params, "intents") == 0)
+        mode = AIWAR_MODE_INTENTS;
+    return 0;
+}
+
+extern "C" int aiwar_mode(void)
+{
+    return mode;
+}
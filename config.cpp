@@ -138,6 +138,12 @@ Config& Config::instance()
 
 Config::Config()
     : help(false),
+      neighbourCache(false),
+      isolateTeams(false),
+      threads(0),
+      perfCounters(false),
+      tickBudget(0.0),
+      matchBudget(0.0),
       seed(0),
       blue(0),
       red(0),
@@ -158,6 +164,13 @@ std::string Config::usage() const
         << "\t--help\t\t\tPrint this message\n"
         << "\t--debug\t\t\tRun in debug mode\n"
         << "\t--manual\t\tDo not automatically play\n"
+        << "\t--cache\t\t\tCache neighbours of items during a round\n"
+        << "\t--isolate\t\tRun each python team in its own interpreter, the process and native teams think at the same time (python ones too with client/aiwar_client.py)\n"
+        << "\t--threads number\tThreads playing the units of a native player in intent mode [one per processor]\n"
+        << "\t--profile output\tTime the phases of the ticks, write output.json and output.folded at the end\n"
+        << "\t--perf-counters\t\tCount the cycles, instructions and misses of the phases of the ticks (Linux)\n"
+        << "\t--tick-budget ms\tCPU time a team can think during a round, it forfeits beyond [no limit]\n"
+        << "\t--match-budget s\tCPU time a team can think during the game, it forfeits beyond [no limit]\n"
         << "\t--file config_file\tConfiguration file [config.xml]\n"
         << "\t--map map_file\t\tMap file [map.xml]\n"
         << "\t--blue player_name\tBlue player name\n"
@@ -170,6 +183,8 @@ std::string Config::usage() const
         << "\t 2  -> Red team won\n"
         << "\t 11 -> Blue team lost because of an error in his script\n"
         << "\t 12 -> Red team lost because of an error in his script\n"
+        << "\t 21 -> Blue team forfeited, over its think time budget\n"
+        << "\t 22 -> Red team forfeited, over its think time budget\n"
         << "\t-1  -> A fatal error occured in the game\n";
 
     return oss.str();
@@ -200,6 +215,12 @@ bool Config::parseCmdLine(int argc, char* argv[])
             _cl_debug = true;
         else if(arg == "manual")
             _cl_manual = true;
+        else if(arg == "cache")
+            neighbourCache = true;
+        else if(arg == "isolate")
+            isolateTeams = true;
+        else if(arg == "perf-counters")
+            perfCounters = true;
         else if(arg == "file")
         {
             if(i == argc-1)
@@ -230,6 +251,45 @@ bool Config::parseCmdLine(int argc, char* argv[])
                 return false;
             _cl_renderer = argv[++i];
         }
+        else if(arg == "profile")
+        {
+            if(i == argc-1)
+                return false;
+            profile = argv[++i];
+        }
+        else if(arg == "tick-budget")
+        {
+            if(i == argc-1)
+                return false;
+            try {
+                tickBudget = convert<double>(argv[++i]) / 1000.0;
+            } catch(const ParseError &e) {
+                std::cerr << "Bad tick-budget value, using no limit\n";
+                tickBudget = 0.0;
+            }
+        }
+        else if(arg == "match-budget")
+        {
+            if(i == argc-1)
+                return false;
+            try {
+                matchBudget = convert<double>(argv[++i]);
+            } catch(const ParseError &e) {
+                std::cerr << "Bad match-budget value, using no limit\n";
+                matchBudget = 0.0;
+            }
+        }
+        else if(arg == "threads")
+        {
+            if(i == argc-1)
+                return false;
+            try {
+                threads = convert<unsigned int>(argv[++i]);
+            } catch(const ParseError &e) {
+                std::cerr << "Bad threads value, using default\n";
+                threads = 0;
+            }
+        }
         else if(arg == "seed")
         {
             if(i == argc-1)
@@ -475,6 +535,13 @@ std::string Config::dump() const
         << "\thelp: " << help << "\n"
         << "\tdebug: " << debug << "\n"
         << "\tmanual: " << manual << "\n"
+        << "\tneighbour cache: " << neighbourCache << "\n"
+        << "\tisolate teams: " << isolateTeams << "\n"
+        << "\tthreads: " << threads << "\n"
+        << "\tprofile: " << profile << "\n"
+        << "\tperf counters: " << perfCounters << "\n"
+        << "\ttick budget: " << tickBudget << "\n"
+        << "\tmatch budget: " << matchBudget << "\n"
         << "\tseed: " << seed << "\n"
         << "\tconfig file: " << _configFile << "\n"
         << "\tmap file: " << mapFile << "\n"
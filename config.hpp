@@ -57,6 +57,13 @@ namespace aiwar {
             bool help;
             bool debug;
             bool manual;
+            bool neighbourCache;
+            bool isolateTeams; ///< one python interpreter per team, and the process and native teams think at the same time
+            unsigned int threads; ///< threads of the native players in intent mode, 0 for one per processor
+            std::string profile; ///< files written by the profiler without their extension, empty if disabled
+            bool perfCounters; ///< read the hardware performance counters around the phases of the ticks
+            double tickBudget; ///< CPU time a team can think during a round, in seconds, 0 for no limit
+            double matchBudget; ///< CPU time a team can think during the game, in seconds, 0 for no limit
             std::string mapFile;
             unsigned int seed;
 
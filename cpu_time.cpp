@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpu_time.hpp"
+
+#include <ctime>
+
+#ifndef _WIN32
+#       include <sys/types.h>
+#       include <time.h>
+#endif
+
+double aiwar::core::threadCpuTime()
+{
+#ifndef _WIN32
+    timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+double aiwar::core::processCpuTime(long pid)
+{
+#ifndef _WIN32
+    clockid_t clock;
+    timespec ts;
+    if(clock_getcpuclockid(static_cast<pid_t>(pid), &clock) != 0 || clock_gettime(clock, &ts) != 0)
+        return -1.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    (void)pid;
+    return -1.0;
+#endif
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CPU_TIME_HPP
+#define CPU_TIME_HPP
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief CPU time used by the calling thread, in seconds
+         *
+         * Without thread clocks (Windows), the CPU time of the whole process.
+         */
+        double threadCpuTime();
+
+        /**
+         * \brief CPU time used by a child process, in seconds
+         * \return -1 if unknown, for example when the process has exited
+         */
+        double processCpuTime(long pid);
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* CPU_TIME_HPP */
@@ -32,6 +32,7 @@ Fighter::Fighter(GameManager &gm, Key k, double px, double py, Team team, PlayFu
       _missiles(Config::instance().FIGHTER_START_MISSILE),
       _hasLaunch(false)
 {
+    _tag |= FIGHTER_KIND;
     _sm.missileCreated(team, _missiles);
 }
 
@@ -39,6 +40,28 @@ Fighter::~Fighter()
 {
 }
 
+Fighter* Fighter::_asFighter()
+{
+    return this;
+}
+
+ItemPool<Fighter> Fighter::_pool;
+
+void* Fighter::operator new(std::size_t size)
+{
+    return _pool.allocate(size);
+}
+
+void Fighter::operator delete(void *p, std::size_t size)
+{
+    _pool.release(p, size);
+}
+
+const ItemPool<Fighter>& Fighter::pool()
+{
+    return _pool;
+}
+
 void Fighter::_preUpdate(unsigned int ticks)
 {
     Movable::_preUpdate(ticks);
@@ -47,6 +70,11 @@ void Fighter::_preUpdate(unsigned int ticks)
     _hasLaunch = false;
 }
 
+void Fighter::_startRound(unsigned int tick)
+{
+    _preUpdate(tick);
+}
+
 void Fighter::update(unsigned int tick)
 {
     _preUpdate(tick);
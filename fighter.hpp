@@ -25,6 +25,7 @@
 #include "living.hpp"
 #include "playable.hpp"
 #include "memory.hpp"
+#include "item_pool.hpp"
 
 namespace aiwar {
     namespace core {
@@ -35,7 +36,18 @@ namespace aiwar {
             Fighter(GameManager &gm, Key k, double px, double py, Team team, PlayFunction& pf);
             ~Fighter();
 
+            Fighter* _asFighter();
+
+            static void* operator new(std::size_t size);
+            static void operator delete(void *p, std::size_t size);
+
+            /**
+             * \brief Storage of all the fighters, for statistics
+             */
+            static const ItemPool<Fighter>& pool();
+
             void update(unsigned int tick);
+            void _startRound(unsigned int tick);
 
             unsigned int missiles() const;
             void launchMissile(Living* target);
@@ -49,6 +61,8 @@ namespace aiwar {
 
             unsigned int _missiles;
             bool _hasLaunch;
+
+            static ItemPool<Fighter> _pool;
         };
 
     } // namespace core
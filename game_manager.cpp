@@ -26,6 +26,7 @@
 #include "mineral.hpp"
 #include "item_manager.hpp"
 #include "stat_manager.hpp"
+#include "profiler.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -83,12 +84,14 @@ void GameManager::update(unsigned int ticks)
 {
     _sm->nextRound();
     _im->update(ticks);
+
+    ProfileScope s(Profiler::ACTIVITY);
     _sm->checkActivity();
 }
 
-void GameManager::registerTeam(Team team, PlayFunction& pfBase, PlayFunction& pfMiningShip, PlayFunction& pfFighter)
+void GameManager::registerTeam(Team team, PlayFunction& pfBase, PlayFunction& pfMiningShip, PlayFunction& pfFighter, TeamPlayFunction *pfTeam)
 {
-    TeamInfo t(pfBase, pfMiningShip, pfFighter);
+    TeamInfo t(pfBase, pfMiningShip, pfFighter, pfTeam);
     _teamMap.insert(std::pair<Team, TeamInfo>(team, t));
 }
 
@@ -107,6 +110,15 @@ PlayFunction& GameManager::getFighterPF(Team team) const
     return _getTeamInfo(team).play_fighter;
 }
 
+TeamPlayFunction* GameManager::getTeamPF(Team team) const
+{
+    TeamMap::const_iterator it = _teamMap.find(team);
+    if(it != _teamMap.end())
+        return it->second.play_team;
+    else
+        return NULL;
+}
+
 bool GameManager::gameOver() const
 {
     int nbLivingTeam = 0;
@@ -152,7 +164,7 @@ const GameManager::TeamInfo& GameManager::_getTeamInfo(Team team) const
 }
 
 
-GameManager::TeamInfo::TeamInfo(PlayFunction& pfb, PlayFunction& pfm, PlayFunction& pff)
-    : play_base(pfb), play_miningShip(pfm), play_fighter(pff)
+GameManager::TeamInfo::TeamInfo(PlayFunction& pfb, PlayFunction& pfm, PlayFunction& pff, TeamPlayFunction *pft)
+    : play_base(pfb), play_miningShip(pfm), play_fighter(pff), play_team(pft)
 {
 }
@@ -44,7 +44,12 @@ namespace aiwar {
             GameManager();
             ~GameManager();
 
-            void registerTeam(Team team, PlayFunction& pfBase, PlayFunction& pfMiningShip, PlayFunction& pfFighter);
+            /**
+             * \brief Register the play functions of a team
+             * \param pfTeam If not NULL, all the units of the team are played at once by this function
+             *               and the other play functions are not used
+             */
+            void registerTeam(Team team, PlayFunction& pfBase, PlayFunction& pfMiningShip, PlayFunction& pfFighter, TeamPlayFunction *pfTeam = NULL);
 
             bool init();
 
@@ -58,6 +63,11 @@ namespace aiwar {
             PlayFunction& getMiningShipPF(Team team) const;
             PlayFunction& getFighterPF(Team team) const;
 
+            /**
+             * \brief Get the TeamPlayFunction of a team, NULL if its units are played one by one or if it is not registered
+             */
+            TeamPlayFunction* getTeamPF(Team team) const;
+
             void update(unsigned int ticks);
 
             bool gameOver() const;
@@ -79,11 +89,12 @@ namespace aiwar {
         class GameManager::TeamInfo
         {
         public:
-            TeamInfo(PlayFunction& pfb = Playable::playNoOp, PlayFunction& pfm = Playable::playNoOp, PlayFunction& pff = Playable::playNoOp);
+            TeamInfo(PlayFunction& pfb = Playable::playNoOp, PlayFunction& pfm = Playable::playNoOp, PlayFunction& pff = Playable::playNoOp, TeamPlayFunction *pft = NULL);
 
             PlayFunction& play_base;
             PlayFunction& play_miningShip;
             PlayFunction& play_fighter;
+            TeamPlayFunction *play_team;
         };
 
     } // aiwar::core
@@ -70,10 +70,10 @@ HandlerExample::PF& HandlerExample::get_FighterHandler(P)
 
 // implementations of play functions
 
-void HandlerExample::play_base(aiwar::core::Playable* base)
+void HandlerExample::play_base(aiwar::core::Playable* base, aiwar::core::Item::ItemVector &n)
 {
     using namespace aiwar::core;
-    Item::ItemList::iterator it;
+    Item::ItemVector::iterator it;
     std::ostringstream oss;
 
     const Config& CFG = Config::instance();
@@ -87,7 +87,7 @@ void HandlerExample::play_base(aiwar::core::Playable* base)
     oss << "MineralStorage: " << self->mineralStorage();
     self->log(oss.str()); oss.str("");
 
-    Item::ItemList n = self->neighbours();
+    self->neighbours(n, NeighbourFilter().kind(MININGSHIP_KIND).team(self->team()));
 
     // refuel friend ships
     for (it = n.begin() ; it != n.end() ; ++it)
@@ -134,10 +134,10 @@ void HandlerExample::play_base(aiwar::core::Playable* base)
     }
 }
 
-void HandlerExample::play_miningship(aiwar::core::Playable* miningship)
+void HandlerExample::play_miningship(aiwar::core::Playable* miningship, aiwar::core::Item::ItemVector &n)
 {
     using namespace aiwar::core;
-    Item::ItemList::iterator it;
+    Item::ItemVector::iterator it;
     std::ostringstream oss;
 
     const Config& CFG = Config::instance();
@@ -153,8 +153,8 @@ void HandlerExample::play_miningship(aiwar::core::Playable* miningship)
     oss << "Fuel: " << self->Movable::fuel();
     self->log(oss.str()); oss.str("");
 
-    Item::ItemList n = self->neighbours();
-    
+    self->neighbours(n);
+
     // recherche de la base amie
     bool baseConnue = false;
     float basePos_x = self->getMemory<float>(0);
@@ -297,7 +297,7 @@ void HandlerExample::play_miningship(aiwar::core::Playable* miningship)
     random_move(self);
 }
 
-void HandlerExample::play_fighter(aiwar::core::Playable*)
+void HandlerExample::play_fighter(aiwar::core::Playable*, aiwar::core::Item::ItemVector&)
 {
 }
 
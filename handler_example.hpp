@@ -21,6 +21,7 @@
 #define HANDLER_EXAMPLE_HPP
 
 #include "handler_interface.hpp"
+#include "item.hpp" // for Item::ItemVector
 
 class HandlerExample : public aiwar::core::HandlerInterface
 {
@@ -41,13 +42,29 @@ public:
     PF& get_FighterHandler(P player);
 
 private:
-    aiwar::core::DefaultPlayFunction _pf_Base;
-    aiwar::core::DefaultPlayFunction _pf_MiningShip;
-    aiwar::core::DefaultPlayFunction _pf_Fighter;
+    /**
+     * \brief Play function with its own neighbour buffer, reused from one call to the next
+     */
+    class BufferedPlayFunction : public aiwar::core::PlayFunction
+    {
+    public:
+        typedef void (*Fun)(aiwar::core::Playable*, aiwar::core::Item::ItemVector&);
 
-    static void play_miningship(aiwar::core::Playable*);
-    static void play_base(aiwar::core::Playable*);
-    static void play_fighter(aiwar::core::Playable*);
+        explicit BufferedPlayFunction(Fun f) : _fun(f) {}
+        void operator()(aiwar::core::Playable* p) { _fun(p, _neighbours); }
+
+    private:
+        Fun _fun;
+        aiwar::core::Item::ItemVector _neighbours;
+    };
+
+    BufferedPlayFunction _pf_Base;
+    BufferedPlayFunction _pf_MiningShip;
+    BufferedPlayFunction _pf_Fighter;
+
+    static void play_miningship(aiwar::core::Playable*, aiwar::core::Item::ItemVector &n);
+    static void play_base(aiwar::core::Playable*, aiwar::core::Item::ItemVector &n);
+    static void play_fighter(aiwar::core::Playable*, aiwar::core::Item::ItemVector &n);
 };
 
 
@@ -43,6 +43,12 @@ namespace aiwar {
             virtual PlayFunction& get_BaseHandler(Config::Player player) = 0;
             virtual PlayFunction& get_MiningShipHandler(Config::Player player) = 0;
             virtual PlayFunction& get_FighterHandler(Config::Player player) = 0;
+
+            /**
+             * \brief Get the function playing all the units of a team at once
+             * \return NULL if the player only has the unit functions
+             */
+            virtual TeamPlayFunction* get_TeamHandler(Config::Player) { return NULL; }
         };
 
         class HandlerError : public std::runtime_error
@@ -55,6 +61,15 @@ namespace aiwar {
             Team _team;
         };
 
+        /**
+         * \brief A team has used more than its think time budget (Config::tickBudget, Config::matchBudget): it forfeits
+         */
+        class BudgetError : public HandlerError
+        {
+        public:
+            BudgetError(Team team, const std::string &what) : HandlerError(team, what) {}
+        };
+
     } // aiwar::core
 } // aiwar
 
@@ -0,0 +1,1180 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "handler_native.hpp"
+#include "handler_process.hpp" // for HandlerProcess::fillConfig
+
+#include "base.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "mineral.hpp"
+#include "cpu_time.hpp"
+#include "think_watchdog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+using namespace aiwar::core;
+
+/**
+ * \brief State of a call of a play function
+ */
+class NativeCall
+{
+public:
+    /**
+     * \brief An action recorded in intent mode
+     */
+    class Intent
+    {
+    public:
+        enum Op
+        {
+            ROTATE_OF,
+            ROTATE_TO,
+            MOVE,
+            MOVE_TOWARDS,
+            KEEP_DISTANCE,
+            STATE,
+            SET_MEMORY_INT,
+            SET_MEMORY_UINT,
+            SET_MEMORY_FLOAT,
+            EXTRACT,
+            PUSH_MINERAL,
+            PULL_MINERAL,
+            LAUNCH_MISSILE,
+            CREATE_MININGSHIP,
+            CREATE_FIGHTER,
+            REPAIR,
+            REFUEL,
+            GIVE_MISSILES
+        };
+
+        Intent(Op o) : op(o), other(NULL), x(0.0), y(0.0), r(0.0), index(0), value(0), ivalue(0), fvalue(0.0f) {}
+
+        Op op;
+        AiwarNativeItem *other; ///< target of the action
+        double x;
+        double y;
+        double r; ///< radius of move_towards() and keep_distance()
+        uint32_t index; ///< memory index
+        uint32_t value; ///< points, state or unsigned memory value
+        int32_t ivalue;
+        float fvalue;
+    };
+
+    NativeCall() : unit(NULL), self(NULL), play(NULL), time(0.0), cpu(0.0) {}
+
+    Playable *unit; ///< unit played in intent mode, NULL for the calls in immediate mode
+    AiwarNativeItem *self; ///< the same unit, as given to the play function
+    NativePlayFunction *play;
+    std::string error; ///< first error of the call, the team loses at its end
+    Item::ItemVector neighbours; ///< result of the last query, or in intent mode all the neighbours at the start of the round
+    std::vector<Intent> intents;
+    double time; ///< seconds, in intent mode
+    double cpu; ///< CPU time in seconds, in intent mode if the call was not run by the thread calling think()
+};
+
+/*** the functions of AiwarApi ***/
+
+namespace {
+
+AiwarConfig config;
+AiwarApi api;
+AiwarApi intentApi; ///< api, with the functions of the intent mode
+
+// calls in immediate mode, units are played one at a time
+NativeCall immediateCall;
+
+#ifndef _WIN32
+pthread_key_t callKey; // NativeCall of the unit played by a thread in intent mode
+bool callKeyCreated = false;
+#endif
+
+NativeCall& current()
+{
+#ifndef _WIN32
+    if(callKeyCreated)
+    {
+        if(NativeCall *c = static_cast<NativeCall*>(pthread_getspecific(callKey)))
+            return *c;
+    }
+#endif
+    return immediateCall;
+}
+
+void setCurrent(NativeCall *c)
+{
+#ifndef _WIN32
+    if(callKeyCreated)
+        pthread_setspecific(callKey, c);
+#else
+    (void)c;
+#endif
+}
+
+void fail(const char *what)
+{
+    NativeCall &c = current();
+    if(c.error.empty())
+        c.error = what;
+}
+
+inline Item* toItem(const AiwarNativeItem *item)
+{
+    return reinterpret_cast<Item*>(const_cast<AiwarNativeItem*>(item));
+}
+
+inline AiwarNativeItem* toNative(Item *item)
+{
+    return reinterpret_cast<AiwarNativeItem*>(item);
+}
+
+Item* checked(const AiwarNativeItem *item, const char *what)
+{
+    if(!item)
+        fail(what);
+    return toItem(item);
+}
+
+template<class T> T* as(const AiwarNativeItem *item, const char *what)
+{
+    T *t = item_cast<T>(toItem(item));
+    if(!t)
+        fail(what);
+    return t;
+}
+
+uint64_t api_key(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "key: no item");
+    return i ? i->_getKey() : 0;
+}
+
+uint32_t api_kind(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "kind: no item");
+    return i ? i->_kind() : NO_KIND;
+}
+
+uint32_t api_team(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "team: no item");
+    return i ? i->_tagTeam() : NO_TEAM;
+}
+
+double api_xpos(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "xpos: no item");
+    return i ? i->xpos() : 0.0;
+}
+
+double api_ypos(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "ypos: no item");
+    return i ? i->ypos() : 0.0;
+}
+
+double api_distance(const AiwarNativeItem *item, const AiwarNativeItem *other)
+{
+    Item *i = checked(item, "distance: no item");
+    Item *o = checked(other, "distance: no item");
+    return (i && o) ? i->distanceTo(o) : 0.0;
+}
+
+double api_distance_to(const AiwarNativeItem *item, double x, double y)
+{
+    Item *i = checked(item, "distance_to: no item");
+    return i ? i->distanceTo(x, y) : 0.0;
+}
+
+uint32_t api_life(const AiwarNativeItem *item)
+{
+    Item *i = checked(item, "life: no item");
+    Living *l = item_cast<Living>(i);
+    return l ? l->life() : 0;
+}
+
+size_t api_neighbours(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, AiwarNativeItem **res, size_t max)
+{
+    Item *i = checked(self, "neighbours: no item");
+    if(!i)
+        return 0;
+
+    Item::ItemVector &found = current().neighbours;
+    i->neighbours(found, NeighbourFilter(kinds, teams));
+    std::size_t n;
+    for(n = 0 ; n < found.size() && n < max ; ++n)
+        res[n] = toNative(found[n]);
+    return found.size();
+}
+
+AiwarNativeItem* api_nearest(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, double maxRadius)
+{
+    Item *i = checked(self, "nearest: no item");
+    return i ? toNative(i->nearest(NeighbourFilter(kinds, teams), maxRadius)) : NULL;
+}
+
+int api_is_friend(const AiwarNativeItem *self, const AiwarNativeItem *other)
+{
+    Playable *p = as<Playable>(self, "is_friend: not a unit");
+    Playable *o = item_cast<Playable>(toItem(other));
+    return (p && o && p->isFriend(o)) ? 1 : 0;
+}
+
+void api_log(AiwarNativeItem *self, const char *msg)
+{
+    Playable *p = as<Playable>(self, "log: not a unit");
+    if(p && msg)
+        p->log(msg);
+}
+
+void api_state(AiwarNativeItem *self, uint32_t state)
+{
+    Playable *p = as<Playable>(self, "state: not a unit");
+    if(!p)
+        return;
+    if(state > DARK)
+    {
+        fail("state: unknown state");
+        return;
+    }
+    p->state(static_cast<State>(state));
+}
+
+uint32_t api_memory_size(const AiwarNativeItem *self)
+{
+    Memory *m = as<Memory>(self, "memory_size: no memory");
+    return m ? m->memorySize() : 0;
+}
+
+template<class T> T getMemory(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other)
+{
+    Memory *m = as<Memory>(self, "get_memory: no memory");
+    if(!m)
+        return T();
+    if(!other)
+        return m->getMemory<T>(index);
+    Memory *o = as<Memory>(other, "get_memory: the other item has no memory");
+    return o ? m->getMemory<T>(index, o) : T();
+}
+
+template<class T> void setMemory(AiwarNativeItem *self, uint32_t index, T value, AiwarNativeItem *other)
+{
+    Memory *m = as<Memory>(self, "set_memory: no memory");
+    if(!m)
+        return;
+    if(!other)
+        m->setMemory<T>(index, value);
+    else
+    {
+        Memory *o = as<Memory>(other, "set_memory: the other item has no memory");
+        if(o)
+            m->setMemory<T>(index, value, o);
+    }
+}
+
+int32_t api_get_memory_int(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other)
+{
+    return getMemory<int>(self, index, other);
+}
+
+uint32_t api_get_memory_uint(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other)
+{
+    return getMemory<unsigned int>(self, index, other);
+}
+
+float api_get_memory_float(const AiwarNativeItem *self, uint32_t index, const AiwarNativeItem *other)
+{
+    return getMemory<float>(self, index, other);
+}
+
+void api_set_memory_int(AiwarNativeItem *self, uint32_t index, int32_t value, AiwarNativeItem *other)
+{
+    setMemory<int>(self, index, value, other);
+}
+
+void api_set_memory_uint(AiwarNativeItem *self, uint32_t index, uint32_t value, AiwarNativeItem *other)
+{
+    setMemory<unsigned int>(self, index, value, other);
+}
+
+void api_set_memory_float(AiwarNativeItem *self, uint32_t index, float value, AiwarNativeItem *other)
+{
+    setMemory<float>(self, index, value, other);
+}
+
+double api_angle(const AiwarNativeItem *ship)
+{
+    Movable *m = as<Movable>(ship, "angle: not a ship");
+    return m ? m->angle() : 0.0;
+}
+
+uint32_t api_fuel(const AiwarNativeItem *ship)
+{
+    Movable *m = as<Movable>(ship, "fuel: not a ship");
+    return m ? m->fuel() : 0;
+}
+
+uint32_t api_friend_fuel(const AiwarNativeItem *self, const AiwarNativeItem *ship)
+{
+    Playable *p = as<Playable>(self, "friend_fuel: not a unit");
+    Movable *m = as<Movable>(ship, "friend_fuel: not a ship");
+    return (p && m) ? p->fuel(m) : 0;
+}
+
+void api_rotate_of(AiwarNativeItem *ship, double angle)
+{
+    Movable *m = as<Movable>(ship, "rotate_of: not a ship");
+    if(m)
+        m->rotateOf(angle);
+}
+
+void api_rotate_to(AiwarNativeItem *ship, double x, double y)
+{
+    Movable *m = as<Movable>(ship, "rotate_to: not a ship");
+    if(m)
+        m->rotateTo(x, y);
+}
+
+void api_move(AiwarNativeItem *ship)
+{
+    Movable *m = as<Movable>(ship, "move: not a ship");
+    if(m)
+        m->move();
+}
+
+int api_move_towards(AiwarNativeItem *ship, double x, double y, double stopRadius)
+{
+    Movable *m = as<Movable>(ship, "move_towards: not a ship");
+    return (m && m->moveTowards(x, y, stopRadius)) ? 1 : 0;
+}
+
+int api_keep_distance(AiwarNativeItem *ship, double x, double y, double radius)
+{
+    Movable *m = as<Movable>(ship, "keep_distance: not a ship");
+    return (m && m->keepDistance(x, y, radius)) ? 1 : 0;
+}
+
+uint32_t api_mineral_storage(const AiwarNativeItem *unit)
+{
+    Item *i = toItem(unit);
+    if(Base *b = item_cast<Base>(i))
+        return b->mineralStorage();
+    MiningShip *s = as<MiningShip>(unit, "mineral_storage: not a base nor a mining ship");
+    return s ? s->mineralStorage() : 0;
+}
+
+uint32_t api_extract(AiwarNativeItem *ship, AiwarNativeItem *mineral)
+{
+    MiningShip *s = as<MiningShip>(ship, "extract: not a mining ship");
+    Mineral *m = as<Mineral>(mineral, "extract: not a mineral");
+    return (s && m) ? s->extract(m) : 0;
+}
+
+uint32_t api_push_mineral(AiwarNativeItem *ship, AiwarNativeItem *base, uint32_t points)
+{
+    MiningShip *s = as<MiningShip>(ship, "push_mineral: not a mining ship");
+    Base *b = as<Base>(base, "push_mineral: not a base");
+    return (s && b) ? s->pushMineral(b, points) : 0;
+}
+
+uint32_t api_missiles(const AiwarNativeItem *fighter)
+{
+    Fighter *f = as<Fighter>(fighter, "missiles: not a fighter");
+    return f ? f->missiles() : 0;
+}
+
+void api_launch_missile(AiwarNativeItem *unit, AiwarNativeItem *target)
+{
+    Living *t = as<Living>(target, "launch_missile: the target is not living");
+    if(!t)
+        return;
+    if(Base *b = item_cast<Base>(toItem(unit)))
+        b->launchMissile(t);
+    else if(Fighter *f = as<Fighter>(unit, "launch_missile: not a base nor a fighter"))
+        f->launchMissile(t);
+}
+
+void api_create_miningship(AiwarNativeItem *base)
+{
+    Base *b = as<Base>(base, "create_miningship: not a base");
+    if(b)
+        b->createMiningShip();
+}
+
+void api_create_fighter(AiwarNativeItem *base)
+{
+    Base *b = as<Base>(base, "create_fighter: not a base");
+    if(b)
+        b->createFighter();
+}
+
+uint32_t api_pull_mineral(AiwarNativeItem *base, AiwarNativeItem *ship, uint32_t points)
+{
+    Base *b = as<Base>(base, "pull_mineral: not a base");
+    MiningShip *s = as<MiningShip>(ship, "pull_mineral: not a mining ship");
+    return (b && s) ? b->pullMineral(s, points) : 0;
+}
+
+uint32_t api_repair(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *target)
+{
+    Base *b = as<Base>(base, "repair: not a base");
+    if(!b)
+        return 0;
+    if(!target)
+        return b->repair(points);
+    Living *l = as<Living>(target, "repair: the target is not living");
+    return l ? b->repair(points, l) : 0;
+}
+
+uint32_t api_refuel(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *ship)
+{
+    Base *b = as<Base>(base, "refuel: not a base");
+    Movable *m = as<Movable>(ship, "refuel: not a ship");
+    return (b && m) ? b->refuel(points, m) : 0;
+}
+
+uint32_t api_give_missiles(AiwarNativeItem *base, uint32_t missiles, AiwarNativeItem *fighter)
+{
+    Base *b = as<Base>(base, "give_missiles: not a base");
+    Fighter *f = as<Fighter>(fighter, "give_missiles: not a fighter");
+    return (b && f) ? b->giveMissiles(missiles, f) : 0;
+}
+
+int api_over_budget(const AiwarNativeItem *self)
+{
+    Item *i = checked(self, "over_budget: no item");
+    return (i && ThinkWatchdog::expired(i->_tagTeam())) ? 1 : 0;
+}
+
+/*** the functions of the intent mode ***/
+
+// the unit played by the thread, an error if self is another item
+NativeCall* acting(const AiwarNativeItem *self, const char *what)
+{
+    NativeCall &c = current();
+    if(!self || self != c.self)
+    {
+        fail(what);
+        return NULL;
+    }
+    return &c;
+}
+
+// record an action of the unit played, NULL if self is another item
+NativeCall::Intent* record(const AiwarNativeItem *self, NativeCall::Intent::Op op, const char *what)
+{
+    NativeCall *c = acting(self, what);
+    if(!c)
+        return NULL;
+    c->intents.push_back(NativeCall::Intent(op));
+    return &c->intents.back();
+}
+
+size_t intent_neighbours(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, AiwarNativeItem **res, size_t max)
+{
+    NativeCall *c = acting(self, "neighbours: only the unit played can query its neighbours");
+    if(!c)
+        return 0;
+
+    NeighbourFilter filter(kinds, teams);
+    std::size_t n = 0;
+    Item::ItemVector::const_iterator it;
+    for(it = c->neighbours.begin() ; it != c->neighbours.end() ; ++it)
+    {
+        if(!filter.accept(*it))
+            continue;
+        if(n < max)
+            res[n] = toNative(*it);
+        n++;
+    }
+    return n;
+}
+
+// like Item::nearest(): the saved neighbours are all the items within the detection radius
+AiwarNativeItem* intent_nearest(const AiwarNativeItem *self, uint32_t kinds, uint32_t teams, double maxRadius)
+{
+    NativeCall *c = acting(self, "nearest: only the unit played can query its neighbours");
+    if(!c)
+        return NULL;
+
+    NeighbourFilter filter(kinds, teams);
+    const double px = c->unit->xpos(), py = c->unit->ypos();
+    Item *best = NULL;
+    double bestDistance = 0.0;
+    Item::ItemVector::const_iterator it;
+    for(it = c->neighbours.begin() ; it != c->neighbours.end() ; ++it)
+    {
+        if(!filter.accept(*it))
+            continue;
+        const double dx = (*it)->xpos() - px, dy = (*it)->ypos() - py;
+        const double d2 = dx * dx + dy * dy;
+        if(maxRadius >= 0.0 && d2 > maxRadius * maxRadius)
+            continue;
+        // neighbours are sorted by key: the first one wins a tie
+        if(!best || d2 < bestDistance)
+        {
+            best = *it;
+            bestDistance = d2;
+        }
+    }
+    return toNative(best);
+}
+
+void intent_log(AiwarNativeItem *self, const char *msg)
+{
+    if(acting(self, "log: only the unit played can log"))
+        api_log(self, msg);
+}
+
+void intent_state(AiwarNativeItem *self, uint32_t state)
+{
+    if(NativeCall::Intent *in = record(self, NativeCall::Intent::STATE, "state: only the unit played can act"))
+        in->value = state;
+}
+
+void intent_set_memory_int(AiwarNativeItem *self, uint32_t index, int32_t value, AiwarNativeItem *other)
+{
+    if(NativeCall::Intent *in = record(self, NativeCall::Intent::SET_MEMORY_INT, "set_memory: only the unit played can act"))
+    {
+        in->index = index;
+        in->ivalue = value;
+        in->other = other;
+    }
+}
+
+void intent_set_memory_uint(AiwarNativeItem *self, uint32_t index, uint32_t value, AiwarNativeItem *other)
+{
+    if(NativeCall::Intent *in = record(self, NativeCall::Intent::SET_MEMORY_UINT, "set_memory: only the unit played can act"))
+    {
+        in->index = index;
+        in->value = value;
+        in->other = other;
+    }
+}
+
+void intent_set_memory_float(AiwarNativeItem *self, uint32_t index, float value, AiwarNativeItem *other)
+{
+    if(NativeCall::Intent *in = record(self, NativeCall::Intent::SET_MEMORY_FLOAT, "set_memory: only the unit played can act"))
+    {
+        in->index = index;
+        in->fvalue = value;
+        in->other = other;
+    }
+}
+
+void intent_rotate_of(AiwarNativeItem *ship, double angle)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::ROTATE_OF, "rotate_of: only the unit played can act"))
+        in->x = angle;
+}
+
+void intent_rotate_to(AiwarNativeItem *ship, double x, double y)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::ROTATE_TO, "rotate_to: only the unit played can act"))
+    {
+        in->x = x;
+        in->y = y;
+    }
+}
+
+void intent_move(AiwarNativeItem *ship)
+{
+    record(ship, NativeCall::Intent::MOVE, "move: only the unit played can act");
+}
+
+int intent_move_towards(AiwarNativeItem *ship, double x, double y, double stopRadius)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::MOVE_TOWARDS, "move_towards: only the unit played can act"))
+    {
+        in->x = x;
+        in->y = y;
+        in->r = stopRadius;
+    }
+    return 0;
+}
+
+int intent_keep_distance(AiwarNativeItem *ship, double x, double y, double radius)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::KEEP_DISTANCE, "keep_distance: only the unit played can act"))
+    {
+        in->x = x;
+        in->y = y;
+        in->r = radius;
+    }
+    return 0;
+}
+
+uint32_t intent_extract(AiwarNativeItem *ship, AiwarNativeItem *mineral)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::EXTRACT, "extract: only the unit played can act"))
+        in->other = mineral;
+    return 0;
+}
+
+uint32_t intent_push_mineral(AiwarNativeItem *ship, AiwarNativeItem *base, uint32_t points)
+{
+    if(NativeCall::Intent *in = record(ship, NativeCall::Intent::PUSH_MINERAL, "push_mineral: only the unit played can act"))
+    {
+        in->other = base;
+        in->value = points;
+    }
+    return 0;
+}
+
+void intent_launch_missile(AiwarNativeItem *unit, AiwarNativeItem *target)
+{
+    if(NativeCall::Intent *in = record(unit, NativeCall::Intent::LAUNCH_MISSILE, "launch_missile: only the unit played can act"))
+        in->other = target;
+}
+
+void intent_create_miningship(AiwarNativeItem *base)
+{
+    record(base, NativeCall::Intent::CREATE_MININGSHIP, "create_miningship: only the unit played can act");
+}
+
+void intent_create_fighter(AiwarNativeItem *base)
+{
+    record(base, NativeCall::Intent::CREATE_FIGHTER, "create_fighter: only the unit played can act");
+}
+
+uint32_t intent_pull_mineral(AiwarNativeItem *base, AiwarNativeItem *ship, uint32_t points)
+{
+    if(NativeCall::Intent *in = record(base, NativeCall::Intent::PULL_MINERAL, "pull_mineral: only the unit played can act"))
+    {
+        in->other = ship;
+        in->value = points;
+    }
+    return 0;
+}
+
+uint32_t intent_repair(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *target)
+{
+    if(NativeCall::Intent *in = record(base, NativeCall::Intent::REPAIR, "repair: only the unit played can act"))
+    {
+        in->other = target;
+        in->value = points;
+    }
+    return 0;
+}
+
+uint32_t intent_refuel(AiwarNativeItem *base, uint32_t points, AiwarNativeItem *ship)
+{
+    if(NativeCall::Intent *in = record(base, NativeCall::Intent::REFUEL, "refuel: only the unit played can act"))
+    {
+        in->other = ship;
+        in->value = points;
+    }
+    return 0;
+}
+
+uint32_t intent_give_missiles(AiwarNativeItem *base, uint32_t missiles, AiwarNativeItem *fighter)
+{
+    if(NativeCall::Intent *in = record(base, NativeCall::Intent::GIVE_MISSILES, "give_missiles: only the unit played can act"))
+    {
+        in->other = fighter;
+        in->value = missiles;
+    }
+    return 0;
+}
+
+// run a recorded action with the function of the immediate mode
+void replay(const NativeCall &c, const NativeCall::Intent &in)
+{
+    switch(in.op)
+    {
+    case NativeCall::Intent::ROTATE_OF: api_rotate_of(c.self, in.x); break;
+    case NativeCall::Intent::ROTATE_TO: api_rotate_to(c.self, in.x, in.y); break;
+    case NativeCall::Intent::MOVE: api_move(c.self); break;
+    case NativeCall::Intent::MOVE_TOWARDS: api_move_towards(c.self, in.x, in.y, in.r); break;
+    case NativeCall::Intent::KEEP_DISTANCE: api_keep_distance(c.self, in.x, in.y, in.r); break;
+    case NativeCall::Intent::STATE: api_state(c.self, in.value); break;
+    case NativeCall::Intent::SET_MEMORY_INT: api_set_memory_int(c.self, in.index, in.ivalue, in.other); break;
+    case NativeCall::Intent::SET_MEMORY_UINT: api_set_memory_uint(c.self, in.index, in.value, in.other); break;
+    case NativeCall::Intent::SET_MEMORY_FLOAT: api_set_memory_float(c.self, in.index, in.fvalue, in.other); break;
+    case NativeCall::Intent::EXTRACT: api_extract(c.self, in.other); break;
+    case NativeCall::Intent::PUSH_MINERAL: api_push_mineral(c.self, in.other, in.value); break;
+    case NativeCall::Intent::PULL_MINERAL: api_pull_mineral(c.self, in.other, in.value); break;
+    case NativeCall::Intent::LAUNCH_MISSILE: api_launch_missile(c.self, in.other); break;
+    case NativeCall::Intent::CREATE_MININGSHIP: api_create_miningship(c.self); break;
+    case NativeCall::Intent::CREATE_FIGHTER: api_create_fighter(c.self); break;
+    case NativeCall::Intent::REPAIR: api_repair(c.self, in.value, in.other); break;
+    case NativeCall::Intent::REFUEL: api_refuel(c.self, in.value, in.other); break;
+    case NativeCall::Intent::GIVE_MISSILES: api_give_missiles(c.self, in.value, in.other); break;
+    }
+}
+
+void buildApi()
+{
+    HandlerProcess::fillConfig(config);
+
+    api.version = AIWAR_NATIVE_VERSION;
+    api.size = sizeof(AiwarApi);
+    api.config = &config;
+
+    api.key = &api_key;
+    api.kind = &api_kind;
+    api.team = &api_team;
+    api.xpos = &api_xpos;
+    api.ypos = &api_ypos;
+    api.distance = &api_distance;
+    api.distance_to = &api_distance_to;
+    api.life = &api_life;
+    api.neighbours = &api_neighbours;
+    api.nearest = &api_nearest;
+
+    api.is_friend = &api_is_friend;
+    api.log = &api_log;
+    api.state = &api_state;
+
+    api.memory_size = &api_memory_size;
+    api.get_memory_int = &api_get_memory_int;
+    api.get_memory_uint = &api_get_memory_uint;
+    api.get_memory_float = &api_get_memory_float;
+    api.set_memory_int = &api_set_memory_int;
+    api.set_memory_uint = &api_set_memory_uint;
+    api.set_memory_float = &api_set_memory_float;
+
+    api.angle = &api_angle;
+    api.fuel = &api_fuel;
+    api.friend_fuel = &api_friend_fuel;
+    api.rotate_of = &api_rotate_of;
+    api.rotate_to = &api_rotate_to;
+    api.move = &api_move;
+    api.move_towards = &api_move_towards;
+    api.keep_distance = &api_keep_distance;
+
+    api.mineral_storage = &api_mineral_storage;
+    api.extract = &api_extract;
+    api.push_mineral = &api_push_mineral;
+    api.missiles = &api_missiles;
+    api.launch_missile = &api_launch_missile;
+
+    api.create_miningship = &api_create_miningship;
+    api.create_fighter = &api_create_fighter;
+    api.pull_mineral = &api_pull_mineral;
+    api.repair = &api_repair;
+    api.refuel = &api_refuel;
+    api.give_missiles = &api_give_missiles;
+
+    api.over_budget = &api_over_budget;
+
+    // the queries read the world as it was at the start of the round, and the actions are recorded
+    intentApi = api;
+    intentApi.neighbours = &intent_neighbours;
+    intentApi.nearest = &intent_nearest;
+    intentApi.log = &intent_log;
+    intentApi.state = &intent_state;
+    intentApi.set_memory_int = &intent_set_memory_int;
+    intentApi.set_memory_uint = &intent_set_memory_uint;
+    intentApi.set_memory_float = &intent_set_memory_float;
+    intentApi.rotate_of = &intent_rotate_of;
+    intentApi.rotate_to = &intent_rotate_to;
+    intentApi.move = &intent_move;
+    intentApi.move_towards = &intent_move_towards;
+    intentApi.keep_distance = &intent_keep_distance;
+    intentApi.extract = &intent_extract;
+    intentApi.push_mineral = &intent_push_mineral;
+    intentApi.launch_missile = &intent_launch_missile;
+    intentApi.create_miningship = &intent_create_miningship;
+    intentApi.create_fighter = &intent_create_fighter;
+    intentApi.pull_mineral = &intent_pull_mineral;
+    intentApi.repair = &intent_repair;
+    intentApi.refuel = &intent_refuel;
+    intentApi.give_missiles = &intent_give_missiles;
+
+#ifndef _WIN32
+    if(!callKeyCreated)
+        callKeyCreated = (pthread_key_create(&callKey, NULL) == 0);
+#endif
+}
+
+#ifndef _WIN32
+double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// dlsym() returns a void*, which ISO C++ cannot convert to a function pointer
+template<class F> F symbol(void *library, const char *name)
+{
+    F f;
+    void *p = dlsym(library, name);
+    std::memcpy(&f, &p, sizeof(f));
+    return f;
+}
+#endif
+
+bool keyLess(const NativeCall *a, const NativeCall *b)
+{
+    return a->unit->_getKey() < b->unit->_getKey();
+}
+
+} // anonymous namespace
+
+/*** NativePlayFunction ***/
+
+NativePlayFunction::NativePlayFunction() : _fun(NULL), _calls(0), _total(0.0), _max(0.0)
+{
+}
+
+void NativePlayFunction::operator()(Playable *p)
+{
+    if(!_fun)
+        return;
+
+#ifndef _WIN32
+    double start = now();
+    _fun(&api, toNative(p));
+    addCall(now() - start);
+#endif
+
+    if(!immediateCall.error.empty())
+    {
+        std::string what;
+        what.swap(immediateCall.error);
+        throw HandlerError(p->team(), what);
+    }
+}
+
+void NativePlayFunction::addCall(double seconds)
+{
+    _calls++;
+    _total += seconds;
+    if(seconds > _max)
+        _max = seconds;
+}
+
+/*** NativeTeamPlayFunction ***/
+
+NativeTeamPlayFunction::NativeTeamPlayFunction(HandlerNative::PlayerInfo &player, ThreadPool &pool)
+    : _player(player), _pool(pool), _count(0), _team(NO_TEAM), _left(-1.0)
+{
+}
+
+NativeTeamPlayFunction::~NativeTeamPlayFunction()
+{
+    std::vector<NativeCall*>::iterator it;
+    for(it = _calls.begin() ; it != _calls.end() ; ++it)
+        delete *it;
+}
+
+void NativeTeamPlayFunction::operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+{
+    prepare(bases, miningShips, fighters);
+    think();
+    apply();
+}
+
+NativeCall& NativeTeamPlayFunction::_call(Playable *unit, NativePlayFunction &play)
+{
+    if(_count == _calls.size())
+        _calls.push_back(new NativeCall());
+    NativeCall &c = *_calls[_count++];
+
+    c.unit = unit;
+    c.self = toNative(unit);
+    c.play = &play;
+    c.error.clear();
+    c.intents.clear();
+    c.time = 0.0;
+    c.cpu = 0.0;
+    return c;
+}
+
+void NativeTeamPlayFunction::prepare(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+{
+    _count = 0;
+
+    // one call per living unit: ItemManager drops the ones destroyed during the item loop
+    BaseVector::const_iterator bit;
+    for(bit = bases.begin() ; bit != bases.end() ; ++bit)
+        _call(*bit, _player.baseHandler);
+
+    MiningShipVector::const_iterator mit;
+    for(mit = miningShips.begin() ; mit != miningShips.end() ; ++mit)
+        _call(*mit, _player.miningShipHandler);
+
+    FighterVector::const_iterator fit;
+    for(fit = fighters.begin() ; fit != fighters.end() ; ++fit)
+        _call(*fit, _player.fighterHandler);
+
+    std::sort(_calls.begin(), _calls.begin() + _count, keyLess);
+
+    // the neighbour queries are not thread-safe: the ones of the round are made now
+    for(std::size_t i = 0 ; i < _count ; ++i)
+        _calls[i]->unit->neighbours(_calls[i]->neighbours);
+}
+
+void NativeTeamPlayFunction::think()
+{
+    // the workers join the watch of the thread calling think()
+    _team = _count ? _calls[0]->unit->team() : NO_TEAM;
+    _left = ThinkWatchdog::left(_team);
+    _pool.run(*this, _count);
+}
+
+void NativeTeamPlayFunction::run(std::size_t index, unsigned int worker)
+{
+    NativeCall &c = *_calls[index];
+
+    setCurrent(&c);
+#ifndef _WIN32
+    // the thread calling think() is counted and watched by the game
+    ThinkScope w(_team, worker ? _left : -1.0);
+    double cpu = worker ? threadCpuTime() : 0.0;
+    double start = now();
+    c.play->function()(&intentApi, c.self);
+    c.time = now() - start;
+    if(worker)
+        c.cpu = threadCpuTime() - cpu;
+#else
+    (void)worker;
+    c.play->function()(&intentApi, c.self);
+#endif
+    setCurrent(NULL);
+}
+
+double NativeTeamPlayFunction::externalCpuTime() const
+{
+    double cpu = 0.0;
+    for(std::size_t i = 0 ; i < _count ; ++i)
+        cpu += _calls[i]->cpu;
+    return cpu;
+}
+
+void NativeTeamPlayFunction::apply()
+{
+    std::size_t i;
+
+    for(i = 0 ; i < _count ; ++i)
+        _calls[i]->play->addCall(_calls[i]->time);
+
+    // the first error in key order, like in immediate mode
+    for(i = 0 ; i < _count ; ++i)
+    {
+        if(!_calls[i]->error.empty())
+            throw HandlerError(_calls[i]->unit->team(), _calls[i]->error);
+    }
+
+    for(i = 0 ; i < _count ; ++i)
+    {
+        NativeCall &c = *_calls[i];
+        std::vector<NativeCall::Intent>::const_iterator it;
+        for(it = c.intents.begin() ; it != c.intents.end() ; ++it)
+            replay(c, *it);
+
+        if(!immediateCall.error.empty())
+        {
+            std::string what;
+            what.swap(immediateCall.error);
+            throw HandlerError(c.unit->team(), what);
+        }
+    }
+}
+
+/*** HandlerNative ***/
+
+HandlerNative::HandlerNative() : _pool(NULL)
+{
+}
+
+HandlerNative::~HandlerNative()
+{
+    finalize();
+    delete _pool;
+}
+
+bool HandlerNative::initialize()
+{
+    buildApi();
+    return true;
+}
+
+bool HandlerNative::finalize()
+{
+    while(!_playerMap.empty())
+    {
+        PlayerInfo *info = _playerMap.begin()->second;
+        info->loads = 1;
+        unload(_playerMap.begin()->first);
+    }
+    return true;
+}
+
+const AiwarApi& HandlerNative::api()
+{
+    return ::api;
+}
+
+bool HandlerNative::load(P player, const std::string &params)
+{
+#ifndef _WIN32
+    PlayerMap::iterator it = _playerMap.find(player);
+    if(it != _playerMap.end())
+    {
+        it->second->loads++;
+        return true;
+    }
+
+    // the path, then the params of aiwar_init()
+    std::string::size_type sep = params.find(' ');
+    std::string path = params.substr(0, sep);
+    std::string initParams = (sep == std::string::npos) ? std::string() : params.substr(sep + 1);
+
+    // the rules may have changed since initialize()
+    HandlerProcess::fillConfig(config);
+
+    void *library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(!library)
+    {
+        std::cerr << "Cannot load native player: " << dlerror() << std::endl;
+        return false;
+    }
+
+    AiwarPlayFunction base = symbol<AiwarPlayFunction>(library, "play_base");
+    AiwarPlayFunction miningShip = symbol<AiwarPlayFunction>(library, "play_miningship");
+    AiwarPlayFunction fighter = symbol<AiwarPlayFunction>(library, "play_fighter");
+    if(!base || !miningShip || !fighter)
+    {
+        std::cerr << "Native player " << path << " must export play_base, play_miningship and play_fighter\n";
+        dlclose(library);
+        return false;
+    }
+
+    AiwarInitFunction init = symbol<AiwarInitFunction>(library, "aiwar_init");
+    if(init && init(&::api, initParams.c_str()) != 0)
+    {
+        std::cerr << "Native player " << path << ": aiwar_init failed\n";
+        dlclose(library);
+        return false;
+    }
+
+    PlayerInfo *info = new PlayerInfo();
+    info->path = path;
+    info->library = library;
+    info->loads = 1;
+    info->teardown = symbol<AiwarTeardownFunction>(library, "aiwar_teardown");
+    info->baseHandler.setFunction(base);
+    info->miningShipHandler.setFunction(miningShip);
+    info->fighterHandler.setFunction(fighter);
+    AiwarModeFunction mode = symbol<AiwarModeFunction>(library, "aiwar_mode");
+    info->intents = (mode && mode() == AIWAR_MODE_INTENTS);
+    _playerMap[player] = info;
+
+    return true;
+#else
+    (void)player;
+    (void)params;
+    std::cerr << "The native handler is not available on this system\n";
+    return false;
+#endif
+}
+
+bool HandlerNative::unload(P player)
+{
+    PlayerMap::iterator it = _playerMap.find(player);
+    if(it == _playerMap.end())
+        return false;
+
+    PlayerInfo *info = it->second;
+    if(--info->loads > 0)
+        return true;
+
+    _report(*info);
+    std::vector<NativeTeamPlayFunction*>::iterator tit;
+    for(tit = info->teamHandlers.begin() ; tit != info->teamHandlers.end() ; ++tit)
+        delete *tit;
+    if(info->teardown)
+        info->teardown();
+#ifndef _WIN32
+    dlclose(info->library);
+#endif
+
+    delete info;
+    _playerMap.erase(it);
+    return true;
+}
+
+HandlerNative::PlayerInfo& HandlerNative::_player(P player)
+{
+    PlayerMap::iterator it = _playerMap.find(player);
+    if(it == _playerMap.end())
+        throw std::runtime_error("Player not registered");
+    return *it->second;
+}
+
+HandlerNative::PF& HandlerNative::get_BaseHandler(P player)
+{
+    return _player(player).baseHandler;
+}
+
+HandlerNative::PF& HandlerNative::get_MiningShipHandler(P player)
+{
+    return _player(player).miningShipHandler;
+}
+
+HandlerNative::PF& HandlerNative::get_FighterHandler(P player)
+{
+    return _player(player).fighterHandler;
+}
+
+TeamPlayFunction* HandlerNative::get_TeamHandler(P player)
+{
+    PlayerInfo &info = _player(player);
+    if(!info.intents)
+        return NULL;
+
+    // the threads are shared by all the teams, the number is read once the command line is parsed
+    if(!_pool)
+        _pool = new ThreadPool(Config::instance().threads);
+
+    info.teamHandlers.push_back(new NativeTeamPlayFunction(info, *_pool));
+    return info.teamHandlers.back();
+}
+
+void HandlerNative::_report(const PlayerInfo &info)
+{
+    const char *names[] = { "play_base", "play_miningship", "play_fighter" };
+    const NativePlayFunction *functions[] = { &info.baseHandler, &info.miningShipHandler, &info.fighterHandler };
+
+    std::ostringstream oss;
+    oss << "Native player " << info.path << (info.intents ? " (intent mode)" : "") << ":\n" << std::fixed << std::setprecision(3);
+    for(int i = 0 ; i < 3 ; ++i)
+    {
+        const NativePlayFunction &f = *functions[i];
+        oss << "\t" << std::left << std::setw(16) << names[i] << std::right
+            << std::setw(10) << f.calls() << " calls "
+            << std::setw(10) << (f.calls() ? f.totalTime() * 1e6 / f.calls() : 0.0) << " us/call "
+            << std::setw(10) << f.maxTime() * 1e6 << " us max\n";
+    }
+    std::cout << oss.str();
+}
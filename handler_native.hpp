@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HANDLER_NATIVE_HPP
+#define HANDLER_NATIVE_HPP
+
+#include <map>
+#include <vector>
+
+#include "handler_interface.hpp"
+#include "thread_pool.hpp"
+#include "client/aiwar_native.h"
+
+class NativeTeamPlayFunction;
+class NativeCall;
+
+/**
+ * \brief Calls a play function of a shared object, and measures the time of the calls
+ */
+class NativePlayFunction : public aiwar::core::PlayFunction
+{
+public:
+    NativePlayFunction();
+
+    void operator()(aiwar::core::Playable *p);
+
+    void setFunction(AiwarPlayFunction fn) { _fun = fn; }
+    AiwarPlayFunction function() const { return _fun; }
+
+    /**
+     * \brief Count a call made apart, by NativeTeamPlayFunction
+     */
+    void addCall(double seconds);
+
+    unsigned long calls() const { return _calls; }
+    double totalTime() const { return _total; } ///< seconds
+    double maxTime() const { return _max; } ///< seconds
+
+private:
+    AiwarPlayFunction _fun;
+    unsigned long _calls;
+    double _total;
+    double _max;
+};
+
+
+/**
+ * \brief Handler of the AIs compiled as shared objects, see client/aiwar_native.h
+ *
+ * Only available on POSIX systems.
+ */
+class HandlerNative : public aiwar::core::HandlerInterface
+{
+public:
+    typedef aiwar::core::Config::Player P;
+    typedef aiwar::core::PlayFunction PF;
+
+    HandlerNative();
+    ~HandlerNative();
+
+    bool initialize();
+    bool finalize();
+
+    bool load(P player, const std::string &params);
+    bool unload(P player);
+
+    PF& get_BaseHandler(P player);
+    PF& get_MiningShipHandler(P player);
+    PF& get_FighterHandler(P player);
+    aiwar::core::TeamPlayFunction* get_TeamHandler(P player);
+
+    /**
+     * \brief The functions of the AIs, built by initialize()
+     */
+    static const AiwarApi& api();
+
+    class PlayerInfo;
+
+private:
+    typedef std::map<P, PlayerInfo*> PlayerMap;
+
+    HandlerNative(const HandlerNative&);
+    HandlerNative& operator=(const HandlerNative&);
+
+    PlayerInfo& _player(P player);
+
+    // print the time spent in the functions of a player
+    static void _report(const PlayerInfo &info);
+
+    PlayerMap _playerMap;
+    aiwar::core::ThreadPool *_pool; ///< created by the first player in intent mode
+};
+
+
+class HandlerNative::PlayerInfo
+{
+public:
+    PlayerInfo() : library(NULL), loads(0), teardown(NULL), intents(false) {}
+
+    std::string path;
+    void *library; ///< handle of dlopen()
+    unsigned int loads; ///< the player is loaded once per team it plays
+    AiwarTeardownFunction teardown; ///< NULL if none
+    NativePlayFunction baseHandler;
+    NativePlayFunction miningShipHandler;
+    NativePlayFunction fighterHandler;
+    bool intents; ///< aiwar_mode() is AIWAR_MODE_INTENTS
+    std::vector<NativeTeamPlayFunction*> teamHandlers; ///< one per team played, in intent mode
+};
+
+
+/**
+ * \brief Plays all the units of a team at once, for a player in intent mode
+ *
+ * prepare() saves the neighbours of each unit, think() runs the play functions on
+ * the threads of a ThreadPool with the functions of the intent mode, which record the
+ * actions, and apply() runs the recorded actions in key order.
+ */
+class NativeTeamPlayFunction : public aiwar::core::TeamPlayFunction, private aiwar::core::ThreadPool::Job
+{
+public:
+    NativeTeamPlayFunction(HandlerNative::PlayerInfo &player, aiwar::core::ThreadPool &pool);
+    ~NativeTeamPlayFunction();
+
+    void operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters);
+
+    bool concurrent() const { return true; }
+    void prepare(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters);
+    void think();
+    void apply();
+
+    /**
+     * \brief CPU time of the calls run by the other threads of the pool
+     */
+    double externalCpuTime() const;
+
+private:
+    // play a unit, in a thread of the pool
+    void run(std::size_t index, unsigned int worker);
+
+    NativeCall& _call(aiwar::core::Playable *unit, NativePlayFunction &play);
+
+    HandlerNative::PlayerInfo &_player;
+    aiwar::core::ThreadPool &_pool;
+
+    std::vector<NativeCall*> _calls; ///< one per unit of the round, in key order. Kept from one round to the next
+    std::size_t _count; ///< units of the round
+    aiwar::core::Team _team; ///< team of the units of the round
+    double _left; ///< think time left to the team when think() is called, -1 if not watched
+};
+
+#endif /* HANDLER_NATIVE_HPP */
@@ -0,0 +1,681 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "handler_process.hpp"
+
+#include "base.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "mineral.hpp"
+#include "cpu_time.hpp"
+#include "think_watchdog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+using namespace aiwar::core;
+
+namespace {
+
+const uint32_t NO_INDEX = static_cast<uint32_t>(-1);
+
+// commands a unit may send in one round, above that the process is out of control
+const std::size_t MAX_COMMANDS_PER_UNIT = 64;
+
+template<class T> T* expect(Item *item, Team team, const char *what)
+{
+    T *t = item_cast<T>(item);
+    if(!t)
+        throw HandlerError(team, what);
+    return t;
+}
+
+void append(std::vector<char> &out, const void *data, std::size_t size)
+{
+    const char *p = static_cast<const char*>(data);
+    out.insert(out.end(), p, p + size);
+}
+
+// a command without shell operators replaces the shell, so the pid of the
+// child is the one of the AI and its CPU time can be read
+std::string shellCommand(const std::string &command)
+{
+    if(command.find_first_of(";&|()`{}\n") != std::string::npos)
+        return command;
+    return "exec " + command;
+}
+
+} // anonymous namespace
+
+/*** HandlerProcess ***/
+
+HandlerProcess::HandlerProcess()
+{
+}
+
+HandlerProcess::~HandlerProcess()
+{
+    finalize();
+}
+
+bool HandlerProcess::initialize()
+{
+#ifndef _WIN32
+    // a dead process must not kill the game when its pipe is written
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    return true;
+}
+
+bool HandlerProcess::finalize()
+{
+    FunctionVector::iterator it;
+    for(it = _functions.begin() ; it != _functions.end() ; ++it)
+        delete it->second;
+    _functions.clear();
+    _commands.clear();
+    return true;
+}
+
+bool HandlerProcess::load(P player, const std::string &command)
+{
+#ifndef _WIN32
+    if(command.empty())
+    {
+        std::cerr << "The process handler needs a command in the params of the player\n";
+        return false;
+    }
+
+    _commands[player] = command;
+    return true;
+#else
+    (void)player;
+    (void)command;
+    std::cerr << "The process handler is not available on this system\n";
+    return false;
+#endif
+}
+
+bool HandlerProcess::unload(P player)
+{
+    FunctionVector::iterator it = _functions.begin();
+    while(it != _functions.end())
+    {
+        if(it->first == player)
+        {
+            delete it->second;
+            it = _functions.erase(it);
+        }
+        else
+            ++it;
+    }
+    return _commands.erase(player) > 0;
+}
+
+HandlerProcess::PF& HandlerProcess::get_BaseHandler(P)
+{
+    return Playable::playNoOp;
+}
+
+HandlerProcess::PF& HandlerProcess::get_MiningShipHandler(P)
+{
+    return Playable::playNoOp;
+}
+
+HandlerProcess::PF& HandlerProcess::get_FighterHandler(P)
+{
+    return Playable::playNoOp;
+}
+
+TeamPlayFunction* HandlerProcess::get_TeamHandler(P player)
+{
+    CommandMap::const_iterator it = _commands.find(player);
+    if(it == _commands.end())
+        throw std::runtime_error("Player not registered");
+
+    // a player may play both teams: one process per team
+    ProcessTeamPlayFunction *f = new ProcessTeamPlayFunction(it->second);
+    _functions.push_back(std::make_pair(player, f));
+    return f;
+}
+
+void HandlerProcess::fillConfig(AiwarConfig &c)
+{
+    const Config &CFG = Config::instance();
+
+    c.WORLD_SIZE_X = CFG.WORLD_SIZE_X;
+    c.WORLD_SIZE_Y = CFG.WORLD_SIZE_Y;
+
+    c.MINERAL_SIZE_X = CFG.MINERAL_SIZE_X;
+    c.MINERAL_SIZE_Y = CFG.MINERAL_SIZE_Y;
+    c.MINERAL_LIFE = CFG.MINERAL_LIFE;
+
+    c.MININGSHIP_SIZE_X = CFG.MININGSHIP_SIZE_X;
+    c.MININGSHIP_SIZE_Y = CFG.MININGSHIP_SIZE_Y;
+    c.MININGSHIP_SPEED = CFG.MININGSHIP_SPEED;
+    c.MININGSHIP_DETECTION_RADIUS = CFG.MININGSHIP_DETECTION_RADIUS;
+    c.MININGSHIP_MAX_LIFE = CFG.MININGSHIP_MAX_LIFE;
+    c.MININGSHIP_START_LIFE = CFG.MININGSHIP_START_LIFE;
+    c.MININGSHIP_START_FUEL = CFG.MININGSHIP_START_FUEL;
+    c.MININGSHIP_MAX_FUEL = CFG.MININGSHIP_MAX_FUEL;
+    c.MININGSHIP_MOVE_CONSO = CFG.MININGSHIP_MOVE_CONSO;
+    c.MININGSHIP_MINING_RADIUS = CFG.MININGSHIP_MINING_RADIUS;
+    c.MININGSHIP_MINERAL_EXTRACT = CFG.MININGSHIP_MINERAL_EXTRACT;
+    c.MININGSHIP_MAX_MINERAL_STORAGE = CFG.MININGSHIP_MAX_MINERAL_STORAGE;
+
+    c.FIGHTER_SIZE_X = CFG.FIGHTER_SIZE_X;
+    c.FIGHTER_SIZE_Y = CFG.FIGHTER_SIZE_Y;
+    c.FIGHTER_SPEED = CFG.FIGHTER_SPEED;
+    c.FIGHTER_DETECTION_RADIUS = CFG.FIGHTER_DETECTION_RADIUS;
+    c.FIGHTER_MAX_LIFE = CFG.FIGHTER_MAX_LIFE;
+    c.FIGHTER_START_LIFE = CFG.FIGHTER_START_LIFE;
+    c.FIGHTER_MOVE_CONSO = CFG.FIGHTER_MOVE_CONSO;
+    c.FIGHTER_START_FUEL = CFG.FIGHTER_START_FUEL;
+    c.FIGHTER_MAX_FUEL = CFG.FIGHTER_MAX_FUEL;
+    c.FIGHTER_START_MISSILE = CFG.FIGHTER_START_MISSILE;
+    c.FIGHTER_MAX_MISSILE = CFG.FIGHTER_MAX_MISSILE;
+
+    c.MISSILE_SIZE_X = CFG.MISSILE_SIZE_X;
+    c.MISSILE_SIZE_Y = CFG.MISSILE_SIZE_Y;
+    c.MISSILE_LIFE = CFG.MISSILE_LIFE;
+    c.MISSILE_MOVE_CONSO = CFG.MISSILE_MOVE_CONSO;
+    c.MISSILE_START_FUEL = CFG.MISSILE_START_FUEL;
+    c.MISSILE_MAX_FUEL = CFG.MISSILE_MAX_FUEL;
+    c.MISSILE_SPEED = CFG.MISSILE_SPEED;
+    c.MISSILE_DAMAGE = CFG.MISSILE_DAMAGE;
+
+    c.BASE_SIZE_X = CFG.BASE_SIZE_X;
+    c.BASE_SIZE_Y = CFG.BASE_SIZE_Y;
+    c.BASE_DETECTION_RADIUS = CFG.BASE_DETECTION_RADIUS;
+    c.BASE_MAX_LIFE = CFG.BASE_MAX_LIFE;
+    c.BASE_START_LIFE = CFG.BASE_START_LIFE;
+    c.BASE_MISSILE_PRICE = CFG.BASE_MISSILE_PRICE;
+    c.BASE_MININGSHIP_PRICE = CFG.BASE_MININGSHIP_PRICE;
+    c.BASE_FIGHTER_PRICE = CFG.BASE_FIGHTER_PRICE;
+    c.BASE_START_MINERAL_STORAGE = CFG.BASE_START_MINERAL_STORAGE;
+    c.BASE_MAX_MINERAL_STORAGE = CFG.BASE_MAX_MINERAL_STORAGE;
+    c.BASE_REPAIR_RADIUS = CFG.BASE_REPAIR_RADIUS;
+    c.BASE_REFUEL_RADIUS = CFG.BASE_REFUEL_RADIUS;
+    c.BASE_GIVE_MISSILE_RADIUS = CFG.BASE_GIVE_MISSILE_RADIUS;
+
+    c.COMMUNICATION_RADIUS = CFG.COMMUNICATION_RADIUS;
+
+    c.MININGSHIP_MEMORY_SIZE = CFG.MININGSHIP_MEMORY_SIZE;
+    c.FIGHTER_MEMORY_SIZE = CFG.FIGHTER_MEMORY_SIZE;
+    c.BASE_MEMORY_SIZE = CFG.BASE_MEMORY_SIZE;
+}
+
+/*** ProcessTeamPlayFunction ***/
+
+ProcessTeamPlayFunction::ProcessTeamPlayFunction(const std::string &command)
+    : _command(command), _pid(0), _toChild(-1), _fromChild(-1), _childTime(-1.0), _roundTime(0.0), _thinkStart(-1.0), _team(NO_TEAM), _round(0)
+{
+}
+
+ProcessTeamPlayFunction::~ProcessTeamPlayFunction()
+{
+    stop();
+}
+
+void ProcessTeamPlayFunction::operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+{
+    prepare(bases, miningShips, fighters);
+    think();
+    apply();
+}
+
+void ProcessTeamPlayFunction::prepare(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+{
+    if(!bases.empty())
+        _team = bases.front()->team();
+    else if(!miningShips.empty())
+        _team = miningShips.front()->team();
+    else if(!fighters.empty())
+        _team = fighters.front()->team();
+
+    _out.clear();
+    if(!_pid)
+        _start();
+
+    _items.clear();
+    _itemPtrs.clear();
+    _units.clear();
+    _neighbours.clear();
+
+    // the units first, so a unit has the same index in _units and in _items
+    // they are alive: ItemManager drops the ones destroyed during the item loop
+    std::size_t i;
+    for(i = 0 ; i < bases.size() ; ++i)
+        _add(bases[i], true);
+    for(i = 0 ; i < miningShips.size() ; ++i)
+        _add(miningShips[i], true);
+    for(i = 0 ; i < fighters.size() ; ++i)
+        _add(fighters[i], true);
+
+    std::size_t unitCount = _items.size();
+    for(i = 0 ; i < unitCount ; ++i)
+        _addUnit(_itemPtrs[i]);
+
+    // reset the slots for the next round, and index the rows by key
+    _byKey.clear();
+    for(i = 0 ; i < _itemPtrs.size() ; ++i)
+    {
+        _indexOfSlot[_itemPtrs[i]->_getSlot()] = NO_INDEX;
+        _byKey.push_back(KeyIndex(_items[i].key, i));
+    }
+    std::sort(_byKey.begin(), _byKey.end());
+
+    AiwarFrameHeader h;
+    h.magic = AIWAR_MAGIC_FRAME;
+    h.tick = _round++;
+    h.unitCount = static_cast<uint32_t>(unitCount);
+    h.itemCount = static_cast<uint32_t>(_items.size());
+    h.neighbourCount = static_cast<uint32_t>(_neighbours.size());
+    h.reserved = 0;
+
+    append(_out, &h, sizeof(h));
+    if(!_items.empty())
+        append(_out, &_items[0], _items.size() * sizeof(AiwarItem));
+    if(!_units.empty())
+        append(_out, &_units[0], _units.size() * sizeof(AiwarUnit));
+    if(!_neighbours.empty())
+        append(_out, &_neighbours[0], _neighbours.size() * sizeof(uint32_t));
+}
+
+void ProcessTeamPlayFunction::think()
+{
+    // like externalCpuTime(), the process thinks from its last answer
+    _thinkStart = (_childTime >= 0.0) ? _childTime : processCpuTime(_pid);
+    if(!_out.empty())
+        _write(&_out[0], _out.size());
+
+    AiwarCommandHeader h;
+    _read(&h, sizeof(h));
+    if(h.magic != AIWAR_MAGIC_COMMAND)
+        throw HandlerError(_team, "The AI process sent a bad message");
+    if(h.count > MAX_COMMANDS_PER_UNIT * (_units.size() + 1))
+        throw HandlerError(_team, "The AI process sent too many commands");
+
+    _commands.resize(h.count);
+    if(h.count)
+        _read(&_commands[0], h.count * sizeof(AiwarCommand));
+
+    double t = processCpuTime(_pid);
+    _roundTime = (t >= 0.0 && _childTime >= 0.0) ? t - _childTime : 0.0;
+    _childTime = t;
+}
+
+double ProcessTeamPlayFunction::externalCpuTime() const
+{
+    return _roundTime;
+}
+
+void ProcessTeamPlayFunction::apply()
+{
+    std::vector<AiwarCommand>::const_iterator it;
+    for(it = _commands.begin() ; it != _commands.end() ; ++it)
+        _execute(*it);
+    _commands.clear();
+}
+
+void ProcessTeamPlayFunction::stop()
+{
+#ifndef _WIN32
+    // the process exits when its standard input is closed
+    if(_toChild >= 0)
+        close(_toChild);
+    if(_fromChild >= 0)
+        close(_fromChild);
+    _toChild = _fromChild = -1;
+
+    if(_pid)
+    {
+        pid_t pid = static_cast<pid_t>(_pid);
+        int i;
+        for(i = 0 ; i < 100 && waitpid(pid, NULL, WNOHANG) == 0 ; ++i)
+            usleep(10000);
+        if(i == 100)
+        {
+            std::cerr << "The AI process '" << _command << "' does not exit, it is killed\n";
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+        _pid = 0;
+    }
+#endif
+}
+
+void ProcessTeamPlayFunction::_start()
+{
+#ifndef _WIN32
+    int toChild[2], fromChild[2];
+    if(pipe(toChild) != 0)
+        throw HandlerError(_team, std::string("Cannot create a pipe: ") + std::strerror(errno));
+    if(pipe(fromChild) != 0)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        throw HandlerError(_team, std::string("Cannot create a pipe: ") + std::strerror(errno));
+    }
+
+    // the process of the other team must not keep these pipes open
+    for(int i = 0 ; i < 2 ; ++i)
+    {
+        fcntl(toChild[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fromChild[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    std::string command = shellCommand(_command);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        throw HandlerError(_team, std::string("Cannot start the AI process: ") + std::strerror(errno));
+    }
+
+    if(pid == 0)
+    {
+        // dup2 clears FD_CLOEXEC on the standard input and output
+        dup2(toChild[0], 0);
+        dup2(fromChild[1], 1);
+        signal(SIGPIPE, SIG_DFL);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(NULL));
+        _exit(127);
+    }
+
+    close(toChild[0]);
+    close(fromChild[1]);
+    _pid = pid;
+    _childTime = 0.0;
+    _toChild = toChild[1];
+    _fromChild = fromChild[0];
+
+    AiwarHello hello;
+    std::memset(&hello, 0, sizeof(hello));
+    hello.magic = AIWAR_MAGIC_HELLO;
+    hello.version = AIWAR_PROTOCOL_VERSION;
+    hello.team = _team;
+    hello.seed = Config::instance().seed;
+    HandlerProcess::fillConfig(hello.config);
+    append(_out, &hello, sizeof(hello));
+#else
+    throw HandlerError(_team, "The process handler is not available on this system");
+#endif
+}
+
+std::size_t ProcessTeamPlayFunction::_add(Item *item, bool own)
+{
+    KinematicStore::Slot slot = item->_getSlot();
+    if(slot >= _indexOfSlot.size())
+        _indexOfSlot.resize(slot + 1, NO_INDEX);
+    if(_indexOfSlot[slot] != NO_INDEX)
+        return _indexOfSlot[slot];
+
+    AiwarItem r;
+    std::memset(&r, 0, sizeof(r));
+    r.key = item->_getKey();
+    r.x = item->xpos();
+    r.y = item->ypos();
+    r.kind = static_cast<uint8_t>(item->_kind());
+    r.team = static_cast<uint8_t>(item->_tagTeam());
+
+    const Living *l = item_cast<Living>(item);
+    if(l)
+        r.life = l->life();
+
+    const Movable *m = item_cast<Movable>(item);
+    if(m)
+    {
+        r.angle = m->angle();
+        if(own)
+            r.fuel = m->fuel();
+    }
+
+    if(own)
+    {
+        switch(item->_kind())
+        {
+        case BASE_KIND:
+            r.extra = item_cast<Base>(item)->mineralStorage();
+            break;
+        case MININGSHIP_KIND:
+            r.extra = item_cast<MiningShip>(item)->mineralStorage();
+            break;
+        case FIGHTER_KIND:
+            r.extra = item_cast<Fighter>(item)->missiles();
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::size_t index = _items.size();
+    _items.push_back(r);
+    _itemPtrs.push_back(item);
+    _indexOfSlot[slot] = static_cast<uint32_t>(index);
+    return index;
+}
+
+void ProcessTeamPlayFunction::_addUnit(Item *unit)
+{
+    unit->neighbours(_buffer);
+
+    AiwarUnit u;
+    u.first = static_cast<uint32_t>(_neighbours.size());
+    u.count = static_cast<uint32_t>(_buffer.size());
+    _units.push_back(u);
+
+    Item::ItemVector::const_iterator it;
+    for(it = _buffer.begin() ; it != _buffer.end() ; ++it)
+        _neighbours.push_back(static_cast<uint32_t>(_add(*it, false)));
+}
+
+Item* ProcessTeamPlayFunction::_find(Item::Key key, bool unit) const
+{
+    std::vector<KeyIndex>::const_iterator it = std::lower_bound(_byKey.begin(), _byKey.end(), KeyIndex(key, 0));
+    if(it == _byKey.end() || it->first != key)
+        return NULL;
+    if(unit && it->second >= _units.size())
+        return NULL;
+    return _itemPtrs[it->second];
+}
+
+void ProcessTeamPlayFunction::_execute(const AiwarCommand &cmd)
+{
+    Item *unit = _find(cmd.unit, true);
+    if(!unit)
+        throw HandlerError(_team, "The AI process sent a command for an unknown unit");
+
+    Item *target = NULL;
+    if(cmd.target)
+    {
+        target = _find(cmd.target, false);
+        if(!target)
+            throw HandlerError(_team, "The AI process sent a command with a target not seen by the team");
+    }
+
+    switch(cmd.op)
+    {
+    case AIWAR_ROTATE_TO:
+        if(target)
+            expect<Movable>(unit, _team, "Only ships can rotate")->rotateTo(target);
+        else
+            expect<Movable>(unit, _team, "Only ships can rotate")->rotateTo(cmd.x, cmd.y);
+        break;
+
+    case AIWAR_ROTATE_OF:
+        expect<Movable>(unit, _team, "Only ships can rotate")->rotateOf(cmd.x);
+        break;
+
+    case AIWAR_MOVE:
+        expect<Movable>(unit, _team, "Only ships can move")->move();
+        break;
+
+    case AIWAR_EXTRACT:
+        expect<MiningShip>(unit, _team, "Only mining ships can extract")->extract(expect<Mineral>(target, _team, "Extract needs a mineral"));
+        break;
+
+    case AIWAR_PUSH_MINERAL:
+        expect<MiningShip>(unit, _team, "Only mining ships can push mineral")->pushMineral(expect<Base>(target, _team, "Push mineral needs a base"), cmd.value);
+        break;
+
+    case AIWAR_PULL_MINERAL:
+        expect<Base>(unit, _team, "Only bases can pull mineral")->pullMineral(expect<MiningShip>(target, _team, "Pull mineral needs a mining ship"), cmd.value);
+        break;
+
+    case AIWAR_LAUNCH_MISSILE:
+    {
+        Living *l = expect<Living>(target, _team, "Launch missile needs a living target");
+        if(unit->_kind() == BASE_KIND)
+            item_cast<Base>(unit)->launchMissile(l);
+        else
+            expect<Fighter>(unit, _team, "Only bases and fighters can launch missiles")->launchMissile(l);
+        break;
+    }
+
+    case AIWAR_CREATE_MININGSHIP:
+        expect<Base>(unit, _team, "Only bases can create mining ships")->createMiningShip();
+        break;
+
+    case AIWAR_CREATE_FIGHTER:
+        expect<Base>(unit, _team, "Only bases can create fighters")->createFighter();
+        break;
+
+    case AIWAR_REPAIR:
+        if(target)
+            expect<Base>(unit, _team, "Only bases can repair")->repair(cmd.value, expect<Living>(target, _team, "Repair needs a living target"));
+        else
+            expect<Base>(unit, _team, "Only bases can repair")->repair(cmd.value);
+        break;
+
+    case AIWAR_REFUEL:
+        expect<Base>(unit, _team, "Only bases can refuel")->refuel(cmd.value, expect<Movable>(target, _team, "Refuel needs a ship"));
+        break;
+
+    case AIWAR_GIVE_MISSILES:
+        expect<Base>(unit, _team, "Only bases can give missiles")->giveMissiles(cmd.value, expect<Fighter>(target, _team, "Give missiles needs a fighter"));
+        break;
+
+    case AIWAR_STATE:
+        if(cmd.value > DARK)
+            throw HandlerError(_team, "The AI process sent an unknown state");
+        expect<Playable>(unit, _team, "Only units have a state")->state(static_cast<State>(cmd.value));
+        break;
+
+    default:
+        throw HandlerError(_team, "The AI process sent an unknown command");
+    }
+}
+
+void ProcessTeamPlayFunction::_write(const void *data, std::size_t size)
+{
+#ifndef _WIN32
+    const char *p = static_cast<const char*>(data);
+    while(size > 0)
+    {
+        ssize_t n = _toChild >= 0 ? ::write(_toChild, p, size) : -1;
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            throw HandlerError(_team, "The AI process has exited");
+        p += n;
+        size -= n;
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+void ProcessTeamPlayFunction::_read(void *data, std::size_t size)
+{
+#ifndef _WIN32
+    char *p = static_cast<char*>(data);
+    while(size > 0)
+    {
+        _wait();
+        ssize_t n = _fromChild >= 0 ? ::read(_fromChild, p, size) : -1;
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            throw HandlerError(_team, "The AI process has exited");
+        p += n;
+        size -= n;
+    }
+#else
+    (void)data;
+    (void)size;
+    throw HandlerError(_team, "The process handler is not available on this system");
+#endif
+}
+
+void ProcessTeamPlayFunction::_wait()
+{
+#ifndef _WIN32
+    double left = ThinkWatchdog::left(_team);
+    if(left < 0.0 || _fromChild < 0)
+        return;
+
+    for(;;)
+    {
+        double before = processCpuTime(_pid);
+        double used = (before >= 0.0 && _thinkStart >= 0.0) ? before - _thinkStart : 0.0;
+        if(used < left)
+        {
+            pollfd fd;
+            fd.fd = _fromChild;
+            fd.events = POLLIN;
+            fd.revents = 0;
+            double wait = left - used;
+            int r = poll(&fd, 1, static_cast<int>(wait * 1000.0) + 1);
+            if(r < 0 && errno == EINTR)
+                continue;
+            if(r != 0)
+                return; // an answer, the end of the pipe or an error: read() tells
+
+            // the time is over: a process still thinking, maybe sharing a processor, gets what is left of its
+            // CPU time, but a process waiting instead of answering is stopped like one over budget
+            double after = processCpuTime(_pid);
+            if(before >= 0.0 && after - before > wait * 0.1)
+                continue;
+            used = (after >= 0.0 && _thinkStart >= 0.0) ? after - _thinkStart : used;
+        }
+
+        std::ostringstream oss;
+        oss << "think time over budget: no answer of the AI process within the " << left * 1000.0
+            << " ms left to the team, it has used " << used * 1000.0 << " ms of CPU time";
+        throw BudgetError(_team, oss.str());
+    }
+#endif
+}
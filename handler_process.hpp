@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HANDLER_PROCESS_HPP
+#define HANDLER_PROCESS_HPP
+
+#include <map>
+#include <vector>
+#include <utility>
+
+#include "handler_interface.hpp"
+#include "client/aiwar_protocol.h"
+
+class ProcessTeamPlayFunction;
+
+/**
+ * \brief Handler running the AI of a team in a child process
+ *
+ * The params of the player are a shell command. Each team played by the player
+ * gets its own process, started at the first round. The process reads the world
+ * seen by its team and writes the commands of its units through two pipes, with
+ * the protocol of client/aiwar_protocol.h.
+ *
+ * Only available on POSIX systems.
+ */
+class HandlerProcess : public aiwar::core::HandlerInterface
+{
+public:
+    typedef aiwar::core::Config::Player P;
+    typedef aiwar::core::PlayFunction PF;
+
+    HandlerProcess();
+    ~HandlerProcess();
+
+    bool initialize();
+    bool finalize();
+
+    bool load(P player, const std::string &command);
+    bool unload(P player);
+
+    PF& get_BaseHandler(P player);
+    PF& get_MiningShipHandler(P player);
+    PF& get_FighterHandler(P player);
+    aiwar::core::TeamPlayFunction* get_TeamHandler(P player);
+
+    /**
+     * \brief Copy the rules of the game from the Config
+     */
+    static void fillConfig(AiwarConfig &config);
+
+private:
+    typedef std::map<P, std::string> CommandMap;
+    typedef std::vector<std::pair<P, ProcessTeamPlayFunction*> > FunctionVector;
+
+    HandlerProcess(const HandlerProcess&);
+    HandlerProcess& operator=(const HandlerProcess&);
+
+    CommandMap _commands;
+    FunctionVector _functions; ///< one per team played, with its player
+};
+
+
+/**
+ * \brief Plays a team with a child process
+ *
+ * think() only talks to the process, so the processes of both teams think at
+ * the same time when the teams are isolated.
+ */
+class ProcessTeamPlayFunction : public aiwar::core::TeamPlayFunction
+{
+public:
+    ProcessTeamPlayFunction(const std::string &command);
+    ~ProcessTeamPlayFunction();
+
+    void operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters);
+
+    bool concurrent() const { return true; }
+    void prepare(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters);
+    void think();
+    void apply();
+
+    /**
+     * \brief CPU time used by the process to answer the last frame
+     */
+    double externalCpuTime() const;
+
+    /**
+     * \brief Close the pipes and wait for the end of the process, it is killed if it does not exit
+     */
+    void stop();
+
+private:
+    typedef std::pair<aiwar::core::Item::Key, std::size_t> KeyIndex;
+
+    // start the process and queue the hello message
+    void _start();
+
+    // add an item to the frame, return its index
+    std::size_t _add(aiwar::core::Item *item, bool own);
+    void _addUnit(aiwar::core::Item *unit);
+
+    aiwar::core::Item* _find(aiwar::core::Item::Key key, bool unit) const;
+    void _execute(const AiwarCommand &cmd);
+
+    void _write(const void *data, std::size_t size);
+    void _read(void *data, std::size_t size);
+    // wait for the answer of the process while its team has think time left, throw BudgetError beyond
+    void _wait();
+
+    std::string _command;
+    long _pid; ///< 0 if not started
+    int _toChild; ///< write end of the standard input of the process, -1 if closed
+    int _fromChild; ///< read end of its standard output, -1 if closed
+    double _childTime; ///< CPU time used by the process until its last answer, -1 if unknown
+    double _roundTime; ///< CPU time used by the process for its last answer
+    double _thinkStart; ///< CPU time of the process from which the current answer is counted, -1 if unknown
+
+    aiwar::core::Team _team;
+    unsigned int _round;
+
+    // the frame
+    std::vector<AiwarItem> _items;
+    std::vector<aiwar::core::Item*> _itemPtrs; ///< item of each row of _items
+    std::vector<AiwarUnit> _units;
+    std::vector<uint32_t> _neighbours;
+    std::vector<uint32_t> _indexOfSlot; ///< row of the items of the frame, by KinematicStore slot
+    std::vector<KeyIndex> _byKey; ///< rows of the frame sorted by key, to find the targets
+    aiwar::core::Item::ItemVector _buffer;
+    std::vector<char> _out; ///< bytes to send
+
+    // the answer
+    std::vector<AiwarCommand> _commands;
+};
+
+#endif /* HANDLER_PROCESS_HPP */
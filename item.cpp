@@ -20,62 +20,171 @@
 #include "item.hpp"
 
 #include "game_manager.hpp"
+#include "profiler.hpp"
+
+#ifdef AIWAR_RTTI_CAST
+#       include "mineral.hpp"
+#       include "missile.hpp"
+#       include "miningship.hpp"
+#       include "base.hpp"
+#       include "fighter.hpp"
+#endif
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 
 using namespace aiwar::core;
 
-Item::Item(GameManager &gm, Key k, double px, double py, double sx, double sy, double detection) : _im(gm.getItemManager()), _sm(gm.getStatManager()), _key(k), _toRemoveFlag(false), _xpos(px), _ypos(py), _xsize(sx), _ysize(sy), _detection_radius(detection)
+Item::Item(GameManager &gm, Key k, double px, double py, double sx, double sy, double detection) : _im(gm.getItemManager()), _sm(gm.getStatManager()), _key(k), _toRemoveFlag(false), _kin(_im._kinematics()), _slot(_kin.add(px, py)), _xsize(sx), _ysize(sy), _detection_radius(detection), _tag(NO_KIND), _binding(NULL)
 {
 //    std::cout << "Ctr Item(" << px << "," << py << ") -> " << this << std::endl;
 }
 
 Item::~Item()
 {
+    if(_binding)
+        _binding->itemDeleted();
+    _kin.remove(_slot);
 }
 
 double Item::xpos() const
 {
-    return _xpos;
+    return _kin.x(_slot);
 }
 
 double Item::ypos() const
 {
-    return _ypos;
+    return _kin.y(_slot);
+}
+
+// neighbours are sorted by key, like a walk through the whole ItemMap
+static bool keyLess(const Item *a, const Item *b)
+{
+    return a->_getKey() < b->_getKey();
 }
 
 Item::ItemList Item::neighbours() const
 {
-    ItemList res;
-    ItemManager::ItemMap::const_iterator cit;
-    for(cit = _im.begin() ; cit != _im.end() ; cit++)
+    ItemVector found;
+    neighbours(found);
+    return ItemList(found.begin(), found.end());
+}
+
+void Item::neighbours(ItemVector &res, const NeighbourFilter &filter) const
+{
+    ProfileScope s(Profiler::NEIGHBOURS);
+
+    ItemVector::size_type i, j;
+
+    res.clear();
+    if(!_im._getCachedNeighbours(this, _detection_radius, res))
     {
-        Item* i = cit->second;
-        if(i->_key == this->_key)
-            continue;
+        // the cache keeps all the neighbours: filter them later
+        const bool filterNow = !_im.cacheEnabled() && !filter.all();
+
+        // candidates are kept in place, res is not reallocated
+        const double x = _kin.x(_slot), y = _kin.y(_slot);
+        _im._queryGrid(x, y, _detection_radius, res);
+        for(i = 0, j = 0 ; i < res.size() ; ++i)
+        {
+            Item* item = res[i];
+            if(item == this)
+                continue;
+
+            if(item->_toRemove())
+                continue;
+
+            if(filterNow && !filter.accept(item))
+                continue;
+
+            const double ix = _kin.x(item->_slot), iy = _kin.y(item->_slot);
+            double distance = (ix - x) * (ix - x) + (iy - y) * (iy - y);
+            if(distance > _detection_radius * _detection_radius)
+                continue;
+
+            res[j++] = item;
+        }
+        res.resize(j);
+
+        std::sort(res.begin(), res.end(), keyLess);
+        if(filterNow)
+            return;
+        _im._setCachedNeighbours(this, res);
+    }
+
+    if(filter.all())
+        return;
+
+    for(i = 0, j = 0 ; i < res.size() ; ++i)
+    {
+        if(filter.accept(res[i]))
+            res[j++] = res[i];
+    }
+    res.resize(j);
+}
+
+namespace {
+
+// borrow a query buffer from the ItemManager for the scope
+class BorrowedBuffer
+{
+public:
+    BorrowedBuffer(ItemManager &im) : _im(im), _buffer(im._acquireBuffer()) {}
+    ~BorrowedBuffer() { _im._releaseBuffer(_buffer); }
+
+    Item::ItemVector& get() { return *_buffer; }
+
+private:
+    BorrowedBuffer(const BorrowedBuffer&);
+    BorrowedBuffer& operator=(const BorrowedBuffer&);
 
-        if(i->_toRemove())
-            continue;
+    ItemManager &_im;
+    Item::ItemVector *_buffer;
+};
 
-        double distance = (i->_xpos - _xpos) * (i->_xpos - _xpos) + (i->_ypos - _ypos) * (i->_ypos - _ypos);
-        if(distance > _detection_radius * _detection_radius)
-            continue;
+} // anonymous namespace
 
-        res.push_back(i);
+void Item::visitNeighbours(NeighbourVisitor &visitor, const NeighbourFilter &filter) const
+{
+    BorrowedBuffer buffer(_im);
+    neighbours(buffer.get(), filter);
+
+    ItemVector::const_iterator it;
+    for(it = buffer.get().begin() ; it != buffer.get().end() ; ++it)
+    {
+        if(!visitor.visit(*it))
+            break;
     }
+}
+
+// search radius of nearest(): never farther than the detection radius
+static double searchRadius(double maxRadius, double detection)
+{
+    if(maxRadius < 0.0 || maxRadius > detection)
+        return detection;
+    return maxRadius;
+}
 
-    return res;
+Item* Item::nearest(const NeighbourFilter &filter, double maxRadius) const
+{
+    return _im.nearest(_kin.x(_slot), _kin.y(_slot), filter, searchRadius(maxRadius, _detection_radius), this);
+}
+
+void Item::kNearest(std::size_t k, ItemVector &res, const NeighbourFilter &filter, double maxRadius) const
+{
+    _im.kNearest(_kin.x(_slot), _kin.y(_slot), k, filter, searchRadius(maxRadius, _detection_radius), res, this);
 }
 
 double Item::distanceTo(const Item *i) const
 {
-    return distanceTo(i->_xpos, i->_ypos);
+    return distanceTo(_kin.x(i->_slot), _kin.y(i->_slot));
 }
 
 double Item::distanceTo(double px, double py) const
 {
-    return sqrt( (px - _xpos) * (px - _xpos) + (py - _ypos) * (py - _ypos) );
+    const double x = _kin.x(_slot), y = _kin.y(_slot);
+    return sqrt( (px - x) * (px - x) + (py - y) * (py - y) );
 }
 
 
@@ -89,6 +198,117 @@ Item::Key Item::_getKey() const
     return _key;
 }
 
+ItemBinding* Item::_getBinding() const
+{
+    return _binding;
+}
+
+void Item::_setBinding(ItemBinding *binding)
+{
+    _binding = binding;
+}
+
+KinematicStore::Slot Item::_getSlot() const
+{
+    return _slot;
+}
+
+#ifndef AIWAR_RTTI_CAST
+ItemKind Item::_kind() const
+{
+    return static_cast<ItemKind>(_tag & TAG_KIND_MASK);
+}
+
+bool Item::_has(ItemCapability cap) const
+{
+    return (_tag & cap) != 0;
+}
+
+Team Item::_tagTeam() const
+{
+    return static_cast<Team>(_tag >> TAG_TEAM_SHIFT);
+}
+#else
+// the dispatch of the code before the tags, for bench_dispatch_rtti: a chain of dynamic_cast
+ItemKind Item::_kind() const
+{
+    if(dynamic_cast<const Mineral*>(this))
+        return MINERAL_KIND;
+    if(dynamic_cast<const Missile*>(this))
+        return MISSILE_KIND;
+    if(dynamic_cast<const MiningShip*>(this))
+        return MININGSHIP_KIND;
+    if(dynamic_cast<const Base*>(this))
+        return BASE_KIND;
+    if(dynamic_cast<const Fighter*>(this))
+        return FIGHTER_KIND;
+    return NO_KIND;
+}
+
+bool Item::_has(ItemCapability cap) const
+{
+    switch(cap)
+    {
+    case MOVABLE_CAP: return dynamic_cast<const Movable*>(this) != NULL;
+    case LIVING_CAP: return dynamic_cast<const Living*>(this) != NULL;
+    case PLAYABLE_CAP: return dynamic_cast<const Playable*>(this) != NULL;
+    case MEMORY_CAP: return dynamic_cast<const Memory*>(this) != NULL;
+    }
+    return false;
+}
+
+Team Item::_tagTeam() const
+{
+    const Playable *p = dynamic_cast<const Playable*>(this);
+    return p ? p->team() : NO_TEAM;
+}
+#endif
+
+Movable* Item::_asMovable()
+{
+    return NULL;
+}
+
+Living* Item::_asLiving()
+{
+    return NULL;
+}
+
+Playable* Item::_asPlayable()
+{
+    return NULL;
+}
+
+Memory* Item::_asMemory()
+{
+    return NULL;
+}
+
+Mineral* Item::_asMineral()
+{
+    return NULL;
+}
+
+Missile* Item::_asMissile()
+{
+    return NULL;
+}
+
+Base* Item::_asBase()
+{
+    return NULL;
+}
+
+MiningShip* Item::_asMiningShip()
+{
+    return NULL;
+}
+
+Fighter* Item::_asFighter()
+{
+    return NULL;
+}
+
 double Item::_xSize() const
 {
     return _xsize;
@@ -23,6 +23,7 @@
 #include <list>
 
 #include "item_manager.hpp" // for ItemManager::ItemMap
+#include "kinematics.hpp"
 
 namespace aiwar {
     namespace core {
@@ -30,6 +31,117 @@ namespace aiwar {
         class GameManager;
         class StatManager;
 
+        class Movable;
+        class Living;
+        class Playable;
+        class Memory;
+        class Mineral;
+        class Missile;
+        class Base;
+        class MiningShip;
+        class Fighter;
+
+        /**
+         * \brief Concrete class of an item, stored in the low bits of the item tag
+         */
+        enum ItemKind
+        {
+            NO_KIND,
+            MINERAL_KIND,
+            MISSILE_KIND,
+            BASE_KIND,
+            MININGSHIP_KIND,
+            FIGHTER_KIND
+        };
+
+        /**
+         * \brief Interfaces implemented by an item, one bit each in the item tag
+         */
+        enum ItemCapability
+        {
+            MOVABLE_CAP = 0x10,
+            LIVING_CAP = 0x20,
+            PLAYABLE_CAP = 0x40,
+            MEMORY_CAP = 0x80
+        };
+
+        class Item;
+
+        /**
+         * \brief Selection of neighbours by kind and team, all items by default
+         *
+         * Filters are chained: NeighbourFilter().kind(BASE_KIND).kind(FIGHTER_KIND).team(RED_TEAM)
+         * selects the red bases and fighters.
+         */
+        class NeighbourFilter
+        {
+        public:
+            NeighbourFilter() : _kinds(0), _teams(0) {}
+
+            /**
+             * \brief Build a filter from masks
+             * \param kindMask Bit (1 << kind) set for each accepted ItemKind, 0 for all
+             * \param teamMask Bit (1 << team) set for each accepted Team, 0 for all
+             */
+            NeighbourFilter(unsigned int kindMask, unsigned int teamMask) : _kinds(kindMask), _teams(teamMask) {}
+
+            /**
+             * \brief Accept the items of a kind. Without any call, all kinds are accepted
+             */
+            NeighbourFilter& kind(ItemKind k) { _kinds |= 1u << k; return *this; }
+
+            /**
+             * \brief Accept the items of a team, NO_TEAM for the items that are not Playable.
+             * Without any call, all teams are accepted
+             */
+            NeighbourFilter& team(Team t) { _teams |= 1u << t; return *this; }
+
+            unsigned int kindMask() const { return _kinds; }
+            unsigned int teamMask() const { return _teams; }
+
+            /**
+             * \brief Return true if the filter accepts all items
+             */
+            bool all() const { return _kinds == 0 && _teams == 0; }
+
+            bool accept(const Item *item) const;
+
+        private:
+            unsigned int _kinds; ///< one bit per accepted ItemKind, 0 for all
+            unsigned int _teams; ///< one bit per accepted Team, 0 for all
+        };
+
+        /**
+         * \brief Callback of Item::visitNeighbours()
+         */
+        class NeighbourVisitor
+        {
+        public:
+            virtual ~NeighbourVisitor() {}
+
+            /**
+             * \brief Called for each neighbour, in the order of Item::neighbours()
+             * \return False to stop the visit
+             */
+            virtual bool visit(Item *item) = 0;
+        };
+
+        /**
+         * \brief Objects of a script language bound to an item, for example its Python wrappers
+         */
+        class ItemBinding
+        {
+        public:
+            virtual ~ItemBinding() {}
+
+            /**
+             * \brief Called by the destructor of the item: drop every reference to it
+             *
+             * The binding is not used by the item anymore afterwards, it can delete itself.
+             */
+            virtual void itemDeleted() = 0;
+        };
+
         /**
          * \brief Abstract base class for all items on the plate
          */
@@ -37,6 +149,7 @@ namespace aiwar {
         {
         public:
             typedef std::list<Item*> ItemList;
+            typedef SpatialGrid::ItemVector ItemVector;
             typedef ItemManager::ItemKey Key;
 
             virtual ~Item();
@@ -52,9 +165,42 @@ namespace aiwar {
 
             /**
              * \brief return item nearer than _vision from itself, itself excluded
+             *
+             * The list is allocated at each call: prefer the two other forms.
              */
             ItemList neighbours() const;
 
+            /**
+             * \brief Get the items nearer than _vision from itself, itself excluded, sorted by key
+             * \param res Cleared then filled with the neighbours. Reuse it from one call to
+             *            the next: once it is large enough, a query does not allocate memory
+             * \param filter Kinds and team of the neighbours to keep
+             */
+            void neighbours(ItemVector &res, const NeighbourFilter &filter = NeighbourFilter()) const;
+
+            /**
+             * \brief Call a visitor on each neighbour, like neighbours(ItemVector&, const NeighbourFilter&)
+             *
+             * The buffer is taken from the ItemManager, so the visitor may itself query neighbours.
+             */
+            void visitNeighbours(NeighbourVisitor &visitor, const NeighbourFilter &filter = NeighbourFilter()) const;
+
+            /**
+             * \brief Get the nearest neighbour accepted by a filter
+             * \param filter Kinds and teams of the accepted neighbours
+             * \param maxRadius Neighbours farther than maxRadius are ignored, it cannot exceed _vision
+             * \return The nearest neighbour, the one with the lowest key if several are at the same distance, NULL if none
+             */
+            Item* nearest(const NeighbourFilter &filter = NeighbourFilter(), double maxRadius = -1.0) const;
+
+            /**
+             * \brief Get the k nearest neighbours accepted by a filter
+             * \param res Cleared then filled with at most k neighbours, nearest first
+             *
+             * Other parameters are the ones of nearest().
+             */
+            void kNearest(std::size_t k, ItemVector &res, const NeighbourFilter &filter = NeighbourFilter(), double maxRadius = -1.0) const;
+
             /**
              * \brief Get the distance to the other item.
              * \param other The other item
@@ -78,6 +224,47 @@ namespace aiwar {
 
             Key _getKey() const;
 
+            /**
+             * \brief Intern methods. Script objects bound to the item, NULL if none
+             */
+            ItemBinding* _getBinding() const;
+            void _setBinding(ItemBinding *binding);
+
+            /**
+             * \brief Intern method. Slot of the item in the KinematicStore of the ItemManager
+             */
+            KinematicStore::Slot _getSlot() const;
+
+            /**
+             * \brief Intern method. Get the concrete class of the item without RTTI
+             */
+            ItemKind _kind() const;
+
+            /**
+             * \brief Intern method. Check if the item implements an interface without RTTI
+             */
+            bool _has(ItemCapability cap) const;
+
+            /**
+             * \brief Intern method. Team of a Playable item, NO_TEAM for the others
+             */
+            Team _tagTeam() const;
+
+            /**
+             * \brief Intern methods. Downcasts without RTTI, NULL if the item is not of this type
+             *
+             * Use item_cast<T>() instead.
+             */
+            virtual Movable* _asMovable();
+            virtual Living* _asLiving();
+            virtual Playable* _asPlayable();
+            virtual Memory* _asMemory();
+            virtual Mineral* _asMineral();
+            virtual Missile* _asMissile();
+            virtual Base* _asBase();
+            virtual MiningShip* _asMiningShip();
+            virtual Fighter* _asFighter();
+
             double _xSize() const;
             double _ySize() const;
 
@@ -96,20 +283,64 @@ namespace aiwar {
 
             bool _toRemoveFlag; ///< set to true when the item must be deleted by the game manager
 
-            double _xpos; ///< horizontal Position
-            double _ypos; ///< vertical Position
+            KinematicStore &_kin; ///< where the position is stored
+            const KinematicStore::Slot _slot; ///< position of the item in _kin
 
             double _xsize; ///< horizontal size
             double _ysize; ///< vertical size
 
             double _detection_radius; ///< radius of vision for the item
 
+            unsigned short _tag; ///< kind | capabilities | team << TAG_TEAM_SHIFT, filled by the constructors
+
+            ItemBinding *_binding; ///< told when the item is deleted
+
+            static const unsigned short TAG_KIND_MASK = 0x0f;
+            static const unsigned short TAG_TEAM_SHIFT = 8;
+
         private:
             // no copy
             Item(const Item&);
             Item& operator= (const Item&);
         };
 
+        inline bool NeighbourFilter::accept(const Item *item) const
+        {
+            if(_kinds != 0 && !(_kinds & (1u << item->_kind())))
+                return false;
+            return _teams == 0 || (_teams & (1u << item->_tagTeam())) != 0;
+        }
+
+        /**
+         * \brief Downcast an item without RTTI
+         * \return The item as a T, or NULL if the item is not a T (or is NULL)
+         *
+         * The builds defining AIWAR_RTTI_CAST (bench_dispatch_rtti) use dynamic_cast
+         * instead, and find the kind, capabilities and team of an item with it too.
+         */
+#ifdef AIWAR_RTTI_CAST
+        template<class T> inline T* item_cast(Item *item) { return dynamic_cast<T*>(item); }
+#else
+        template<class T> T* item_cast(Item *item);
+#endif
+
+        template<class T> inline const T* item_cast(const Item *item)
+        {
+            return item_cast<T>(const_cast<Item*>(item));
+        }
+
+#ifndef AIWAR_RTTI_CAST
+        template<> inline Movable* item_cast<Movable>(Item *item) { return item ? item->_asMovable() : NULL; }
+        template<> inline Living* item_cast<Living>(Item *item) { return item ? item->_asLiving() : NULL; }
+        template<> inline Playable* item_cast<Playable>(Item *item) { return item ? item->_asPlayable() : NULL; }
+        template<> inline Memory* item_cast<Memory>(Item *item) { return item ? item->_asMemory() : NULL; }
+        template<> inline Mineral* item_cast<Mineral>(Item *item) { return item ? item->_asMineral() : NULL; }
+        template<> inline Missile* item_cast<Missile>(Item *item) { return item ? item->_asMissile() : NULL; }
+        template<> inline Base* item_cast<Base>(Item *item) { return item ? item->_asBase() : NULL; }
+        template<> inline MiningShip* item_cast<MiningShip>(Item *item) { return item ? item->_asMiningShip() : NULL; }
+        template<> inline Fighter* item_cast<Fighter>(Item *item) { return item ? item->_asFighter() : NULL; }
+#endif
+
     } // namespace aiwar::core
 } // namespace aiwar
 
@@ -29,20 +29,43 @@
 
 #include "game_manager.hpp"
 #include "stat_manager.hpp"
+#include "handler_interface.hpp" // for HandlerError
+#include "profiler.hpp"
+#include "cpu_time.hpp"
+#include "think_watchdog.hpp"
+#include "alloc_tracker.hpp"
 
 #include <stdexcept>
 #include <cstdlib>
+#include <sstream>
 #include <tinyxml.h>
 
+#ifndef _WIN32
+#       include <pthread.h>
+#endif
+
 
 using namespace aiwar::core;
 
-ItemManager::ItemManager(GameManager& gm) : _gm(gm), _currentItemId(0)
+ItemManager::ItemManager(GameManager& gm)
+    : _gm(gm), _treeStale(true),
+      _cacheEnabled(Config::instance().neighbourCache), _cacheHits(0), _cacheMisses(0),
+      _teamRounds(new TeamRound[RED_TEAM + 1])
 {
     // offset is between 1 and 50000 included
     _xOffset = static_cast<double>(std::rand() % 50000) + 1.0;
     _yOffset = static_cast<double>(std::rand() % 50000) + 1.0;
 
+    // a neighbours() query never covers more than 3x3 cells if a cell is as big as the largest detection radius
+    const Config &cfg = Config::instance();
+    double cellSize = cfg.BASE_DETECTION_RADIUS;
+    if(cfg.MININGSHIP_DETECTION_RADIUS > cellSize)
+        cellSize = cfg.MININGSHIP_DETECTION_RADIUS;
+    if(cfg.FIGHTER_DETECTION_RADIUS > cellSize)
+        cellSize = cfg.FIGHTER_DETECTION_RADIUS;
+    _grid.setCellSize(cellSize);
+    _static.setCellSize(cellSize);
+
     std::cout << "ItemManager: position offset: " << _xOffset << "x" << _yOffset << "\n";
 }
 
@@ -54,6 +77,14 @@ ItemManager::~ItemManager()
     {
         delete it->second;
     }
+
+    std::vector<SpatialGrid::ItemVector*>::iterator bit;
+    for(bit = _buffers.begin() ; bit != _buffers.end() ; ++bit)
+    {
+        delete *bit;
+    }
+
+    delete [] _teamRounds;
 }
 
 bool ItemManager::init()
@@ -70,52 +101,360 @@ bool ItemManager::init()
 
 void ItemManager::update(unsigned int tick)
 {
-    ItemMap::iterator it, tmp;
     Item* item;
+
+    // neighbours are cached for one round only
+    _cache.clear();
+
+    // the tree is built again by the first nearest query of the round
+    _tree.clear();
+    _treeStale = true;
+
+    // units of the teams played at once are gathered by the loop, and played after it
+    int t;
+    for(t = NO_TEAM ; t <= RED_TEAM ; ++t)
+    {
+        TeamRound &round = _teamRounds[t];
+        round.play = _gm.getTeamPF(static_cast<Team>(t));
+        round.bases.clear();
+        round.miningShips.clear();
+        round.fighters.clear();
+    }
+
     // update all items if not to remove, and remove deleted items
-    // limit the loop to existing item at the start of the round by counting elements
-    const unsigned long c = _itemMap.size();
-    unsigned int i;
-    for(it = _itemMap.begin(), i = 0 ; it != _itemMap.end() && i < c ; ++i)
+    // limit the loop to existing item at the start of the round: new items are added at the end
+    const ItemMap::size_type c = _itemMap.size();
+    ItemMap::size_type i;
+    try
+    {
+        for(i = 0 ; i < c ; ++i)
+        {
+            item = _itemMap.at(i).second;
+            if(!item->_toRemove()) // item is not deleted, so it can play
+            {
+                // missiles belong to no team, minerals do nothing
+                ItemKind kind = item->_kind();
+                if(kind == MISSILE_KIND)
+                {
+                    ProfileScope s(Profiler::MISSILES);
+                    item->update(tick);
+                }
+                else if(kind != MINERAL_KIND)
+                {
+                    if(_teamRounds[item->_tagTeam()].play)
+                        _startTeamRound(item, tick);
+                    else
+                    {
+                        ProfileScope s(Profiler::PLAY, item->_tagTeam(), kind);
+                        double start = threadCpuTime();
+                        {
+                            ThinkScope w(item->_tagTeam(), _budgetLeft(item->_tagTeam()));
+                            item->update(tick); // play
+                        }
+                        _addThinkTime(item->_tagTeam(), threadCpuTime() - start);
+                    }
+                }
+            }
+            else // remove item deleted in the last round, so renderer has access to the deleted item one round
+            {
+                ProfileScope s(Profiler::REMOVE);
+                if(item->_kind() == MINERAL_KIND)
+                {
+                    _static.remove(item);
+                    // the static layer has no stamp: neighbours saved during this round may hold the mineral
+                    _cache.clear();
+                }
+                else
+                    _grid.remove(item);
+                if(!_treeStale)
+                    _tree.remove(item);
+                _itemMap.erase(item->_getKey()); // the key is not found anymore, but positions do not change until compact()
+                delete item;
+            }
+        }
+    }
+    catch(...)
     {
-        // keep trace of the current iterator *before* increment
-        tmp = it++;
+        // a play function failed: the map must stay iterable for the renderer
+        _itemMap.compact();
+        throw;
+    }
 
-        item = tmp->second;
-        if(!item->_toRemove()) // item is not deleted, so it can play
+    _itemMap.compact();
+
+    _playTeams();
+}
+
+void ItemManager::_startTeamRound(Item *item, unsigned int tick)
+{
+    TeamRound &round = _teamRounds[item->_tagTeam()];
+    switch(item->_kind())
+    {
+    case BASE_KIND:
+        round.bases.push_back(item_cast<Base>(item));
+        round.bases.back()->_startRound(tick);
+        break;
+    case MININGSHIP_KIND:
+        round.miningShips.push_back(item_cast<MiningShip>(item));
+        round.miningShips.back()->_startRound(tick);
+        break;
+    case FIGHTER_KIND:
+        round.fighters.push_back(item_cast<Fighter>(item));
+        round.fighters.back()->_startRound(tick);
+        break;
+    default:
+        break;
+    }
+}
+
+namespace {
+
+// think() of a team, maybe in its own thread
+class TeamThought
+{
+public:
+    TeamThought() : play(NULL), team(NO_TEAM), time(0.0), budget(-1.0), failed(false), handlerError(false), budgetError(false) {}
+
+    void run()
+    {
+        double start = threadCpuTime();
+        try
+        {
+            ThinkScope w(team, budget);
+            play->think();
+        }
+        catch(const BudgetError &e)
+        {
+            failed = handlerError = budgetError = true;
+            what = e.what();
+        }
+        catch(const HandlerError &e)
         {
-            item->update(tick); // play
+            failed = handlerError = true;
+            what = e.what();
         }
-        else // remove item deleted in the last round, so renderer has access to the deleted item one round
+        catch(const std::exception &e)
         {
-            delete item;
-            _itemMap.erase(tmp);  // this unvalidates tmp, but 'it' has been updated before
+            failed = true;
+            what = e.what();
         }
+        time += threadCpuTime() - start;
+    }
+
+    // errors are thrown again by the main thread
+    void rethrow() const
+    {
+        if(budgetError)
+            throw BudgetError(team, what);
+        else if(handlerError)
+            throw HandlerError(team, what);
+        else if(failed)
+            throw std::runtime_error(what);
+    }
+
+    TeamPlayFunction *play;
+    Team team;
+    double time; ///< CPU time of prepare() and think()
+    double budget; ///< think time left to the team for think(), -1 without budget
+    bool failed;
+    bool handlerError;
+    bool budgetError;
+    std::string what;
+};
+
+#ifndef _WIN32
+void* thinkThread(void *thought)
+{
+    static_cast<TeamThought*>(thought)->run();
+    return NULL;
+}
+#endif
+
+// run the thoughts at the same time, the last one in the calling thread
+void thinkAll(TeamThought *thoughts, int n)
+{
+#ifndef _WIN32
+    pthread_t threads[RED_TEAM + 1];
+    bool started[RED_TEAM + 1];
+    int i;
+    for(i = 0 ; i < n - 1 ; ++i)
+        started[i] = (pthread_create(&threads[i], NULL, &thinkThread, &thoughts[i]) == 0);
+
+    thoughts[n - 1].run();
+
+    for(i = 0 ; i < n - 1 ; ++i)
+    {
+        if(started[i])
+            pthread_join(threads[i], NULL);
+        else
+            thoughts[i].run(); // no thread available, think now
     }
+#else
+    for(int i = 0 ; i < n ; ++i)
+        thoughts[i].run();
+#endif
+}
+
+// drop the units destroyed since they were gathered, by a missile later in the item loop
+template<class T>
+void dropDestroyed(std::vector<T*> &units)
+{
+    typename std::vector<T*>::size_type i, n = 0;
+    for(i = 0 ; i < units.size() ; ++i)
+    {
+        if(!units[i]->_toRemove())
+            units[n++] = units[i];
+    }
+    units.resize(n);
+}
+
+} // anonymous namespace
+
+void ItemManager::_playTeams()
+{
+    int t;
+
+    // the teams only play their living units
+    for(t = BLUE_TEAM ; t <= RED_TEAM ; ++t)
+    {
+        TeamRound &round = _teamRounds[t];
+        dropDestroyed(round.bases);
+        dropDestroyed(round.miningShips);
+        dropDestroyed(round.fighters);
+    }
+
+    // with isolated teams, the concurrent ones think at the same time
+    TeamThought thoughts[RED_TEAM + 1];
+    TeamThought *thoughtOf[RED_TEAM + 1] = { NULL };
+    int n = 0;
+    if(Config::instance().isolateTeams)
+    {
+        for(t = BLUE_TEAM ; t <= RED_TEAM ; ++t)
+        {
+            TeamRound &round = _teamRounds[t];
+            if(round.play && round.play->concurrent())
+            {
+                ProfileScope s(Profiler::PLAY, static_cast<Team>(t));
+                double budget = _budgetLeft(static_cast<Team>(t));
+                double start = threadCpuTime();
+                {
+                    ThinkScope w(static_cast<Team>(t), budget);
+                    round.play->prepare(round.bases, round.miningShips, round.fighters);
+                }
+                thoughts[n].time = threadCpuTime() - start;
+                if(budget >= 0.0)
+                    thoughts[n].budget = (budget > thoughts[n].time) ? budget - thoughts[n].time : 0.0;
+                thoughts[n].play = round.play;
+                thoughts[n].team = static_cast<Team>(t);
+                thoughtOf[t] = &thoughts[n++];
+            }
+        }
+        if(n > 0)
+        {
+            // only the main thread is timed
+            ProfileScope s(Profiler::THINK);
+            Profiler &profiler = Profiler::instance();
+            profiler.pause();
+            thinkAll(thoughts, n);
+            profiler.resume();
+        }
+    }
+
+    // units created by a team wait for the next round, like in the item loop
+    for(t = BLUE_TEAM ; t <= RED_TEAM ; ++t)
+    {
+        TeamRound &round = _teamRounds[t];
+        if(!round.play)
+            continue;
+
+        ProfileScope s(Profiler::PLAY, static_cast<Team>(t));
+        double start;
+        if(thoughtOf[t])
+        {
+            thoughtOf[t]->rethrow();
+            // a team over budget does not apply what it has thought
+            _addThinkTime(static_cast<Team>(t), thoughtOf[t]->time + round.play->externalCpuTime());
+            start = threadCpuTime();
+            {
+                ThinkScope w(static_cast<Team>(t), _budgetLeft(static_cast<Team>(t)));
+                round.play->apply();
+            }
+            _addThinkTime(static_cast<Team>(t), threadCpuTime() - start);
+        }
+        else
+        {
+            start = threadCpuTime();
+            {
+                ThinkScope w(static_cast<Team>(t), _budgetLeft(static_cast<Team>(t)));
+                (*round.play)(round.bases, round.miningShips, round.fighters);
+            }
+            _addThinkTime(static_cast<Team>(t), threadCpuTime() - start + round.play->externalCpuTime());
+        }
+    }
+}
+
+void ItemManager::_addThinkTime(Team team, double seconds)
+{
+    StatManager &sm = _gm.getStatManager();
+    sm.thinkTime(team, seconds);
+
+    const Config &cfg = Config::instance();
+    std::ostringstream oss;
+    if(cfg.tickBudget > 0.0 && sm.tickThinkTime(team) > cfg.tickBudget)
+        oss << "think time of the round over budget: " << sm.tickThinkTime(team) * 1000.0 << " ms > " << cfg.tickBudget * 1000.0 << " ms";
+    else if(cfg.matchBudget > 0.0 && sm.thinkTime(team) > cfg.matchBudget)
+        oss << "think time of the game over budget: " << sm.thinkTime(team) << " s > " << cfg.matchBudget << " s";
+    else
+        return;
+
+    throw BudgetError(team, oss.str());
+}
+
+double ItemManager::_budgetLeft(Team team)
+{
+    StatManager &sm = _gm.getStatManager();
+    const Config &cfg = Config::instance();
+    double left = -1.0;
+    if(cfg.tickBudget > 0.0)
+    {
+        double t = cfg.tickBudget - sm.tickThinkTime(team);
+        left = (t > 0.0) ? t : 0.0;
+    }
+    if(cfg.matchBudget > 0.0)
+    {
+        double m = cfg.matchBudget - sm.thinkTime(team);
+        m = (m > 0.0) ? m : 0.0;
+        if(left < 0.0 || m < left)
+            left = m;
+    }
+    return left;
 }
 
 Missile* ItemManager::createMissile(Item* launcher, Living* target)
 {
+    AllocSite a(AllocTracker::ITEMS);
     ItemKey k = _getNextItemKey();
     Missile *m = new Missile(_gm, k, launcher->xpos(), launcher->ypos(), target);
-    _itemMap.insert(ItemMap::value_type(k, m));
+    _insert(k, m);
     return m;
 }
 
 Base* ItemManager::createBase(double px, double py, Team team)
 {
+    AllocSite a(AllocTracker::ITEMS);
     ItemKey k = _getNextItemKey();
     Base *b = new Base(_gm, k, px, py, team, _gm.getBasePF(team));
-    _itemMap.insert(ItemMap::value_type(k, b));
+    _insert(k, b);
     _gm.getStatManager().baseCreated(b);
     return b;
 }
 
 MiningShip* ItemManager::createMiningShip(double px, double py, Team team)
 {
+    AllocSite a(AllocTracker::ITEMS);
     ItemKey k = _getNextItemKey();
     MiningShip *t = new MiningShip(_gm, k, px, py, team, _gm.getMiningShipPF(team));
-    _itemMap.insert(ItemMap::value_type(k, t));
+    _insert(k, t);
     _gm.getStatManager().miningShipCreated(t);
     return t;
 }
@@ -127,17 +466,19 @@ MiningShip* ItemManager::createMiningShip(Base* base)
 
 Mineral* ItemManager::createMineral(double px, double py)
 {
+    AllocSite a(AllocTracker::ITEMS);
     ItemKey k = _getNextItemKey();
     Mineral *m = new Mineral(_gm, k, px, py);
-    _itemMap.insert(ItemMap::value_type(k, m));
+    _insert(k, m);
     return m;
 }
 
 Fighter* ItemManager::createFighter(double px, double py, Team team)
 {
+    AllocSite a(AllocTracker::ITEMS);
     ItemKey k = _getNextItemKey();
     Fighter *f = new Fighter(_gm, k, px, py, team, _gm.getFighterPF(team));
-    _itemMap.insert(ItemMap::value_type(k, f));
+    _insert(k, f);
     _gm.getStatManager().fighterCreated(f);
     return f;
 }
@@ -154,11 +495,7 @@ bool ItemManager::exists(ItemKey key) const
 
 Item* ItemManager::get(ItemKey key) const
 {
-    ItemMap::const_iterator cit = _itemMap.find(key);
-    if(cit != _itemMap.end())
-        return cit->second;
-    else
-        return NULL;
+    return _itemMap.get(key);
 }
 
 void ItemManager::applyOffset(double &px, double &py) const
@@ -183,10 +520,140 @@ ItemManager::ItemMap::const_iterator ItemManager::end() const
     return _itemMap.end();
 }
 
+void ItemManager::_queryGrid(double px, double py, double radius, SpatialGrid::ItemVector &res) const
+{
+    _grid.query(px, py, radius, res);
+    _static.query(px, py, radius, res);
+}
+
+void ItemManager::_itemMoved(Item *item, double oldx, double oldy)
+{
+    _grid.move(item, oldx, oldy);
+    if(!_treeStale)
+        _tree.itemMoved(item);
+}
+
+Item* ItemManager::nearest(double px, double py, const NeighbourFilter &filter, double maxRadius, const Item *exclude)
+{
+    return _getTree().nearest(px, py, filter, maxRadius, exclude);
+}
+
+void ItemManager::kNearest(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, SpatialGrid::ItemVector &res, const Item *exclude)
+{
+    _getTree().kNearest(px, py, k, filter, maxRadius, exclude, res);
+}
+
+bool ItemManager::_getCachedNeighbours(const Item *item, double radius, SpatialGrid::ItemVector &res)
+{
+    if(!_cacheEnabled)
+        return false;
+
+    CacheMap::const_iterator cit = _cache.find(item->_getKey());
+    if(cit == _cache.end() || _grid.stamp(item->xpos(), item->ypos(), radius) > cit->second.stamp)
+    {
+        _cacheMisses++;
+        return false;
+    }
+
+    // items killed since the neighbours were saved are still in the grid until the next round
+    SpatialGrid::ItemVector::const_iterator nit;
+    for(nit = cit->second.neighbours.begin() ; nit != cit->second.neighbours.end() ; ++nit)
+    {
+        if(!(*nit)->_toRemove())
+            res.push_back(*nit);
+    }
+
+    _cacheHits++;
+    return true;
+}
+
+void ItemManager::_setCachedNeighbours(const Item *item, const SpatialGrid::ItemVector &neighbours)
+{
+    if(!_cacheEnabled)
+        return;
+
+    AllocSite a(AllocTracker::CACHE);
+    CacheEntry &entry = _cache[item->_getKey()];
+    entry.neighbours = neighbours;
+    entry.stamp = _grid.stamp();
+}
+
+SpatialGrid::ItemVector* ItemManager::_acquireBuffer()
+{
+    if(_buffers.empty())
+        return new SpatialGrid::ItemVector();
+
+    SpatialGrid::ItemVector *buffer = _buffers.back();
+    _buffers.pop_back();
+    return buffer;
+}
+
+void ItemManager::_releaseBuffer(SpatialGrid::ItemVector *buffer)
+{
+    _buffers.push_back(buffer);
+}
+
+KinematicStore& ItemManager::_kinematics()
+{
+    return _kin;
+}
+
+bool ItemManager::cacheEnabled() const
+{
+    return _cacheEnabled;
+}
+
+unsigned long ItemManager::cacheHits() const
+{
+    return _cacheHits;
+}
+
+unsigned long ItemManager::cacheMisses() const
+{
+    return _cacheMisses;
+}
+
 ItemManager::ItemKey ItemManager::_getNextItemKey()
 {
-    ItemKey k = _currentItemId++;
-    return k;
+    return _itemMap.nextKey();
+}
+
+void ItemManager::_insert(ItemKey key, Item *item)
+{
+    if(_itemMap.insert(item) != key)
+        throw std::logic_error("ItemManager: item created with an unexpected key");
+
+    if(item->_kind() == MINERAL_KIND)
+    {
+        _static.insert(item);
+        // the static layer has no stamp: neighbours saved during this round do not know the mineral
+        _cache.clear();
+    }
+    else
+        _grid.insert(item);
+
+    if(!_treeStale)
+        _tree.insert(item);
+}
+
+KdTree& ItemManager::_getTree()
+{
+    if(_treeStale)
+    {
+        SpatialGrid::ItemVector *items = _acquireBuffer();
+        items->clear();
+        ItemMap::const_iterator it;
+        for(it = _itemMap.begin() ; it != _itemMap.end() ; ++it)
+        {
+            // during update(), items deleted earlier in the round leave a hole until compact()
+            if(it->second)
+                items->push_back(it->second);
+        }
+        _tree.build(*items);
+        _releaseBuffer(items);
+        _treeStale = false;
+    }
+    return _tree;
 }
 
 bool ItemManager::loadMap(const std::string& mapFile)
@@ -267,5 +734,13 @@ bool ItemManager::loadMap(const std::string& mapFile)
         }
     }
 
+    // minerals never move: pack them once for all
+    packMinerals();
+
     return true;
 }
+
+void ItemManager::packMinerals()
+{
+    _static.build();
+}
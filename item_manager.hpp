@@ -22,8 +22,14 @@
 
 #include <set>
 #include <map>
+#include <vector>
 
 #include "config.hpp" // for Team
+#include "spatial_grid.hpp"
+#include "static_layer.hpp"
+#include "kd_tree.hpp"
+#include "slot_map.hpp"
+#include "kinematics.hpp"
 
 namespace aiwar {
     namespace core {
@@ -35,6 +41,8 @@ namespace aiwar {
         class MiningShip;
         class Mineral;
         class Fighter;
+        class NeighbourFilter;
+        class TeamPlayFunction;
 
         class GameManager;
 
@@ -42,8 +50,8 @@ namespace aiwar {
         class ItemManager
         {
         public:
-            typedef unsigned long ItemKey;
-            typedef std::map<ItemKey, Item*> ItemMap;
+            typedef SlotMap<Item*> ItemMap;
+            typedef ItemMap::Key ItemKey;
 
             ItemManager(GameManager& gm);
             ~ItemManager();
@@ -70,18 +78,140 @@ namespace aiwar {
 
             bool loadMap(const std::string& mapFile);
 
+            /**
+             * \brief Pack the minerals created so far in their spatial index, done by loadMap()
+             *
+             * The minerals created after it are checked one by one by each neighbours query.
+             */
+            void packMinerals();
+
+            /**
+             * \brief Get the nearest item accepted by a filter
+             * \param px x position of the point
+             * \param py y position of the point
+             * \param filter Kinds and teams of the accepted items
+             * \param maxRadius Items farther than maxRadius are ignored
+             * \param exclude An item to ignore, usually the one asking
+             * \return The nearest item, the one with the lowest key if several are at the same distance, NULL if none
+             *
+             * The kd-tree behind this query is built at most once per round, by the first query.
+             */
+            Item* nearest(double px, double py, const NeighbourFilter &filter, double maxRadius, const Item *exclude = NULL);
+
+            /**
+             * \brief Get the k nearest items accepted by a filter
+             * \param res Cleared then filled with at most k items, nearest first
+             *
+             * Other parameters are the ones of nearest().
+             */
+            void kNearest(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, SpatialGrid::ItemVector &res, const Item *exclude = NULL);
+
+            /**
+             * \brief Intern method. Get the items that may be in a disc, from the grid and the static layer
+             * \param px x position of the center of the disc
+             * \param py y position of the center of the disc
+             * \param radius Radius of the disc
+             * \param res Candidates are appended to this vector, the distance is not checked
+             */
+            void _queryGrid(double px, double py, double radius, SpatialGrid::ItemVector &res) const;
+
+            /**
+             * \brief Intern method. Must be called each time an item position has changed
+             * \param item The moved item
+             * \param oldx The x position before the move
+             * \param oldy The y position before the move
+             */
+            void _itemMoved(Item *item, double oldx, double oldy);
+
+            /**
+             * \brief Intern method. Get the neighbours of an item saved during the current round
+             * \param item The item
+             * \param radius The detection radius of the item
+             * \param res Filled with the saved neighbours that are not to remove
+             * \return False if the cache is disabled or if something has changed near the item since its neighbours were saved
+             */
+            bool _getCachedNeighbours(const Item *item, double radius, SpatialGrid::ItemVector &res);
+
+            /**
+             * \brief Intern method. Save the neighbours of an item for the current round
+             */
+            void _setCachedNeighbours(const Item *item, const SpatialGrid::ItemVector &neighbours);
+
+            /**
+             * \brief Intern method. Borrow a buffer for a neighbour query, it must be given back by _releaseBuffer()
+             *
+             * Buffers keep their capacity from one query to the next.
+             */
+            SpatialGrid::ItemVector* _acquireBuffer();
+            void _releaseBuffer(SpatialGrid::ItemVector *buffer);
+
+            /**
+             * \brief Intern method. Get the store of the positions, headings, speeds and fuels of all items
+             */
+            KinematicStore& _kinematics();
+
+            bool cacheEnabled() const;
+            unsigned long cacheHits() const;
+            unsigned long cacheMisses() const;
+
         private:
+            class CacheEntry;
+            class TeamRound;
+
+            typedef std::map<ItemKey, CacheEntry> CacheMap;
+
             // no copy
             ItemManager(const ItemManager&);
             ItemManager& operator=(const ItemManager&);
 
             ItemKey _getNextItemKey();
+            void _insert(ItemKey key, Item *item);
+            KdTree& _getTree();
+            void _startTeamRound(Item *item, unsigned int tick);
+            void _playTeams();
+            // count the CPU time of a play function, throw BudgetError if the team is over budget
+            void _addThinkTime(Team team, double seconds);
+            // think time left to a team in the round and the game, -1 without budget
+            double _budgetLeft(Team team);
 
             GameManager& _gm;
-            ItemKey _currentItemId;
+            KinematicStore _kin; ///< kinematic state of all items in _itemMap, must outlive them
             ItemMap _itemMap;
+            SpatialGrid _grid; ///< spatial index of the items of _itemMap that can move
+            StaticLayer _static; ///< spatial index of the minerals of _itemMap
+            KdTree _tree; ///< all the items of _itemMap, for nearest queries
+            bool _treeStale; ///< _tree must be built before its next query
+
+            bool _cacheEnabled;
+            CacheMap _cache; ///< neighbours computed during the current round (saving them allocates memory)
+            unsigned long _cacheHits;
+            unsigned long _cacheMisses;
             double _xOffset;
             double _yOffset;
+
+            std::vector<SpatialGrid::ItemVector*> _buffers; ///< query buffers not borrowed
+
+            TeamRound *_teamRounds; ///< one per Team, units of the teams played by a TeamPlayFunction
+        };
+
+
+        class ItemManager::CacheEntry
+        {
+        public:
+            SpatialGrid::ItemVector neighbours;
+            unsigned long stamp; ///< grid stamp when the neighbours were computed
+        };
+
+
+        class ItemManager::TeamRound
+        {
+        public:
+            TeamRound() : play(NULL) {}
+
+            TeamPlayFunction *play; ///< NULL if the units of the team are played one by one
+            std::vector<Base*> bases;
+            std::vector<MiningShip*> miningShips;
+            std::vector<Fighter*> fighters;
         };
 
     } // namespace aiwar::core
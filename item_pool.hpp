@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ITEM_POOL_HPP
+#define ITEM_POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Free-list allocator for items of one concrete class
+         *
+         * Storage is allocated by blocks and never given back to the heap
+         * before the pool is destroyed: a released slot is reused by the next
+         * allocation. It is meant to be used by a class-specific operator new
+         * and operator delete, so that a delete through an Item* (virtual
+         * destructor) gives back the address of the complete object whatever
+         * the virtual inheritance layout is.
+         */
+        template<class T>
+        class ItemPool
+        {
+        public:
+            ItemPool(std::size_t blockSize = 64)
+                : _blockSize(blockSize ? blockSize : 1), _free(NULL), _inUse(0), _highWaterMark(0)
+            {
+            }
+
+            ~ItemPool()
+            {
+                typename std::vector<Slot*>::iterator it;
+                for(it = _blocks.begin() ; it != _blocks.end() ; ++it)
+                    delete [] *it;
+            }
+
+            /**
+             * \brief Get storage for one T
+             * \param size Size asked to operator new, a derived class bigger than T gets global storage
+             * \return Uninitialized storage
+             */
+            void* allocate(std::size_t size)
+            {
+                if(size > sizeof(T))
+                    return ::operator new(size);
+
+                if(!_free)
+                    _grow();
+
+                Slot *s = _free;
+                _free = s->next;
+
+                if(++_inUse > _highWaterMark)
+                    _highWaterMark = _inUse;
+
+                return s;
+            }
+
+            /**
+             * \brief Give back storage got from allocate()
+             * \param p The storage, can be NULL
+             * \param size The same size as the one given to allocate()
+             */
+            void release(void *p, std::size_t size)
+            {
+                if(!p)
+                    return;
+
+                if(size > sizeof(T))
+                {
+                    ::operator delete(p);
+                    return;
+                }
+
+                Slot *s = static_cast<Slot*>(p);
+                s->next = _free;
+                _free = s;
+                _inUse--;
+            }
+
+            /**
+             * \brief Number of objects currently alive in the pool
+             */
+            std::size_t inUse() const
+            {
+                return _inUse;
+            }
+
+            /**
+             * \brief Maximum number of objects alive in the pool at the same time
+             */
+            std::size_t highWaterMark() const
+            {
+                return _highWaterMark;
+            }
+
+            /**
+             * \brief Number of slots allocated from the heap
+             */
+            std::size_t capacity() const
+            {
+                return _blocks.size() * _blockSize;
+            }
+
+        private:
+            // the other members are only there for the alignment
+            union Slot
+            {
+                Slot *next;
+                char data[sizeof(T)];
+                long double ld;
+                long long ll;
+                void *p;
+            };
+
+            // no copy
+            ItemPool(const ItemPool&);
+            ItemPool& operator=(const ItemPool&);
+
+            void _grow()
+            {
+                Slot *block = new Slot[_blockSize];
+                _blocks.push_back(block);
+
+                // chain the new slots, the first one is given first
+                for(std::size_t i = _blockSize ; i > 0 ; --i)
+                {
+                    block[i-1].next = _free;
+                    _free = &block[i-1];
+                }
+            }
+
+            const std::size_t _blockSize;
+            std::vector<Slot*> _blocks;
+            Slot *_free;
+            std::size_t _inUse;
+            std::size_t _highWaterMark;
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* ITEM_POOL_HPP */
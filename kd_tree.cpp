@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kd_tree.hpp"
+
+#include "item.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace aiwar::core;
+
+namespace {
+
+const std::size_t NO_NODE = static_cast<std::size_t>(-1);
+
+unsigned int maskOf(const Item *item)
+{
+    return (1u << item->_kind()) | ((1u << item->_tagTeam()) << 16);
+}
+
+} // anonymous namespace
+
+// state of a query
+class KdTree::Search
+{
+public:
+    double px;
+    double py;
+    std::size_t k;
+    unsigned int kinds; ///< kinds of the filter, in the layout of Node::mask
+    unsigned int teams; ///< teams of the filter, in the layout of Node::mask
+    const NeighbourFilter *filter;
+    double maxRadius;
+    const Item *exclude;
+    double drift;
+
+    // a subtree may hold a candidate
+    bool accept(unsigned int mask) const
+    {
+        return (kinds == 0 || (mask & kinds) != 0) && (teams == 0 || (mask & teams) != 0);
+    }
+};
+
+KdTree::KdTree() : _drift(0.0)
+{
+}
+
+KdTree::~KdTree()
+{
+}
+
+void KdTree::build(const ItemVector &items)
+{
+    clear();
+
+    _nodes.reserve(items.size());
+    KinematicStore::Slot slots = 0;
+    ItemVector::const_iterator it;
+    for(it = items.begin() ; it != items.end() ; ++it)
+    {
+        Item *item = *it;
+        if(item->_toRemove())
+            continue;
+
+        Node n;
+        n.x = item->xpos();
+        n.y = item->ypos();
+        n.item = item;
+        n.mask = maskOf(item);
+        n.axis = 0;
+        _nodes.push_back(n);
+
+        if(item->_getSlot() >= slots)
+            slots = item->_getSlot() + 1;
+    }
+
+    _build(0, _nodes.size());
+
+    _nodeOfSlot.assign(slots, NO_NODE);
+    for(std::size_t i = 0 ; i < _nodes.size() ; ++i)
+        _nodeOfSlot[_nodes[i].item->_getSlot()] = i;
+}
+
+namespace {
+
+// sort nodes along one axis
+template<class N>
+class AxisLess
+{
+public:
+    AxisLess(unsigned char axis) : _axis(axis) {}
+
+    bool operator()(const N &a, const N &b) const
+    {
+        return _axis == 0 ? a.x < b.x : a.y < b.y;
+    }
+
+private:
+    unsigned char _axis;
+};
+
+} // anonymous namespace
+
+void KdTree::_build(std::size_t lo, std::size_t hi)
+{
+    if(lo >= hi)
+        return;
+
+    // split along the largest extent
+    double xmin = _nodes[lo].x, xmax = xmin, ymin = _nodes[lo].y, ymax = ymin;
+    for(std::size_t i = lo + 1 ; i < hi ; ++i)
+    {
+        xmin = std::min(xmin, _nodes[i].x);
+        xmax = std::max(xmax, _nodes[i].x);
+        ymin = std::min(ymin, _nodes[i].y);
+        ymax = std::max(ymax, _nodes[i].y);
+    }
+    unsigned char axis = (xmax - xmin >= ymax - ymin) ? 0 : 1;
+
+    std::size_t mid = (lo + hi) / 2;
+    std::nth_element(_nodes.begin() + lo, _nodes.begin() + mid, _nodes.begin() + hi, AxisLess<Node>(axis));
+    _nodes[mid].axis = axis;
+
+    _build(lo, mid);
+    _build(mid + 1, hi);
+
+    unsigned int mask = maskOf(_nodes[mid].item);
+    if(lo < mid)
+        mask |= _nodes[(lo + mid) / 2].mask;
+    if(mid + 1 < hi)
+        mask |= _nodes[(mid + 1 + hi) / 2].mask;
+    _nodes[mid].mask = mask;
+}
+
+void KdTree::insert(Item *item)
+{
+    _fresh.push_back(item);
+}
+
+void KdTree::remove(Item *item)
+{
+    KinematicStore::Slot slot = item->_getSlot();
+    if(slot < _nodeOfSlot.size() && _nodeOfSlot[slot] != NO_NODE && _nodes[_nodeOfSlot[slot]].item == item)
+    {
+        _nodes[_nodeOfSlot[slot]].item = NULL;
+        _nodeOfSlot[slot] = NO_NODE;
+        return;
+    }
+
+    ItemVector::iterator it = std::find(_fresh.begin(), _fresh.end(), item);
+    if(it != _fresh.end())
+        _fresh.erase(it);
+}
+
+void KdTree::itemMoved(Item *item)
+{
+    KinematicStore::Slot slot = item->_getSlot();
+    if(slot >= _nodeOfSlot.size() || _nodeOfSlot[slot] == NO_NODE)
+        return;
+
+    const Node &n = _nodes[_nodeOfSlot[slot]];
+    if(n.item != item)
+        return;
+
+    double d = item->distanceTo(n.x, n.y);
+    if(d > _drift)
+        _drift = d;
+}
+
+Item* KdTree::nearest(double px, double py, const NeighbourFilter &filter, double maxRadius, const Item *exclude) const
+{
+    _query(px, py, 1, filter, maxRadius, exclude);
+    return _heap.empty() ? NULL : _heap.front().item;
+}
+
+void KdTree::kNearest(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, const Item *exclude, ItemVector &res) const
+{
+    res.clear();
+    _query(px, py, k, filter, maxRadius, exclude);
+
+    std::sort_heap(_heap.begin(), _heap.end());
+    std::vector<Candidate>::const_iterator it;
+    for(it = _heap.begin() ; it != _heap.end() ; ++it)
+        res.push_back(it->item);
+}
+
+void KdTree::_query(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, const Item *exclude) const
+{
+    _heap.clear();
+    if(k == 0)
+        return;
+
+    Search s;
+    s.px = px;
+    s.py = py;
+    s.k = k;
+    s.kinds = filter.kindMask();
+    s.teams = filter.teamMask() << 16;
+    s.filter = &filter;
+    s.maxRadius = maxRadius;
+    s.exclude = exclude;
+    s.drift = _drift;
+
+    _search(0, _nodes.size(), s);
+
+    ItemVector::const_iterator it;
+    for(it = _fresh.begin() ; it != _fresh.end() ; ++it)
+        _offer(*it, s);
+}
+
+void KdTree::_search(std::size_t lo, std::size_t hi, Search &s) const
+{
+    if(lo >= hi)
+        return;
+
+    std::size_t mid = (lo + hi) / 2;
+    const Node &n = _nodes[mid];
+    if(!s.accept(n.mask))
+        return;
+
+    if(n.item)
+        _offer(n.item, s);
+
+    // nearest half first
+    double diff = (n.axis == 0) ? s.px - n.x : s.py - n.y;
+    if(diff < 0.0)
+        _search(lo, mid, s);
+    else
+        _search(mid + 1, hi, s);
+
+    // an item of the other half is at least |diff| - drift away
+    double bound = (_heap.size() < s.k) ? s.maxRadius : std::sqrt(_heap.front().d2);
+    if(std::fabs(diff) - s.drift <= bound)
+    {
+        if(diff < 0.0)
+            _search(mid + 1, hi, s);
+        else
+            _search(lo, mid, s);
+    }
+}
+
+void KdTree::_offer(Item *item, Search &s) const
+{
+    if(item == s.exclude || item->_toRemove() || !s.filter->accept(item))
+        return;
+
+    const double dx = item->xpos() - s.px, dy = item->ypos() - s.py;
+    Candidate c;
+    c.d2 = dx * dx + dy * dy;
+    if(c.d2 > s.maxRadius * s.maxRadius)
+        return;
+
+    c.key = item->_getKey();
+    c.item = item;
+    if(_heap.size() < s.k)
+    {
+        _heap.push_back(c);
+        std::push_heap(_heap.begin(), _heap.end());
+    }
+    else if(c < _heap.front())
+    {
+        std::pop_heap(_heap.begin(), _heap.end());
+        _heap.back() = c;
+        std::push_heap(_heap.begin(), _heap.end());
+    }
+}
+
+void KdTree::clear()
+{
+    _nodes.clear();
+    _nodeOfSlot.clear();
+    _fresh.clear();
+    _drift = 0.0;
+}
+
+std::size_t KdTree::size() const
+{
+    std::size_t n = _fresh.size();
+    std::vector<Node>::const_iterator it;
+    for(it = _nodes.begin() ; it != _nodes.end() ; ++it)
+    {
+        if(it->item)
+            n++;
+    }
+    return n;
+}
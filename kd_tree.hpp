@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KD_TREE_HPP
+#define KD_TREE_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "spatial_grid.hpp" // for SpatialGrid::ItemVector
+#include "slot_map.hpp"
+
+namespace aiwar {
+    namespace core {
+
+        class Item;
+        class NeighbourFilter;
+
+        /**
+         * \brief 2d-tree of the items, for nearest neighbour queries
+         *
+         * The tree is balanced and stored implicitly in one array: the node of the
+         * range [lo, hi) is at (lo + hi) / 2, its children are the two halves.
+         * Each node also keeps the kinds and teams found in its subtree, so a
+         * filtered query skips the subtrees without any candidate.
+         *
+         * The tree is built from a snapshot of the positions and is not
+         * rebalanced afterwards: moved items only increase a drift, the largest
+         * distance between an item and its snapshot position, which widens the
+         * pruning so results stay exact. Removed items are left out, inserted
+         * items are kept apart and scanned linearly until the next build().
+         */
+        class KdTree
+        {
+        public:
+            typedef SpatialGrid::ItemVector ItemVector;
+
+            KdTree();
+            ~KdTree();
+
+            /**
+             * \brief Rebuild the tree with the current positions of items
+             * \param items The items, the ones to remove are left out
+             */
+            void build(const ItemVector &items);
+
+            void insert(Item *item);
+            void remove(Item *item);
+
+            /**
+             * \brief Must be called each time an item position has changed
+             */
+            void itemMoved(Item *item);
+
+            /**
+             * \brief Get the nearest item accepted by a filter
+             * \param px x position of the point
+             * \param py y position of the point
+             * \param filter Kinds and teams of the accepted items
+             * \param maxRadius Items farther than maxRadius are ignored
+             * \param exclude An item to ignore, usually the one asking, can be NULL
+             * \return The nearest item, the one with the lowest key if several are at the same distance, NULL if none
+             */
+            Item* nearest(double px, double py, const NeighbourFilter &filter, double maxRadius, const Item *exclude) const;
+
+            /**
+             * \brief Get the k nearest items accepted by a filter
+             * \param res Cleared then filled with at most k items, nearest first. Equal distances are sorted by key
+             *
+             * Other parameters are the ones of nearest().
+             */
+            void kNearest(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, const Item *exclude, ItemVector &res) const;
+
+            void clear();
+            std::size_t size() const;
+
+        private:
+            class Node
+            {
+            public:
+                double x; ///< snapshot position
+                double y;
+                Item *item; ///< NULL for a removed item
+                unsigned int mask; ///< kinds | teams << 16 of the subtree
+                unsigned char axis; ///< 0 to split on x, 1 on y
+            };
+
+            class Candidate
+            {
+            public:
+                double d2; ///< squared distance
+                SlotMap<Item*>::Key key;
+                Item *item;
+
+                // a candidate is less than another if it is nearer
+                bool operator<(const Candidate &o) const { return d2 < o.d2 || (d2 == o.d2 && key < o.key); }
+            };
+
+            class Search;
+
+            // no copy
+            KdTree(const KdTree&);
+            KdTree& operator=(const KdTree&);
+
+            void _build(std::size_t lo, std::size_t hi);
+            void _search(std::size_t lo, std::size_t hi, Search &s) const;
+            void _offer(Item *item, Search &s) const;
+            void _query(double px, double py, std::size_t k, const NeighbourFilter &filter, double maxRadius, const Item *exclude) const;
+
+            std::vector<Node> _nodes;
+
+            std::vector<std::size_t> _nodeOfSlot; ///< node of each KinematicStore slot, NO_NODE if none
+            ItemVector _fresh; ///< items inserted since the last build()
+            double _drift; ///< largest distance between an item and its snapshot position
+
+            mutable std::vector<Candidate> _heap; ///< the k best candidates of the last query, worst first
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* KD_TREE_HPP */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kinematics.hpp"
+
+#include <cmath>
+
+#ifndef M_PI
+#       define M_PI 3.1415926535897932384626433832795
+#endif
+
+using namespace aiwar::core;
+
+KinematicStore::KinematicStore()
+{
+}
+
+KinematicStore::~KinematicStore()
+{
+}
+
+KinematicStore::Slot KinematicStore::add(double px, double py)
+{
+    Slot s;
+    if(!_free.empty())
+    {
+        s = _free.back();
+        _free.pop_back();
+    }
+    else
+    {
+        s = static_cast<Slot>(_x.size());
+        _x.push_back(0.0);
+        _y.push_back(0.0);
+        _hx.push_back(0.0);
+        _hy.push_back(0.0);
+        _speed.push_back(0.0);
+        _fuel.push_back(0);
+    }
+
+    _x[s] = px;
+    _y[s] = py;
+    _speed[s] = 0.0;
+    _fuel[s] = 0;
+    setHeading(s, 0.0);
+
+    return s;
+}
+
+void KinematicStore::remove(Slot s)
+{
+    _speed[s] = 0.0;
+    _free.push_back(s);
+}
+
+KinematicStore::Slot KinematicStore::size() const
+{
+    return static_cast<Slot>(_x.size());
+}
+
+void KinematicStore::setHeading(Slot s, double angle)
+{
+    // same expressions as the per-move computation it replaces, so positions do not change
+    _hx[s] = cos(angle * M_PI / 180.0);
+    _hy[s] = -sin(angle * M_PI / 180.0);
+}
+
+double KinematicStore::headTo(Slot s, double px, double py)
+{
+    const double dx = px - _x[s];
+    const double dy = py - _y[s];
+    const double d = sqrt(dx * dx + dy * dy);
+    if(d > 0.0)
+    {
+        _hx[s] = dx / d;
+        _hy[s] = dy / d;
+    }
+    return d;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KINEMATICS_HPP
+#define KINEMATICS_HPP
+
+#include <vector>
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Structure of arrays holding the kinematic state of all items
+         *
+         * Each item owns a slot: its position for every item, plus its heading,
+         * speed and fuel for the Movable ones. The heading is kept as a unit
+         * vector in screen coordinates (y grows downward), so a step is a
+         * multiply-add without any trigonometry.
+         *
+         * A step is applied at once to one slot with step(): the items after it
+         * in the item loop see its new position.
+         */
+        class KinematicStore
+        {
+        public:
+            typedef unsigned int Slot;
+
+            KinematicStore();
+            ~KinematicStore();
+
+            /**
+             * \brief Get a new slot, speed and fuel are null and the heading is 0 degree
+             * \return The slot, slots of removed items are reused
+             */
+            Slot add(double px, double py);
+            void remove(Slot s);
+
+            /**
+             * \brief Number of slots, free slots included
+             */
+            Slot size() const;
+
+            double x(Slot s) const { return _x[s]; }
+            double y(Slot s) const { return _y[s]; }
+            void setPosition(Slot s, double px, double py) { _x[s] = px; _y[s] = py; }
+
+            double speed(Slot s) const { return _speed[s]; }
+            void setSpeed(Slot s, double speed) { _speed[s] = speed; }
+
+            unsigned int fuel(Slot s) const { return _fuel[s]; }
+            void setFuel(Slot s, unsigned int fuel) { _fuel[s] = fuel; }
+
+            /**
+             * \brief Set the heading of a slot
+             * \param s The slot
+             * \param angle Direction in degree, trigonometric system
+             */
+            void setHeading(Slot s, double angle);
+
+            /**
+             * \brief Turn a slot toward a point, without trigonometry
+             * \param s The slot
+             * \param px x position of the point
+             * \param py y position of the point
+             * \return The distance to the point. If it is null the heading does not change
+             */
+            double headTo(Slot s, double px, double py);
+
+            double headingX(Slot s) const { return _hx[s]; }
+            double headingY(Slot s) const { return _hy[s]; }
+
+            /**
+             * \brief Move a slot now by its speed along its heading
+             */
+            void step(Slot s) { _x[s] += _hx[s] * _speed[s]; _y[s] += _hy[s] * _speed[s]; }
+
+        private:
+            // no copy
+            KinematicStore(const KinematicStore&);
+            KinematicStore& operator=(const KinematicStore&);
+
+            std::vector<double> _x;
+            std::vector<double> _y;
+            std::vector<double> _hx; ///< cos(angle)
+            std::vector<double> _hy; ///< -sin(angle), y axis is downward
+            std::vector<double> _speed;
+            std::vector<unsigned int> _fuel;
+
+            std::vector<Slot> _free; ///< removed slots, reused by add()
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* KINEMATICS_HPP */
@@ -27,10 +27,12 @@ using namespace aiwar::core;
 
 Living::Living(GameManager& gm, Key k) : Item(gm, k), _maxLife(0), _life(0)
 {
+    _tag |= LIVING_CAP;
 }
 
 Living::Living(GameManager& gm, Key k, unsigned int life, unsigned int maxLife) : Item(gm, k), _maxLife(maxLife), _life(life)
 {
+    _tag |= LIVING_CAP;
 }
 
 Living::~Living()
@@ -38,6 +40,11 @@ Living::~Living()
 //    std::cout << "~Living: " << this << std::endl;
 }
 
+Living* Living::_asLiving()
+{
+    return this;
+}
+
 unsigned int Living::_takeLife(unsigned int v, bool kill)
 {
     unsigned int tmp = _life;
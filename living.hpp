@@ -31,6 +31,8 @@ namespace aiwar {
 
             virtual ~Living();
 
+            Living* _asLiving();
+
             /**
              * \brief Get the current number of life points
              * \return The current number of life points
@@ -429,7 +429,8 @@ logging.basicConfig(filename=logsFilename, level=logging.ERROR)
 
 
 result_txt = {0: "draw", 1: "blue wins", 2: "red wins",
-              11: "blue error", 12: "red error", 255: "error"}
+              11: "blue error", 12: "red error",
+              21: "blue forfeit", 22: "red forfeit", 255: "error"}
 result_int = {value: key for (key, value) in result_txt.iteritems()}
 
 bluePlayer, redPlayer, mapName, players, playersParams, _ = readConfig(configFile)
@@ -32,8 +32,11 @@
 #include "handler_dummy.hpp"
 #include "handler_example.hpp"
 #include "python_handler.hpp"
+#include "handler_process.hpp"
+#include "handler_native.hpp"
 
 #include "config.hpp"
+#include "profiler.hpp"
 
 #include "renderer_interface.hpp"
 #include "renderer_dummy.hpp"
@@ -83,6 +86,11 @@ int main(int argc, char* argv[])
 //    std::cout << cfg.dump();
 //    return 0;
 
+    if(!cfg.profile.empty())
+        Profiler::instance().enable();
+    if(cfg.perfCounters)
+        PerfCounters::instance().enable();
+
     // initialize pseudo-random
     std::srand(cfg.seed);
     std::cout << "Pseudo-random generator seed: " << cfg.seed << std::endl;
@@ -113,6 +121,27 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    HandlerProcess prh;
+    if(!prh.initialize())
+    {
+        std::cerr << "Fail to initialize process handler\n";
+        ph.finalize();
+        eh.finalize();
+        th.finalize();
+        return -1;
+    }
+
+    HandlerNative nh;
+    if(!nh.initialize())
+    {
+        std::cerr << "Fail to initialize native handler\n";
+        prh.finalize();
+        ph.finalize();
+        eh.finalize();
+        th.finalize();
+        return -1;
+    }
+
     /*** Load teams ***/
 
     // load blue Team
@@ -124,12 +153,18 @@ int main(int argc, char* argv[])
         hblue = &eh;
     else if(pblue.handler == "python")
         hblue = &ph;
+    else if(pblue.handler == "process")
+        hblue = &prh;
+    else if(pblue.handler == "native")
+        hblue = &nh;
     else
     {
         std::cerr << "Unknown handler name for blue player: " << pblue.handler << std::endl;
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -139,6 +174,8 @@ int main(int argc, char* argv[])
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -151,12 +188,18 @@ int main(int argc, char* argv[])
         hred = &eh;
     else if(pred.handler == "python")
         hred = &ph;
+    else if(pred.handler == "process")
+        hred = &prh;
+    else if(pred.handler == "native")
+        hred = &nh;
     else
     {
         std::cerr << "Unknown handler name for red team: " << pred.handler << std::endl;
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -166,6 +209,8 @@ int main(int argc, char* argv[])
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -189,6 +234,8 @@ int main(int argc, char* argv[])
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -198,6 +245,8 @@ int main(int argc, char* argv[])
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         return -1;
     }
 
@@ -205,8 +254,8 @@ int main(int argc, char* argv[])
 
     GameManager gm;
 
-    gm.registerTeam(BLUE_TEAM, hblue->get_BaseHandler(cfg.blue), hblue->get_MiningShipHandler(cfg.blue), hblue->get_FighterHandler(cfg.blue));
-    gm.registerTeam(RED_TEAM, hred->get_BaseHandler(cfg.red), hred->get_MiningShipHandler(cfg.red), hred->get_FighterHandler(cfg.red));
+    gm.registerTeam(BLUE_TEAM, hblue->get_BaseHandler(cfg.blue), hblue->get_MiningShipHandler(cfg.blue), hblue->get_FighterHandler(cfg.blue), hblue->get_TeamHandler(cfg.blue));
+    gm.registerTeam(RED_TEAM, hred->get_BaseHandler(cfg.red), hred->get_MiningShipHandler(cfg.red), hred->get_FighterHandler(cfg.red), hred->get_TeamHandler(cfg.red));
 
     if(!gm.init())
     {
@@ -214,13 +263,15 @@ int main(int argc, char* argv[])
         th.finalize();
         eh.finalize();
         ph.finalize();
+        prh.finalize();
+        nh.finalize();
         renderer->finalize();
         return -1;
     }
 
     /*** enter the main loop ***/
     bool done = false, gameover = false;
-    Team winner = NO_TEAM, loser = NO_TEAM;
+    Team winner = NO_TEAM, loser = NO_TEAM, forfeit = NO_TEAM;
     unsigned int tick = 0;
 
     // game over ?
@@ -240,11 +291,22 @@ int main(int argc, char* argv[])
 
     while(!done)
     {
+        ProfileScope s(Profiler::TICK);
+
         // play
         try
         {
             gm.update(tick++);
         }
+        catch(const aiwar::core::BudgetError &e)
+        {
+            std::cout << "********** GameOver *********\n";
+            std::string name = (e.team() == BLUE_TEAM) ? cfg.players[cfg.blue].name : cfg.players[cfg.red].name;
+            std::cout << "Team " << name << " forfeits: " << e.what() << std::endl;
+            forfeit = e.team();
+            winner = (e.team() == BLUE_TEAM) ? RED_TEAM : BLUE_TEAM;
+            gameover = true;
+        }
         catch(const aiwar::core::HandlerError &e)
         {
             std::cout << "********** GameOver *********\n";
@@ -268,11 +330,15 @@ int main(int argc, char* argv[])
         }
 
         // render
+        ProfileScope r(Profiler::RENDER);
         done = !renderer->render(gm.getItemManager(), gm.getStatManager(), gameover, winner) || gameover;
     }
 
     std::cout << "Number of rounds: " << gm.getStatManager().round() << "\n";
 
+    if(!cfg.profile.empty())
+        Profiler::instance().write(cfg.profile);
+
     renderer->finalize();
 
     // unload teams
@@ -283,13 +349,19 @@ int main(int argc, char* argv[])
     th.finalize();
     eh.finalize();
     ph.finalize();
+    prh.finalize();
+    nh.finalize();
 
     std::cout << "Exiting gracefully...\n";
     std::cout << "(seed: " << cfg.seed << ")\n";
 
     int rc = 0;
 
-    if(loser != NO_TEAM)
+    if(forfeit != NO_TEAM)
+    {
+        rc = (forfeit == BLUE_TEAM) ? 21 : 22;
+    }
+    else if(loser != NO_TEAM)
     {
         switch(loser)
         {
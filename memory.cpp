@@ -27,6 +27,7 @@ using namespace aiwar::core;
 
 Memory::Memory(GameManager& gm, Key k, unsigned int size) : Item(gm, k), _memory(size)
 {
+    _tag |= MEMORY_CAP;
 //    std::cout << "sizeof MemorySlot: " << sizeof(MemorySlot) << std::endl;
     assert(sizeof(MemorySlot) == 4); // check size of MemorySlot -> must be 32 bits
 }
@@ -35,6 +36,11 @@ Memory::~Memory()
 {
 }
 
+Memory* Memory::_asMemory()
+{
+    return this;
+}
+
 unsigned int Memory::memorySize() const
 {
     return _memory.size();
@@ -35,6 +35,8 @@ namespace aiwar {
         public:
             virtual ~Memory();
 
+            Memory* _asMemory();
+
             unsigned int memorySize() const;
 
             template<typename T>
@@ -77,13 +79,11 @@ namespace aiwar {
 
             // manage playability : if we are a Playable item, we check if the other item is also a playable item. If it is the case, we check if the other item is a friend. Else we do not exchange information. If we are not a Playable item, we do no other check and we accept the exchange.
 
-            const Playable *self = dynamic_cast<const Playable*>(this);
-            if(self)
+            if(_has(PLAYABLE_CAP))
             {
-                const Playable *o = dynamic_cast<const Playable*>(other);
-                if(o)
+                if(other->_has(PLAYABLE_CAP))
                 {
-                    if(!self->isFriend(o))
+                    if(_tagTeam() != other->_tagTeam()) // same as Playable::isFriend()
                     {
                         std::cerr << "Memory::getMemory: item is not a friend" << std::endl;
                         return T();
@@ -110,13 +110,11 @@ namespace aiwar {
 
             // manage playability : if we are a Playable item, we check if the other item is also a playable item. If it is the case, we check if the other item is a friend. Else we do not exchange information. If we are not a Playable item, we do no other check and we accept the exchange.
 
-            Playable *self = dynamic_cast<Playable*>(this);
-            if(self)
+            if(_has(PLAYABLE_CAP))
             {
-                Playable *o = dynamic_cast<Playable*>(other);
-                if(o)
+                if(other->_has(PLAYABLE_CAP))
                 {
-                    if(!self->isFriend(o))
+                    if(_tagTeam() != other->_tagTeam()) // same as Playable::isFriend()
                     {
                         std::cerr << "Memory::setMemory: item is not a friend" << std::endl;
                         return;
@@ -30,6 +30,12 @@ Mineral::Mineral(GameManager& gm, Key k, double px, double py)
     : Item(gm, k, px, py, Config::instance().MINERAL_SIZE_X, Config::instance().MINERAL_SIZE_Y),
       Living(gm, k, Config::instance().MINERAL_LIFE, Config::instance().MINERAL_LIFE)
 {
+    _tag |= MINERAL_KIND;
+}
+
+Mineral* Mineral::_asMineral()
+{
+    return this;
 }
 
 void Mineral::update(unsigned int)
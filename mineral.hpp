@@ -31,6 +31,8 @@ namespace aiwar {
         public:
             Mineral(GameManager& gm, Key k, double px, double py);
 
+            Mineral* _asMineral();
+
             void update(unsigned int tick);
 
             std::string _dump() const;
@@ -38,12 +38,35 @@ MiningShip::MiningShip(GameManager& gm, Key k, double xpos, double ypos, Team te
       _mineralStorage(0),
       _hasExtracted(false)
 {
+    _tag |= MININGSHIP_KIND;
 }
 
 MiningShip::~MiningShip()
 {
 }
 
+MiningShip* MiningShip::_asMiningShip()
+{
+    return this;
+}
+
+ItemPool<MiningShip> MiningShip::_pool;
+
+void* MiningShip::operator new(std::size_t size)
+{
+    return _pool.allocate(size);
+}
+
+void MiningShip::operator delete(void *p, std::size_t size)
+{
+    _pool.release(p, size);
+}
+
+const ItemPool<MiningShip>& MiningShip::pool()
+{
+    return _pool;
+}
+
 void MiningShip::_preUpdate(unsigned int ticks)
 {
     Movable::_preUpdate(ticks);
@@ -52,6 +75,11 @@ void MiningShip::_preUpdate(unsigned int ticks)
     _hasExtracted = false;
 }
 
+void MiningShip::_startRound(unsigned int tick)
+{
+    _preUpdate(tick);
+}
+
 void MiningShip::update(unsigned int tick)
 {
     _preUpdate(tick);
@@ -27,6 +27,7 @@
 #include "living.hpp"
 #include "playable.hpp"
 #include "memory.hpp"
+#include "item_pool.hpp"
 
 namespace aiwar {
     namespace core {
@@ -40,7 +41,18 @@ namespace aiwar {
             MiningShip(GameManager& gm, Key k, double xpos, double ypos, Team team, PlayFunction& pf);
             ~MiningShip();
 
+            MiningShip* _asMiningShip();
+
+            static void* operator new(std::size_t size);
+            static void operator delete(void *p, std::size_t size);
+
+            /**
+             * \brief Storage of all the mining ships, for statistics
+             */
+            static const ItemPool<MiningShip>& pool();
+
             void update(unsigned int tick);
+            void _startRound(unsigned int tick);
 
             unsigned int extract(Mineral *m);
             unsigned int mineralStorage() const;
@@ -64,6 +76,8 @@ namespace aiwar {
             unsigned int _mineralStorage; ///< Number of mineral units stored
 
             bool _hasExtracted;
+
+            static ItemPool<MiningShip> _pool;
         };
 
     } // namespace aiwar::core
@@ -33,6 +33,7 @@ Missile::Missile(GameManager& gm, Key k, double px, double py, Living* target)
       Living(gm, k, Config::instance().MISSILE_LIFE, Config::instance().MISSILE_LIFE),
       _target(target->_getKey())
 {
+    _tag |= MISSILE_KIND;
     // set angle
     rotateTo(target);
 }
@@ -41,12 +42,34 @@ Missile::~Missile()
 {
 }
 
+Missile* Missile::_asMissile()
+{
+    return this;
+}
+
+ItemPool<Missile> Missile::_pool;
+
+void* Missile::operator new(std::size_t size)
+{
+    return _pool.allocate(size);
+}
+
+void Missile::operator delete(void *p, std::size_t size)
+{
+    _pool.release(p, size);
+}
+
+const ItemPool<Missile>& Missile::pool()
+{
+    return _pool;
+}
+
 void Missile::update(unsigned int tick)
 {
     Movable::_preUpdate(tick);
 
     // check if the target is still alive
-    Living *target = dynamic_cast<Living*>(_im.get(_target));
+    Living *target = item_cast<Living>(_im.get(_target));
     if(!target || target->_toRemove())
     {
         // no more target, auto destruction
@@ -55,13 +78,12 @@ void Missile::update(unsigned int tick)
     }
     else
     {
-        // move to the target
-        rotateTo(target);
-        double d = distanceTo(target);
+        // move to the target, the heading is computed without trigonometry
+        double d = _headTo(target->xpos(), target->ypos());
         bool reached = false;
-        if(d <= _speed)
+        if(d <= _getSpeed())
         {
-            _speed = d;
+            _setSpeed(d);
             reached = true;
         }
         move();
@@ -74,7 +96,7 @@ void Missile::update(unsigned int tick)
             _sm.itemDestroyed(this);
         }
         // enough fuel to continue ?
-        else if(_fuel < Config::instance().MISSILE_MOVE_CONSO)
+        else if(fuel() < Config::instance().MISSILE_MOVE_CONSO)
         {
             _toRemoveFlag = true;
             _sm.itemDestroyed(this);
@@ -23,6 +23,7 @@
 #include "item.hpp"
 #include "movable.hpp"
 #include "living.hpp"
+#include "item_pool.hpp"
 
 namespace aiwar {
     namespace core {
@@ -33,12 +34,24 @@ namespace aiwar {
             Missile(GameManager& gm, Key k, double px, double py, Living* target);
             ~Missile();
 
+            Missile* _asMissile();
+
+            static void* operator new(std::size_t size);
+            static void operator delete(void *p, std::size_t size);
+
+            /**
+             * \brief Storage of all the missiles, for statistics
+             */
+            static const ItemPool<Missile>& pool();
+
             void update(unsigned int tick);
 
             std::string _dump() const;
 
         private:
             const Key _target;
+
+            static ItemPool<Missile> _pool;
         };
 
     } // namespace aiwar::core
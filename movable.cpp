@@ -34,14 +34,23 @@ Movable::~Movable()
 {
 }
 
+Movable* Movable::_asMovable()
+{
+    return this;
+}
+
 Movable::Movable(GameManager& gm, Key k, double speed, unsigned int startFuel, unsigned int maxFuel, unsigned int moveConso, double angle)
-    : Item(gm, k), _speed(speed), _angle(angle), _fuel(startFuel), _maxFuel(maxFuel), _moveConso(moveConso), _hasMoved(false)
+    : Item(gm, k), _angle(0.0), _angleStale(false), _maxFuel(maxFuel), _moveConso(moveConso), _hasMoved(false)
 {
+    _tag |= MOVABLE_CAP;
+    _kin.setSpeed(_slot, speed);
+    _kin.setFuel(_slot, startFuel);
+    _setAngle(angle);
 }
 
 void Movable::rotateOf(double angle)
 {
-    _angle += angle;
+    _setAngle(this->angle() + angle);
 }
 
 void Movable::rotateTo(const Item* target)
@@ -51,29 +60,76 @@ void Movable::rotateTo(const Item* target)
 
 void Movable::rotateTo(double px, double py)
 {
-    _angle = atan2(_ypos-py, px-_xpos) * 180.0 / M_PI;
+    _setAngle(atan2(ypos()-py, px-xpos()) * 180.0 / M_PI);
 }
 
 void Movable::move()
 {
     if(!_hasMoved && doMove())
     {
-        _xpos += cos(_angle * M_PI / 180.0) * _speed;
-        _ypos -= sin(_angle * M_PI / 180.0) * _speed;
+        double oldx = xpos(), oldy = ypos();
+        _kin.step(_slot); // heading is up to date, see _setAngle()
+        _im._itemMoved(this, oldx, oldy);
 
         _hasMoved = true;
         _sm.reportActivity();
     }
 }
 
+bool Movable::moveTowards(double px, double py, double stopRadius)
+{
+    if(distanceTo(px, py) <= stopRadius)
+        return false;
+
+    const bool canMove = !_hasMoved;
+    rotateTo(px, py);
+    move();
+    return canMove && _hasMoved;
+}
+
+bool Movable::moveTowards(const Item *target, double stopRadius)
+{
+    return moveTowards(target->xpos(), target->ypos(), stopRadius);
+}
+
+bool Movable::keepDistance(double px, double py, double radius)
+{
+    double d = distanceTo(px, py);
+    if(d == radius)
+        return false;
+
+    // the angle of rotateTo() then rotateOf(180), with one heading update
+    double a = atan2(ypos()-py, px-xpos()) * 180.0 / M_PI;
+    const bool canMove = !_hasMoved;
+    _setAngle(d > radius ? a : a + 180.0);
+    move();
+    return canMove && _hasMoved;
+}
+
+bool Movable::keepDistance(const Item *target, double radius)
+{
+    return keepDistance(target->xpos(), target->ypos(), radius);
+}
+
 double Movable::angle() const
 {
+    if(_angleStale)
+    {
+        _angle = atan2(-_kin.headingY(_slot), _kin.headingX(_slot)) * 180.0 / M_PI;
+        _angleStale = false;
+    }
     return _angle;
 }
 
+double Movable::_headTo(double px, double py)
+{
+    _angleStale = true;
+    return _kin.headTo(_slot, px, py);
+}
+
 unsigned int Movable::fuel() const
 {
-    return _fuel;
+    return _kin.fuel(_slot);
 }
 
 void Movable::_preUpdate(unsigned int)
@@ -83,20 +139,44 @@ void Movable::_preUpdate(unsigned int)
 
 bool Movable::doMove()
 {
-    if(_fuel < _moveConso)
+    unsigned int f = fuel();
+    if(f < _moveConso)
         return false;
 
-    _fuel -= _moveConso;
+    _setFuel(f - _moveConso);
     return true;
 }
 
 unsigned int Movable::_putFuel(unsigned int points)
 {
+    unsigned int f = fuel();
     unsigned int p = points;
-    if(p > _maxFuel - _fuel)
-        p = _maxFuel - _fuel;
+    if(p > _maxFuel - f)
+        p = _maxFuel - f;
 
-    _fuel += p;
+    _setFuel(f + p);
 
     return p;
 }
+
+double Movable::_getSpeed() const
+{
+    return _kin.speed(_slot);
+}
+
+void Movable::_setSpeed(double speed)
+{
+    _kin.setSpeed(_slot, speed);
+}
+
+void Movable::_setFuel(unsigned int fuel)
+{
+    _kin.setFuel(_slot, fuel);
+}
+
+void Movable::_setAngle(double angle)
+{
+    _angle = angle;
+    _angleStale = false;
+    _kin.setHeading(_slot, _angle);
+}
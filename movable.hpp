@@ -30,12 +30,37 @@ namespace aiwar {
         public:
             virtual ~Movable();
 
+            Movable* _asMovable();
+
             void rotateOf(double angle);
             void rotateTo(const Item *target);
             void rotateTo(double px, double py);
 
             void move();
 
+            /**
+             * \brief Go toward a point, and stop once within a radius of it
+             * \param px x position of the point
+             * \param py y position of the point
+             * \param stopRadius The unit does not move if it is at this distance or nearer
+             * \return true if the unit has moved
+             *
+             * Same as rotateTo() then move() when the point is farther than stopRadius:
+             * the last move can end nearer than stopRadius.
+             */
+            bool moveTowards(double px, double py, double stopRadius = 0.0);
+            bool moveTowards(const Item *target, double stopRadius = 0.0);
+
+            /**
+             * \brief Go toward a point if farther than radius, away from it if nearer
+             * \return true if the unit has moved
+             *
+             * Same as rotateTo(), followed by rotateOf(180) to go away, then move().
+             * The unit does not move if it is exactly at radius.
+             */
+            bool keepDistance(double px, double py, double radius);
+            bool keepDistance(const Item *target, double radius);
+
             double angle() const;
 //            double xdest() const;
 //            double ydest() const;
@@ -44,6 +69,14 @@ namespace aiwar {
 
             unsigned int _putFuel(unsigned int points);
 
+            /**
+             * \brief Intern method. Turn toward a point without computing the angle
+             * \return The distance to the point
+             *
+             * The angle is computed back from the heading only if angle() is called.
+             */
+            double _headTo(double px, double py);
+
         protected:
             Movable(GameManager& gm, Key k, double speed = 0.0, unsigned int startFuel = 0, unsigned int maxFuel = 0, unsigned int moveConso = 0, double angle = 0.0);
 
@@ -64,13 +97,25 @@ namespace aiwar {
              */
             virtual bool doMove();
 
-            double _speed; ///< speed of the item
-            double _angle; ///< direction, in degree, use trigonometric system
-            unsigned int _fuel; ///< fuel quantity
+            /**
+             * \brief Speed of the item, stored in the KinematicStore
+             */
+            double _getSpeed() const;
+            void _setSpeed(double speed);
+
+            /**
+             * \brief Set the fuel quantity, stored in the KinematicStore
+             */
+            void _setFuel(unsigned int fuel);
+
+            mutable double _angle; ///< direction, in degree, use trigonometric system. Always set it with _setAngle()
+            mutable bool _angleStale; ///< true if the heading was set by _headTo() and _angle is not up to date
             unsigned int _maxFuel; ///< capacity of the fuel tank
             unsigned int _moveConso; ///< fuel consumption per move
 
         private:
+            void _setAngle(double angle);
+
             double _hasMoved; ///< true if a move has been done for the current step
         };
 
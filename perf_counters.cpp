@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perf_counters.hpp"
+
+#include "profiler.hpp" // for Profiler::Phase
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#       include <linux/perf_event.h>
+#       include <sys/ioctl.h>
+#       include <sys/syscall.h>
+#       include <unistd.h>
+#endif
+
+using namespace aiwar::core;
+
+namespace {
+
+const char* phaseName(int phase)
+{
+    switch(phase)
+    {
+    case Profiler::TICK: return "tick";
+    case Profiler::PLAY: return "play";
+    case Profiler::PYTHON: return "python";
+    case Profiler::NEIGHBOURS: return "neighbours";
+    case Profiler::THINK: return "think";
+    case Profiler::REMOVE: return "remove";
+    case Profiler::MISSILES: return "missiles";
+    case Profiler::ACTIVITY: return "activity";
+    case Profiler::RENDER: return "render";
+    }
+    return "unknown";
+}
+
+const char* eventName(int event)
+{
+    switch(event)
+    {
+    case PerfCounters::CYCLES: return "cycles";
+    case PerfCounters::INSTRUCTIONS: return "instructions";
+    case PerfCounters::L1D_MISSES: return "L1d misses";
+    case PerfCounters::LLC_MISSES: return "LLC misses";
+    case PerfCounters::BRANCH_MISSES: return "branch misses";
+    }
+    return "unknown";
+}
+
+#ifdef __linux__
+void eventAttr(int event, perf_event_attr &attr)
+{
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch(event)
+    {
+    case PerfCounters::CYCLES:
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PerfCounters::INSTRUCTIONS:
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PerfCounters::L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PerfCounters::LLC_MISSES:
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PerfCounters::BRANCH_MISSES:
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+}
+#endif
+
+} // anonymous namespace
+
+
+/*** PerfCounters class ***/
+
+PerfCounters PerfCounters::_instance; // singleton instance
+bool PerfCounters::_enabled = false;
+
+PerfCounters& PerfCounters::instance()
+{
+    return _instance;
+}
+
+PerfCounters::PerfCounters() : _opened(0), _phases(Profiler::RENDER + 1)
+{
+    for(int e = 0 ; e < EVENTS ; ++e)
+    {
+        _fds[e] = -1;
+        _index[e] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for(int e = 0 ; e < EVENTS ; ++e)
+    {
+        if(_fds[e] >= 0)
+            close(_fds[e]);
+    }
+#endif
+}
+
+bool PerfCounters::enable()
+{
+#ifdef __linux__
+    // the first event opened leads the group, the others are read with it
+    int leader = -1, error = 0;
+    for(int e = 0 ; e < EVENTS ; ++e)
+    {
+        perf_event_attr attr;
+        eventAttr(e, attr);
+        attr.disabled = (leader < 0);
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+        if(fd < 0)
+        {
+            error = errno;
+            continue;
+        }
+        if(leader < 0)
+            leader = fd;
+        _fds[e] = fd;
+        _index[e] = _opened++;
+    }
+
+    if(leader < 0)
+    {
+        std::cerr << "Performance counters are not available: " << std::strerror(error);
+        if(error == EACCES || error == EPERM)
+            std::cerr << " (see /proc/sys/kernel/perf_event_paranoid)";
+        std::cerr << "\n";
+        return false;
+    }
+    for(int e = 0 ; e < EVENTS ; ++e)
+    {
+        if(_fds[e] < 0)
+            std::cerr << "Performance counter not available: " << eventName(e) << "\n";
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    _thread = pthread_self();
+    _stack.reserve(8);
+    _enabled = true;
+    return true;
+#else
+    std::cerr << "Performance counters are not available on this system\n";
+    return false;
+#endif
+}
+
+bool PerfCounters::_read(Reading &reading) const
+{
+#ifdef __linux__
+    // nr, time enabled, time running, then a value per event of the group
+    unsigned long long buffer[3 + EVENTS];
+    int leader = -1;
+    for(int e = 0 ; e < EVENTS && leader < 0 ; ++e)
+        leader = _fds[e];
+
+    ssize_t size = static_cast<ssize_t>((3 + _opened) * sizeof(unsigned long long));
+    if(read(leader, buffer, size) != size)
+        return false;
+
+    reading.enabled = buffer[1];
+    reading.running = buffer[2];
+    for(int e = 0 ; e < EVENTS ; ++e)
+        reading.values[e] = (_index[e] >= 0) ? buffer[3 + _index[e]] : 0;
+    return true;
+#else
+    (void)reading;
+    return false;
+#endif
+}
+
+bool PerfCounters::enter()
+{
+#ifdef __linux__
+    if(!pthread_equal(pthread_self(), _thread))
+        return false;
+#endif
+
+    _stack.push_back(Reading());
+    _read(_stack.back());
+    return true;
+}
+
+void PerfCounters::leave(int phase)
+{
+    Reading end;
+    bool ok = _read(end);
+    const Reading &start = _stack.back();
+
+    // a reading failed at the start has no enabled time
+    Totals &t = _phases[phase];
+    t.calls++;
+    if(ok && start.enabled > 0)
+    {
+        for(int e = 0 ; e < EVENTS ; ++e)
+            t.counts.values[e] += end.values[e] - start.values[e];
+        t.counts.enabled += end.enabled - start.enabled;
+        t.counts.running += end.running - start.running;
+    }
+    _stack.pop_back();
+}
+
+std::string PerfCounters::dump() const
+{
+    std::ostringstream oss;
+    oss << "Performance counters (user space of the main thread, nested phases included):\n"
+        << "\t" << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "calls";
+    for(int e = 0 ; e < EVENTS ; ++e)
+        oss << std::setw(16) << eventName(e);
+    oss << std::setw(8) << "IPC" << "\n";
+
+    std::vector<Totals>::size_type p;
+    for(p = 0 ; p < _phases.size() ; ++p)
+    {
+        const Totals &t = _phases[p];
+        if(t.calls == 0)
+            continue;
+
+        oss << "\t" << std::left << std::setw(12) << phaseName(static_cast<int>(p)) << std::right << std::setw(10) << t.calls;
+
+        // the counts are scaled when the group was multiplexed with other ones
+        double scale = (t.counts.running > 0) ? static_cast<double>(t.counts.enabled) / t.counts.running : 0.0;
+        for(int e = 0 ; e < EVENTS ; ++e)
+        {
+            if(_fds[e] < 0 || t.counts.running == 0)
+                oss << std::setw(16) << "n/a";
+            else
+                oss << std::setw(16) << static_cast<unsigned long long>(t.counts.values[e] * scale + 0.5);
+        }
+
+        if(_fds[CYCLES] >= 0 && _fds[INSTRUCTIONS] >= 0 && t.counts.values[CYCLES] > 0)
+            oss << std::setw(8) << std::fixed << std::setprecision(2)
+                << static_cast<double>(t.counts.values[INSTRUCTIONS]) / t.counts.values[CYCLES];
+        else
+            oss << std::setw(8) << "n/a";
+        oss << "\n";
+    }
+    return oss.str();
+}
+
+
+/*** PerfCounters::Reading class ***/
+
+PerfCounters::Reading::Reading() : enabled(0), running(0)
+{
+    for(int e = 0 ; e < EVENTS ; ++e)
+        values[e] = 0;
+}
+
+
+/*** PerfCounters::Totals class ***/
+
+PerfCounters::Totals::Totals() : calls(0)
+{
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#       include <pthread.h>
+#endif
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Hardware performance counters of the phases of the ticks, enabled by --perf-counters
+         *
+         * The counters are read with perf_event_open (Linux only) at the
+         * start and the end of each ProfileScope of the main thread, and
+         * the counts are added to the phase of the scope: the counts of a
+         * phase include the ones of the phases nested in it. Only the user
+         * space of the main thread is counted.
+         *
+         * When the system does not allow the counters (perf_event_paranoid,
+         * virtual machines without a PMU), the missing events are reported
+         * and the game runs without them.
+         */
+        class PerfCounters
+        {
+        public:
+            enum Event
+            {
+                CYCLES,
+                INSTRUCTIONS,
+                L1D_MISSES,   ///< L1 data cache read misses
+                LLC_MISSES,   ///< last level cache misses
+                BRANCH_MISSES,
+                EVENTS
+            };
+
+            static PerfCounters& instance();
+
+            static bool enabled() { return _enabled; }
+
+            /**
+             * \brief Open the counters of the calling thread
+             * \return False if no counter is available, they stay disabled
+             */
+            bool enable();
+
+            /**
+             * \brief Intern method. Start counting a phase, use a ProfileScope instead
+             * \return False out of the main thread, leave() must not be called then
+             */
+            bool enter();
+            void leave(int phase);
+
+            /**
+             * \brief Counts of each phase, since enable()
+             */
+            std::string dump() const;
+
+        private:
+            class Reading;
+            class Totals;
+
+            PerfCounters(); // singleton
+            ~PerfCounters();
+
+            static PerfCounters _instance;
+            static bool _enabled;
+
+            // no copy
+            PerfCounters(const PerfCounters&);
+            PerfCounters& operator=(const PerfCounters&);
+
+            bool _read(Reading &reading) const;
+
+            int _fds[EVENTS]; ///< -1 for the events not available
+            int _index[EVENTS]; ///< place of each event in a read of the group
+            int _opened;
+#ifdef __linux__
+            pthread_t _thread;
+#endif
+            std::vector<Reading> _stack; ///< readings at the start of the scopes not left
+            std::vector<Totals> _phases; ///< indexed by Profiler::Phase
+        };
+
+
+        class PerfCounters::Reading
+        {
+        public:
+            Reading();
+
+            unsigned long long values[EVENTS];
+            unsigned long long enabled; ///< nanoseconds the group was enabled
+            unsigned long long running; ///< nanoseconds the group was counting, less when multiplexed
+        };
+
+
+        class PerfCounters::Totals
+        {
+        public:
+            Totals();
+
+            unsigned long calls;
+            Reading counts;
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* PERF_COUNTERS_HPP */
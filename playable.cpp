@@ -20,6 +20,7 @@
 #include "playable.hpp"
 
 #include "movable.hpp"
+#include "alloc_tracker.hpp"
 
 #include <iostream>
 
@@ -33,12 +34,18 @@ Playable::Playable(GameManager& gm, Key k, Team team, PlayFunction& play)
       _play(play),
       _state(DEFAULT)
 {
+    _tag |= PLAYABLE_CAP | (static_cast<unsigned short>(team) << TAG_TEAM_SHIFT);
 }
 
 Playable::~Playable()
 {
 }
 
+Playable* Playable::_asPlayable()
+{
+    return this;
+}
+
 Team Playable::team() const
 {
     return _team;
@@ -51,6 +58,7 @@ bool Playable::isFriend(const Playable* p) const
 
 void Playable::log(const std::string &msg)
 {
+    AllocSite a(AllocTracker::LOG);
     _log << msg << "\n";
 }
 
@@ -75,7 +83,7 @@ unsigned int Playable::fuel(const Movable* other) const
     if(this->distanceTo(other) <= Config::instance().COMMUNICATION_RADIUS)
     {
         // we return fuel only if other is a Playable and is a friend. Else we always return 0.
-        const Playable* o = dynamic_cast<const Playable*>(other);
+        const Playable* o = item_cast<Playable>(other);
         if(o)
         {
             if(this->isFriend(o))
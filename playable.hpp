@@ -21,6 +21,7 @@
 #define PLAYABLE_HPP
 
 #include <sstream>
+#include <vector>
 
 #include "config.hpp" // for Team
 #include "item.hpp"
@@ -30,6 +31,9 @@ namespace aiwar {
 
         class Movable;
         class Playable;
+        class Base;
+        class MiningShip;
+        class Fighter;
 
         enum State
         {
@@ -60,6 +64,63 @@ namespace aiwar {
             void (*_fun_ptr)(Playable*);
         };
 
+        /**
+         * \brief Play function called once per round with all the units of a team
+         *
+         * A team registered with a TeamPlayFunction does not use its PlayFunctions.
+         * The rules of a round still apply to each unit: one move, one launch, one extraction.
+         * The function is called after the item loop of the round, with the units still
+         * alive: a unit destroyed in the loop, by a missile, is not given to it.
+         *
+         * A concurrent() function may also be played in three steps, when the teams are
+         * isolated (Config::isolateTeams): prepare() for each team, then think() for all
+         * the teams at the same time, then apply() for each team, in team order.
+         * So all the teams see the world as it was before any of them played.
+         * The process and native handlers are concurrent, the python one is not: a python
+         * AI is concurrent when played by the process handler with client/aiwar_client.py.
+         */
+        class TeamPlayFunction
+        {
+        public:
+            typedef std::vector<Base*> BaseVector;
+            typedef std::vector<MiningShip*> MiningShipVector;
+            typedef std::vector<Fighter*> FighterVector;
+
+            TeamPlayFunction() {}
+            virtual ~TeamPlayFunction() {}
+            virtual void operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters) = 0;
+
+            /**
+             * \brief true if the function can be played with prepare(), think() and apply()
+             */
+            virtual bool concurrent() const { return false; }
+
+            /**
+             * \brief Read what the team needs from the world, the units are kept until apply()
+             */
+            virtual void prepare(const BaseVector &, const MiningShipVector &, const FighterVector &) {}
+
+            /**
+             * \brief Decide what the units do, in its own thread: the world must not be changed, and only read without side effect (no neighbour query)
+             */
+            virtual void think() {}
+
+            /**
+             * \brief Make the units do what has been decided
+             */
+            virtual void apply() {}
+
+            /**
+             * \brief CPU time used during the last round out of the thread calling the function
+             * (worker threads, child processes), in seconds. It is counted in the think time of the team
+             */
+            virtual double externalCpuTime() const { return 0.0; }
+
+        private:
+            TeamPlayFunction(const TeamPlayFunction&);
+            TeamPlayFunction& operator=(const TeamPlayFunction&);
+        };
+
         class Playable : virtual public Item
         {
         public:
@@ -67,6 +128,8 @@ namespace aiwar {
 
             virtual ~Playable();
 
+            Playable* _asPlayable();
+
             Team team() const;
             bool isFriend(const Playable* p) const;
 
@@ -85,6 +148,12 @@ namespace aiwar {
             void state(State state);
             State getState() const;
 
+            /**
+             * \brief Intern method. Start a round without calling the play function,
+             * the unit is played by the TeamPlayFunction of its team
+             */
+            virtual void _startRound(unsigned int tick) = 0;
+
         protected:
             Playable(GameManager& gm, Key k, Team team, PlayFunction& play);
 
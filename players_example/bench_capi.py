@@ -0,0 +1,70 @@
+# -*- coding: utf-8 -*-
+
+# Benchmark of the C API of the aiwar module (client/aiwar_python.h)
+#
+# The team is played by example_capi, the play of handler_example.cpp
+# compiled as a python extension. Before each unit plays, the same scan
+# (nearest mineral with points left, friends in the communication radius)
+# is run with the methods of the aiwar objects and with example_capi.scan.
+# Results are checked to be the same, and the times are printed when the
+# game ends.
+#
+# Usage: python setup.py build, then add a player with
+# <params>bench_capi</params> in config.xml, with players_example and the
+# built example_capi module in PYTHONPATH.
+
+import aiwar
+import atexit
+import time
+
+import example_capi
+
+times = {"python": 0.0, "C API": 0.0}
+calls = [0]
+
+def py_scan(self):
+    best = None
+    bestDistance = 0.0
+    friends = 0
+    r = aiwar.COMMUNICATION_RADIUS()
+    for i in self.neighbours():
+        d = self.distanceTo(i)
+        if isinstance(i, aiwar.Mineral):
+            if i.life() > 0 and (best is None or d < bestDistance):
+                best = i
+                bestDistance = d
+        elif not isinstance(i, aiwar.Missile) and self.isFriend(i) and d <= r:
+            friends += 1
+    return (best, friends)
+
+def bench(self):
+    calls[0] += 1
+    t = time.time()
+    a = py_scan(self)
+    times["python"] += time.time() - t
+    t = time.time()
+    b = example_capi.scan(self)
+    times["C API"] += time.time() - t
+    if a != b:
+        raise RuntimeError("scan: %r != %r" % (a, b))
+
+def report():
+    tp = times["python"]
+    tc = times["C API"]
+    print "C API benchmark: %d units played" % calls[0]
+    print "  scan  python %8.3f ms  C API %8.3f ms  x%.1f" % (tp * 1000.0, tc * 1000.0, tp / tc if tc > 0.0 else 0.0)
+
+atexit.register(report)
+
+
+def play_miningship(ship):
+    bench(ship)
+    example_capi.play_miningship(ship)
+
+def play_base(base):
+    bench(base)
+    example_capi.play_base(base)
+
+def play_fighter(fighter):
+    bench(fighter)
+    example_capi.play_fighter(fighter)
@@ -0,0 +1,116 @@
+# -*- coding: utf-8 -*-
+
+# Benchmark of the native queries (closest, within, countWithin, argminBy)
+#
+# The team is played by AIWar_GuiGui_06. Before each unit plays, the four
+# filters GuiGui writes in Python are run both ways: with the Python loops
+# of AIWar_GuiGui_06 and with the native queries. Results are checked to be
+# the same, and the times are printed when the game ends.
+#
+# Usage: add a player with <params>bench_queries</params> in config.xml,
+# with players_example in PYTHONPATH.
+
+import aiwar
+import atexit
+import time
+
+import AIWar_GuiGui_06 as guigui
+
+FRIENDS_OR_ENEMIES = aiwar.FRIENDS | aiwar.ENEMIES
+SHIPS = aiwar.MININGSHIPS | aiwar.FIGHTERS
+
+times = {}
+calls = [0]
+
+def timed(name, fun, *args):
+    t = time.time()
+    r = fun(*args)
+    times[name] = times.get(name, 0.0) + time.time() - t
+    return r
+
+
+### the filters, written in Python like in AIWar_GuiGui_06 ###
+
+def py_closest_mineral(self):
+    for i in guigui.getSortedNeighbours(self):
+        if isinstance(i, aiwar.Mineral) and i.life() > 0:
+            return i
+    return None
+
+def py_enemies_in_range(self):
+    r = guigui.MissileRange()
+    return [i for i in self.neighbours() if (isinstance(i, aiwar.MiningShip) or isinstance(i, aiwar.Fighter) or isinstance(i, aiwar.Base)) and not self.isFriend(i) and self.distanceTo(i) <= r]
+
+def py_count_friends(self):
+    n = 0
+    for i in self.neighbours():
+        if (isinstance(i, aiwar.MiningShip) or isinstance(i, aiwar.Fighter) or isinstance(i, aiwar.Base)) and self.isFriend(i) and self.distanceTo(i) <= aiwar.COMMUNICATION_RADIUS():
+            n += 1
+    return n
+
+def py_lowest_fuel(self):
+    best = None
+    for i in self.neighbours():
+        if (isinstance(i, aiwar.MiningShip) or isinstance(i, aiwar.Fighter)) and self.isFriend(i) and self.distanceTo(i) <= aiwar.COMMUNICATION_RADIUS():
+            if best is None or self.fuel(i) < self.fuel(best):
+                best = i
+    return best
+
+
+### the same filters with the native queries ###
+
+def native_closest_mineral(self):
+    return self.closest(aiwar.MINERALS, 0, -1.0, 1)
+
+def native_enemies_in_range(self):
+    return self.within(guigui.MissileRange(), aiwar.BASES | SHIPS, aiwar.ENEMIES)
+
+def native_count_friends(self):
+    return self.countWithin(aiwar.COMMUNICATION_RADIUS(), aiwar.BASES | SHIPS, aiwar.FRIENDS)
+
+def native_lowest_fuel(self):
+    return self.argminBy("fuel", SHIPS, aiwar.FRIENDS)
+
+
+CASES = [
+    ("closest mineral", py_closest_mineral, native_closest_mineral),
+    ("enemies in missile range", py_enemies_in_range, native_enemies_in_range),
+    ("friends in communication", py_count_friends, native_count_friends),
+    ("lowest fuel friend", py_lowest_fuel, native_lowest_fuel),
+]
+
+def same(self, a, b):
+    # equal distances may be ordered differently by the sort of getSortedNeighbours
+    if a is None or b is None or isinstance(a, (int, list)):
+        return a == b
+    return a == b or self.distanceTo(a) == self.distanceTo(b)
+
+def bench(self):
+    calls[0] += 1
+    for name, py, native in CASES:
+        a = timed(name + " (python)", py, self)
+        b = timed(name + " (native)", native, self)
+        if not same(self, a, b):
+            raise RuntimeError("%s: %r != %r" % (name, a, b))
+
+def report():
+    print "queries benchmark: %d units played" % calls[0]
+    for name, py, native in CASES:
+        tp = times.get(name + " (python)", 0.0)
+        tn = times.get(name + " (native)", 0.0)
+        print "  %-26s python %8.3f ms  native %8.3f ms  x%.1f" % (name, tp * 1000.0, tn * 1000.0, tp / tn if tn > 0.0 else 0.0)
+
+atexit.register(report)
+
+
+def play_miningship(ship):
+    bench(ship)
+    guigui.play_miningship(ship)
+
+def play_base(base):
+    bench(base)
+    guigui.play_base(base)
+
+def play_fighter(fighter):
+    bench(fighter)
+    guigui.play_fighter(fighter)
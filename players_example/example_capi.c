@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Example of a python AI compiled as an extension, the play of handler_example.cpp
+ * written with the C API of the aiwar module (client/aiwar_python.h).
+ *
+ * Build: python setup.py build, then put the example_capi module in PYTHONPATH.
+ * config.xml:
+ *     <player>
+ *       <name>Example-CAPI</name>
+ *       <handler>python</handler>
+ *       <params>example_capi</params>
+ *     </player>
+ *
+ * scan() is used by bench_capi.py to compare the C API with the python methods.
+ */
+
+#include "aiwar_python.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_NEIGHBOURS 256
+
+static const AiwarPythonApi *api = NULL;
+
+/* rules of the game, read from the aiwar module at import */
+static double BASE_REFUEL_RADIUS;
+static double BASE_MININGSHIP_PRICE;
+static double MININGSHIP_START_FUEL;
+static double MININGSHIP_MAX_MINERAL_STORAGE;
+static double MININGSHIP_MINING_RADIUS;
+static double MININGSHIP_DETECTION_RADIUS;
+static double COMMUNICATION_RADIUS;
+
+/* units are played one at a time */
+static AiwarPyItem *neighbours[MAX_NEIGHBOURS];
+
+static Py_ssize_t get_neighbours(AiwarPyUnit *self, unsigned int kinds, unsigned int teams)
+{
+    Py_ssize_t n = api->neighbours(self, kinds, teams, neighbours, MAX_NEIGHBOURS);
+    return n < MAX_NEIGHBOURS ? n : MAX_NEIGHBOURS;
+}
+
+static int is_friend(AiwarPyUnit *self, AiwarPyItem *i)
+{
+    return api->team(i) == api->team(AIWAR_PY_ITEM(self));
+}
+
+static float memory(AiwarPyUnit *self, unsigned int index, AiwarPyItem *other)
+{
+    float v = 0.0f;
+    api->get_memory_float(self, index, other, &v);
+    return v;
+}
+
+static void log_value(AiwarPyUnit *self, const char *what, long value)
+{
+    char msg[64];
+    snprintf(msg, sizeof(msg), "%s%ld", what, value);
+    api->log(self, msg);
+}
+
+static void random_move(AiwarPyUnit *self)
+{
+    api->rotate_of(self, (rand() % 91) - 45);
+    api->move(self);
+}
+
+/* give the position of the known mineral to a friend which does not know one */
+static void share_mineral(AiwarPyUnit *self, AiwarPyItem *i)
+{
+    float x = memory(self, 2, NULL), y = memory(self, 3, NULL);
+    if(x != 0.0f || y != 0.0f)
+    {
+        if(memory(self, 2, i) == 0.0f && memory(self, 3, i) == 0.0f)
+        {
+            api->set_memory_float(self, 2, x, i);
+            api->set_memory_float(self, 3, y, i);
+            api->log(self, "J'ai donne la position de mon minerais a mon copain");
+        }
+    }
+}
+
+static PyObject *play_base(PyObject *module, PyObject *unit)
+{
+    AiwarPyUnit *self = api->unit(unit);
+    Py_ssize_t i, n;
+    (void)module;
+    if(!self)
+        return NULL;
+
+    api->log(self, "*********BASE**********");
+    log_value(self, "Vie: ", api->life(AIWAR_PY_ITEM(self)));
+    log_value(self, "MineralStorage: ", api->mineral_storage(self));
+
+    n = get_neighbours(self, AIWAR_PY_KIND(AIWAR_MININGSHIP), AIWAR_PY_FRIENDS);
+
+    /* refuel friend ships */
+    for(i = 0 ; i < n ; ++i)
+    {
+        if(is_friend(self, neighbours[i]) && api->distance(AIWAR_PY_ITEM(self), neighbours[i]) <= BASE_REFUEL_RADIUS)
+        {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "mon ami a encore %ld fuel", api->fuel(self, neighbours[i]));
+            api->log(self, msg);
+            api->log(self, "je fais le plein de mon ami");
+            api->refuel(self, (unsigned int)MININGSHIP_START_FUEL, neighbours[i]);
+        }
+    }
+
+    /* create new MiningShip */
+    if(api->mineral_storage(self) > BASE_MININGSHIP_PRICE && (rand() % 20) == 1)
+    {
+        api->log(self, "Je cree un MiningShip");
+        api->create_miningship(self);
+    }
+
+    /* communiquer avec les copains */
+    for(i = 0 ; i < n ; ++i)
+    {
+        if(is_friend(self, neighbours[i]) && api->distance(AIWAR_PY_ITEM(self), neighbours[i]) <= COMMUNICATION_RADIUS)
+            share_mineral(self, neighbours[i]);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *play_miningship(PyObject *module, PyObject *unit)
+{
+    AiwarPyUnit *self = api->unit(unit);
+    AiwarPyItem *me;
+    Py_ssize_t i, n;
+    int baseKnown = 0;
+    float baseX, baseY, x, y;
+    (void)module;
+    if(!self)
+        return NULL;
+    me = AIWAR_PY_ITEM(self);
+
+    api->log(self, "*******MININGSHIP******");
+    log_value(self, "Vie: ", api->life(me));
+    log_value(self, "MineralStorage: ", api->mineral_storage(self));
+    log_value(self, "Fuel: ", api->fuel(self, NULL));
+
+    n = get_neighbours(self, 0, 0);
+
+    /* recherche de la base amie */
+    baseX = memory(self, 0, NULL);
+    baseY = memory(self, 1, NULL);
+    if(baseX != 0.0f || baseY != 0.0f)
+    {
+        api->log(self, "je connais ma base");
+        baseKnown = 1;
+    }
+    else
+    {
+        for(i = 0 ; i < n ; ++i)
+        {
+            if(api->kind(neighbours[i]) == AIWAR_BASE && is_friend(self, neighbours[i]))
+            {
+                api->log(self, "base trouvee");
+                baseX = api->xpos(neighbours[i]);
+                baseY = api->ypos(neighbours[i]);
+                api->set_memory_float(self, 0, baseX, NULL);
+                api->set_memory_float(self, 1, baseY, NULL);
+                baseKnown = 1;
+                break;
+            }
+        }
+    }
+
+    /* communiquer avec les copains */
+    for(i = 0 ; i < n ; ++i)
+    {
+        int kind = api->kind(neighbours[i]);
+        if((kind == AIWAR_BASE || kind == AIWAR_MININGSHIP) && is_friend(self, neighbours[i])
+           && api->distance(me, neighbours[i]) <= COMMUNICATION_RADIUS)
+            share_mineral(self, neighbours[i]);
+    }
+
+    /* rentrer a la base ? */
+    if(api->mineral_storage(self) == MININGSHIP_MAX_MINERAL_STORAGE
+       || api->fuel(self, NULL) < (baseKnown ? api->distance_to(me, baseX, baseY) : 170))
+    {
+        if(baseKnown)
+        {
+            api->log(self, "je rentre a la base");
+            api->state(self, AIWAR_PY_DARK);
+            api->rotate_to(self, baseX, baseY);
+            api->move(self);
+            /* base en vue et assez proche pour donner le minerai ? */
+            for(i = 0 ; i < n ; ++i)
+            {
+                if(api->kind(neighbours[i]) == AIWAR_BASE && is_friend(self, neighbours[i]))
+                {
+                    if(api->distance(me, neighbours[i]) <= MININGSHIP_MINING_RADIUS)
+                    {
+                        api->log(self, "je donne mon minerai a ma base");
+                        api->push_mineral(self, neighbours[i], api->mineral_storage(self));
+                    }
+                    break;
+                }
+            }
+        }
+        else
+        {
+            api->log(self, "je cherche ma base");
+            random_move(self);
+        }
+        Py_RETURN_NONE;
+    }
+
+    /* recherche de minerais visible */
+    for(i = 0 ; i < n ; ++i)
+    {
+        if(api->kind(neighbours[i]) == AIWAR_MINERAL)
+        {
+            api->log(self, "je sauvegarde la position du minerai");
+            api->set_memory_float(self, 2, api->xpos(neighbours[i]), NULL);
+            api->set_memory_float(self, 3, api->ypos(neighbours[i]), NULL);
+            api->log(self, "je vais au minerais visible");
+            api->state(self, AIWAR_PY_DEFAULT);
+            api->rotate_to(self, api->xpos(neighbours[i]), api->ypos(neighbours[i]));
+            api->move(self);
+            if(api->distance(me, neighbours[i]) <= MININGSHIP_MINING_RADIUS - 1)
+            {
+                api->log(self, "je mine");
+                api->state(self, AIWAR_PY_LIGHT);
+                api->extract(self, neighbours[i]);
+            }
+            Py_RETURN_NONE;
+        }
+    }
+
+    /* recherche de minerai connu */
+    x = memory(self, 2, NULL);
+    y = memory(self, 3, NULL);
+    if(x != 0.0f || y != 0.0f)
+    {
+        api->log(self, "je connais un minerai");
+        if(api->distance_to(me, x, y) < MININGSHIP_DETECTION_RADIUS) /* on aurait du voir le minerai -> il est vide */
+        {
+            api->set_memory_float(self, 2, 0.0f, NULL);
+            api->set_memory_float(self, 3, 0.0f, NULL);
+        }
+        else
+        {
+            api->log(self, "je vais au minerais connus");
+            api->state(self, AIWAR_PY_DEFAULT);
+            api->rotate_to(self, x, y);
+            api->move(self);
+            Py_RETURN_NONE;
+        }
+    }
+
+    /* deplacement aleatoire */
+    api->log(self, "je cherche du minerais");
+    api->state(self, AIWAR_PY_DEFAULT);
+    random_move(self);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *play_fighter(PyObject *module, PyObject *unit)
+{
+    (void)module;
+    (void)unit;
+    Py_RETURN_NONE;
+}
+
+/* nearest mineral with points left, and friends in the communication radius */
+static PyObject *scan(PyObject *module, PyObject *unit)
+{
+    AiwarPyUnit *self = api->unit(unit);
+    AiwarPyItem *me, *best = NULL;
+    double bestDistance = 0.0;
+    Py_ssize_t i, n;
+    long friends = 0;
+    PyObject *mineral, *res;
+    (void)module;
+    if(!self)
+        return NULL;
+    me = AIWAR_PY_ITEM(self);
+
+    n = get_neighbours(self, 0, 0);
+    for(i = 0 ; i < n ; ++i)
+    {
+        int kind = api->kind(neighbours[i]);
+        double d = api->distance(me, neighbours[i]);
+        if(kind == AIWAR_MINERAL && api->life(neighbours[i]) > 0 && (!best || d < bestDistance))
+        {
+            best = neighbours[i];
+            bestDistance = d;
+        }
+        else if(kind != AIWAR_MINERAL && kind != AIWAR_MISSILE && is_friend(self, neighbours[i]) && d <= COMMUNICATION_RADIUS)
+            friends++;
+    }
+
+    if(best)
+        mineral = api->object(best);
+    else
+    {
+        Py_INCREF(Py_None);
+        mineral = Py_None;
+    }
+    if(!mineral)
+        return NULL;
+    res = Py_BuildValue("(Nl)", mineral, friends);
+    return res;
+}
+
+static PyMethodDef methods[] = {
+    {"play_base", play_base, METH_O, "Play a base"},
+    {"play_miningship", play_miningship, METH_O, "Play a mining ship"},
+    {"play_fighter", play_fighter, METH_O, "Play a fighter"},
+    {"scan", scan, METH_O, "Return the nearest mineral with points left and the number of friends in the communication radius"},
+    {NULL, NULL, 0, NULL}
+};
+
+/* read a rule of the game: a function of the aiwar module */
+static int rule(PyObject *aiwar, const char *name, double *value)
+{
+    PyObject *v = PyObject_CallMethod(aiwar, (char*)name, NULL);
+    if(!v)
+        return -1;
+    *value = PyFloat_AsDouble(v);
+    Py_DECREF(v);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+PyMODINIT_FUNC
+initexample_capi(void)
+{
+    PyObject *aiwar;
+    int failed;
+
+    api = aiwar_import_api();
+    if(!api)
+        return;
+
+    aiwar = PyImport_ImportModule("aiwar");
+    if(!aiwar)
+        return;
+    failed = rule(aiwar, "BASE_REFUEL_RADIUS", &BASE_REFUEL_RADIUS)
+        || rule(aiwar, "BASE_MININGSHIP_PRICE", &BASE_MININGSHIP_PRICE)
+        || rule(aiwar, "MININGSHIP_START_FUEL", &MININGSHIP_START_FUEL)
+        || rule(aiwar, "MININGSHIP_MAX_MINERAL_STORAGE", &MININGSHIP_MAX_MINERAL_STORAGE)
+        || rule(aiwar, "MININGSHIP_MINING_RADIUS", &MININGSHIP_MINING_RADIUS)
+        || rule(aiwar, "MININGSHIP_DETECTION_RADIUS", &MININGSHIP_DETECTION_RADIUS)
+        || rule(aiwar, "COMMUNICATION_RADIUS", &COMMUNICATION_RADIUS);
+    Py_DECREF(aiwar);
+    if(failed)
+        return;
+
+    Py_InitModule3("example_capi", methods, "Example of an AI using the C API of the aiwar module");
+}
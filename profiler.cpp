@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.hpp"
+
+#include "item.hpp" // for ItemKind
+
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#       include <time.h>
+#endif
+
+using namespace aiwar::core;
+
+namespace {
+
+double now()
+{
+#ifndef _WIN32
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+const char* phaseName(Profiler::Phase phase)
+{
+    switch(phase)
+    {
+    case Profiler::TICK: return "tick";
+    case Profiler::PLAY: return "play";
+    case Profiler::PYTHON: return "python";
+    case Profiler::NEIGHBOURS: return "neighbours";
+    case Profiler::THINK: return "think";
+    case Profiler::REMOVE: return "remove";
+    case Profiler::MISSILES: return "missiles";
+    case Profiler::ACTIVITY: return "activity";
+    case Profiler::RENDER: return "render";
+    }
+    return "unknown";
+}
+
+const char* teamName(Team team)
+{
+    switch(team)
+    {
+    case BLUE_TEAM: return "blue";
+    case RED_TEAM: return "red";
+    default: return "";
+    }
+}
+
+const char* kindName(int kind)
+{
+    switch(kind)
+    {
+    case MINERAL_KIND: return "mineral";
+    case MISSILE_KIND: return "missile";
+    case BASE_KIND: return "base";
+    case MININGSHIP_KIND: return "miningship";
+    case FIGHTER_KIND: return "fighter";
+    default: return "";
+    }
+}
+
+// milliseconds, for the JSON summary
+std::string ms(double seconds)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3) << seconds * 1000.0;
+    return oss.str();
+}
+
+} // anonymous namespace
+
+
+/*** Profiler class ***/
+
+Profiler Profiler::_instance; // singleton instance
+bool Profiler::_enabled = false;
+
+Profiler& Profiler::instance()
+{
+    return _instance;
+}
+
+Profiler::Profiler() : _paused(0), _ticks(0)
+{
+    _nodes.push_back(Node(0, TICK, NO_TEAM, NO_KIND));
+}
+
+void Profiler::enable()
+{
+    _enabled = true;
+}
+
+bool Profiler::enter(Phase phase, Team team, int kind)
+{
+    if(_paused)
+        return false;
+
+    std::size_t parent = _stack.empty() ? 0 : _stack.back().node;
+    _stack.push_back(Frame(_child(parent, phase, team, kind), now()));
+    return true;
+}
+
+void Profiler::leave()
+{
+    const Frame &f = _stack.back();
+    Node &node = _nodes[f.node];
+    double elapsed = now() - f.start;
+    node.calls++;
+    node.total += elapsed;
+    node.tick += elapsed;
+    node.seen = true;
+    bool tick = (node.phase == TICK);
+    _stack.pop_back();
+
+    if(_stack.empty())
+    {
+        if(tick)
+            _ticks++;
+        _endTick();
+    }
+}
+
+void Profiler::pause()
+{
+    _paused++;
+}
+
+void Profiler::resume()
+{
+    _paused--;
+}
+
+unsigned long Profiler::ticks() const
+{
+    return _ticks;
+}
+
+std::size_t Profiler::_child(std::size_t parent, Phase phase, Team team, int kind)
+{
+    std::vector<std::size_t>::const_iterator it;
+    for(it = _nodes[parent].children.begin() ; it != _nodes[parent].children.end() ; ++it)
+    {
+        const Node &n = _nodes[*it];
+        if(n.phase == phase && n.team == team && n.kind == kind)
+            return *it;
+    }
+
+    _nodes.push_back(Node(parent, phase, team, kind));
+    _nodes[parent].children.push_back(_nodes.size() - 1);
+    return _nodes.size() - 1;
+}
+
+void Profiler::_endTick()
+{
+    std::vector<Node>::iterator it;
+    for(it = _nodes.begin() + 1 ; it != _nodes.end() ; ++it)
+    {
+        if(it->seen)
+        {
+            it->ticks.add(it->tick);
+            it->tick = 0.0;
+            it->seen = false;
+        }
+    }
+}
+
+std::string Profiler::_name(std::size_t node) const
+{
+    const Node &n = _nodes[node];
+    std::string name = phaseName(n.phase);
+    if(n.team != NO_TEAM)
+        name = name + ":" + teamName(n.team);
+    if(n.kind != NO_KIND)
+        name = name + ":" + kindName(n.kind);
+    return name;
+}
+
+std::string Profiler::_path(std::size_t node) const
+{
+    std::string stack = _name(node);
+    for(node = _nodes[node].parent ; node != 0 ; node = _nodes[node].parent)
+        stack = _name(node) + ";" + stack;
+    return stack;
+}
+
+bool Profiler::write(const std::string &prefix) const
+{
+    bool ok = true;
+    std::size_t i;
+
+    // the tick times, from all the ticks
+    Histogram ticks;
+    for(i = 1 ; i < _nodes.size() ; ++i)
+    {
+        if(_nodes[i].parent == 0 && _nodes[i].phase == TICK)
+            ticks = _nodes[i].ticks;
+    }
+    std::cout << "Profile: " << _ticks << " ticks, p50 " << ms(ticks.percentile(0.5)) << " ms, p99 "
+              << ms(ticks.percentile(0.99)) << " ms, max " << ms(ticks.max()) << " ms\n";
+
+    std::string json = prefix + ".json";
+    std::ofstream out(json.c_str());
+    out << "{\n"
+        << "  \"ticks\": " << _ticks << ",\n"
+        << "  \"tick_ms\": {\"p50\": " << ms(ticks.percentile(0.5)) << ", \"p99\": " << ms(ticks.percentile(0.99))
+        << ", \"max\": " << ms(ticks.max()) << "},\n"
+        << "  \"phases\": [";
+    for(i = 1 ; i < _nodes.size() ; ++i)
+    {
+        const Node &n = _nodes[i];
+        out << (i > 1 ? ",\n" : "\n")
+            << "    {\"stack\": \"" << _path(i) << "\", \"phase\": \"" << phaseName(n.phase)
+            << "\", \"team\": \"" << teamName(n.team) << "\", \"kind\": \"" << kindName(n.kind)
+            << "\", \"calls\": " << n.calls << ", \"ticks\": " << n.ticks.count()
+            << ", \"total_ms\": " << ms(n.total) << ", \"tick_ms\": {\"p50\": " << ms(n.ticks.percentile(0.5))
+            << ", \"p99\": " << ms(n.ticks.percentile(0.99)) << ", \"max\": " << ms(n.ticks.max()) << "}}";
+    }
+    out << "\n  ]\n}\n";
+    out.close();
+    if(!out)
+    {
+        std::cerr << "Cannot write profile: " << json << "\n";
+        ok = false;
+    }
+
+    // self time of each node, in microseconds
+    std::string folded = prefix + ".folded";
+    std::ofstream fout(folded.c_str());
+    for(i = 1 ; i < _nodes.size() ; ++i)
+    {
+        const Node &n = _nodes[i];
+        double self = n.total;
+        std::vector<std::size_t>::const_iterator it;
+        for(it = n.children.begin() ; it != n.children.end() ; ++it)
+            self -= _nodes[*it].total;
+        long us = static_cast<long>(self * 1e6 + 0.5);
+        if(us > 0)
+            fout << _path(i) << " " << us << "\n";
+    }
+    fout.close();
+    if(!fout)
+    {
+        std::cerr << "Cannot write profile: " << folded << "\n";
+        ok = false;
+    }
+
+    if(ok)
+        std::cout << "Profile written to " << json << " and " << folded << "\n";
+    return ok;
+}
+
+
+/*** Profiler::Histogram class ***/
+
+Profiler::Histogram::Histogram() : _count(0), _max(0.0)
+{
+    for(unsigned int b = 0 ; b < BUCKETS ; ++b)
+        _counts[b] = 0;
+}
+
+unsigned int Profiler::Histogram::_bucket(double seconds)
+{
+    double us = seconds * 1e6;
+    if(us < 1.0)
+        return 0;
+    unsigned int b = 1 + static_cast<unsigned int>(4.0 * std::log(us) / std::log(2.0));
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+void Profiler::Histogram::add(double seconds)
+{
+    _counts[_bucket(seconds)]++;
+    _count++;
+    if(seconds > _max)
+        _max = seconds;
+}
+
+unsigned long Profiler::Histogram::count() const
+{
+    return _count;
+}
+
+double Profiler::Histogram::max() const
+{
+    return _max;
+}
+
+double Profiler::Histogram::percentile(double p) const
+{
+    if(_count == 0)
+        return 0.0;
+
+    // the bucket b > 0 holds the times in [2^((b-1)/4), 2^(b/4)[ microseconds
+    unsigned long rank = static_cast<unsigned long>(std::ceil(p * _count)), seen = 0;
+    if(rank == 0)
+        rank = 1;
+    for(unsigned int b = 0 ; b < BUCKETS ; ++b)
+    {
+        seen += _counts[b];
+        if(seen >= rank)
+        {
+            double upper = std::pow(2.0, b / 4.0) * 1e-6;
+            return upper < _max ? upper : _max;
+        }
+    }
+    return _max;
+}
+
+
+/*** Profiler::Node class ***/
+
+Profiler::Node::Node(std::size_t p, Phase ph, Team t, int k)
+    : parent(p), phase(ph), team(t), kind(k), calls(0), total(0.0), tick(0.0), seen(false)
+{
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <vector>
+
+#include "config.hpp" // for Team
+#include "alloc_tracker.hpp"
+#include "perf_counters.hpp"
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Times the phases of the ticks, enabled by --profile
+         *
+         * Phases are timed by ProfileScope objects, and nested scopes make a
+         * call tree: a node per phase, team and item kind under its parent.
+         * A tick is the time spent in the outermost scope. At the end of each
+         * tick, the time of every node during the tick goes into a histogram.
+         *
+         * write() saves a JSON summary (calls, total, p50, p99 and max time
+         * per tick of each node) and the tree as collapsed stacks, one line
+         * per node with its self time in microseconds, as read by flamegraph
+         * tools.
+         *
+         * Only the main thread is timed: the threads playing the teams at the
+         * same time run between pause() and resume().
+         */
+        class Profiler
+        {
+        public:
+            enum Phase
+            {
+                TICK,       ///< one loop of the game: update and render
+                PLAY,       ///< a unit, or a team played at once
+                PYTHON,     ///< a call of a python play function
+                NEIGHBOURS, ///< a neighbours query
+                THINK,      ///< the teams thinking at the same time (--isolate)
+                REMOVE,     ///< deletion of the items removed in the last round
+                MISSILES,   ///< update of the missiles
+                ACTIVITY,   ///< StatManager::checkActivity
+                RENDER      ///< the renderer
+            };
+
+            static Profiler& instance();
+
+            static bool enabled() { return _enabled; }
+            void enable();
+
+            /**
+             * \brief Intern method. Start a phase, use a ProfileScope instead
+             * \param kind An ItemKind, NO_KIND if the phase is not about an item
+             * \return False if the profiler is paused, leave() must not be called then
+             */
+            bool enter(Phase phase, Team team, int kind);
+            void leave();
+
+            /**
+             * \brief Stop timing until resume(), while other threads run
+             */
+            void pause();
+            void resume();
+
+            unsigned long ticks() const;
+
+            /**
+             * \brief Print the tick times, and save the profile in prefix.json and prefix.folded
+             * \return False if a file cannot be written
+             */
+            bool write(const std::string &prefix) const;
+
+        private:
+            class Histogram;
+            class Node;
+            class Frame;
+
+            Profiler(); // singleton
+
+            static Profiler _instance;
+            static bool _enabled;
+
+            // no copy
+            Profiler(const Profiler&);
+            Profiler& operator=(const Profiler&);
+
+            std::size_t _child(std::size_t parent, Phase phase, Team team, int kind);
+            void _endTick();
+            std::string _name(std::size_t node) const;
+            std::string _path(std::size_t node) const;
+
+            std::vector<Node> _nodes; ///< _nodes[0] is the root of the tree, it is never timed
+            std::vector<Frame> _stack; ///< scopes entered and not left
+            unsigned int _paused;
+            unsigned long _ticks;
+        };
+
+
+        class Profiler::Histogram
+        {
+        public:
+            Histogram();
+
+            void add(double seconds);
+
+            unsigned long count() const;
+            double max() const;
+
+            /**
+             * \brief Smallest time greater than or equal to a fraction p of the times, within 20%
+             */
+            double percentile(double p) const;
+
+        private:
+            enum { BUCKETS = 4 * 40 }; ///< 4 per octave, from 1 microsecond
+
+            static unsigned int _bucket(double seconds);
+
+            unsigned long _counts[BUCKETS];
+            unsigned long _count;
+            double _max;
+        };
+
+
+        class Profiler::Node
+        {
+        public:
+            Node(std::size_t p, Phase ph, Team t, int k);
+
+            std::size_t parent;
+            Phase phase;
+            Team team;
+            int kind;
+            std::vector<std::size_t> children;
+
+            unsigned long calls;
+            double total; ///< seconds, since the start
+            double tick; ///< seconds, during the current tick
+            bool seen; ///< entered during the current tick
+            Histogram ticks; ///< time per tick, for the ticks the node was entered
+        };
+
+
+        class Profiler::Frame
+        {
+        public:
+            Frame(std::size_t n, double s) : node(n), start(s) {}
+
+            std::size_t node;
+            double start;
+        };
+
+
+        /**
+         * \brief Times a phase from its construction to its destruction, if the profiler is enabled
+         *
+         * It also reads the performance counters if they are enabled and,
+         * with AIWAR_ALLOC_TRACKING, sets the phase of the allocations.
+         */
+        class ProfileScope
+        {
+        public:
+            explicit ProfileScope(Profiler::Phase phase, Team team = NO_TEAM, int kind = 0)
+                : _on(Profiler::enabled() && Profiler::instance().enter(phase, team, kind))
+#ifdef AIWAR_ALLOC_TRACKING
+                , _allocPhase(AllocTracker::enterPhase(phase))
+#endif
+                , _phase(phase), _perf(PerfCounters::enabled() && PerfCounters::instance().enter())
+            {
+            }
+
+            ~ProfileScope()
+            {
+                if(_perf)
+                    PerfCounters::instance().leave(_phase);
+                if(_on)
+                    Profiler::instance().leave();
+#ifdef AIWAR_ALLOC_TRACKING
+                AllocTracker::leavePhase(_allocPhase);
+#endif
+            }
+
+        private:
+            // no copy
+            ProfileScope(const ProfileScope&);
+            ProfileScope& operator=(const ProfileScope&);
+
+            bool _on;
+#ifdef AIWAR_ALLOC_TRACKING
+            int _allocPhase;
+#endif
+            Profiler::Phase _phase;
+            bool _perf;
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* PROFILER_HPP */
@@ -23,9 +23,42 @@
 #include "miningship.hpp"
 #include "base.hpp"
 #include "fighter.hpp"
+#include "profiler.hpp"
+#include "think_watchdog.hpp"
 
 
-PythonHandler::PythonHandler() : _initFlag(false)
+namespace {
+
+// run by the thread executing python code: raise an exception if its team is over budget
+int raiseOverBudget(void*)
+{
+    aiwar::core::Team team = aiwar::core::ThinkWatchdog::current();
+    if(!aiwar::core::ThinkWatchdog::expired(team))
+        return 0;
+    PyErr_SetString(PyExc_RuntimeError, "think time over budget");
+    return -1;
+}
+
+// called by the watchdog thread, python runs the pending calls between two bytecodes
+void interruptPython()
+{
+    Py_AddPendingCall(&raiseOverBudget, NULL);
+}
+
+// a python play function failed: the team loses, or forfeits when it has been stopped by the watchdog
+void callFailed(aiwar::core::Team team, const char *what)
+{
+    std::cerr << what << std::endl;
+    PyErr_Print();
+    if(aiwar::core::ThinkWatchdog::expired(team))
+        throw aiwar::core::BudgetError(team, "think time over budget, the python code has been stopped");
+    throw aiwar::core::HandlerError(team, what);
+}
+
+} // anonymous namespace
+
+
+PythonHandler::PythonHandler() : _initFlag(false), _mainState(NULL)
 {
 }
 
@@ -49,7 +82,20 @@ bool PythonHandler::initialize()
 {
     // initialize Python interpreter
     Py_InitializeEx(0);
+    _mainState = PyThreadState_Get();
+    aiwar::core::ThinkWatchdog::addInterrupt(&interruptPython);
+
+    if(!_initInterpreter())
+        return false;
+
+    // initilization is done
+    _initFlag = true;
+
+    return true;
+}
 
+bool PythonHandler::_initInterpreter()
+{
     // insert "." to the python path
     char *p = strdup("path");
     PyObject *path = PySys_GetObject(p);  // path is a borrowed ref, do not call Py_DECREF on it
@@ -88,9 +134,6 @@ bool PythonHandler::initialize()
         return false;
     }
 
-    // initilization is done
-    _initFlag = true;
-
     return true;
 }
 
@@ -100,87 +143,122 @@ bool PythonHandler::finalize()
 
     // unload every player
 
+    // end the interpreters of the players, the main one must be the current one after that
+    PlayerMap::iterator it;
+    for(it = _playerMap.begin() ; it != _playerMap.end() ; ++it)
+    {
+        if(it->second->interpreter)
+        {
+            PyThreadState_Swap(it->second->interpreter);
+            Py_EndInterpreter(it->second->interpreter);
+            PyThreadState_Swap(_mainState);
+            it->second->interpreter = NULL;
+        }
+    }
+
     Py_Finalize();
     return true;
 }
 
-bool PythonHandler::load(P player, const std::string &moduleName)
+// get a callable attribute of a module, a missing optional one is left NULL
+static bool getHandler(PyObject *pModule, const char *name, bool optional, PyObject *&pHandler)
 {
-    // load module
-    PyObject *pName = PyString_FromString(moduleName.c_str());
-    if(!pName)
+    pHandler = PyObject_GetAttrString(pModule, name);
+    if(!pHandler)
     {
+        if(optional && PyErr_ExceptionMatches(PyExc_AttributeError))
+        {
+            PyErr_Clear();
+            return true;
+        }
         PyErr_Print();
         return false;
     }
 
-    PyObject *pModule = PyImport_Import(pName);
-    Py_DECREF(pName);
-    if(!pModule)
+    if(!PyCallable_Check(pHandler))
     {
-        PyErr_Print();
+        std::cerr << name << " is not callable\n";
+        Py_CLEAR(pHandler);
         return false;
     }
 
-    // load and check MiningShipHandler
-    PyObject *pMiningShip_Handler = PyObject_GetAttrString(pModule, "play_miningship");
-    if(!pMiningShip_Handler)
+    return true;
+}
+
+bool PythonHandler::load(P player, const std::string &moduleName)
+{
+    // with isolated teams, the player has its own interpreter: its modules are not shared
+    PyThreadState *ts = NULL;
+    if(aiwar::core::Config::instance().isolateTeams)
     {
-        Py_DECREF(pModule);
-        PyErr_Print();
-        return false;
+        ts = Py_NewInterpreter();
+        if(!ts)
+        {
+            std::cerr << "Fail to create an interpreter for " << moduleName << std::endl;
+            PyThreadState_Swap(_mainState);
+            return false;
+        }
+        if(!_initInterpreter())
+        {
+            Py_EndInterpreter(ts);
+            PyThreadState_Swap(_mainState);
+            return false;
+        }
     }
 
-    if(!PyCallable_Check(pMiningShip_Handler))
+    bool ok = _load(player, moduleName, ts);
+
+    if(ts)
     {
-        Py_CLEAR(pMiningShip_Handler);
-        Py_DECREF(pModule);
-        PyErr_Print();
-        return false;
+        if(!ok)
+            Py_EndInterpreter(ts);
+        PyThreadState_Swap(_mainState);
     }
+    return ok;
+}
 
-    // load and check Base Handler
-    PyObject *pBase_Handler = PyObject_GetAttrString(pModule, "play_base");
-    if(!pBase_Handler)
+bool PythonHandler::_load(P player, const std::string &moduleName, PyThreadState *ts)
+{
+    // load module
+    PyObject *pName = PyString_FromString(moduleName.c_str());
+    if(!pName)
     {
-        Py_CLEAR(pMiningShip_Handler);
-        Py_DECREF(pModule);
         PyErr_Print();
         return false;
     }
 
-    if(!PyCallable_Check(pMiningShip_Handler))
+    PyObject *pModule = PyImport_Import(pName);
+    Py_DECREF(pName);
+    if(!pModule)
     {
-        Py_CLEAR(pMiningShip_Handler);
-        Py_CLEAR(pBase_Handler);
-        Py_DECREF(pModule);
         PyErr_Print();
         return false;
     }
 
-    // load and check Fighter Handler
-    PyObject *pFighter_Handler = PyObject_GetAttrString(pModule, "play_fighter");
-    if(!pFighter_Handler)
+    // load and check the team handler, optional
+    PyObject *pTeam_Handler = NULL;
+    if(!getHandler(pModule, "play_team", true, pTeam_Handler))
     {
-        Py_CLEAR(pMiningShip_Handler);
-        Py_CLEAR(pBase_Handler);
         Py_DECREF(pModule);
-        PyErr_Print();
         return false;
     }
 
-    if(!PyCallable_Check(pFighter_Handler))
+    // load and check the unit handlers, optional with a team handler
+    const bool optional = (pTeam_Handler != NULL);
+    PyObject *pMiningShip_Handler = NULL, *pBase_Handler = NULL, *pFighter_Handler = NULL;
+    if(!getHandler(pModule, "play_miningship", optional, pMiningShip_Handler)
+       || !getHandler(pModule, "play_base", optional, pBase_Handler)
+       || !getHandler(pModule, "play_fighter", optional, pFighter_Handler))
     {
-        Py_CLEAR(pMiningShip_Handler);
-        Py_CLEAR(pBase_Handler);
-        Py_CLEAR(pFighter_Handler);
+        Py_XDECREF(pTeam_Handler);
+        Py_XDECREF(pMiningShip_Handler);
+        Py_XDECREF(pBase_Handler);
         Py_DECREF(pModule);
-        PyErr_Print();
         return false;
     }
 
     // add handlers to player map
-    PlayerInfo *info = new PlayerInfo(pBase_Handler, pMiningShip_Handler, pFighter_Handler);
+    PlayerInfo *info = new PlayerInfo(pBase_Handler, pMiningShip_Handler, pFighter_Handler, pTeam_Handler, ts);
     info->moduleName = moduleName;
     info->module = pModule;
     _playerMap[player] = info;
@@ -209,6 +287,19 @@ PythonHandler::PF& PythonHandler::get_BaseHandler(P player)
     }
 }
 
+aiwar::core::TeamPlayFunction* PythonHandler::get_TeamHandler(P player)
+{
+    PlayerMap::iterator it = _playerMap.find(player);
+    if(it != _playerMap.end())
+    {
+        return it->second->teamHandler.handler() ? &it->second->teamHandler : NULL;
+    }
+    else
+    {
+        throw std::runtime_error("Player not registered");
+    }
+}
+
 PythonHandler::PF& PythonHandler::get_MiningShipHandler(P player)
 {
     PlayerMap::iterator it = _playerMap.find(player);
@@ -237,15 +328,15 @@ PythonHandler::PF& PythonHandler::get_FighterHandler(P player)
 
 void PythonHandler::play_miningShip(PyObject *pHandler, aiwar::core::Playable *item)
 {
-    // create the MiningShip PyObject*
-    aiwar::core::MiningShip *m = dynamic_cast<aiwar::core::MiningShip*>(item);
+    // get the MiningShip PyObject*, kept from one round to the next
+    aiwar::core::MiningShip *m = aiwar::core::item_cast<aiwar::core::MiningShip>(item);
     if(!m)
     {
         std::cerr << "Bad cast error : play_miningShip_py expects MiningShip* argument" << std::endl;
         throw std::runtime_error("Bad cast error : play_miningShip_py expects MiningShip* argument");
     }
 
-    PyObject *pM = MiningShip_New(m);
+    PyObject *pM = Playable_Get(m);
     if(!pM)
     {
         std::cerr << "Error while creating new MiningShip python object" << std::endl;
@@ -253,28 +344,30 @@ void PythonHandler::play_miningShip(PyObject *pHandler, aiwar::core::Playable *i
         throw std::runtime_error("Error while creating new MiningShip python object");
     }
 
-    PyObject *pResult = PyObject_CallFunctionObjArgs(pHandler, pM, NULL);
+    PyObject *pResult;
+    {
+        aiwar::core::ProfileScope s(aiwar::core::Profiler::PYTHON);
+        pResult = PyObject_CallFunctionObjArgs(pHandler, pM, NULL);
+    }
     Py_DECREF(pM);
     if(!pResult)
     {
-        std::cerr << "Error while calling pMiningShip_Handler" << std::endl;
-        PyErr_Print();
-        throw aiwar::core::HandlerError(item->team(), "Error while calling pMiningShip_Handler");
+        callFailed(item->team(), "Error while calling pMiningShip_Handler");
     }
     Py_DECREF(pResult);
 }
 
 void PythonHandler::play_base(PyObject *pHandler, aiwar::core::Playable *item)
 {
-    // create the Base PyObject*
-    aiwar::core::Base *b = dynamic_cast<aiwar::core::Base*>(item);
+    // get the Base PyObject*, kept from one round to the next
+    aiwar::core::Base *b = aiwar::core::item_cast<aiwar::core::Base>(item);
     if(!b)
     {
         std::cerr << "Bad cast error: play_base expects Base* argument" << std::endl;
         throw std::runtime_error("Bad cast error: play_base expects Base* argument");
     }
 
-    PyObject *pB = Base_New(b);
+    PyObject *pB = Playable_Get(b);
     if(!pB)
     {
         std::cerr << "Error while creating new Base python object" << std::endl;
@@ -283,28 +376,30 @@ void PythonHandler::play_base(PyObject *pHandler, aiwar::core::Playable *item)
     }
 
     // call the python function
-    PyObject *pResult = PyObject_CallFunctionObjArgs(pHandler, pB, NULL);
+    PyObject *pResult;
+    {
+        aiwar::core::ProfileScope s(aiwar::core::Profiler::PYTHON);
+        pResult = PyObject_CallFunctionObjArgs(pHandler, pB, NULL);
+    }
     Py_DECREF(pB);
     if(!pResult)
     {
-        std::cerr << "Error while calling pBase_Handler" << std::endl;
-        PyErr_Print();
-        throw aiwar::core::HandlerError(item->team(), "Error while calling pBase_Handler");
+        callFailed(item->team(), "Error while calling pBase_Handler");
     }
     Py_DECREF(pResult);
 }
 
 void PythonHandler::play_fighter(PyObject *pHandler, aiwar::core::Playable *item)
 {
-    // create the Fighter PyObject*
-    aiwar::core::Fighter *f = dynamic_cast<aiwar::core::Fighter*>(item);
+    // get the Fighter PyObject*, kept from one round to the next
+    aiwar::core::Fighter *f = aiwar::core::item_cast<aiwar::core::Fighter>(item);
     if(!f)
     {
         std::cerr << "Bad cast error : play_fighter expects Fighter* argument" << std::endl;
         throw std::runtime_error("Bad cast error : play_fighter expects Fighter* argument");
     }
 
-    PyObject *pF = Fighter_New(f);
+    PyObject *pF = Playable_Get(f);
     if(!pF)
     {
         std::cerr << "Error while creating new Fighter python object" << std::endl;
@@ -313,20 +408,89 @@ void PythonHandler::play_fighter(PyObject *pHandler, aiwar::core::Playable *item
     }
 
     // call the python function
-    PyObject *pResult = PyObject_CallFunctionObjArgs(pHandler, pF, NULL);
+    PyObject *pResult;
+    {
+        aiwar::core::ProfileScope s(aiwar::core::Profiler::PYTHON);
+        pResult = PyObject_CallFunctionObjArgs(pHandler, pF, NULL);
+    }
     Py_DECREF(pF);
     if(!pResult)
     {
-        std::cerr << "Error while calling pFighter_Handler" << std::endl;
+        callFailed(item->team(), "Error while calling pFighter_Handler");
+    }
+    Py_DECREF(pResult);
+}
+
+// append the python objects of units to a new list
+template<class T>
+static PyObject* unitList(const std::vector<T*> &units)
+{
+    PyObject *pList = PyList_New(units.size());
+    if(!pList)
+        return NULL;
+    countPythonObject(pList);
+
+    for(typename std::vector<T*>::size_type i = 0 ; i < units.size() ; ++i)
+    {
+        PyObject *pU = Playable_Get(units[i]);
+        if(!pU)
+        {
+            Py_DECREF(pList);
+            return NULL;
+        }
+        PyList_SET_ITEM(pList, i, pU); // steals the reference
+    }
+    return pList;
+}
+
+void PythonHandlerTeamPlayFunction::operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters)
+{
+    // the units of the round all belong to the same team
+    aiwar::core::Team team = aiwar::core::NO_TEAM;
+    PythonInterpreterSwitch s(_ts);
+    if(!bases.empty())
+        team = bases.front()->team();
+    else if(!miningShips.empty())
+        team = miningShips.front()->team();
+    else if(!fighters.empty())
+        team = fighters.front()->team();
+    else
+        return;
+
+    PyObject *pB = unitList(bases);
+    PyObject *pM = pB ? unitList(miningShips) : NULL;
+    PyObject *pF = pM ? unitList(fighters) : NULL;
+    if(!pF)
+    {
+        Py_XDECREF(pB);
+        Py_XDECREF(pM);
+        std::cerr << "Error while creating the unit lists of play_team" << std::endl;
         PyErr_Print();
-        throw aiwar::core::HandlerError(item->team(), "Error while calling pFighter_Handler");
+        throw std::runtime_error("Error while creating the unit lists of play_team");
+    }
+
+    // call the python function once for the whole team
+    PyObject *pResult;
+    {
+        aiwar::core::ProfileScope s(aiwar::core::Profiler::PYTHON);
+        pResult = PyObject_CallFunctionObjArgs(_h, pB, pM, pF, NULL);
+    }
+    Py_DECREF(pB);
+    Py_DECREF(pM);
+    Py_DECREF(pF);
+    if(!pResult)
+    {
+        callFailed(team, "Error while calling pTeam_Handler");
     }
     Py_DECREF(pResult);
 }
 
-PythonHandler::PlayerInfo::PlayerInfo(PyObject *bh, PyObject *mh, PyObject *fh)
-    : baseHandler(&PythonHandler::play_base, bh),
-      miningShipHandler(&PythonHandler::play_miningShip, mh),
-      fighterHandler(&PythonHandler::play_fighter, fh)
+PythonHandler::PlayerInfo::PlayerInfo(PyObject *bh, PyObject *mh, PyObject *fh, PyObject *th, PyThreadState *ts)
+    : module(NULL),
+      interpreter(ts),
+      baseHandler(&PythonHandler::play_base, bh, ts),
+      miningShipHandler(&PythonHandler::play_miningShip, mh, ts),
+      fighterHandler(&PythonHandler::play_fighter, fh, ts),
+      teamHandler(th, ts)
 {
 }
@@ -43,6 +43,7 @@ public:
     PF& get_BaseHandler(P player);
     PF& get_MiningShipHandler(P player);
     PF& get_FighterHandler(P player);
+    aiwar::core::TeamPlayFunction* get_TeamHandler(P player);
 
 private:
     class PlayerInfo;
@@ -56,9 +57,32 @@ private:
     static void play_miningShip(PyObject *pHandler, aiwar::core::Playable *item);
     static void play_fighter(PyObject *pHandler, aiwar::core::Playable *item);
 
+    bool _load(P player, const std::string &moduleName, PyThreadState *ts);
+
+    // add "." to the path, the aiwar module and the random seed to the current interpreter
+    static bool _initInterpreter();
 
     bool _initFlag;
     PlayerMap _playerMap;
+    PyThreadState *_mainState; ///< the main interpreter, current between two calls to a player
+};
+
+
+/**
+ * \brief Make an interpreter the current one during the life of the object
+ */
+class PythonInterpreterSwitch
+{
+public:
+    PythonInterpreterSwitch(PyThreadState *ts) : _prev(ts ? PyThreadState_Swap(ts) : NULL), _ts(ts) {}
+    ~PythonInterpreterSwitch() { if(_ts) PyThreadState_Swap(_prev); }
+
+private:
+    PythonInterpreterSwitch(const PythonInterpreterSwitch&);
+    PythonInterpreterSwitch& operator=(const PythonInterpreterSwitch&);
+
+    PyThreadState *_prev;
+    PyThreadState *_ts; ///< NULL to keep the current interpreter
 };
 
 
@@ -67,25 +91,48 @@ class PythonHandlerPlayFunction : public aiwar::core::PlayFunction
 public:
     typedef void (*PH_PF)(PyObject *h, aiwar::core::Playable *p);
 
-    PythonHandlerPlayFunction(PH_PF fn, PyObject *handler) : _fun(fn), _h(handler) {}
-    void operator()(aiwar::core::Playable* p) { _fun(_h, p); }
+    PythonHandlerPlayFunction(PH_PF fn, PyObject *handler, PyThreadState *ts) : _fun(fn), _h(handler), _ts(ts) {}
+    void operator()(aiwar::core::Playable* p) { PythonInterpreterSwitch s(_ts); _fun(_h, p); }
 
 private:
     PH_PF _fun;
     PyObject *_h;
+    PyThreadState *_ts; ///< interpreter of the handler, NULL for the current one
+};
+
+
+/**
+ * \brief Calls the play_team function of a module, with the lists of bases, mining ships and fighters
+ *
+ * It is not concurrent(): the interpreters of the players share the lock of
+ * Python 2, so the python teams play one after the other, even isolated.
+ */
+class PythonHandlerTeamPlayFunction : public aiwar::core::TeamPlayFunction
+{
+public:
+    PythonHandlerTeamPlayFunction(PyObject *handler, PyThreadState *ts) : _h(handler), _ts(ts) {}
+    void operator()(const BaseVector &bases, const MiningShipVector &miningShips, const FighterVector &fighters);
+
+    PyObject* handler() const { return _h; }
+
+private:
+    PyObject *_h;
+    PyThreadState *_ts; ///< interpreter of the handler, NULL for the current one
 };
 
 
 class PythonHandler::PlayerInfo
 {
 public:
-    PlayerInfo(PyObject *bh, PyObject *mh, PyObject *fh);
+    PlayerInfo(PyObject *bh, PyObject *mh, PyObject *fh, PyObject *th, PyThreadState *ts);
 
     std::string moduleName;
     PyObject* module;
+    PyThreadState *interpreter; ///< own interpreter of the player, NULL if it uses the main one
     PythonHandlerPlayFunction baseHandler;
     PythonHandlerPlayFunction miningShipHandler;
     PythonHandlerPlayFunction fighterHandler;
+    PythonHandlerTeamPlayFunction teamHandler; ///< its handler is NULL if the module has no play_team
 };
 
 #endif /* PYTHON_HANDLER_HPP */
@@ -20,17 +20,32 @@
 #include <Python.h>
 #include <structmember.h>
 
+#include <cstring>
+#include <vector>
+
 #include "python_wrapper.hpp"
 
 #include "config.hpp"
 
+#define AIWAR_PYTHON_MODULE // no aiwar_import_api(), this is the module
+#include "client/aiwar_python.h"
+
 /*** Generic Item Object ***/
 
 typedef struct {
     PyObject_HEAD
-    aiwar::core::Item* item;
+    aiwar::core::Item* item; ///< NULL once the item has been deleted
+    aiwar::core::Item::Key key; ///< kept after the deletion, for hash and comparisons
 } Item;
 
+// teams of nearest() and kNearest(), relative to the caller
+enum NearestTeam
+{
+    NEAREST_FRIENDS = 0x1,
+    NEAREST_ENEMIES = 0x2,
+    NEAREST_NEUTRALS = 0x4
+};
+
 // global tuple with all PyTypeObject based on Item
 static PyObject* pItemBasedTuple = NULL;
 
@@ -38,6 +53,7 @@ static void
 Item_dealloc(Item* self)
 {
 //    self->ob_type->tp_free((PyObject*)self);  -> replace by:
+    uncountPythonObject();
     PyObject_Del(self);
 }
 
@@ -50,14 +66,76 @@ Item_init(Item *self, PyObject * /*args*/, PyObject * /*kwds*/)
     return -1;
 }
 
+// return false with a RuntimeError if the item has been deleted from the game
+static bool
+Item_alive(PyObject *o)
+{
+    if(((Item*)o)->item)
+        return true;
+
+    PyErr_SetString(PyExc_RuntimeError, "the item has been destroyed");
+    return false;
+}
+
+// methods of a deleted item raise, special attributes are still available
+static PyObject *
+Item_getattro(PyObject *o, PyObject *name)
+{
+    if(!((Item*)o)->item)
+    {
+        const char *n = PyString_AsString(name);
+        if(!n)
+            return NULL;
+        if(std::strncmp(n, "__", 2) != 0)
+        {
+            Item_alive(o);
+            return NULL;
+        }
+    }
+    return PyObject_GenericGetAttr(o, name);
+}
+
+// the views of an item are equal, even after its deletion, so they can be used as dict keys
+static long
+Item_hash(Item *self)
+{
+    long h = static_cast<long>(self->key ^ (self->key >> 32));
+    return (h == -1) ? -2 : h;
+}
+
+static PyObject *
+Item_richcompare(PyObject *a, PyObject *b, int op)
+{
+    if((op != Py_EQ && op != Py_NE) || !PyObject_IsInstance(a, pItemBasedTuple) || !PyObject_IsInstance(b, pItemBasedTuple))
+    {
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+
+    bool equal = ((Item*)a)->key == ((Item*)b)->key;
+    if(equal == (op == Py_EQ))
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
 static PyObject * Item_pos(Item* self); // Item
 static PyObject * Item_neighbours(Item* self); // Item
+static PyObject * Item_nearest(Item* self, PyObject *args); // Playable
+static PyObject * Item_kNearest(Item* self, PyObject *args); // Playable
+static PyObject * Item_snapshot(Item* self); // Playable
+static PyObject * Item_closest(Item* self, PyObject *args); // Playable
+static PyObject * Item_within(Item* self, PyObject *args); // Playable
+static PyObject * Item_countWithin(Item* self, PyObject *args); // Playable
+static PyObject * Item_argminBy(Item* self, PyObject *args); // Playable
 static PyObject * Item_distanceTo(Item* self, PyObject *args); // Item
 static PyObject * Item_rotateOf(Item* self, PyObject *args); // Movable
 static PyObject * Item_rotateTo(Item* self, PyObject *args); // Movable
 static PyObject * Item_angle(Item* self); // Movable
 static PyObject * Item_fuel(Item* self, PyObject *args); // Movable
 static PyObject * Item_move(Item* self); // Movable
+static PyObject * Item_moveTowards(Item* self, PyObject *args); // Movable
+static PyObject * Item_keepDistance(Item* self, PyObject *args); // Movable
 static PyObject * Item_life(Item* self); // Living
 static PyObject * Item_team(Item* self); // Playable
 static PyObject * Item_isFriend(Item* self, PyObject *args); // Playable
@@ -93,12 +171,21 @@ static PyMemberDef MiningShip_members[] = {
 static PyMethodDef MiningShip_methods[] = {
     {"pos", (PyCFunction)Item_pos, METH_NOARGS, "Return the position of the item"},
     {"neighbours", (PyCFunction)Item_neighbours, METH_NOARGS, "Return the neighbours of the item"},
+    {"nearest", (PyCFunction)Item_nearest, METH_VARARGS, "Return the nearest neighbour of the given kinds and teams, or None"},
+    {"kNearest", (PyCFunction)Item_kNearest, METH_VARARGS, "Return the k nearest neighbours of the given kinds and teams, nearest first"},
+    {"snapshot", (PyCFunction)Item_snapshot, METH_NOARGS, "Return a read-only buffer with one row per neighbour, see SNAPSHOT_FORMAT"},
+    {"closest", (PyCFunction)Item_closest, METH_VARARGS, "Return the closest neighbour of the given kinds and teams with at least minLife, or None"},
+    {"within", (PyCFunction)Item_within, METH_VARARGS, "Return the neighbours of the given kinds and teams within the radius"},
+    {"countWithin", (PyCFunction)Item_countWithin, METH_VARARGS, "Return the number of neighbours of the given kinds and teams within the radius"},
+    {"argminBy", (PyCFunction)Item_argminBy, METH_VARARGS, "Return the neighbour with the lowest 'distance', 'life' or 'fuel', or None"},
     {"distanceTo", (PyCFunction)Item_distanceTo, METH_VARARGS, "Return the distance to the other item or a point"},
     {"rotateOf", (PyCFunction)Item_rotateOf, METH_VARARGS, "Rotate the movable item of the given angle"},
     {"rotateTo", (PyCFunction)Item_rotateTo, METH_VARARGS, "Rotate the movable item in the direction of the other item"},
     {"angle", (PyCFunction)Item_angle, METH_NOARGS, "Return the current angle of the ship"},
     {"fuel", (PyCFunction)Item_fuel, METH_VARARGS, "Return the current fuel of the ship"},
     {"move", (PyCFunction)Item_move, METH_NOARGS, "Move the movable item in the direction given by its angle"},
+    {"moveTowards", (PyCFunction)Item_moveTowards, METH_VARARGS, "Rotate to the other item or point and move, unless within stopRadius of it"},
+    {"keepDistance", (PyCFunction)Item_keepDistance, METH_VARARGS, "Move toward the other item or point if farther than radius, away from it if nearer"},
     {"life", (PyCFunction)Item_life, METH_NOARGS, "Return the remaining life of the item"},
     {"team", (PyCFunction)Item_team, METH_NOARGS, "Return the team of the item"},
     {"isFriend", (PyCFunction)Item_isFriend, METH_VARARGS, "Return true if the given item belong to the same team"},
@@ -132,17 +219,17 @@ static PyTypeObject MiningShipType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Playable MiningShip objects",/* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -176,8 +263,10 @@ PyObject* MiningShip_New(aiwar::core::MiningShip *m)
         std::cerr << "Error while creating new MiningShip python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -209,17 +298,17 @@ static PyTypeObject MiningShipConstType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Const MiningShip objects",/* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -253,8 +342,10 @@ PyObject* MiningShipConst_New(aiwar::core::MiningShip *m)
         std::cerr << "Error while creating new MiningShipConst python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -286,17 +377,17 @@ static PyTypeObject MineralType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Mineral objects",         /* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -330,8 +421,10 @@ PyObject* Mineral_New(aiwar::core::Mineral *m)
         std::cerr << "Error while creating new Mineral python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -363,17 +456,17 @@ static PyTypeObject MissileType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Missile objects",         /* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -407,8 +500,10 @@ PyObject* Missile_New(aiwar::core::Missile *m)
         std::cerr << "Error while creating new Missile python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -421,6 +516,13 @@ static PyMemberDef Base_members[] = {
 static PyMethodDef Base_methods[] = {
     {"pos", (PyCFunction)Item_pos, METH_NOARGS, "Return the position of the item"},
     {"neighbours", (PyCFunction)Item_neighbours, METH_NOARGS, "Return the neighbours of the item"},
+    {"nearest", (PyCFunction)Item_nearest, METH_VARARGS, "Return the nearest neighbour of the given kinds and teams, or None"},
+    {"kNearest", (PyCFunction)Item_kNearest, METH_VARARGS, "Return the k nearest neighbours of the given kinds and teams, nearest first"},
+    {"snapshot", (PyCFunction)Item_snapshot, METH_NOARGS, "Return a read-only buffer with one row per neighbour, see SNAPSHOT_FORMAT"},
+    {"closest", (PyCFunction)Item_closest, METH_VARARGS, "Return the closest neighbour of the given kinds and teams with at least minLife, or None"},
+    {"within", (PyCFunction)Item_within, METH_VARARGS, "Return the neighbours of the given kinds and teams within the radius"},
+    {"countWithin", (PyCFunction)Item_countWithin, METH_VARARGS, "Return the number of neighbours of the given kinds and teams within the radius"},
+    {"argminBy", (PyCFunction)Item_argminBy, METH_VARARGS, "Return the neighbour with the lowest 'distance', 'life' or 'fuel', or None"},
     {"distanceTo", (PyCFunction)Item_distanceTo, METH_VARARGS, "Return the distance to the other item or a point"},
     {"life", (PyCFunction)Item_life, METH_NOARGS, "Return the remaining life of the item"},
     {"team", (PyCFunction)Item_team, METH_NOARGS, "Return the team of the item"},
@@ -461,17 +563,17 @@ static PyTypeObject BaseType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Playable Base objects",   /* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -505,8 +607,10 @@ PyObject* Base_New(aiwar::core::Base *m)
         std::cerr << "Error while creating new Base python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -537,17 +641,17 @@ static PyTypeObject BaseConstType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Const Base objects",      /* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -581,8 +685,10 @@ PyObject* BaseConst_New(aiwar::core::Base *m)
         std::cerr << "Error while creating new BaseConst python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -595,12 +701,21 @@ static PyMemberDef Fighter_members[] = {
 static PyMethodDef Fighter_methods[] = {
     {"pos", (PyCFunction)Item_pos, METH_NOARGS, "Return the position of the item"},
     {"neighbours", (PyCFunction)Item_neighbours, METH_NOARGS, "Return the neighbours of the item"},
+    {"nearest", (PyCFunction)Item_nearest, METH_VARARGS, "Return the nearest neighbour of the given kinds and teams, or None"},
+    {"kNearest", (PyCFunction)Item_kNearest, METH_VARARGS, "Return the k nearest neighbours of the given kinds and teams, nearest first"},
+    {"snapshot", (PyCFunction)Item_snapshot, METH_NOARGS, "Return a read-only buffer with one row per neighbour, see SNAPSHOT_FORMAT"},
+    {"closest", (PyCFunction)Item_closest, METH_VARARGS, "Return the closest neighbour of the given kinds and teams with at least minLife, or None"},
+    {"within", (PyCFunction)Item_within, METH_VARARGS, "Return the neighbours of the given kinds and teams within the radius"},
+    {"countWithin", (PyCFunction)Item_countWithin, METH_VARARGS, "Return the number of neighbours of the given kinds and teams within the radius"},
+    {"argminBy", (PyCFunction)Item_argminBy, METH_VARARGS, "Return the neighbour with the lowest 'distance', 'life' or 'fuel', or None"},
     {"distanceTo", (PyCFunction)Item_distanceTo, METH_VARARGS, "Return the distance to the other item or a point"},
     {"rotateOf", (PyCFunction)Item_rotateOf, METH_VARARGS, "Rotate the movable item of the given angle"},
     {"rotateTo", (PyCFunction)Item_rotateTo, METH_VARARGS, "Rotate the movable item in the direction of the other item"},
     {"angle", (PyCFunction)Item_angle, METH_NOARGS, "Return the current angle of the ship"},
     {"fuel", (PyCFunction)Item_fuel, METH_VARARGS, "Return the current fuel of the ship"},
     {"move", (PyCFunction)Item_move, METH_NOARGS, "Move the movable item in the direction given by its angle"},
+    {"moveTowards", (PyCFunction)Item_moveTowards, METH_VARARGS, "Rotate to the other item or point and move, unless within stopRadius of it"},
+    {"keepDistance", (PyCFunction)Item_keepDistance, METH_VARARGS, "Move toward the other item or point if farther than radius, away from it if nearer"},
     {"life", (PyCFunction)Item_life, METH_NOARGS, "Return the remaining life of the item"},
     {"team", (PyCFunction)Item_team, METH_NOARGS, "Return the team of the item"},
     {"isFriend", (PyCFunction)Item_isFriend, METH_VARARGS, "Return true if the given item belong to the same team"},
@@ -634,17 +749,17 @@ static PyTypeObject FighterType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Playable Fighter objects",/* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -678,8 +793,10 @@ PyObject* Fighter_New(aiwar::core::Fighter *m)
         std::cerr << "Error while creating new Fighter python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
@@ -711,17 +828,17 @@ static PyTypeObject FighterConstType = {
     0,                         /*tp_as_number*/
     0,                         /*tp_as_sequence*/
     0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
+    (hashfunc)Item_hash,       /*tp_hash */
     0,                         /*tp_call*/
     0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
+    Item_getattro,             /*tp_getattro*/
     0,                         /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "Const Fighter objects",   /* tp_doc */
     0,                         /* tp_traverse */
     0,                         /* tp_clear */
-    0,                         /* tp_richcompare */
+    Item_richcompare,          /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
@@ -755,247 +872,1052 @@ PyObject* FighterConst_New(aiwar::core::Fighter *m)
         std::cerr << "Error while creating new FighterConst python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pM);
 
     pM->item = m;
+    pM->key = m->_getKey();
     return (PyObject*)pM;
 }
 
 
+/*************** Snapshot object **************/
 
-/**** methods implementation ****/
-static PyObject *
-Item_pos(Item* self)
+// one row of a snapshot, the layout is given to Python by SNAPSHOT_FORMAT
+// all fields are at their natural alignment, so the native struct format has no implicit padding
+typedef struct {
+    unsigned long long key;
+    unsigned char kind; ///< ItemKind, 1 << kind is one of MINERALS, MISSILES, ...
+    unsigned char team; ///< Team, NO_TEAM if the item is not Playable
+    char pad[6];
+    double x;
+    double y;
+    double angle; ///< 0 if the item is not Movable
+    unsigned int life; ///< 0 if the item is not Living
+    unsigned int fuel; ///< only for a friend in the communication radius, else 0
+} SnapshotRow;
+
+static char SNAPSHOT_FORMAT[] = "QBB6xdddII";
+
+typedef struct {
+    PyObject_HEAD
+    std::vector<SnapshotRow> *rows;
+    Py_ssize_t shape[1];
+    Py_ssize_t strides[1];
+    Py_ssize_t exports; ///< number of buffers exported, the rows must not change while not 0
+} Snapshot;
+
+static void
+Snapshot_dealloc(Snapshot* self)
 {
-    return Py_BuildValue("(dd)", ((Item*)self)->item->xpos(), ((Item*)self)->item->ypos());
+    delete self->rows;
+    uncountPythonObject();
+    PyObject_Del(self);
 }
 
-static PyObject * Item_neighbours(Item* self)
+static Py_ssize_t
+Snapshot_length(Snapshot* self)
 {
-    PyObject* pList = PyList_New(0);
-    if(!pList)
-        return NULL;
-
-    aiwar::core::Item::ItemList n = self->item->neighbours();
-    aiwar::core::Item::ItemList::iterator it;
-    aiwar::core::Item *item;
-    aiwar::core::Mineral *mineral;
-    aiwar::core::Missile *missile;
-    aiwar::core::MiningShip *miningShip;
-    aiwar::core::Base *base;
-    aiwar::core::Fighter *fighter;
-    PyObject* pItem = NULL;
-
-    for(it = n.begin() ; it != n.end() ; ++it)
-    {
-        item = *it;
-        pItem = NULL;
-
-        if((mineral = dynamic_cast<aiwar::core::Mineral*>(item)))
-            pItem = Mineral_New(mineral);
-        else if((missile = dynamic_cast<aiwar::core::Missile*>(item)))
-            pItem = Missile_New(missile);
-        else if((miningShip = dynamic_cast<aiwar::core::MiningShip*>(item)))
-            pItem = MiningShipConst_New(miningShip);
-        else if((base = dynamic_cast<aiwar::core::Base*>(item)))
-            pItem = BaseConst_New(base);
-        else if((fighter = dynamic_cast<aiwar::core::Fighter*>(item)))
-            pItem = FighterConst_New(fighter);
-
-        if(pItem)
-        {
-            int r = PyList_Append(pList, pItem);
-            Py_DECREF(pItem);
-            if(r != 0) // failure
-            {
-                std::cerr << "Error while filling neighbours Set" << std::endl;
-                PyErr_Print();
-                Py_DECREF(pList);
-                return NULL;
-            }
-        }
-        else
-            std::cerr << "Item type not yet implemented" << std::endl;
-    }
+    return self->rows->size();
+}
 
-    return pList;
+static void*
+Snapshot_data(Snapshot* self)
+{
+    static SnapshotRow empty;
+    return self->rows->empty() ? &empty : &(*self->rows)[0];
 }
 
-static PyObject *
-Item_distanceTo(Item* self, PyObject *args)
+static int
+Snapshot_getbuffer(Snapshot* self, Py_buffer *view, int flags)
 {
-    PyObject *o = NULL;
-    double px = 0.0;
-    double py = 0.0;
-    if(!PyArg_ParseTuple(args, "O", &o))
-    {
-        return NULL;
-    }
-    if(PyObject_IsInstance(o, pItemBasedTuple))
-    {
-        return PyFloat_FromDouble(self->item->distanceTo(((Item*)o)->item));
-    }
-    else if(PyArg_ParseTuple(o, "dd", &px, &py))
-    {
-        return PyFloat_FromDouble(self->item->distanceTo(px, py));
-    }
-    else
+    if(flags & PyBUF_WRITABLE)
     {
-        PyErr_SetString(PyExc_TypeError, "must be an Item or a tuple of two floats");
-        return NULL;
+        PyErr_SetString(PyExc_BufferError, "snapshot is read-only");
+        return -1;
     }
+
+    self->shape[0] = self->rows->size();
+    self->strides[0] = sizeof(SnapshotRow);
+
+    view->buf = Snapshot_data(self);
+    view->obj = (PyObject*)self;
+    Py_INCREF(self);
+    view->len = self->rows->size() * sizeof(SnapshotRow);
+    view->readonly = 1;
+    view->itemsize = sizeof(SnapshotRow);
+    view->format = (flags & PyBUF_FORMAT) ? SNAPSHOT_FORMAT : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    self->exports++;
+    return 0;
 }
 
-static PyObject *
-Item_rotateOf(Item* self, PyObject *args)
+static void
+Snapshot_releasebuffer(Snapshot* self, Py_buffer * /*view*/)
 {
-    double a;
-    if(!PyArg_ParseTuple(args, "d", &a))
-        return NULL;
-    dynamic_cast<aiwar::core::Movable*>(self->item)->rotateOf(a);
-    Py_RETURN_NONE;
+    self->exports--;
 }
 
-static PyObject *
-Item_rotateTo(Item* self, PyObject *args)
+// old buffer protocol, for the modules of Python 2 that only know it (numpy.frombuffer)
+static Py_ssize_t
+Snapshot_getreadbuffer(Snapshot* self, Py_ssize_t segment, void **ptr)
 {
-    PyObject *o = NULL;
-    double px = -1.0;
-    double py = -1.0;
-    if(!PyArg_ParseTuple(args, "O", &o))
-    {
-        return NULL;
-    }
-    if(PyObject_IsInstance(o, pItemBasedTuple))
-    {
-        dynamic_cast<aiwar::core::Movable*>(self->item)->rotateTo(((Item*)o)->item);
-        Py_RETURN_NONE;
-    }
-    else if(PyArg_ParseTuple(o, "dd", &px, &py))
-    {
-        dynamic_cast<aiwar::core::Movable*>(self->item)->rotateTo(px, py);
-        Py_RETURN_NONE;
-    }
-    else
+    if(segment != 0)
     {
-        PyErr_SetString(PyExc_TypeError, "must be an Item or a tuple of two floats");
-        return NULL;
+        PyErr_SetString(PyExc_SystemError, "accessing non-existent snapshot segment");
+        return -1;
     }
+    *ptr = Snapshot_data(self);
+    return self->rows->size() * sizeof(SnapshotRow);
 }
 
-static PyObject *
-Item_angle(Item* self)
+static Py_ssize_t
+Snapshot_getsegcount(Snapshot* self, Py_ssize_t *lenp)
 {
-    return Py_BuildValue("d", dynamic_cast<aiwar::core::Movable*>(self->item)->angle());
+    if(lenp)
+        *lenp = self->rows->size() * sizeof(SnapshotRow);
+    return 1;
 }
 
-static PyObject *
-Item_fuel(Item* self, PyObject *args)
+static PySequenceMethods Snapshot_as_sequence = {
+    (lenfunc)Snapshot_length,  /* sq_length */
+    0,                         /* sq_concat */
+    0,                         /* sq_repeat */
+    0,                         /* sq_item */
+    0,                         /* sq_slice */
+    0,                         /* sq_ass_item */
+    0,                         /* sq_ass_slice */
+    0,                         /* sq_contains */
+    0,                         /* sq_inplace_concat */
+    0,                         /* sq_inplace_repeat */
+};
+
+static PyBufferProcs Snapshot_as_buffer = {
+    (readbufferproc)Snapshot_getreadbuffer, /* bf_getreadbuffer */
+    0,                         /* bf_getwritebuffer */
+    (segcountproc)Snapshot_getsegcount, /* bf_getsegcount */
+    0,                         /* bf_getcharbuffer */
+    (getbufferproc)Snapshot_getbuffer, /* bf_getbuffer */
+    (releasebufferproc)Snapshot_releasebuffer, /* bf_releasebuffer */
+};
+
+static PyTypeObject SnapshotType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "aiwar.Snapshot",          /*tp_name*/
+    sizeof(Snapshot),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)Snapshot_dealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &Snapshot_as_sequence,     /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &Snapshot_as_buffer,       /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, /*tp_flags*/
+    "Read-only rows of the neighbours of an item, one per neighbour", /* tp_doc */
+    0,                         /* tp_traverse */
+    0,                         /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,                         /* tp_weaklistoffset */
+    0,                         /* tp_iter */
+    0,                         /* tp_iternext */
+    0,                         /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+    0,                         /* tp_free */
+    0,                         /* tp_is_gc */
+    0,                         /* tp_bases */
+    0,                         /* tp_mro */
+    0,                         /* tp_cache */
+    0,                         /* tp_subclasses */
+    0,                         /* tp_weaklist */
+    0,                         /* tp_del */
+    0,                         /* tp_version_tag */
+};
+
+static Snapshot* Snapshot_New()
 {
-    PyObject *o = NULL;
-    if(!PyArg_ParseTuple(args, "|O", &o))
+    Snapshot *pS = PyObject_New(Snapshot, &SnapshotType);
+    if(!pS)
     {
+        std::cerr << "Error while creating new Snapshot python object" << std::endl;
         return NULL;
     }
+    countPythonObject((PyObject*)pS);
 
-    if(!o)
-    {
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Movable*>(self->item)->fuel());
-    }
-    else
+    pS->rows = new std::vector<SnapshotRow>();
+    pS->exports = 0;
+    return pS;
+}
+
+
+/*** Python objects kept by the items ***/
+
+// the two views of an item, created on demand and kept until the item is deleted
+class PythonBinding : public aiwar::core::ItemBinding
+{
+public:
+    PythonBinding() : playable(NULL), neighbour(NULL), snapshot(NULL) {}
+
+    void itemDeleted();
+
+    PyObject *playable; ///< given to the play function of the item
+    PyObject *neighbour; ///< seen by the other items
+    Snapshot *snapshot; ///< last snapshot of the item, its rows are reused by the next one
+};
+
+void PythonBinding::itemDeleted()
+{
+    // after Py_Finalize() the objects are gone with the interpreter
+    if(Py_IsInitialized())
     {
-        if(!PyObject_IsInstance(o, pItemBasedTuple))
+        // a player may still hold the objects: they raise from now on
+        if(playable)
         {
-            PyErr_SetString(PyExc_TypeError, "argmument is not an item");
-            return NULL;
+            ((Item*)playable)->item = NULL;
+            Py_DECREF(playable);
         }
-
-        aiwar::core::Movable *ml = dynamic_cast<aiwar::core::Movable*>(((Item*)o)->item);
-        if(!ml)
+        if(neighbour)
         {
-            PyErr_SetString(PyExc_TypeError, "argmument is not a Movable item");
-            return NULL;
+            ((Item*)neighbour)->item = NULL;
+            Py_DECREF(neighbour);
         }
-
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Playable*>(self->item)->fuel(ml));
+        Py_XDECREF(snapshot);
     }
+    delete this;
 }
 
-static PyObject *
-Item_move(Item* self)
+static PythonBinding* bindingOf(aiwar::core::Item *item)
 {
-    dynamic_cast<aiwar::core::Movable*>(self->item)->move();
-    Py_RETURN_NONE;
+    PythonBinding *b = static_cast<PythonBinding*>(item->_getBinding());
+    if(!b)
+    {
+        b = new PythonBinding();
+        item->_setBinding(b);
+    }
+    return b;
 }
 
-static PyObject *
-Item_life(Item* self)
+PyObject* Playable_Get(aiwar::core::Playable *p)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Living*>(self->item)->life());
+    aiwar::core::AllocSite a(aiwar::core::AllocTracker::PYTHON_OBJECTS);
+    PythonBinding *b = bindingOf(p);
+    if(!b->playable)
+    {
+        switch(p->_kind())
+        {
+        case aiwar::core::MININGSHIP_KIND:
+            b->playable = MiningShip_New(aiwar::core::item_cast<aiwar::core::MiningShip>(p));
+            break;
+        case aiwar::core::BASE_KIND:
+            b->playable = Base_New(aiwar::core::item_cast<aiwar::core::Base>(p));
+            break;
+        case aiwar::core::FIGHTER_KIND:
+            b->playable = Fighter_New(aiwar::core::item_cast<aiwar::core::Fighter>(p));
+            break;
+        default:
+            break;
+        }
+        if(!b->playable)
+            return NULL;
+    }
+
+    Py_INCREF(b->playable);
+    return b->playable;
 }
 
-static PyObject *
-Item_team(Item* self)
+PyObject* Neighbour_Get(aiwar::core::Item *item)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Playable*>(self->item)->team());
+    aiwar::core::AllocSite a(aiwar::core::AllocTracker::PYTHON_OBJECTS);
+    PythonBinding *b = bindingOf(item);
+    if(!b->neighbour)
+    {
+        switch(item->_kind())
+        {
+        case aiwar::core::MINERAL_KIND:
+            b->neighbour = Mineral_New(aiwar::core::item_cast<aiwar::core::Mineral>(item));
+            break;
+        case aiwar::core::MISSILE_KIND:
+            b->neighbour = Missile_New(aiwar::core::item_cast<aiwar::core::Missile>(item));
+            break;
+        case aiwar::core::MININGSHIP_KIND:
+            b->neighbour = MiningShipConst_New(aiwar::core::item_cast<aiwar::core::MiningShip>(item));
+            break;
+        case aiwar::core::BASE_KIND:
+            b->neighbour = BaseConst_New(aiwar::core::item_cast<aiwar::core::Base>(item));
+            break;
+        case aiwar::core::FIGHTER_KIND:
+            b->neighbour = FighterConst_New(aiwar::core::item_cast<aiwar::core::Fighter>(item));
+            break;
+        default:
+            break;
+        }
+        if(!b->neighbour)
+            return NULL;
+    }
+
+    Py_INCREF(b->neighbour);
+    return b->neighbour;
 }
 
+
+/**** methods implementation ****/
 static PyObject *
-Item_isFriend(Item* self, PyObject *args)
+Item_pos(Item* self)
 {
-    PyObject *o = NULL;
-    if(!PyArg_ParseTuple(args, "O", &o))
-    {
+    if(!Item_alive((PyObject*)self))
         return NULL;
-    }
+    return Py_BuildValue("(dd)", ((Item*)self)->item->xpos(), ((Item*)self)->item->ypos());
+}
 
-    if(!PyObject_IsInstance(o, pItemBasedTuple))
-    {
-        PyErr_SetString(PyExc_TypeError, "argmument is not an item");
-        return NULL;
-    }
+// append the neighbours to a Python list, without an intermediate C++ list
+class NeighbourListBuilder : public aiwar::core::NeighbourVisitor
+{
+public:
+    NeighbourListBuilder(PyObject *pList) : pList(pList), failed(false) {}
 
-    aiwar::core::Playable *pl = dynamic_cast<aiwar::core::Playable*>(((Item*)o)->item);
-    if(!pl)
+    bool visit(aiwar::core::Item *item);
+
+    PyObject *pList;
+    bool failed;
+};
+
+bool NeighbourListBuilder::visit(aiwar::core::Item *item)
+{
+    PyObject* pItem = Neighbour_Get(item);
+    if(pItem)
     {
-        PyErr_SetString(PyExc_TypeError, "argmument is not a Playable item");
-        return NULL;
+        int r = PyList_Append(pList, pItem);
+        Py_DECREF(pItem);
+        if(r != 0) // failure
+        {
+            std::cerr << "Error while filling neighbours Set" << std::endl;
+            PyErr_Print();
+            failed = true;
+            return false;
+        }
     }
-
-    if(dynamic_cast<aiwar::core::Playable*>(self->item)->isFriend(pl))
-        Py_RETURN_TRUE;
     else
-        Py_RETURN_FALSE;
+        std::cerr << "Item type not yet implemented" << std::endl;
+
+    return true;
 }
 
-static PyObject *
-Item_log(Item* self, PyObject *args)
+static PyObject * Item_neighbours(Item* self)
 {
-    const char *msg;
-    if(!PyArg_ParseTuple(args, "s", &msg))
+    if(!Item_alive((PyObject*)self))
         return NULL;
-    dynamic_cast<aiwar::core::Playable*>(self->item)->log(msg);
+    PyObject* pList = PyList_New(0);
+    if(!pList)
+        return NULL;
+    countPythonObject(pList);
+
+    NeighbourListBuilder builder(pList);
+    self->item->visitNeighbours(builder);
+    if(builder.failed)
+    {
+        Py_DECREF(pList);
+        return NULL;
+    }
+
+    return pList;
+}
+
+// kinds and teams of nearest() and kNearest(), teams are given relatively to the caller
+static aiwar::core::NeighbourFilter nearestFilter(aiwar::core::Item* self, unsigned int kinds, unsigned int teams)
+{
+    using namespace aiwar::core;
+
+    unsigned int teamMask = 0;
+    if(teams != 0)
+    {
+        Team team = item_cast<Playable>(self)->team();
+        Team other = (team == BLUE_TEAM) ? RED_TEAM : BLUE_TEAM;
+        if(teams & NEAREST_FRIENDS)
+            teamMask |= 1u << team;
+        if(teams & NEAREST_ENEMIES)
+            teamMask |= 1u << other;
+        if(teams & NEAREST_NEUTRALS)
+            teamMask |= 1u << NO_TEAM;
+    }
+
+    return NeighbourFilter(kinds, teamMask);
+}
+
+static PyObject *
+Item_nearest(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    unsigned int kinds = 0, teams = 0;
+    double maxRadius = -1.0;
+    if(!PyArg_ParseTuple(args, "|IId", &kinds, &teams, &maxRadius))
+    {
+        return NULL;
+    }
+
+    aiwar::core::Item *item = self->item->nearest(nearestFilter(self->item, kinds, teams), maxRadius);
+    if(!item)
+        Py_RETURN_NONE;
+
+    PyObject *pItem = Neighbour_Get(item);
+    if(!pItem)
+        PyErr_SetString(PyExc_RuntimeError, "Item type not yet implemented");
+    return pItem;
+}
+
+static PyObject *
+Item_kNearest(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    unsigned int k = 0, kinds = 0, teams = 0;
+    double maxRadius = -1.0;
+    if(!PyArg_ParseTuple(args, "I|IId", &k, &kinds, &teams, &maxRadius))
+    {
+        return NULL;
+    }
+
+    aiwar::core::Item::ItemVector items;
+    self->item->kNearest(k, items, nearestFilter(self->item, kinds, teams), maxRadius);
+
+    PyObject* pList = PyList_New(items.size());
+    if(!pList)
+        return NULL;
+    countPythonObject(pList);
+
+    for(std::size_t i = 0 ; i < items.size() ; ++i)
+    {
+        PyObject *pItem = Neighbour_Get(items[i]);
+        if(!pItem)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "Item type not yet implemented");
+            Py_DECREF(pList);
+            return NULL;
+        }
+        PyList_SET_ITEM(pList, i, pItem); // steals the reference
+    }
+
+    return pList;
+}
+
+// fill the rows of a snapshot, as seen by a playable item
+class SnapshotBuilder : public aiwar::core::NeighbourVisitor
+{
+public:
+    SnapshotBuilder(const aiwar::core::Playable *self, std::vector<SnapshotRow> &rows) : self(self), rows(rows) {}
+
+    bool visit(aiwar::core::Item *item);
+
+    const aiwar::core::Playable *self;
+    std::vector<SnapshotRow> &rows;
+};
+
+bool SnapshotBuilder::visit(aiwar::core::Item *item)
+{
+    using namespace aiwar::core;
+
+    SnapshotRow r;
+    std::memset(&r, 0, sizeof(r));
+    r.key = item->_getKey();
+    r.kind = item->_kind();
+    r.x = item->xpos();
+    r.y = item->ypos();
+
+    const Playable *p = item_cast<Playable>(item);
+    r.team = p ? p->team() : NO_TEAM;
+
+    const Living *l = item_cast<Living>(item);
+    if(l)
+        r.life = l->life();
+
+    const Movable *m = item_cast<Movable>(item);
+    if(m)
+    {
+        r.angle = m->angle();
+        // the rule of Playable::fuel(), without its warnings for the rows of other items
+        if(p && self->isFriend(p) && self->distanceTo(item) <= Config::instance().COMMUNICATION_RADIUS)
+            r.fuel = m->fuel();
+    }
+
+    rows.push_back(r);
+    return true;
+}
+
+static PyObject *
+Item_snapshot(Item* self)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PythonBinding *b = bindingOf(self->item);
+
+    // the rows are reused only if the player no longer holds the last snapshot
+    if(!b->snapshot || Py_REFCNT(b->snapshot) > 1 || b->snapshot->exports > 0)
+    {
+        Snapshot *pS = Snapshot_New();
+        if(!pS)
+            return NULL;
+        Py_XDECREF(b->snapshot);
+        b->snapshot = pS;
+    }
+
+    b->snapshot->rows->clear();
+    SnapshotBuilder builder(aiwar::core::item_cast<aiwar::core::Playable>(self->item), *b->snapshot->rows);
+    self->item->visitNeighbours(builder);
+
+    Py_INCREF(b->snapshot);
+    return (PyObject*)b->snapshot;
+}
+
+// base of the queries on the neighbours within a radius, distances are compared squared
+class RangeQuery : public aiwar::core::NeighbourVisitor
+{
+public:
+    RangeQuery(const aiwar::core::Item *self, double radius)
+        : px(self->xpos()), py(self->ypos()), r2(radius < 0.0 ? -1.0 : radius * radius) {}
+
+    // true if the item is in the radius, d2 is its squared distance
+    bool inRange(const aiwar::core::Item *item, double &d2) const
+    {
+        const double dx = item->xpos() - px, dy = item->ypos() - py;
+        d2 = dx * dx + dy * dy;
+        return r2 < 0.0 || d2 <= r2;
+    }
+
+    double px;
+    double py;
+    double r2; ///< negative if there is no radius
+};
+
+// the nearest item, the first visited (lowest key) if several are at the same distance
+class ClosestQuery : public RangeQuery
+{
+public:
+    ClosestQuery(const aiwar::core::Item *self, double radius, unsigned int minLife)
+        : RangeQuery(self, radius), minLife(minLife), best(NULL), bestD2(0.0) {}
+
+    bool visit(aiwar::core::Item *item)
+    {
+        double d2;
+        if(!inRange(item, d2) || (best && d2 >= bestD2))
+            return true;
+        if(minLife > 0)
+        {
+            const aiwar::core::Living *l = aiwar::core::item_cast<aiwar::core::Living>(item);
+            if(!l || l->life() < minLife)
+                return true;
+        }
+        best = item;
+        bestD2 = d2;
+        return true;
+    }
+
+    unsigned int minLife;
+    aiwar::core::Item *best;
+    double bestD2;
+};
+
+// all the items in the radius, in the order of neighbours()
+class WithinQuery : public RangeQuery
+{
+public:
+    WithinQuery(const aiwar::core::Item *self, double radius, PyObject *pList)
+        : RangeQuery(self, radius), pList(pList), failed(false) {}
+
+    bool visit(aiwar::core::Item *item)
+    {
+        double d2;
+        if(!inRange(item, d2))
+            return true;
+
+        PyObject *pItem = Neighbour_Get(item);
+        if(!pItem || PyList_Append(pList, pItem) != 0)
+        {
+            Py_XDECREF(pItem);
+            failed = true;
+            return false;
+        }
+        Py_DECREF(pItem);
+        return true;
+    }
+
+    PyObject *pList;
+    bool failed;
+};
+
+class CountQuery : public RangeQuery
+{
+public:
+    CountQuery(const aiwar::core::Item *self, double radius) : RangeQuery(self, radius), count(0) {}
+
+    bool visit(aiwar::core::Item *item)
+    {
+        double d2;
+        if(inRange(item, d2))
+            count++;
+        return true;
+    }
+
+    unsigned long count;
+};
+
+// the item with the lowest value of an attribute, the first visited if several have the same value
+class ArgminQuery : public RangeQuery
+{
+public:
+    enum Attribute { DISTANCE, LIFE, FUEL };
+
+    ArgminQuery(const aiwar::core::Playable *self, double radius, Attribute attr)
+        : RangeQuery(self, radius), self(self), attr(attr), best(NULL), bestValue(0.0) {}
+
+    bool visit(aiwar::core::Item *item)
+    {
+        using namespace aiwar::core;
+
+        double d2, value;
+        if(!inRange(item, d2))
+            return true;
+
+        switch(attr)
+        {
+        case DISTANCE:
+            value = d2;
+            break;
+        case LIFE:
+        {
+            const Living *l = item_cast<Living>(item);
+            if(!l)
+                return true;
+            value = l->life();
+            break;
+        }
+        case FUEL:
+        {
+            // only the fuel of a friend in the communication radius is known, see Playable::fuel()
+            const Movable *m = item_cast<Movable>(item);
+            const Playable *p = item_cast<Playable>(item);
+            if(!m || !p || !self->isFriend(p) || d2 > Config::instance().COMMUNICATION_RADIUS * Config::instance().COMMUNICATION_RADIUS)
+                return true;
+            value = m->fuel();
+            break;
+        }
+        default:
+            return true;
+        }
+
+        if(!best || value < bestValue)
+        {
+            best = item;
+            bestValue = value;
+        }
+        return true;
+    }
+
+    const aiwar::core::Playable *self;
+    Attribute attr;
+    aiwar::core::Item *best;
+    double bestValue;
+};
+
+static PyObject *
+Item_closest(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    unsigned int kinds = 0, teams = 0, minLife = 0;
+    double maxRadius = -1.0;
+    if(!PyArg_ParseTuple(args, "|IIdI", &kinds, &teams, &maxRadius, &minLife))
+    {
+        return NULL;
+    }
+
+    ClosestQuery q(self->item, maxRadius, minLife);
+    self->item->visitNeighbours(q, nearestFilter(self->item, kinds, teams));
+    if(!q.best)
+        Py_RETURN_NONE;
+
+    PyObject *pItem = Neighbour_Get(q.best);
+    if(!pItem)
+        PyErr_SetString(PyExc_RuntimeError, "Item type not yet implemented");
+    return pItem;
+}
+
+static PyObject *
+Item_within(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    unsigned int kinds = 0, teams = 0;
+    double radius = 0.0;
+    if(!PyArg_ParseTuple(args, "d|II", &radius, &kinds, &teams))
+    {
+        return NULL;
+    }
+
+    PyObject* pList = PyList_New(0);
+    if(!pList)
+        return NULL;
+    countPythonObject(pList);
+
+    WithinQuery q(self->item, radius, pList);
+    self->item->visitNeighbours(q, nearestFilter(self->item, kinds, teams));
+    if(q.failed)
+    {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Item type not yet implemented");
+        Py_DECREF(pList);
+        return NULL;
+    }
+
+    return pList;
+}
+
+static PyObject *
+Item_countWithin(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    unsigned int kinds = 0, teams = 0;
+    double radius = 0.0;
+    if(!PyArg_ParseTuple(args, "d|II", &radius, &kinds, &teams))
+    {
+        return NULL;
+    }
+
+    CountQuery q(self->item, radius);
+    self->item->visitNeighbours(q, nearestFilter(self->item, kinds, teams));
+    return Py_BuildValue("k", q.count);
+}
+
+static PyObject *
+Item_argminBy(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    const char *name = NULL;
+    unsigned int kinds = 0, teams = 0;
+    double maxRadius = -1.0;
+    if(!PyArg_ParseTuple(args, "s|IId", &name, &kinds, &teams, &maxRadius))
+    {
+        return NULL;
+    }
+
+    ArgminQuery::Attribute attr;
+    if(std::strcmp(name, "distance") == 0)
+        attr = ArgminQuery::DISTANCE;
+    else if(std::strcmp(name, "life") == 0)
+        attr = ArgminQuery::LIFE;
+    else if(std::strcmp(name, "fuel") == 0)
+        attr = ArgminQuery::FUEL;
+    else
+    {
+        PyErr_SetString(PyExc_ValueError, "attribute must be 'distance', 'life' or 'fuel'");
+        return NULL;
+    }
+
+    ArgminQuery q(aiwar::core::item_cast<aiwar::core::Playable>(self->item), maxRadius, attr);
+    self->item->visitNeighbours(q, nearestFilter(self->item, kinds, teams));
+    if(!q.best)
+        Py_RETURN_NONE;
+
+    PyObject *pItem = Neighbour_Get(q.best);
+    if(!pItem)
+        PyErr_SetString(PyExc_RuntimeError, "Item type not yet implemented");
+    return pItem;
+}
+
+static PyObject *
+Item_distanceTo(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    double px = 0.0;
+    double py = 0.0;
+    if(!PyArg_ParseTuple(args, "O", &o))
+    {
+        return NULL;
+    }
+    if(PyObject_IsInstance(o, pItemBasedTuple))
+    {
+        if(!Item_alive(o))
+            return NULL;
+        return PyFloat_FromDouble(self->item->distanceTo(((Item*)o)->item));
+    }
+    else if(PyArg_ParseTuple(o, "dd", &px, &py))
+    {
+        return PyFloat_FromDouble(self->item->distanceTo(px, py));
+    }
+    else
+    {
+        PyErr_SetString(PyExc_TypeError, "must be an Item or a tuple of two floats");
+        return NULL;
+    }
+}
+
+static PyObject *
+Item_rotateOf(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    double a;
+    if(!PyArg_ParseTuple(args, "d", &a))
+        return NULL;
+    aiwar::core::item_cast<aiwar::core::Movable>(self->item)->rotateOf(a);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+Item_rotateTo(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    double px = -1.0;
+    double py = -1.0;
+    if(!PyArg_ParseTuple(args, "O", &o))
+    {
+        return NULL;
+    }
+    if(PyObject_IsInstance(o, pItemBasedTuple))
+    {
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::item_cast<aiwar::core::Movable>(self->item)->rotateTo(((Item*)o)->item);
+        Py_RETURN_NONE;
+    }
+    else if(PyArg_ParseTuple(o, "dd", &px, &py))
+    {
+        aiwar::core::item_cast<aiwar::core::Movable>(self->item)->rotateTo(px, py);
+        Py_RETURN_NONE;
+    }
+    else
+    {
+        PyErr_SetString(PyExc_TypeError, "must be an Item or a tuple of two floats");
+        return NULL;
+    }
+}
+
+static PyObject *
+Item_angle(Item* self)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("d", aiwar::core::item_cast<aiwar::core::Movable>(self->item)->angle());
+}
+
+static PyObject *
+Item_fuel(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    if(!PyArg_ParseTuple(args, "|O", &o))
+    {
+        return NULL;
+    }
+
+    if(!o)
+    {
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Movable>(self->item)->fuel());
+    }
+    else
+    {
+        if(!PyObject_IsInstance(o, pItemBasedTuple))
+        {
+            PyErr_SetString(PyExc_TypeError, "argmument is not an item");
+            return NULL;
+        }
+        if(!Item_alive(o))
+            return NULL;
+
+        aiwar::core::Movable *ml = aiwar::core::item_cast<aiwar::core::Movable>(((Item*)o)->item);
+        if(!ml)
+        {
+            PyErr_SetString(PyExc_TypeError, "argmument is not a Movable item");
+            return NULL;
+        }
+
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Playable>(self->item)->fuel(ml));
+    }
+}
+
+static PyObject *
+Item_move(Item* self)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    aiwar::core::item_cast<aiwar::core::Movable>(self->item)->move();
+    Py_RETURN_NONE;
+}
+
+// position of an Item or of a tuple of two floats, false with a TypeError otherwise
+static bool
+targetPosition(PyObject *o, double &px, double &py)
+{
+    if(PyObject_IsInstance(o, pItemBasedTuple))
+    {
+        if(!Item_alive(o))
+            return false;
+        px = ((Item*)o)->item->xpos();
+        py = ((Item*)o)->item->ypos();
+        return true;
+    }
+    else if(PyArg_ParseTuple(o, "dd", &px, &py))
+    {
+        return true;
+    }
+    else
+    {
+        PyErr_SetString(PyExc_TypeError, "must be an Item or a tuple of two floats");
+        return false;
+    }
+}
+
+static PyObject *
+Item_moveTowards(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    double stopRadius = 0.0;
+    double px, py;
+    if(!PyArg_ParseTuple(args, "O|d", &o, &stopRadius) || !targetPosition(o, px, py))
+    {
+        return NULL;
+    }
+
+    if(aiwar::core::item_cast<aiwar::core::Movable>(self->item)->moveTowards(px, py, stopRadius))
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+static PyObject *
+Item_keepDistance(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    double radius = 0.0;
+    double px, py;
+    if(!PyArg_ParseTuple(args, "Od", &o, &radius) || !targetPosition(o, px, py))
+    {
+        return NULL;
+    }
+
+    if(aiwar::core::item_cast<aiwar::core::Movable>(self->item)->keepDistance(px, py, radius))
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+static PyObject *
+Item_life(Item* self)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Living>(self->item)->life());
+}
+
+static PyObject *
+Item_team(Item* self)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Playable>(self->item)->team());
+}
+
+static PyObject *
+Item_isFriend(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    PyObject *o = NULL;
+    if(!PyArg_ParseTuple(args, "O", &o))
+    {
+        return NULL;
+    }
+
+    if(!PyObject_IsInstance(o, pItemBasedTuple))
+    {
+        PyErr_SetString(PyExc_TypeError, "argmument is not an item");
+        return NULL;
+    }
+    if(!Item_alive(o))
+        return NULL;
+
+    aiwar::core::Playable *pl = aiwar::core::item_cast<aiwar::core::Playable>(((Item*)o)->item);
+    if(!pl)
+    {
+        PyErr_SetString(PyExc_TypeError, "argmument is not a Playable item");
+        return NULL;
+    }
+
+    if(aiwar::core::item_cast<aiwar::core::Playable>(self->item)->isFriend(pl))
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+static PyObject *
+Item_log(Item* self, PyObject *args)
+{
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    const char *msg;
+    if(!PyArg_ParseTuple(args, "s", &msg))
+        return NULL;
+    aiwar::core::item_cast<aiwar::core::Playable>(self->item)->log(msg);
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Item_state(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int state;
     if(!PyArg_ParseTuple(args, "I", &state))
         return NULL;
-    dynamic_cast<aiwar::core::Playable*>(self->item)->state(static_cast<aiwar::core::State>(state));
+    aiwar::core::item_cast<aiwar::core::Playable>(self->item)->state(static_cast<aiwar::core::State>(state));
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Item_memorySize(Item* self)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Memory*>(self->item)->memorySize());
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->memorySize());
 }
 
 static PyObject *
 Item_getMemoryInt(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     PyObject *o = NULL;
     if(!PyArg_ParseTuple(args, "I|O", &index, &o))
@@ -1009,23 +1931,27 @@ Item_getMemoryInt(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        return Py_BuildValue("i", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<int>(index, mem));
+        return Py_BuildValue("i", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<int>(index, mem));
     }
     else
     {
-        return Py_BuildValue("i", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<int>(index));
+        return Py_BuildValue("i", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<int>(index));
     }
 }
 
 static PyObject *
 Item_getMemoryUInt(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     PyObject *o = NULL;
     if(!PyArg_ParseTuple(args, "I|O", &index, &o))
@@ -1039,23 +1965,27 @@ Item_getMemoryUInt(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<unsigned int>(index, mem));
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<unsigned int>(index, mem));
     }
     else
     {
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<unsigned int>(index));
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<unsigned int>(index));
     }
 }
 
 static PyObject *
 Item_getMemoryFloat(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     PyObject *o = NULL;
     if(!PyArg_ParseTuple(args, "I|O", &index, &o))
@@ -1069,23 +1999,27 @@ Item_getMemoryFloat(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        return Py_BuildValue("f", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<float>(index, mem));
+        return Py_BuildValue("f", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<float>(index, mem));
     }
     else
     {
-        return Py_BuildValue("f", dynamic_cast<aiwar::core::Memory*>(self->item)->getMemory<float>(index));
+        return Py_BuildValue("f", aiwar::core::item_cast<aiwar::core::Memory>(self->item)->getMemory<float>(index));
     }
 }
 
 static PyObject *
 Item_setMemoryInt(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     int value = 0;
     PyObject *o = NULL;
@@ -1100,17 +2034,19 @@ Item_setMemoryInt(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<int>(index, value, mem);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<int>(index, value, mem);
     }
     else
     {
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<int>(index, value);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<int>(index, value);
     }
     Py_RETURN_NONE;
 }
@@ -1118,6 +2054,8 @@ Item_setMemoryInt(Item *self, PyObject *args)
 static PyObject *
 Item_setMemoryUInt(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     unsigned int value = 0u;
     PyObject *o = NULL;
@@ -1132,17 +2070,19 @@ Item_setMemoryUInt(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<unsigned int>(index, value, mem);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<unsigned int>(index, value, mem);
     }
     else
     {
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<unsigned int>(index, value);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<unsigned int>(index, value);
     }
     Py_RETURN_NONE;
 }
@@ -1150,6 +2090,8 @@ Item_setMemoryUInt(Item *self, PyObject *args)
 static PyObject *
 Item_setMemoryFloat(Item *self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     unsigned int index = 0;
     float value = 0.0f;
     PyObject *o = NULL;
@@ -1164,17 +2106,19 @@ Item_setMemoryFloat(Item *self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "second argmument is not an item");
             return NULL;
         }
-        aiwar::core::Memory *mem = dynamic_cast<aiwar::core::Memory*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Memory *mem = aiwar::core::item_cast<aiwar::core::Memory>(((Item*)o)->item);
         if(!mem)
         {
             PyErr_SetString(PyExc_TypeError, "second argmument is not a Memory item");
             return NULL;
         }
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<float>(index, value, mem);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<float>(index, value, mem);
     }
     else
     {
-        dynamic_cast<aiwar::core::Memory*>(self->item)->setMemory<float>(index, value);
+        aiwar::core::item_cast<aiwar::core::Memory>(self->item)->setMemory<float>(index, value);
     }
     Py_RETURN_NONE;
 }
@@ -1182,21 +2126,27 @@ Item_setMemoryFloat(Item *self, PyObject *args)
 static PyObject *
 MiningShip_extract(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     Item *m = NULL;
     if(!PyArg_ParseTuple(args, "O!", &MineralType, &m))
         return NULL;
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::MiningShip*>(self->item)->extract(dynamic_cast<aiwar::core::Mineral*>(m->item)));
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::MiningShip>(self->item)->extract(aiwar::core::item_cast<aiwar::core::Mineral>(m->item)));
 }
 
 static PyObject *
 MiningShip_mineralStorage(Item* self)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::MiningShip*>(self->item)->mineralStorage());
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::MiningShip>(self->item)->mineralStorage());
 }
 
 static PyObject *
 MiningShip_pushMineral(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     unsigned int value = 0;
     if(!PyArg_ParseTuple(args, "OI", &o, &value))
@@ -1207,25 +2157,31 @@ MiningShip_pushMineral(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::Base *b = dynamic_cast<aiwar::core::Base*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::Base *b = aiwar::core::item_cast<aiwar::core::Base>(((Item*)o)->item);
     if(!b)
     {
         PyErr_SetString(PyExc_TypeError, "must be a Base");
         return NULL;
     }
 
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::MiningShip*>(self->item)->pushMineral(b, value));
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::MiningShip>(self->item)->pushMineral(b, value));
 }
 
 static PyObject *
 Base_mineralStorage(Item* self)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->mineralStorage());
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->mineralStorage());
 }
 
 static PyObject *
 Base_pullMineral(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     unsigned int value = 0;
     if(!PyArg_ParseTuple(args, "OI", &o, &value))
@@ -1237,18 +2193,22 @@ Base_pullMineral(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::MiningShip *m = dynamic_cast<aiwar::core::MiningShip*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::MiningShip *m = aiwar::core::item_cast<aiwar::core::MiningShip>(((Item*)o)->item);
     if(!m)
     {
         PyErr_SetString(PyExc_TypeError, "must be a MiningShip");
         return NULL;
     }
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->pullMineral(m, value));
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->pullMineral(m, value));
 }
 
 static PyObject *
 Base_launchMissile(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     if(!PyArg_ParseTuple(args, "O", &o))
     {
@@ -1259,26 +2219,32 @@ Base_launchMissile(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::Living *t = dynamic_cast<aiwar::core::Living*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::Living *t = aiwar::core::item_cast<aiwar::core::Living>(((Item*)o)->item);
     if(!t)
     {
         PyErr_SetString(PyExc_TypeError, "must be a Living Object");
         return NULL;
     }
-    dynamic_cast<aiwar::core::Base*>(self->item)->launchMissile(t);
+    aiwar::core::item_cast<aiwar::core::Base>(self->item)->launchMissile(t);
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Base_createMiningShip(Item* self)
 {
-    dynamic_cast<aiwar::core::Base*>(self->item)->createMiningShip();
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    aiwar::core::item_cast<aiwar::core::Base>(self->item)->createMiningShip();
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Base_repair(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     unsigned int value = 0;
     if(!PyArg_ParseTuple(args, "I|O", &value, &o))
@@ -1287,7 +2253,7 @@ Base_repair(Item* self, PyObject *args)
     }
     if(!o)
     {
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->repair(value));
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->repair(value));
     }
     else
     {
@@ -1296,19 +2262,23 @@ Base_repair(Item* self, PyObject *args)
             PyErr_SetString(PyExc_TypeError, "must be an item");
             return NULL;
         }
-        aiwar::core::Living *t = dynamic_cast<aiwar::core::Living*>(((Item*)o)->item);
+        if(!Item_alive(o))
+            return NULL;
+        aiwar::core::Living *t = aiwar::core::item_cast<aiwar::core::Living>(((Item*)o)->item);
         if(!t)
         {
             PyErr_SetString(PyExc_TypeError, "must be a Living Object");
             return NULL;
         }
-        return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->repair(value, t));
+        return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->repair(value, t));
     }
 }
 
 static PyObject *
 Base_refuel(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     unsigned int value = 0;
     if(!PyArg_ParseTuple(args, "IO", &value, &o))
@@ -1320,24 +2290,30 @@ Base_refuel(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::Movable *t = dynamic_cast<aiwar::core::Movable*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::Movable *t = aiwar::core::item_cast<aiwar::core::Movable>(((Item*)o)->item);
     if(!t)
     {
         PyErr_SetString(PyExc_TypeError, "must be a Movable Object");
         return NULL;
     }
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->refuel(value, t));
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->refuel(value, t));
 }
 
 static PyObject *
 Fighter_missiles(Item* self)
 {
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Fighter*>(self->item)->missiles());
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Fighter>(self->item)->missiles());
 }
 
 static PyObject *
 Fighter_launchMissile(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     if(!PyArg_ParseTuple(args, "O", &o))
     {
@@ -1348,26 +2324,32 @@ Fighter_launchMissile(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::Living *t = dynamic_cast<aiwar::core::Living*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::Living *t = aiwar::core::item_cast<aiwar::core::Living>(((Item*)o)->item);
     if(!t)
     {
         PyErr_SetString(PyExc_TypeError, "must be a Living Object");
         return NULL;
     }
-    dynamic_cast<aiwar::core::Fighter*>(self->item)->launchMissile(t);
+    aiwar::core::item_cast<aiwar::core::Fighter>(self->item)->launchMissile(t);
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Base_createFighter(Item* self)
 {
-    dynamic_cast<aiwar::core::Base*>(self->item)->createFighter();
+    if(!Item_alive((PyObject*)self))
+        return NULL;
+    aiwar::core::item_cast<aiwar::core::Base>(self->item)->createFighter();
     Py_RETURN_NONE;
 }
 
 static PyObject *
 Base_giveMissiles(Item* self, PyObject *args)
 {
+    if(!Item_alive((PyObject*)self))
+        return NULL;
     PyObject *o = NULL;
     unsigned int value = 0;
     if(!PyArg_ParseTuple(args, "IO", &value, &o))
@@ -1379,13 +2361,15 @@ Base_giveMissiles(Item* self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "must be an item");
         return NULL;
     }
-    aiwar::core::Fighter *t = dynamic_cast<aiwar::core::Fighter*>(((Item*)o)->item);
+    if(!Item_alive(o))
+        return NULL;
+    aiwar::core::Fighter *t = aiwar::core::item_cast<aiwar::core::Fighter>(((Item*)o)->item);
     if(!t)
     {
         PyErr_SetString(PyExc_TypeError, "must be a Fighter");
         return NULL;
     }
-    return Py_BuildValue("I", dynamic_cast<aiwar::core::Base*>(self->item)->giveMissiles(value, t));
+    return Py_BuildValue("I", aiwar::core::item_cast<aiwar::core::Base>(self->item)->giveMissiles(value, t));
 }
 
 
@@ -1516,6 +2500,439 @@ static PyMethodDef module_methods[] = {
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
+/*** C API, for the AIs compiled as python extensions (client/aiwar_python.h) ***/
+
+namespace {
+
+using aiwar::core::item_cast;
+
+inline aiwar::core::Item* capiItem(const AiwarPyItem *item)
+{
+    return reinterpret_cast<aiwar::core::Item*>(const_cast<AiwarPyItem*>(item));
+}
+
+inline aiwar::core::Item* capiItem(const AiwarPyUnit *unit)
+{
+    return reinterpret_cast<aiwar::core::Item*>(const_cast<AiwarPyUnit*>(unit));
+}
+
+inline AiwarPyItem* capiHandle(aiwar::core::Item *item)
+{
+    return reinterpret_cast<AiwarPyItem*>(item);
+}
+
+// the item as a T, NULL with a TypeError if it is not one
+template<class T> T* capiAs(aiwar::core::Item *item, const char *what)
+{
+    T *t = item ? item_cast<T>(item) : NULL;
+    if(!t)
+        PyErr_SetString(PyExc_TypeError, what);
+    return t;
+}
+
+template<class T> T* capiAs(const AiwarPyItem *item, const char *what)
+{
+    return capiAs<T>(capiItem(item), what);
+}
+
+template<class T> T* capiAs(const AiwarPyUnit *unit, const char *what)
+{
+    return capiAs<T>(capiItem(unit), what);
+}
+
+AiwarPyUnit* capi_unit(PyObject *o)
+{
+    if(Py_TYPE(o) != &BaseType && Py_TYPE(o) != &MiningShipType && Py_TYPE(o) != &FighterType)
+    {
+        PyErr_SetString(PyExc_TypeError, "not a unit given to a play function");
+        return NULL;
+    }
+    if(!Item_alive(o))
+        return NULL;
+    return reinterpret_cast<AiwarPyUnit*>(((Item*)o)->item);
+}
+
+AiwarPyItem* capi_item(PyObject *o)
+{
+    if(!PyObject_IsInstance(o, pItemBasedTuple))
+    {
+        PyErr_SetString(PyExc_TypeError, "not an item");
+        return NULL;
+    }
+    if(!Item_alive(o))
+        return NULL;
+    return capiHandle(((Item*)o)->item);
+}
+
+PyObject* capi_object(AiwarPyItem *item)
+{
+    return Neighbour_Get(capiItem(item));
+}
+
+uint64_t capi_key(const AiwarPyItem *item)
+{
+    return capiItem(item)->_getKey();
+}
+
+int capi_kind(const AiwarPyItem *item)
+{
+    return capiItem(item)->_kind();
+}
+
+int capi_team(const AiwarPyItem *item)
+{
+    return capiItem(item)->_tagTeam();
+}
+
+double capi_xpos(const AiwarPyItem *item)
+{
+    return capiItem(item)->xpos();
+}
+
+double capi_ypos(const AiwarPyItem *item)
+{
+    return capiItem(item)->ypos();
+}
+
+double capi_distance(const AiwarPyItem *item, const AiwarPyItem *other)
+{
+    return capiItem(item)->distanceTo(capiItem(other));
+}
+
+double capi_distance_to(const AiwarPyItem *item, double x, double y)
+{
+    return capiItem(item)->distanceTo(x, y);
+}
+
+long capi_life(const AiwarPyItem *item)
+{
+    aiwar::core::Living *l = item_cast<aiwar::core::Living>(capiItem(item));
+    return l ? l->life() : 0;
+}
+
+// results of the last neighbours() query, the units are played one at a time
+aiwar::core::Item::ItemVector capiNeighbours;
+
+Py_ssize_t capi_neighbours(AiwarPyUnit *unit, unsigned int kinds, unsigned int teams, AiwarPyItem **res, Py_ssize_t max)
+{
+    aiwar::core::Item *self = capiItem(unit);
+    self->neighbours(capiNeighbours, nearestFilter(self, kinds, teams));
+    Py_ssize_t n;
+    for(n = 0 ; n < static_cast<Py_ssize_t>(capiNeighbours.size()) && n < max ; ++n)
+        res[n] = capiHandle(capiNeighbours[n]);
+    return capiNeighbours.size();
+}
+
+AiwarPyItem* capi_nearest(AiwarPyUnit *unit, unsigned int kinds, unsigned int teams, double maxRadius)
+{
+    aiwar::core::Item *self = capiItem(unit);
+    return capiHandle(self->nearest(nearestFilter(self, kinds, teams), maxRadius));
+}
+
+long capi_is_friend(AiwarPyUnit *unit, const AiwarPyItem *item)
+{
+    aiwar::core::Playable *p = capiAs<aiwar::core::Playable>(item, "not a unit");
+    if(!p)
+        return -1;
+    return item_cast<aiwar::core::Playable>(capiItem(unit))->isFriend(p) ? 1 : 0;
+}
+
+long capi_memory_size(AiwarPyUnit *unit)
+{
+    return item_cast<aiwar::core::Memory>(capiItem(unit))->memorySize();
+}
+
+template<class T> long capiGetMemory(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, T *value)
+{
+    aiwar::core::Memory *m = item_cast<aiwar::core::Memory>(capiItem(unit));
+    if(!other)
+    {
+        *value = m->getMemory<T>(index);
+        return 0;
+    }
+    aiwar::core::Memory *o = capiAs<aiwar::core::Memory>(other, "the other item has no memory");
+    if(!o)
+        return -1;
+    *value = m->getMemory<T>(index, o);
+    return 0;
+}
+
+template<class T> long capiSetMemory(AiwarPyUnit *unit, unsigned int index, T value, AiwarPyItem *other)
+{
+    aiwar::core::Memory *m = item_cast<aiwar::core::Memory>(capiItem(unit));
+    if(!other)
+    {
+        m->setMemory<T>(index, value);
+        return 0;
+    }
+    aiwar::core::Memory *o = capiAs<aiwar::core::Memory>(other, "the other item has no memory");
+    if(!o)
+        return -1;
+    m->setMemory<T>(index, value, o);
+    return 0;
+}
+
+long capi_get_memory_int(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, int32_t *value)
+{
+    int v = 0;
+    long r = capiGetMemory<int>(unit, index, other, &v);
+    *value = v;
+    return r;
+}
+
+long capi_get_memory_uint(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, uint32_t *value)
+{
+    unsigned int v = 0;
+    long r = capiGetMemory<unsigned int>(unit, index, other, &v);
+    *value = v;
+    return r;
+}
+
+long capi_get_memory_float(AiwarPyUnit *unit, unsigned int index, AiwarPyItem *other, float *value)
+{
+    return capiGetMemory<float>(unit, index, other, value);
+}
+
+long capi_set_memory_int(AiwarPyUnit *unit, unsigned int index, int32_t value, AiwarPyItem *other)
+{
+    return capiSetMemory<int>(unit, index, value, other);
+}
+
+long capi_set_memory_uint(AiwarPyUnit *unit, unsigned int index, uint32_t value, AiwarPyItem *other)
+{
+    return capiSetMemory<unsigned int>(unit, index, value, other);
+}
+
+long capi_set_memory_float(AiwarPyUnit *unit, unsigned int index, float value, AiwarPyItem *other)
+{
+    return capiSetMemory<float>(unit, index, value, other);
+}
+
+long capi_log(AiwarPyUnit *unit, const char *msg)
+{
+    item_cast<aiwar::core::Playable>(capiItem(unit))->log(msg);
+    return 0;
+}
+
+long capi_state(AiwarPyUnit *unit, unsigned int state)
+{
+    if(state > aiwar::core::DARK)
+    {
+        PyErr_SetString(PyExc_ValueError, "unknown state");
+        return -1;
+    }
+    item_cast<aiwar::core::Playable>(capiItem(unit))->state(static_cast<aiwar::core::State>(state));
+    return 0;
+}
+
+double capi_angle(AiwarPyUnit *ship)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    return m ? m->angle() : 0.0;
+}
+
+long capi_fuel(AiwarPyUnit *unit, const AiwarPyItem *ship)
+{
+    if(!ship)
+    {
+        aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(unit, "not a ship");
+        return m ? static_cast<long>(m->fuel()) : -1;
+    }
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    return m ? static_cast<long>(item_cast<aiwar::core::Playable>(capiItem(unit))->fuel(m)) : -1;
+}
+
+long capi_rotate_of(AiwarPyUnit *ship, double angle)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    if(!m)
+        return -1;
+    m->rotateOf(angle);
+    return 0;
+}
+
+long capi_rotate_to(AiwarPyUnit *ship, double x, double y)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    if(!m)
+        return -1;
+    m->rotateTo(x, y);
+    return 0;
+}
+
+long capi_move(AiwarPyUnit *ship)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    if(!m)
+        return -1;
+    m->move();
+    return 0;
+}
+
+long capi_move_towards(AiwarPyUnit *ship, double x, double y, double stopRadius)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    return m ? (m->moveTowards(x, y, stopRadius) ? 1 : 0) : -1;
+}
+
+long capi_keep_distance(AiwarPyUnit *ship, double x, double y, double radius)
+{
+    aiwar::core::Movable *m = capiAs<aiwar::core::Movable>(ship, "not a ship");
+    return m ? (m->keepDistance(x, y, radius) ? 1 : 0) : -1;
+}
+
+long capi_mineral_storage(AiwarPyUnit *unit)
+{
+    if(aiwar::core::Base *b = item_cast<aiwar::core::Base>(capiItem(unit)))
+        return b->mineralStorage();
+    aiwar::core::MiningShip *s = capiAs<aiwar::core::MiningShip>(unit, "not a base nor a mining ship");
+    return s ? static_cast<long>(s->mineralStorage()) : -1;
+}
+
+long capi_extract(AiwarPyUnit *ship, AiwarPyItem *mineral)
+{
+    aiwar::core::MiningShip *s = capiAs<aiwar::core::MiningShip>(ship, "not a mining ship");
+    aiwar::core::Mineral *m = s ? capiAs<aiwar::core::Mineral>(mineral, "not a mineral") : NULL;
+    return m ? static_cast<long>(s->extract(m)) : -1;
+}
+
+long capi_push_mineral(AiwarPyUnit *ship, AiwarPyItem *base, unsigned int points)
+{
+    aiwar::core::MiningShip *s = capiAs<aiwar::core::MiningShip>(ship, "not a mining ship");
+    aiwar::core::Base *b = s ? capiAs<aiwar::core::Base>(base, "not a base") : NULL;
+    return b ? static_cast<long>(s->pushMineral(b, points)) : -1;
+}
+
+long capi_missiles(AiwarPyUnit *fighter)
+{
+    aiwar::core::Fighter *f = capiAs<aiwar::core::Fighter>(fighter, "not a fighter");
+    return f ? static_cast<long>(f->missiles()) : -1;
+}
+
+long capi_launch_missile(AiwarPyUnit *unit, AiwarPyItem *target)
+{
+    aiwar::core::Living *t = capiAs<aiwar::core::Living>(target, "the target is not living");
+    if(!t)
+        return -1;
+    if(aiwar::core::Base *b = item_cast<aiwar::core::Base>(capiItem(unit)))
+        b->launchMissile(t);
+    else if(aiwar::core::Fighter *f = capiAs<aiwar::core::Fighter>(unit, "not a base nor a fighter"))
+        f->launchMissile(t);
+    else
+        return -1;
+    return 0;
+}
+
+long capi_create_miningship(AiwarPyUnit *base)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    if(!b)
+        return -1;
+    b->createMiningShip();
+    return 0;
+}
+
+long capi_create_fighter(AiwarPyUnit *base)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    if(!b)
+        return -1;
+    b->createFighter();
+    return 0;
+}
+
+long capi_pull_mineral(AiwarPyUnit *base, AiwarPyItem *ship, unsigned int points)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    aiwar::core::MiningShip *s = b ? capiAs<aiwar::core::MiningShip>(ship, "not a mining ship") : NULL;
+    return s ? static_cast<long>(b->pullMineral(s, points)) : -1;
+}
+
+long capi_repair(AiwarPyUnit *base, unsigned int points, AiwarPyItem *target)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    if(!b)
+        return -1;
+    if(!target)
+        return b->repair(points);
+    aiwar::core::Living *l = capiAs<aiwar::core::Living>(target, "the target is not living");
+    return l ? static_cast<long>(b->repair(points, l)) : -1;
+}
+
+long capi_refuel(AiwarPyUnit *base, unsigned int points, AiwarPyItem *ship)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    aiwar::core::Movable *m = b ? capiAs<aiwar::core::Movable>(ship, "not a ship") : NULL;
+    return m ? static_cast<long>(b->refuel(points, m)) : -1;
+}
+
+long capi_give_missiles(AiwarPyUnit *base, unsigned int missiles, AiwarPyItem *fighter)
+{
+    aiwar::core::Base *b = capiAs<aiwar::core::Base>(base, "not a base");
+    aiwar::core::Fighter *f = b ? capiAs<aiwar::core::Fighter>(fighter, "not a fighter") : NULL;
+    return f ? static_cast<long>(b->giveMissiles(missiles, f)) : -1;
+}
+
+AiwarPythonApi capi;
+
+void buildCApi()
+{
+    capi.version = AIWAR_PYTHON_API_VERSION;
+    capi.size = sizeof(AiwarPythonApi);
+
+    capi.unit = &capi_unit;
+    capi.item = &capi_item;
+    capi.object = &capi_object;
+
+    capi.key = &capi_key;
+    capi.kind = &capi_kind;
+    capi.team = &capi_team;
+    capi.xpos = &capi_xpos;
+    capi.ypos = &capi_ypos;
+    capi.distance = &capi_distance;
+    capi.distance_to = &capi_distance_to;
+    capi.life = &capi_life;
+
+    capi.neighbours = &capi_neighbours;
+    capi.nearest = &capi_nearest;
+    capi.is_friend = &capi_is_friend;
+
+    capi.memory_size = &capi_memory_size;
+    capi.get_memory_int = &capi_get_memory_int;
+    capi.get_memory_uint = &capi_get_memory_uint;
+    capi.get_memory_float = &capi_get_memory_float;
+    capi.set_memory_int = &capi_set_memory_int;
+    capi.set_memory_uint = &capi_set_memory_uint;
+    capi.set_memory_float = &capi_set_memory_float;
+
+    capi.log = &capi_log;
+    capi.state = &capi_state;
+
+    capi.angle = &capi_angle;
+    capi.fuel = &capi_fuel;
+    capi.rotate_of = &capi_rotate_of;
+    capi.rotate_to = &capi_rotate_to;
+    capi.move = &capi_move;
+    capi.move_towards = &capi_move_towards;
+    capi.keep_distance = &capi_keep_distance;
+
+    capi.mineral_storage = &capi_mineral_storage;
+    capi.extract = &capi_extract;
+    capi.push_mineral = &capi_push_mineral;
+
+    capi.missiles = &capi_missiles;
+    capi.launch_missile = &capi_launch_missile;
+
+    capi.create_miningship = &capi_create_miningship;
+    capi.create_fighter = &capi_create_fighter;
+    capi.pull_mineral = &capi_pull_mineral;
+    capi.repair = &capi_repair;
+    capi.refuel = &capi_refuel;
+    capi.give_missiles = &capi_give_missiles;
+}
+
+} // anonymous namespace
+
 bool initPythonInterpreter(int /*argc*/, char* /*argv*/[])
 {
     char *p = strdup("path");
@@ -1548,31 +2965,34 @@ bool initPythonInterpreter(int /*argc*/, char* /*argv*/[])
 // todo clean when an error occured
 bool initAiwarModule()
 {
-    // init pItemBasedTuple
-    pItemBasedTuple = PyTuple_New(8);
+    // init pItemBasedTuple, once for all the interpreters
     if(!pItemBasedTuple)
     {
-        std::cerr << "Fail to create pItemBasedTuple" << std::endl;
-        PyErr_Print();
-        return false;
+        pItemBasedTuple = PyTuple_New(8);
+        if(!pItemBasedTuple)
+        {
+            std::cerr << "Fail to create pItemBasedTuple" << std::endl;
+            PyErr_Print();
+            return false;
+        }
+        unsigned int i = 0;
+        Py_INCREF(&MiningShipType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MiningShipType);
+        Py_INCREF(&MiningShipConstType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MiningShipConstType);
+        Py_INCREF(&MineralType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MineralType);
+        Py_INCREF(&MissileType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MissileType);
+        Py_INCREF(&BaseType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&BaseType);
+        Py_INCREF(&BaseConstType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&BaseConstType);
+        Py_INCREF(&FighterType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&FighterType);
+        Py_INCREF(&FighterConstType);
+        PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&FighterConstType);
     }
-    unsigned int i = 0;
-    Py_INCREF(&MiningShipType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MiningShipType);
-    Py_INCREF(&MiningShipConstType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MiningShipConstType);
-    Py_INCREF(&MineralType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MineralType);
-    Py_INCREF(&MissileType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&MissileType);
-    Py_INCREF(&BaseType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&BaseType);
-    Py_INCREF(&BaseConstType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&BaseConstType);
-    Py_INCREF(&FighterType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&FighterType);
-    Py_INCREF(&FighterConstType);
-    PyTuple_SetItem(pItemBasedTuple, i++, (PyObject*)&FighterConstType);
 
     PyObject* m;
 
@@ -1608,6 +3028,9 @@ bool initAiwarModule()
     if(PyType_Ready(&FighterConstType) < 0)
         return false;
 
+    if(PyType_Ready(&SnapshotType) < 0)
+        return false;
+
     m = Py_InitModule3("aiwar", module_methods, "aiwar module that provides item types and constant values");
 
     if (m == NULL)
@@ -1653,6 +3076,28 @@ bool initAiwarModule()
     PyModule_AddIntConstant(m, "LIGHT", aiwar::core::LIGHT);
     PyModule_AddIntConstant(m, "DARK", aiwar::core::DARK);
 
+    /* add kinds and teams of nearest() and kNearest() */
+    PyModule_AddIntConstant(m, "MINERALS", 1 << aiwar::core::MINERAL_KIND);
+    PyModule_AddIntConstant(m, "MISSILES", 1 << aiwar::core::MISSILE_KIND);
+    PyModule_AddIntConstant(m, "BASES", 1 << aiwar::core::BASE_KIND);
+    PyModule_AddIntConstant(m, "MININGSHIPS", 1 << aiwar::core::MININGSHIP_KIND);
+    PyModule_AddIntConstant(m, "FIGHTERS", 1 << aiwar::core::FIGHTER_KIND);
+    PyModule_AddIntConstant(m, "FRIENDS", NEAREST_FRIENDS);
+    PyModule_AddIntConstant(m, "ENEMIES", NEAREST_ENEMIES);
+    PyModule_AddIntConstant(m, "NEUTRALS", NEAREST_NEUTRALS);
+
+    /* add Snapshot, and the struct format of its rows */
+    Py_INCREF(&SnapshotType);
+    PyModule_AddObject(m, "Snapshot", (PyObject*)&SnapshotType);
+    PyModule_AddStringConstant(m, "SNAPSHOT_FORMAT", SNAPSHOT_FORMAT);
+
+    /* add the C API, for the compiled extensions */
+    buildCApi();
+    PyObject *c_api = PyCapsule_New(&capi, AIWAR_PYTHON_CAPSULE, NULL);
+    if(!c_api)
+        return false;
+    PyModule_AddObject(m, "_C_API", c_api);
+
     return true;
 }
 
@@ -27,6 +27,7 @@
 #include "mineral.hpp"
 #include "base.hpp"
 #include "fighter.hpp"
+#include "alloc_tracker.hpp"
 
 // initialize the interpreter: add "." to sys.path
 bool initPythonInterpreter(int argc, char* argv[]);
@@ -58,4 +59,34 @@ PyObject* Fighter_New(aiwar::core::Fighter *m);
 // return a New Reference of FighterConst python object
 PyObject* FighterConst_New(aiwar::core::Fighter *m);
 
+// return a New Reference of the python object of a Playable item, as seen by its player
+// the object is created at the first call, then the same object is returned until the item is deleted
+PyObject* Playable_Get(aiwar::core::Playable *p);
+
+// return a New Reference of the python object of an item, as seen by the other items
+// the object is created at the first call, then the same object is returned until the item is deleted
+PyObject* Neighbour_Get(aiwar::core::Item *item);
+
+// count a python object created for the AIs, in the AIWAR_ALLOC_TRACKING builds
+// python 2 has no hook on its allocators: only these objects are counted, a list at its size of creation
+inline void countPythonObject(PyObject *o)
+{
+#ifdef AIWAR_ALLOC_TRACKING
+    std::size_t bytes = Py_TYPE(o)->tp_basicsize;
+    if(PyList_Check(o))
+        bytes += PyList_GET_SIZE(o) * sizeof(PyObject*);
+    aiwar::core::AllocTracker::allocated(aiwar::core::AllocTracker::PYTHON, bytes);
+#else
+    (void)o;
+#endif
+}
+
+// count the release of an object counted by countPythonObject(), from the deallocators of the wrapper types
+inline void uncountPythonObject()
+{
+#ifdef AIWAR_ALLOC_TRACKING
+    aiwar::core::AllocTracker::freed(aiwar::core::AllocTracker::PYTHON);
+#endif
+}
+
 #endif /* PYTHON_WRAPPER_HPP */
@@ -379,7 +379,7 @@ void RendererSDL::_updateItemEx(const aiwar::core::ItemManager& itemManager)
         item = it_src->second; // could be deleted ! check it with item->_toRemove()
         ItemEx &ite = _itemExMap[it_src->first];
         ite.item = item;
-        const aiwar::core::Playable* p = dynamic_cast<const aiwar::core::Playable*>(item);
+        const aiwar::core::Playable* p = aiwar::core::item_cast<aiwar::core::Playable>(item);
         if(p)
         {
 //            ite.logStream << p->getLog();
@@ -295,12 +295,6 @@ void RendererSDLDraw::preDraw(bool clicked, int xmc, int ymc, int dxViewPort, in
 
 void RendererSDLDraw::draw(RendererSDL::ItemEx *itemEx, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::Mineral *mineral;
-    const aiwar::core::Missile *missile;
-    const aiwar::core::MiningShip *miningShip;
-    const aiwar::core::Base *base;
-    const aiwar::core::Fighter *fighter;
-
     if(_clicked)
     {
         double px = itemEx->item->xpos();
@@ -320,16 +314,26 @@ void RendererSDLDraw::draw(RendererSDL::ItemEx *itemEx, const aiwar::core::ItemM
         }
     }
 
-    if((mineral = dynamic_cast<const aiwar::core::Mineral*>(itemEx->item)))
+    switch(itemEx->item->_kind())
+    {
+    case aiwar::core::MINERAL_KIND:
         _drawMineral(itemEx, im);
-    else if((missile = dynamic_cast<const aiwar::core::Missile*>(itemEx->item)))
+        break;
+    case aiwar::core::MISSILE_KIND:
         _drawMissile(itemEx, im);
-    else if((miningShip = dynamic_cast<const aiwar::core::MiningShip*>(itemEx->item)))
+        break;
+    case aiwar::core::MININGSHIP_KIND:
         _drawMiningShip(itemEx, im);
-    else if((base = dynamic_cast<const aiwar::core::Base*>(itemEx->item)))
+        break;
+    case aiwar::core::BASE_KIND:
         _drawBase(itemEx, im);
-    else if((fighter = dynamic_cast<const aiwar::core::Fighter*>(itemEx->item)))
+        break;
+    case aiwar::core::FIGHTER_KIND:
         _drawFighter(itemEx, im);
+        break;
+    default:
+        break;
+    }
 
     if(_gameover)
     {
@@ -518,7 +522,7 @@ void RendererSDLDraw::resetZoom()
 
 void RendererSDLDraw::_drawMineral(const RendererSDL::ItemEx *ite, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::Mineral *m = dynamic_cast<const aiwar::core::Mineral*>(ite->item);
+    const aiwar::core::Mineral *m = aiwar::core::item_cast<aiwar::core::Mineral>(ite->item);
 
     double px = m->xpos();
     double py = m->ypos();
@@ -540,7 +544,7 @@ void RendererSDLDraw::_drawMineral(const RendererSDL::ItemEx *ite, const aiwar::
 
 void RendererSDLDraw::_drawBase(const RendererSDL::ItemEx *ite, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::Base *b = dynamic_cast<const aiwar::core::Base*>(ite->item);
+    const aiwar::core::Base *b = aiwar::core::item_cast<aiwar::core::Base>(ite->item);
 
     double px = b->xpos();
     double py = b->ypos();
@@ -611,7 +615,7 @@ void RendererSDLDraw::_drawBase(const RendererSDL::ItemEx *ite, const aiwar::cor
 
 void RendererSDLDraw::_drawMiningShip(const RendererSDL::ItemEx *ite, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::MiningShip *m = dynamic_cast<const aiwar::core::MiningShip*>(ite->item);
+    const aiwar::core::MiningShip *m = aiwar::core::item_cast<aiwar::core::MiningShip>(ite->item);
 
     double px = m->xpos();
     double py = m->ypos();
@@ -683,7 +687,7 @@ void RendererSDLDraw::_drawMiningShip(const RendererSDL::ItemEx *ite, const aiwa
 
 void RendererSDLDraw::_drawMissile(const RendererSDL::ItemEx *ite, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::Missile *m = dynamic_cast<const aiwar::core::Missile*>(ite->item);
+    const aiwar::core::Missile *m = aiwar::core::item_cast<aiwar::core::Missile>(ite->item);
 
     double px = m->xpos();
     double py = m->ypos();
@@ -706,7 +710,7 @@ void RendererSDLDraw::_drawMissile(const RendererSDL::ItemEx *ite, const aiwar::
 
 void RendererSDLDraw::_drawFighter(const RendererSDL::ItemEx *ite, const aiwar::core::ItemManager &im)
 {
-    const aiwar::core::Fighter *f = dynamic_cast<const aiwar::core::Fighter*>(ite->item);
+    const aiwar::core::Fighter *f = aiwar::core::item_cast<aiwar::core::Fighter>(ite->item);
 
     double px = f->xpos();
     double py = f->ypos();
@@ -19,6 +19,12 @@
 
 #include "renderer_summary.hpp"
 
+#include "missile.hpp"
+#include "miningship.hpp"
+#include "fighter.hpp"
+#include "alloc_tracker.hpp"
+#include "perf_counters.hpp"
+
 #include <iostream>
 
 using namespace aiwar::renderer;
@@ -51,7 +57,7 @@ bool RendererSummary::finalize()
     return true;
 }
 
-bool RendererSummary::render(const aiwar::core::ItemManager&, const aiwar::core::StatManager& sm, bool gameover, const aiwar::core::Team& winner)
+bool RendererSummary::render(const aiwar::core::ItemManager& im, const aiwar::core::StatManager& sm, bool gameover, const aiwar::core::Team& winner)
 {
     if(gameover)
     {
@@ -71,6 +77,23 @@ bool RendererSummary::render(const aiwar::core::ItemManager&, const aiwar::core:
         std::cout << std::endl;
 
         std::cout << sm.dump();
+
+        if(im.cacheEnabled())
+            std::cout << "neighbour cache (hits/misses): " << im.cacheHits() << " / " << im.cacheMisses() << std::endl;
+
+        if(aiwar::core::PerfCounters::enabled())
+            std::cout << aiwar::core::PerfCounters::instance().dump();
+
+        if(aiwar::core::AllocTracker::compiled())
+            std::cout << aiwar::core::AllocTracker::dump();
+
+        if(aiwar::core::Config::instance().debug)
+        {
+            std::cout << "item pools high-water marks (missiles/miningships/fighters): "
+                      << aiwar::core::Missile::pool().highWaterMark() << " / "
+                      << aiwar::core::MiningShip::pool().highWaterMark() << " / "
+                      << aiwar::core::Fighter::pool().highWaterMark() << std::endl;
+        }
     }
     return true;
 }
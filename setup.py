@@ -1,9 +1,10 @@
 from distutils.core import setup, Extension
 
-cxxsrc = ["config.cpp", "item.cpp", "living.cpp", "movable.cpp", "playable.cpp", "memory.cpp", "mineral.cpp", "base.cpp", "miningship.cpp", "fighter.cpp", "missile.cpp", "item_manager.cpp", "game_manager.cpp", "stat_manager.cpp", "python_wrapper.cpp"]
+cxxsrc = ["config.cpp", "item.cpp", "living.cpp", "movable.cpp", "playable.cpp", "memory.cpp", "mineral.cpp", "base.cpp", "miningship.cpp", "fighter.cpp", "missile.cpp", "item_manager.cpp", "spatial_grid.cpp", "kinematics.cpp", "static_layer.cpp", "kd_tree.cpp", "profiler.cpp", "cpu_time.cpp", "think_watchdog.cpp", "alloc_tracker.cpp", "perf_counters.cpp", "game_manager.cpp", "stat_manager.cpp", "python_wrapper.cpp"]
 
 
 setup(name="aiwar", version="1.0-beta1",
       ext_modules=[
-        Extension("aiwar", cxxsrc, libraries=["tinyxml"])
+        Extension("aiwar", cxxsrc, libraries=["tinyxml"]),
+        Extension("example_capi", ["players_example/example_capi.c"], include_dirs=["client"])
         ])
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Associative container with O(1) insertion, removal and lookup
+         *
+         * Values are stored contiguously, in insertion order, as (key, value) pairs.
+         * A key is made of the index of a slot, which gives the position of the
+         * value, and of a serial number incremented at each insertion. So keys are
+         * never reused, a removed key is never found again and keys are sorted
+         * by insertion order.
+         *
+         * erase() leaves a hole in the values until compact() is called. Lookups
+         * are valid with holes, but iterations must be done after compact().
+         */
+        template<typename T>
+        class SlotMap
+        {
+        public:
+            typedef unsigned long long Key;
+            typedef std::pair<Key, T> value_type;
+            typedef std::vector<value_type> ValueVector;
+            typedef typename ValueVector::iterator iterator;
+            typedef typename ValueVector::const_iterator const_iterator;
+            typedef typename ValueVector::size_type size_type;
+
+            static const unsigned int INDEX_BITS = 24; ///< up to 16M values at the same time
+
+            SlotMap();
+
+            /**
+             * \brief Get the key that the next call to insert() will return
+             */
+            Key nextKey() const;
+
+            Key insert(const T &value);
+
+            /**
+             * \brief Remove a value
+             * \return False if the key is not in the map
+             *
+             * The value is not found anymore, but its place is kept until the next compact().
+             */
+            bool erase(Key key);
+
+            /**
+             * \brief Find a value
+             * \return The value, or T() if the key is not in the map
+             */
+            T get(Key key) const;
+            bool contains(Key key) const;
+
+            /**
+             * \brief Remove the holes left by erase(), keeping the insertion order
+             */
+            void compact();
+
+            void clear();
+
+            /**
+             * \brief Number of values, holes included
+             */
+            size_type size() const;
+
+            /**
+             * \brief Access the (key, value) pair at a given position
+             */
+            const value_type& at(size_type pos) const;
+
+            iterator begin();
+            iterator end();
+            const_iterator begin() const;
+            const_iterator end() const;
+
+        private:
+            class Slot
+            {
+            public:
+                Slot() : key(0), pos(0) {}
+
+                Key key; ///< key of the value in this slot, 0 if the slot is free
+                size_type pos; ///< position of the value in _values
+            };
+
+            static size_type _index(Key key);
+
+            std::vector<Slot> _slots;
+            std::vector<size_type> _freeSlots;
+            ValueVector _values;
+            Key _serial;
+            size_type _holes;
+        };
+
+
+// template implementation
+
+
+        template<typename T>
+        SlotMap<T>::SlotMap() : _serial(0), _holes(0)
+        {
+        }
+
+        template<typename T>
+        typename SlotMap<T>::Key SlotMap<T>::nextKey() const
+        {
+            Key index = _freeSlots.empty() ? _slots.size() : _freeSlots.back();
+            return ((_serial + 1) << INDEX_BITS) | index;
+        }
+
+        template<typename T>
+        typename SlotMap<T>::Key SlotMap<T>::insert(const T &value)
+        {
+            size_type index;
+            if(_freeSlots.empty())
+            {
+                index = _slots.size();
+                if(index >> INDEX_BITS)
+                    throw std::length_error("SlotMap: too many values");
+                _slots.push_back(Slot());
+            }
+            else
+            {
+                index = _freeSlots.back();
+                _freeSlots.pop_back();
+            }
+
+            Key key = (++_serial << INDEX_BITS) | index;
+            _slots[index].key = key;
+            _slots[index].pos = _values.size();
+            _values.push_back(value_type(key, value));
+            return key;
+        }
+
+        template<typename T>
+        bool SlotMap<T>::erase(Key key)
+        {
+            if(!contains(key))
+                return false;
+
+            Slot &slot = _slots[_index(key)];
+            _values[slot.pos] = value_type(0, T());
+            slot.key = 0;
+            _freeSlots.push_back(_index(key));
+            _holes++;
+            return true;
+        }
+
+        template<typename T>
+        T SlotMap<T>::get(Key key) const
+        {
+            if(!contains(key))
+                return T();
+            return _values[_slots[_index(key)].pos].second;
+        }
+
+        template<typename T>
+        bool SlotMap<T>::contains(Key key) const
+        {
+            size_type index = _index(key);
+            return key != 0 && index < _slots.size() && _slots[index].key == key;
+        }
+
+        template<typename T>
+        void SlotMap<T>::compact()
+        {
+            if(!_holes)
+                return;
+
+            size_type i, j;
+            for(i = 0, j = 0 ; i < _values.size() ; ++i)
+            {
+                if(_values[i].first == 0)
+                    continue;
+
+                if(i != j)
+                {
+                    _values[j] = _values[i];
+                    _slots[_index(_values[j].first)].pos = j;
+                }
+                j++;
+            }
+            _values.resize(j);
+            _holes = 0;
+        }
+
+        template<typename T>
+        void SlotMap<T>::clear()
+        {
+            _slots.clear();
+            _freeSlots.clear();
+            _values.clear();
+            _holes = 0;
+        }
+
+        template<typename T>
+        typename SlotMap<T>::size_type SlotMap<T>::size() const
+        {
+            return _values.size();
+        }
+
+        template<typename T>
+        const typename SlotMap<T>::value_type& SlotMap<T>::at(size_type pos) const
+        {
+            return _values[pos];
+        }
+
+        template<typename T>
+        typename SlotMap<T>::iterator SlotMap<T>::begin()
+        {
+            return _values.begin();
+        }
+
+        template<typename T>
+        typename SlotMap<T>::iterator SlotMap<T>::end()
+        {
+            return _values.end();
+        }
+
+        template<typename T>
+        typename SlotMap<T>::const_iterator SlotMap<T>::begin() const
+        {
+            return _values.begin();
+        }
+
+        template<typename T>
+        typename SlotMap<T>::const_iterator SlotMap<T>::end() const
+        {
+            return _values.end();
+        }
+
+        template<typename T>
+        typename SlotMap<T>::size_type SlotMap<T>::_index(Key key)
+        {
+            return static_cast<size_type>(key & ((static_cast<Key>(1) << INDEX_BITS) - 1));
+        }
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* SLOT_MAP_HPP */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#include "spatial_grid.hpp"
+
+#include "item.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace aiwar::core;
+
+SpatialGrid::SpatialGrid(double cellSize) : _cellSize(cellSize > 0.0 ? cellSize : 1.0), _size(0), _stamp(0)
+{
+}
+
+SpatialGrid::~SpatialGrid()
+{
+}
+
+void SpatialGrid::setCellSize(double cellSize)
+{
+    if(cellSize <= 0.0 || cellSize == _cellSize)
+        return;
+
+    // re-index all the items with the new cell size
+    ItemVector items;
+    items.reserve(_size);
+    CellMap::const_iterator cit;
+    for(cit = _cells.begin() ; cit != _cells.end() ; ++cit)
+        items.insert(items.end(), cit->second.items.begin(), cit->second.items.end());
+
+    clear();
+    _cellSize = cellSize;
+
+    ItemVector::const_iterator it;
+    for(it = items.begin() ; it != items.end() ; ++it)
+        insert(*it);
+}
+
+double SpatialGrid::cellSize() const
+{
+    return _cellSize;
+}
+
+void SpatialGrid::insert(Item *item)
+{
+    _insert(_cellOf(item->xpos(), item->ypos()), item);
+}
+
+void SpatialGrid::remove(Item *item)
+{
+    _remove(_cellOf(item->xpos(), item->ypos()), item);
+}
+
+void SpatialGrid::move(Item *item, double oldx, double oldy)
+{
+    CellKey oldCell = _cellOf(oldx, oldy);
+    CellKey newCell = _cellOf(item->xpos(), item->ypos());
+    if(oldCell == newCell)
+    {
+        // the item stays in its cell, but the cell content has changed
+        _cells[oldCell].stamp = ++_stamp;
+        return;
+    }
+
+    _remove(oldCell, item);
+    _insert(newCell, item);
+}
+
+void SpatialGrid::query(double px, double py, double radius, ItemVector &res) const
+{
+    CellKey min = _cellOf(px - radius, py - radius);
+    CellKey max = _cellOf(px + radius, py + radius);
+
+    long cx, cy;
+    for(cx = min.first ; cx <= max.first ; ++cx)
+    {
+        for(cy = min.second ; cy <= max.second ; ++cy)
+        {
+            CellMap::const_iterator cit = _cells.find(CellKey(cx, cy));
+            if(cit != _cells.end())
+                res.insert(res.end(), cit->second.items.begin(), cit->second.items.end());
+        }
+    }
+}
+
+unsigned long SpatialGrid::stamp() const
+{
+    return _stamp;
+}
+
+unsigned long SpatialGrid::stamp(double px, double py, double radius) const
+{
+    CellKey min = _cellOf(px - radius, py - radius);
+    CellKey max = _cellOf(px + radius, py + radius);
+
+    unsigned long s = 0;
+    long cx, cy;
+    for(cx = min.first ; cx <= max.first ; ++cx)
+    {
+        for(cy = min.second ; cy <= max.second ; ++cy)
+        {
+            CellMap::const_iterator cit = _cells.find(CellKey(cx, cy));
+            if(cit != _cells.end() && cit->second.stamp > s)
+                s = cit->second.stamp;
+        }
+    }
+    return s;
+}
+
+void SpatialGrid::clear()
+{
+    _cells.clear();
+    _size = 0;
+    _stamp++;
+}
+
+std::size_t SpatialGrid::size() const
+{
+    return _size;
+}
+
+SpatialGrid::CellKey SpatialGrid::_cellOf(double px, double py) const
+{
+    return CellKey(static_cast<long>(std::floor(px / _cellSize)), static_cast<long>(std::floor(py / _cellSize)));
+}
+
+void SpatialGrid::_insert(const CellKey &cell, Item *item)
+{
+    Cell &c = _cells[cell];
+    c.items.push_back(item);
+    c.stamp = ++_stamp;
+    _size++;
+}
+
+void SpatialGrid::_remove(const CellKey &cell, Item *item)
+{
+    CellMap::iterator cit = _cells.find(cell);
+    if(cit == _cells.end())
+        return;
+
+    ItemVector &v = cit->second.items;
+    ItemVector::iterator it = std::find(v.begin(), v.end(), item);
+    if(it == v.end())
+        return;
+
+    // order inside a cell does not matter: swap with the last one
+    *it = v.back();
+    v.pop_back();
+    cit->second.stamp = ++_stamp;
+    _size--;
+}
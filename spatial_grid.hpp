@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+namespace aiwar {
+    namespace core {
+
+        class Item;
+
+        /**
+         * \brief Uniform grid indexing items by their position
+         *
+         * The plane is split in square cells of the same size and each item is
+         * stored in the cell containing its position. A query returns every item
+         * of the cells covered by a disc: the caller still has to check the
+         * exact distance.
+         */
+        class SpatialGrid
+        {
+        public:
+            typedef std::vector<Item*> ItemVector;
+
+            SpatialGrid(double cellSize = 1.0);
+            ~SpatialGrid();
+
+            /**
+             * \brief Change the size of the cells
+             * \param cellSize The new size, must be strictly positive
+             *
+             * Items already stored are re-indexed.
+             */
+            void setCellSize(double cellSize);
+            double cellSize() const;
+
+            void insert(Item *item);
+
+            /**
+             * \brief Remove an item
+             * \param item The item to remove, it must be at the position it was inserted or last moved to
+             */
+            void remove(Item *item);
+
+            /**
+             * \brief Update the cell of an item after a move
+             * \param item The item that has moved
+             * \param oldx The x position before the move
+             * \param oldy The y position before the move
+             */
+            void move(Item *item, double oldx, double oldy);
+
+            /**
+             * \brief Get the items of all the cells covered by a disc
+             * \param px x position of the center of the disc
+             * \param py y position of the center of the disc
+             * \param radius Radius of the disc
+             * \param res Items are appended to this vector, in no particular order
+             */
+            void query(double px, double py, double radius, ItemVector &res) const;
+
+            /**
+             * \brief Get the current modification stamp
+             * \return A value incremented each time an item is inserted, removed or moved
+             */
+            unsigned long stamp() const;
+
+            /**
+             * \brief Get the last modification stamp of the cells covered by a disc
+             * \return The stamp of the last modification in these cells, 0 if they were never modified
+             *
+             * If the returned value is not greater than a stamp() previously saved, no
+             * item has been inserted, removed or moved in these cells since.
+             * Stamps saved before a call to clear() or setCellSize() must be discarded.
+             */
+            unsigned long stamp(double px, double py, double radius) const;
+
+            void clear();
+            std::size_t size() const;
+
+        private:
+            typedef std::pair<long, long> CellKey;
+
+            class Cell
+            {
+            public:
+                Cell() : stamp(0) {}
+
+                ItemVector items;
+                unsigned long stamp; ///< stamp of the last modification of the cell
+            };
+
+            // cells are never removed, so their stamps stay valid until clear()
+            typedef std::map<CellKey, Cell> CellMap;
+
+            CellKey _cellOf(double px, double py) const;
+            void _insert(const CellKey &cell, Item *item);
+            void _remove(const CellKey &cell, Item *item);
+
+            double _cellSize;
+            CellMap _cells;
+            std::size_t _size;
+            unsigned long _stamp;
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* SPATIAL_GRID_HPP */
@@ -44,6 +44,10 @@ void StatManager::nextRound()
 {
     _round++;
     _progress = false;
+
+    TeamMap::iterator it;
+    for(it = _teamMap.begin() ; it != _teamMap.end() ; ++it)
+        it->second.think_tick = 0.0;
 }
  
 unsigned int StatManager::round() const
@@ -164,18 +168,46 @@ unsigned int StatManager::mineralSpent(const Team& t) const
     return _teamMap.find(t)->second.nb_mineral_spent;
 }
 
-void StatManager::itemDestroyed(const Item* item)
+void StatManager::thinkTime(const Team& t, double seconds)
 {
-    const aiwar::core::MiningShip *miningShip;
-    const aiwar::core::Base *base;
-    const aiwar::core::Fighter *fighter;
+    TeamInfo &info = _teamMap[t];
+    info.think_time += seconds;
+    info.think_tick += seconds;
+    if(info.think_tick > info.think_tick_max)
+        info.think_tick_max = info.think_tick;
+}
 
-    if((fighter = dynamic_cast<const aiwar::core::Fighter*>(item)))
-        fighterDestroyed(fighter);
-    else if((miningShip = dynamic_cast<const aiwar::core::MiningShip*>(item)))
-        miningShipDestroyed(miningShip);
-    else if((base = dynamic_cast<const aiwar::core::Base*>(item)))
-        baseDestroyed(base);
+double StatManager::thinkTime(const Team& t) const
+{
+    return _teamMap.find(t)->second.think_time;
+}
+
+double StatManager::tickThinkTime(const Team& t) const
+{
+    return _teamMap.find(t)->second.think_tick;
+}
+
+double StatManager::maxTickThinkTime(const Team& t) const
+{
+    return _teamMap.find(t)->second.think_tick_max;
+}
+
+void StatManager::itemDestroyed(const Item* item)
+{
+    switch(item->_kind())
+    {
+    case FIGHTER_KIND:
+        fighterDestroyed(item_cast<Fighter>(item));
+        break;
+    case MININGSHIP_KIND:
+        miningShipDestroyed(item_cast<MiningShip>(item));
+        break;
+    case BASE_KIND:
+        baseDestroyed(item_cast<Base>(item));
+        break;
+    default:
+        break;
+    }
 }
 
 void StatManager::reportActivity()
@@ -223,6 +255,8 @@ std::string StatManager::dump() const
             << "\tFighters (current/max):      " << cit->second.nb_fighter << " / " << cit->second.nb_fighter_max << "\n"
             << "\tMissiles (created/launched): " << cit->second.nb_missile_created << " / " << cit->second.nb_missile_launched << "\n"
             << "\tMinerals (spent/saved):      " << cit->second.nb_mineral_spent << " / " << cit->second.nb_mineral_saved << "\n"
+            << "\tThink time (total/max round): " << std::fixed << std::setprecision(3) << cit->second.think_time << " s / "
+            << cit->second.think_tick_max * 1000.0 << " ms\n"
             << "----------------------------------------------\n";
 
     }
@@ -240,6 +274,7 @@ StatManager::TeamInfo::TeamInfo()
       nb_miningShip(0), nb_miningShip_max(0),
       nb_fighter(0), nb_fighter_max(0),
       nb_missile_created(0), nb_missile_launched(0),
-      nb_mineral_saved(0), nb_mineral_spent(0)
+      nb_mineral_saved(0), nb_mineral_spent(0),
+      think_time(0.0), think_tick(0.0), think_tick_max(0.0)
 {
 }
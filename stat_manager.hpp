@@ -65,6 +65,14 @@ namespace aiwar {
 
             void itemDestroyed(const Item*);
 
+            /**
+             * \brief CPU time spent by the play functions of a team, in seconds
+             */
+            void thinkTime(const Team&, double);
+            double thinkTime(const Team&) const;
+            double tickThinkTime(const Team&) const; ///< during the current round
+            double maxTickThinkTime(const Team&) const; ///< during the slowest round
+
             void reportActivity();
             void checkActivity();
             unsigned int inactiveRounds() const;
@@ -100,6 +108,9 @@ namespace aiwar {
             unsigned int nb_missile_launched;
             unsigned int nb_mineral_saved;
             unsigned int nb_mineral_spent;
+            double think_time;
+            double think_tick;
+            double think_tick_max;
         };
 
     } // aiwar::core
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "static_layer.hpp"
+
+#include "item.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace aiwar::core;
+
+StaticLayer::StaticLayer(double cellSize) : _cellSize(cellSize > 0.0 ? cellSize : 1.0), _holes(0)
+{
+}
+
+StaticLayer::~StaticLayer()
+{
+}
+
+void StaticLayer::setCellSize(double cellSize)
+{
+    if(cellSize <= 0.0 || cellSize == _cellSize)
+        return;
+
+    _cellSize = cellSize;
+    build();
+}
+
+void StaticLayer::insert(Item *item)
+{
+    _pending.push_back(item);
+}
+
+void StaticLayer::remove(Item *item)
+{
+    // pending items are few: look there first
+    ItemVector::iterator pit = std::find(_pending.begin(), _pending.end(), item);
+    if(pit != _pending.end())
+    {
+        _pending.erase(pit);
+        return;
+    }
+
+    CellKey cell = _cellOf(item->xpos(), item->ypos());
+    std::vector<CellKey>::const_iterator cit = std::lower_bound(_cells.begin(), _cells.end(), cell);
+    if(cit == _cells.end() || *cit != cell)
+        return;
+
+    std::size_t c = cit - _cells.begin();
+    for(std::size_t i = _start[c] ; i < _start[c+1] ; ++i)
+    {
+        if(_items[i] == item)
+        {
+            _items[i] = NULL;
+            _holes++;
+            break;
+        }
+    }
+
+    // the index is immutable, but not forever
+    if(_holes > 32 && _holes > _items.size() / 2)
+        build();
+}
+
+namespace {
+
+// sort items by cell, using their position
+class CellLess
+{
+public:
+    CellLess(double cellSize) : _cellSize(cellSize) {}
+
+    bool operator()(const Item *a, const Item *b) const
+    {
+        long ax = static_cast<long>(std::floor(a->xpos() / _cellSize));
+        long bx = static_cast<long>(std::floor(b->xpos() / _cellSize));
+        if(ax != bx)
+            return ax < bx;
+        return static_cast<long>(std::floor(a->ypos() / _cellSize)) < static_cast<long>(std::floor(b->ypos() / _cellSize));
+    }
+
+private:
+    double _cellSize;
+};
+
+} // anonymous namespace
+
+void StaticLayer::build()
+{
+    ItemVector items;
+    items.reserve(_items.size() - _holes + _pending.size());
+    ItemVector::const_iterator it;
+    for(it = _items.begin() ; it != _items.end() ; ++it)
+    {
+        if(*it)
+            items.push_back(*it);
+    }
+    items.insert(items.end(), _pending.begin(), _pending.end());
+    _pending.clear();
+    _holes = 0;
+
+    std::stable_sort(items.begin(), items.end(), CellLess(_cellSize));
+
+    _cells.clear();
+    _start.clear();
+    for(std::size_t i = 0 ; i < items.size() ; ++i)
+    {
+        CellKey cell = _cellOf(items[i]->xpos(), items[i]->ypos());
+        if(_cells.empty() || _cells.back() != cell)
+        {
+            _cells.push_back(cell);
+            _start.push_back(i);
+        }
+    }
+    _start.push_back(items.size());
+
+    _items.swap(items);
+}
+
+void StaticLayer::query(double px, double py, double radius, ItemVector &res) const
+{
+    CellKey min = _cellOf(px - radius, py - radius);
+    CellKey max = _cellOf(px + radius, py + radius);
+
+    // cells are sorted by column then by row: one binary search per column
+    long cx;
+    for(cx = min.first ; cx <= max.first ; ++cx)
+    {
+        std::vector<CellKey>::const_iterator cit = std::lower_bound(_cells.begin(), _cells.end(), CellKey(cx, min.second));
+        for( ; cit != _cells.end() && cit->first == cx && cit->second <= max.second ; ++cit)
+        {
+            std::size_t c = cit - _cells.begin();
+            for(std::size_t i = _start[c] ; i < _start[c+1] ; ++i)
+            {
+                if(_items[i])
+                    res.push_back(_items[i]);
+            }
+        }
+    }
+
+    // items not packed yet
+    ItemVector::const_iterator it;
+    for(it = _pending.begin() ; it != _pending.end() ; ++it)
+        res.push_back(*it);
+}
+
+void StaticLayer::clear()
+{
+    _cells.clear();
+    _start.clear();
+    _items.clear();
+    _pending.clear();
+    _holes = 0;
+}
+
+std::size_t StaticLayer::size() const
+{
+    return _items.size() - _holes + _pending.size();
+}
+
+StaticLayer::CellKey StaticLayer::_cellOf(double px, double py) const
+{
+    return CellKey(static_cast<long>(std::floor(px / _cellSize)), static_cast<long>(std::floor(py / _cellSize)));
+}
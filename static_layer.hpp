@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATIC_LAYER_HPP
+#define STATIC_LAYER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "spatial_grid.hpp" // for SpatialGrid::ItemVector
+
+namespace aiwar {
+    namespace core {
+
+        class Item;
+
+        /**
+         * \brief Spatial index of the items that never move (minerals)
+         *
+         * Items are packed cell by cell in one array, with a sorted table of the
+         * non-empty cells: a query only reads contiguous memory. The index is
+         * built once by build() and does not change afterwards, except that
+         * removed items leave a hole. It is rebuilt when there are too many holes.
+         * Items inserted after build() are kept apart and still found by query().
+         */
+        class StaticLayer
+        {
+        public:
+            typedef SpatialGrid::ItemVector ItemVector;
+
+            StaticLayer(double cellSize = 1.0);
+            ~StaticLayer();
+
+            /**
+             * \brief Change the size of the cells, the index is rebuilt
+             * \param cellSize The new size, must be strictly positive
+             */
+            void setCellSize(double cellSize);
+
+            /**
+             * \brief Add an item, it will be packed in the index at the next build()
+             */
+            void insert(Item *item);
+
+            /**
+             * \brief Remove an item, it leaves a hole in the index
+             * \param item The item to remove, it must not have moved since its insertion
+             */
+            void remove(Item *item);
+
+            /**
+             * \brief Pack the index with all the items, holes removed
+             */
+            void build();
+
+            /**
+             * \brief Get the items of all the cells covered by a disc
+             * \param px x position of the center of the disc
+             * \param py y position of the center of the disc
+             * \param radius Radius of the disc
+             * \param res Items are appended to this vector, in no particular order
+             */
+            void query(double px, double py, double radius, ItemVector &res) const;
+
+            void clear();
+            std::size_t size() const;
+
+        private:
+            typedef std::pair<long, long> CellKey;
+
+            // no copy
+            StaticLayer(const StaticLayer&);
+            StaticLayer& operator=(const StaticLayer&);
+
+            CellKey _cellOf(double px, double py) const;
+
+            double _cellSize;
+
+            std::vector<CellKey> _cells; ///< non-empty cells, sorted
+            std::vector<std::size_t> _start; ///< items of _cells[i] are _items[_start[i]] to _items[_start[i+1]-1]
+            ItemVector _items; ///< packed items, NULL for a removed item
+
+            ItemVector _pending; ///< items inserted since the last build()
+            std::size_t _holes; ///< number of NULL in _items
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* STATIC_LAYER_HPP */
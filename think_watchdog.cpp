@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "think_watchdog.hpp"
+
+#include <cstdio>
+#include <vector>
+
+#ifndef _WIN32
+#       include <pthread.h>
+#       include <time.h>
+#       include <unistd.h>
+#endif
+
+using namespace aiwar::core;
+
+#ifndef _WIN32
+namespace {
+
+// period of the checks, in nanoseconds
+const long PERIOD = 5000000;
+
+// wall time left to a play function to return once it has been stopped, in seconds
+const double LAST_RESORT = 5.0;
+
+// a team with threads in scopes
+struct TeamWatch
+{
+    int scopes;
+    double budget;
+    double used; ///< CPU time of the scopes already left
+    bool expired;
+    double stoppedAt; ///< wall time at which the team had used twice its budget plus a second, 0 before
+};
+
+// a thread in a scope
+struct Thinker
+{
+    bool active;
+    Team team;
+    pthread_t thread;
+    clockid_t clock;
+    double start;
+};
+
+// everything is protected by the lock
+pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t armed = PTHREAD_COND_INITIALIZER;
+bool started = false;
+TeamWatch teams[RED_TEAM + 1];
+std::vector<Thinker> thinkers;
+std::vector<ThinkWatchdog::Interrupt> interrupts;
+
+double cpuTime(clockid_t clock)
+{
+    timespec ts;
+    if(clock_gettime(clock, &ts) != 0)
+        return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double wallTime()
+{
+    return cpuTime(CLOCK_MONOTONIC);
+}
+
+double used(int team)
+{
+    double u = teams[team].used;
+    std::vector<Thinker>::const_iterator it;
+    for(it = thinkers.begin() ; it != thinkers.end() ; ++it)
+    {
+        if(it->active && it->team == team)
+            u += cpuTime(it->clock) - it->start;
+    }
+    return u;
+}
+
+void interrupt()
+{
+    std::vector<ThinkWatchdog::Interrupt>::const_iterator it;
+    for(it = interrupts.begin() ; it != interrupts.end() ; ++it)
+        (*it)();
+}
+
+// last resort, the play function does not return even after it has been stopped:
+// the game ends without its summary, with the exit code main() gives to a BudgetError
+void forfeit(int team)
+{
+    Config &cfg = Config::instance();
+    const std::string &name = cfg.players[(team == BLUE_TEAM) ? cfg.blue : cfg.red].name;
+    std::printf("********** GameOver *********\nTeam %s forfeits: think time over budget, its play function does not return\n", name.c_str());
+    std::fflush(stdout);
+    _exit((team == BLUE_TEAM) ? 21 : 22);
+}
+
+void* watch(void*)
+{
+    pthread_mutex_lock(&lock);
+    for(;;)
+    {
+        bool watching = false;
+        for(int t = BLUE_TEAM ; t <= RED_TEAM ; ++t)
+        {
+            TeamWatch &w = teams[t];
+            if(w.scopes == 0)
+                continue;
+
+            // the play function is stopped, the main thread throws a BudgetError when it returns
+            watching = true;
+            double u = used(t);
+            if(!w.expired && u > w.budget)
+            {
+                w.expired = true;
+                interrupt();
+            }
+            else if(w.expired && w.stoppedAt == 0.0 && u > 2.0 * w.budget + 1.0)
+            {
+                // the first interrupt may have been caught by the AI
+                w.stoppedAt = wallTime();
+                interrupt();
+            }
+            else if(w.stoppedAt > 0.0 && wallTime() - w.stoppedAt > LAST_RESORT)
+                forfeit(t);
+        }
+
+        if(watching)
+        {
+            pthread_mutex_unlock(&lock);
+            timespec ts = { 0, PERIOD };
+            nanosleep(&ts, NULL);
+            pthread_mutex_lock(&lock);
+        }
+        else
+            pthread_cond_wait(&armed, &lock);
+    }
+    return NULL;
+}
+
+} // anonymous namespace
+#endif
+
+
+/*** ThinkWatchdog class ***/
+
+void ThinkWatchdog::addInterrupt(Interrupt interrupt)
+{
+#ifndef _WIN32
+    pthread_mutex_lock(&lock);
+    interrupts.push_back(interrupt);
+    pthread_mutex_unlock(&lock);
+#else
+    (void)interrupt;
+#endif
+}
+
+bool ThinkWatchdog::expired(Team team)
+{
+#ifndef _WIN32
+    if(team == NO_TEAM)
+        return false;
+    pthread_mutex_lock(&lock);
+    bool e = teams[team].scopes > 0 && teams[team].expired;
+    pthread_mutex_unlock(&lock);
+    return e;
+#else
+    (void)team;
+    return false;
+#endif
+}
+
+double ThinkWatchdog::left(Team team)
+{
+#ifndef _WIN32
+    if(team == NO_TEAM)
+        return -1.0;
+    pthread_mutex_lock(&lock);
+    double l = -1.0;
+    if(teams[team].scopes > 0)
+    {
+        l = teams[team].budget - used(team);
+        if(l < 0.0)
+            l = 0.0;
+    }
+    pthread_mutex_unlock(&lock);
+    return l;
+#else
+    (void)team;
+    return -1.0;
+#endif
+}
+
+Team ThinkWatchdog::current()
+{
+    Team team = NO_TEAM;
+#ifndef _WIN32
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&lock);
+    std::vector<Thinker>::const_iterator it;
+    for(it = thinkers.begin() ; it != thinkers.end() ; ++it)
+    {
+        if(it->active && pthread_equal(it->thread, self))
+            team = it->team;
+    }
+    pthread_mutex_unlock(&lock);
+#endif
+    return team;
+}
+
+
+/*** ThinkScope class ***/
+
+ThinkScope::ThinkScope(Team team, double budget) : _slot(-1)
+{
+#ifndef _WIN32
+    clockid_t clock;
+    if(team == NO_TEAM || budget < 0.0 || pthread_getcpuclockid(pthread_self(), &clock) != 0)
+        return;
+
+    pthread_mutex_lock(&lock);
+    TeamWatch &w = teams[team];
+    if(w.scopes++ == 0)
+    {
+        w.budget = budget;
+        w.used = 0.0;
+        w.expired = false;
+        w.stoppedAt = 0.0;
+    }
+
+    std::vector<Thinker>::size_type i;
+    for(i = 0 ; i < thinkers.size() && thinkers[i].active ; ++i)
+        ;
+    if(i == thinkers.size())
+        thinkers.push_back(Thinker());
+    Thinker &th = thinkers[i];
+    th.active = true;
+    th.team = team;
+    th.thread = pthread_self();
+    th.clock = clock;
+    th.start = cpuTime(clock);
+    _slot = static_cast<int>(i);
+
+    if(!started)
+    {
+        pthread_t thread;
+        started = (pthread_create(&thread, NULL, &watch, NULL) == 0);
+        if(started)
+            pthread_detach(thread);
+    }
+    pthread_cond_signal(&armed);
+    pthread_mutex_unlock(&lock);
+#else
+    (void)team;
+    (void)budget;
+#endif
+}
+
+ThinkScope::~ThinkScope()
+{
+#ifndef _WIN32
+    if(_slot < 0)
+        return;
+
+    pthread_mutex_lock(&lock);
+    Thinker &th = thinkers[_slot];
+    TeamWatch &w = teams[th.team];
+    w.used += cpuTime(th.clock) - th.start;
+    w.scopes--;
+    th.active = false;
+    pthread_mutex_unlock(&lock);
+#endif
+}
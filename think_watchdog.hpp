@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THINK_WATCHDOG_HPP
+#define THINK_WATCHDOG_HPP
+
+#include "config.hpp" // for Team
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Watches the play functions while they run, to stop the ones thinking beyond the budget of their team
+         *
+         * The game checks the think time of a team (Config::tickBudget,
+         * Config::matchBudget) after each play function. The watchdog checks
+         * it during the call: a thread reads every few milliseconds the CPU
+         * time of the threads in a ThinkScope. When a team goes over budget:
+         *  - expired() is true until its last scope is left, the native AIs
+         *    read it with over_budget() and the interrupts are called, the
+         *    python handler raises an exception in the python code with one;
+         *  - when the team has used twice its budget plus a second and is still
+         *    thinking, the interrupts are called again.
+         * The game throws a BudgetError when the play function returns, and the
+         * team forfeits. As a last resort, when the play function still has not
+         * returned a few seconds after the second interrupt, the watchdog ends
+         * the game at once with the exit code of a forfeit, since native code
+         * cannot be stopped from outside.
+         * The process handler does not wait for its processes longer than left().
+         *
+         * Without pthreads (Windows), only the checks after the calls are made.
+         */
+        class ThinkWatchdog
+        {
+        public:
+            typedef void (*Interrupt)();
+
+            /**
+             * \brief Call a function from the watchdog thread when a team goes over budget
+             */
+            static void addInterrupt(Interrupt interrupt);
+
+            /**
+             * \brief True once a thinking team is over budget, until its last scope is left
+             */
+            static bool expired(Team team);
+
+            /**
+             * \brief Think time left to a team in its scopes, in seconds, -1 if it is not watched
+             */
+            static double left(Team team);
+
+            /**
+             * \brief Team of the scope of the calling thread, NO_TEAM if none
+             */
+            static Team current();
+        };
+
+
+        /**
+         * \brief Watches the calling thread thinking for a team, from its construction to its destruction
+         */
+        class ThinkScope
+        {
+        public:
+            /**
+             * \param budget Think time left to the team, in seconds, negative for no limit (nothing
+             * is watched). Ignored when another thread of the team is in a scope: this one is added to it
+             */
+            ThinkScope(Team team, double budget);
+            ~ThinkScope();
+
+        private:
+            // no copy
+            ThinkScope(const ThinkScope&);
+            ThinkScope& operator=(const ThinkScope&);
+
+            int _slot; ///< -1 if not watched
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* THINK_WATCHDOG_HPP */
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.hpp"
+
+#ifndef _WIN32
+#       include <unistd.h>
+#endif
+
+using namespace aiwar::core;
+
+#ifndef _WIN32
+
+class ThreadPool::Worker
+{
+public:
+    Worker(ThreadPool *p, unsigned int i) : pool(p), id(i), started(false), begin(0), end(0)
+    {
+        pthread_mutex_init(&lock, NULL);
+    }
+
+    ~Worker()
+    {
+        pthread_mutex_destroy(&lock);
+    }
+
+    ThreadPool *pool;
+    unsigned int id;
+    pthread_t thread;
+    bool started; ///< false for the worker 0, or if the thread could not be created
+
+    pthread_mutex_t lock; ///< protects the range
+    std::size_t begin; ///< next task of the worker
+    std::size_t end; ///< end of its range
+};
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : _job(NULL), _batch(0), _busy(0), _stop(false), _threads(threads ? threads : processors())
+{
+    pthread_mutex_init(&_runLock, NULL);
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_start, NULL);
+    pthread_cond_init(&_done, NULL);
+
+    unsigned int w;
+    for(w = 0 ; w < _threads ; ++w)
+        _workers.push_back(new Worker(this, w));
+
+    // a worker without thread is emptied by the others
+    for(w = 1 ; w < _threads ; ++w)
+        _workers[w]->started = (pthread_create(&_workers[w]->thread, NULL, &ThreadPool::_main, _workers[w]) == 0);
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&_lock);
+    _stop = true;
+    pthread_cond_broadcast(&_start);
+    pthread_mutex_unlock(&_lock);
+
+    std::vector<Worker*>::iterator it;
+    for(it = _workers.begin() ; it != _workers.end() ; ++it)
+    {
+        if((*it)->started)
+            pthread_join((*it)->thread, NULL);
+        delete *it;
+    }
+
+    pthread_cond_destroy(&_done);
+    pthread_cond_destroy(&_start);
+    pthread_mutex_destroy(&_lock);
+    pthread_mutex_destroy(&_runLock);
+}
+
+void ThreadPool::run(Job &job, std::size_t count)
+{
+    if(count == 0)
+        return;
+
+    if(_threads == 1)
+    {
+        for(std::size_t i = 0 ; i < count ; ++i)
+            job.run(i, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&_runLock);
+
+    // no worker is busy: the ranges can be changed
+    unsigned int w, started = 0;
+    for(w = 0 ; w < _threads ; ++w)
+    {
+        Worker &worker = *_workers[w];
+        pthread_mutex_lock(&worker.lock);
+        worker.begin = count * w / _threads;
+        worker.end = count * (w + 1) / _threads;
+        pthread_mutex_unlock(&worker.lock);
+        if(worker.started)
+            started++;
+    }
+
+    pthread_mutex_lock(&_lock);
+    _job = &job;
+    _batch++;
+    _busy = started;
+    pthread_cond_broadcast(&_start);
+    pthread_mutex_unlock(&_lock);
+
+    _work(0);
+
+    pthread_mutex_lock(&_lock);
+    while(_busy > 0)
+        pthread_cond_wait(&_done, &_lock);
+    _job = NULL;
+    pthread_mutex_unlock(&_lock);
+
+    pthread_mutex_unlock(&_runLock);
+}
+
+void* ThreadPool::_main(void *worker)
+{
+    Worker *me = static_cast<Worker*>(worker);
+    ThreadPool &pool = *me->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool._lock);
+    for(;;)
+    {
+        while(!pool._stop && pool._batch == seen)
+            pthread_cond_wait(&pool._start, &pool._lock);
+        if(pool._stop)
+            break;
+        seen = pool._batch;
+
+        pthread_mutex_unlock(&pool._lock);
+        pool._work(me->id);
+        pthread_mutex_lock(&pool._lock);
+
+        if(--pool._busy == 0)
+            pthread_cond_signal(&pool._done);
+    }
+    pthread_mutex_unlock(&pool._lock);
+    return NULL;
+}
+
+void ThreadPool::_work(unsigned int w)
+{
+    std::size_t index;
+    while(_next(w, index))
+        _job->run(index, w);
+}
+
+bool ThreadPool::_next(unsigned int w, std::size_t &index)
+{
+    Worker &me = *_workers[w];
+
+    pthread_mutex_lock(&me.lock);
+    if(me.begin < me.end)
+    {
+        index = me.begin++;
+        pthread_mutex_unlock(&me.lock);
+        return true;
+    }
+    pthread_mutex_unlock(&me.lock);
+
+    // steal the upper half of the range of another worker, the next ones first
+    for(unsigned int k = 1 ; k < _threads ; ++k)
+    {
+        Worker &victim = *_workers[(w + k) % _threads];
+        pthread_mutex_lock(&victim.lock);
+        if(victim.begin < victim.end)
+        {
+            std::size_t begin = victim.begin + (victim.end - victim.begin) / 2;
+            std::size_t end = victim.end;
+            victim.end = begin;
+            pthread_mutex_unlock(&victim.lock);
+
+            // the first stolen task is run now, the others go to the range of the thief
+            index = begin;
+            if(begin + 1 < end)
+            {
+                pthread_mutex_lock(&me.lock);
+                me.begin = begin + 1;
+                me.end = end;
+                pthread_mutex_unlock(&me.lock);
+            }
+            return true;
+        }
+        pthread_mutex_unlock(&victim.lock);
+    }
+
+    return false;
+}
+
+unsigned int ThreadPool::processors()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<unsigned int>(n) : 1;
+}
+
+#else // _WIN32
+
+class ThreadPool::Worker
+{
+};
+
+ThreadPool::ThreadPool(unsigned int)
+    : _threads(1)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+void ThreadPool::run(Job &job, std::size_t count)
+{
+    for(std::size_t i = 0 ; i < count ; ++i)
+        job.run(i, 0);
+}
+
+unsigned int ThreadPool::processors()
+{
+    return 1;
+}
+
+#endif // _WIN32
+
+unsigned int ThreadPool::threads() const
+{
+    return _threads;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2012, 2013 Paul Grégoire
+ *
+ * This file is part of AIWar.
+ *
+ * AIWar is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AIWar is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AIWar.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#ifndef _WIN32
+#       include <pthread.h>
+#endif
+
+namespace aiwar {
+    namespace core {
+
+        /**
+         * \brief Runs the tasks of a batch on a set of threads, with work stealing
+         *
+         * The indices of a batch are split in one range per thread. A thread runs
+         * its own range from the start, and when it is empty it steals the upper
+         * half of the range of another thread. The thread calling run() works too.
+         *
+         * Without pthreads (Windows), the tasks run one after the other.
+         */
+        class ThreadPool
+        {
+        public:
+            /**
+             * \brief Tasks of a batch, run() is called once per index
+             */
+            class Job
+            {
+            public:
+                virtual ~Job() {}
+
+                /**
+                 * \brief Run a task, maybe at the same time as the others: it must not throw
+                 * \param index Index of the task in the batch
+                 * \param worker Index of the thread running it, 0 is the thread calling ThreadPool::run()
+                 */
+                virtual void run(std::size_t index, unsigned int worker) = 0;
+            };
+
+            /**
+             * \param threads Number of threads, the calling one included. 0 for one per processor
+             */
+            explicit ThreadPool(unsigned int threads = 0);
+            ~ThreadPool();
+
+            unsigned int threads() const;
+
+            /**
+             * \brief Run the tasks 0 to count-1 of a job and wait for their end
+             *
+             * Batches run one at a time: a second caller waits for the end of the first batch.
+             */
+            void run(Job &job, std::size_t count);
+
+            /**
+             * \brief Number of processors online, 1 if unknown
+             */
+            static unsigned int processors();
+
+        private:
+            class Worker;
+
+            // no copy
+            ThreadPool(const ThreadPool&);
+            ThreadPool& operator=(const ThreadPool&);
+
+#ifndef _WIN32
+            static void* _main(void *worker);
+
+            // run the tasks of the current batch until none is left
+            void _work(unsigned int w);
+            // take the next task of a worker range, or steal one
+            bool _next(unsigned int w, std::size_t &index);
+
+            std::vector<Worker*> _workers; ///< _workers[0] is the thread calling run()
+
+            pthread_mutex_t _runLock; ///< held during a batch
+            pthread_mutex_t _lock; ///< protects the fields below
+            pthread_cond_t _start; ///< a batch is available, or the pool stops
+            pthread_cond_t _done; ///< a worker has finished its part of the batch
+            Job *_job;
+            unsigned long _batch; ///< number of the current batch, workers wait for a new one
+            unsigned int _busy; ///< workers still working on the batch
+            bool _stop;
+#endif
+            unsigned int _threads;
+        };
+
+    } // namespace aiwar::core
+} // namespace aiwar
+
+#endif /* THREAD_POOL_HPP */